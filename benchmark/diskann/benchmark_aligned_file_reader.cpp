@@ -0,0 +1,150 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark_base.h"
+#include "diskann/linux_aligned_file_reader.h"
+#include "diskann/uring_aligned_file_reader.h"
+
+// IOPS and read latency of the DiskANN aligned file readers for random 4 KB reads, the reads of a beam search.
+//
+// Each thread submits `depth` reads at a time and waits for all of them, as a search does for the nodes of a beam.
+// The latency is that of such a batch, which is what a search waits for. The reads are O_DIRECT from the file named by
+// the DISKANN_READER_BENCH_FILE environment variable, which should be on the NVMe drive to measure. Without it, a 1 GB
+// file is written to the working directory.
+class Benchmark_aligned_file_reader : public Benchmark_base, public ::testing::Test {
+ protected:
+    void
+    SetUp() override {
+        T0_ = elapsed();
+        if (auto path = std::getenv("DISKANN_READER_BENCH_FILE")) {
+            file_path_ = path;
+        } else {
+            file_path_ = "aligned_file_reader_bench.bin";
+            printf("[%.3f s] Writing %s\n", get_time_diff(), file_path_.c_str());
+            std::ofstream writer(file_path_, std::ios::binary);
+            std::vector<char> block(1 << 20);
+            std::mt19937 rng(42);
+            for (size_t i = 0; i < kDefaultFileSize / block.size(); ++i) {
+                std::generate(block.begin(), block.end(), rng);
+                writer.write(block.data(), block.size());
+            }
+            remove_file_ = true;
+        }
+        std::ifstream reader(file_path_, std::ios::binary | std::ios::ate);
+        num_sectors_ = static_cast<size_t>(reader.tellg()) / kSectorLen;
+        ASSERT_GT(num_sectors_, 0);
+    }
+
+    void
+    TearDown() override {
+        if (remove_file_) {
+            std::remove(file_path_.c_str());
+        }
+    }
+
+    void
+    test_reader(const std::string& name, const std::function<std::shared_ptr<AlignedFileReader>()>& make_reader) {
+        printf("\n[%0.3f s] %s | %s, %zu sectors\n", get_time_diff(), name.c_str(), file_path_.c_str(), num_sectors_);
+        printf("================================================================================\n");
+        for (auto num_threads : kNumThreads) {
+            for (auto depth : kDepths) {
+                auto reader = make_reader();
+                reader->open(file_path_);
+                std::vector<std::vector<double>> latencies(num_threads);
+                auto worker = [&](size_t t) {
+                    std::mt19937_64 rng(t);
+                    char* buf = nullptr;
+                    diskann::alloc_aligned((void**)&buf, depth * kSectorLen, kSectorLen);
+                    std::vector<AlignedRead> reqs(depth);
+                    auto ctx = reader->get_ctx();
+                    for (size_t i = 0; i < kNumReads / depth; ++i) {
+                        for (size_t j = 0; j < depth; ++j) {
+                            reqs[j] = AlignedRead(rng() % num_sectors_ * kSectorLen, kSectorLen, buf + j * kSectorLen);
+                        }
+                        double t_start = elapsed();
+                        reader->submit_req(ctx, reqs);
+                        reader->get_submitted_req(ctx, depth);
+                        latencies[t].push_back(elapsed() - t_start);
+                    }
+                    reader->put_ctx(ctx);
+                    diskann::aligned_free(buf);
+                };
+                double t_start = elapsed();
+                std::vector<std::thread> threads;
+                for (size_t t = 0; t < num_threads; ++t) {
+                    threads.emplace_back(worker, t);
+                }
+                for (auto& thread : threads) {
+                    thread.join();
+                }
+                double t_diff = elapsed() - t_start;
+                reader->close();
+
+                std::vector<double> all;
+                for (const auto& l : latencies) {
+                    all.insert(all.end(), l.begin(), l.end());
+                }
+                std::sort(all.begin(), all.end());
+                double mean = std::accumulate(all.begin(), all.end(), 0.0) / all.size();
+                double p99 = all[std::min(all.size() - 1, all.size() * 99 / 100)];
+                printf("  threads = %2zu, depth = %3zu, IOPS = %9.0f, latency mean = %7.1f us, p99 = %7.1f us\n",
+                       num_threads, depth, all.size() * depth / t_diff, mean * 1e6, p99 * 1e6);
+            }
+        }
+        printf("================================================================================\n");
+        printf("[%.3f s] Test '%s' done\n\n", get_time_diff(), name.c_str());
+    }
+
+ protected:
+    static constexpr size_t kSectorLen = 4096;
+    static constexpr size_t kDefaultFileSize = 1UL << 30;
+    // reads of each thread for a depth
+    static constexpr size_t kNumReads = 1 << 16;
+    const std::vector<size_t> kNumThreads = {1, 4, 16};
+    const std::vector<size_t> kDepths = {1, 8, 32, 128};
+
+    std::string file_path_;
+    bool remove_file_ = false;
+    size_t num_sectors_ = 0;
+};
+
+TEST_F(Benchmark_aligned_file_reader, TEST_LIBAIO) {
+    test_reader("libaio", [] { return std::make_shared<LinuxAlignedFileReader>(); });
+}
+
+TEST_F(Benchmark_aligned_file_reader, TEST_IO_URING) {
+    if (!UringAlignedFileReader::InitGlobalUring(true, false)) {
+        GTEST_SKIP() << "io_uring is not supported";
+    }
+    test_reader("io_uring", [] { return std::make_shared<UringAlignedFileReader>(); });
+    UringAlignedFileReader::InitGlobalUring(false, false);
+}
+
+TEST_F(Benchmark_aligned_file_reader, TEST_IO_URING_SQPOLL) {
+    if (!UringAlignedFileReader::InitGlobalUring(true, true)) {
+        GTEST_SKIP() << "io_uring is not supported";
+    }
+    test_reader("io_uring sqpoll", [] { return std::make_shared<UringAlignedFileReader>(); });
+    UringAlignedFileReader::InitGlobalUring(false, false);
+}
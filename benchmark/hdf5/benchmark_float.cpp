@@ -270,3 +270,16 @@ TEST_F(Benchmark_float, TEST_DISKANN) {
     test_diskann(conf);
 }
 #endif
+
+#ifdef KNOWHERE_WITH_DISKANN
+TEST_F(Benchmark_float, TEST_VAMANA) {
+    index_type_ = knowhere::IndexEnum::INDEX_VAMANA;
+
+    knowhere::Json conf = cfg_;
+    conf["max_degree"] = 56;
+    conf["search_list_size"] = 128;
+    std::string index_file_name = get_index_name({56, 128});
+    create_index(index_file_name, conf);
+    test_diskann(conf);
+}
+#endif
@@ -233,3 +233,15 @@ TEST_F(Benchmark_float_bitset, TEST_DISKANN) {
     test_diskann(conf);
 }
 #endif
+
+#ifdef KNOWHERE_WITH_DISKANN
+TEST_F(Benchmark_float_bitset, TEST_VAMANA) {
+    index_type_ = knowhere::IndexEnum::INDEX_VAMANA;
+
+    knowhere::Json conf = cfg_;
+    conf["search_list_size"] = 128;
+    std::string index_file_name = get_index_name({});
+    create_index(index_file_name, conf);
+    test_diskann(conf);
+}
+#endif
@@ -0,0 +1,162 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <unordered_set>
+#include <vector>
+
+#include "benchmark/benchmark_base.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/comp/knowhere_config.h"
+#include "knowhere/dataset.h"
+#include "knowhere/index/index_factory.h"
+#include "knowhere/sparse_utils.h"
+#include "knowhere/version.h"
+
+// QPS of the sparse inverted indexes on synthetic data shaped like SPLADE embeddings: a 30522 term vocabulary with
+// Zipf distributed term popularity, documents of 60 to 180 non-zeros and queries of 4 to 40 non-zeros.
+//
+// Searching the queries one at a time reads the posting lists of every query term once per query, while a large-nq
+// request lets the inverted index search the queries in batches that read each posting list once per batch. The
+// posting bytes read are estimated from the document frequencies of the query terms.
+class Benchmark_sparse_qps : public Benchmark_base, public ::testing::Test {
+ protected:
+    void
+    SetUp() override {
+        T0_ = elapsed();
+        std::mt19937 rng(42);
+        std::vector<double> weights(dim_);
+        for (int32_t i = 0; i < dim_; ++i) {
+            weights[i] = 1.0 / std::pow(i + 1, 0.8);
+        }
+        std::discrete_distribution<int32_t> term_dist(weights.begin(), weights.end());
+        std::uniform_real_distribution<float> val_dist(0.05, 3.0);
+        auto gen_rows = [&](int32_t rows, int32_t min_nnz, int32_t max_nnz) {
+            std::vector<knowhere::sparse::SparseRow<float>> data(rows);
+            std::uniform_int_distribution<int32_t> nnz_dist(min_nnz, max_nnz);
+            for (auto& row : data) {
+                std::set<int32_t> terms;
+                auto nnz = nnz_dist(rng);
+                while (static_cast<int32_t>(terms.size()) < nnz) {
+                    terms.insert(term_dist(rng));
+                }
+                knowhere::sparse::SparseRow<float> r(nnz);
+                size_t j = 0;
+                for (auto term : terms) {
+                    r.set_at(j++, term, val_dist(rng));
+                }
+                row = std::move(r);
+            }
+            return data;
+        };
+        printf("[%.3f s] Generating %d docs and %d queries\n", get_time_diff(), nb_, nq_);
+        xb_sparse_ = gen_rows(nb_, 60, 180);
+        xq_sparse_ = gen_rows(nq_, 4, 40);
+
+        doc_freq_.assign(dim_, 0);
+        for (const auto& row : xb_sparse_) {
+            for (size_t j = 0; j < row.size(); ++j) {
+                doc_freq_[row[j].id]++;
+            }
+        }
+    }
+
+    knowhere::DataSetPtr
+    GenSparseDataSet(std::vector<knowhere::sparse::SparseRow<float>>& rows, int32_t begin, int32_t num) {
+        auto ds = knowhere::GenDataSet(num, dim_, rows.data() + begin);
+        ds->SetIsSparse(true);
+        return ds;
+    }
+
+    // posting bytes read when the queries are searched in batches of batch_size, each distinct term of a batch
+    // being read once.
+    double
+    PostingBytesRead(int32_t batch_size) {
+        constexpr size_t kPostingBytes = sizeof(knowhere::sparse::table_t) + sizeof(float);
+        double bytes = 0;
+        for (int32_t begin = 0; begin < nq_; begin += batch_size) {
+            std::unordered_set<knowhere::sparse::table_t> terms;
+            for (int32_t i = begin; i < std::min(begin + batch_size, nq_); ++i) {
+                for (size_t j = 0; j < xq_sparse_[i].size(); ++j) {
+                    terms.insert(xq_sparse_[i][j].id);
+                }
+            }
+            for (auto term : terms) {
+                bytes += doc_freq_[term] * kPostingBytes;
+            }
+        }
+        return bytes;
+    }
+
+    void
+    test_sparse(const knowhere::Json& conf) {
+        auto version = knowhere::Version::GetCurrentVersion().VersionNumber();
+        auto index = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(index_type_, version).value();
+        printf("[%.3f s] Building %s on %d docs\n", get_time_diff(), index_type_.c_str(), nb_);
+        index.Build(GenSparseDataSet(xb_sparse_, 0, nb_), conf);
+
+        printf("\n[%0.3f s] %s | k=%d\n", get_time_diff(), index_type_.c_str(), topk_);
+        printf("================================================================================\n");
+        {
+            CALC_TIME_SPAN(for (int32_t i = 0; i < nq_; ++i) {
+                index.Search(GenSparseDataSet(xq_sparse_, i, 1), conf, nullptr);
+            });
+            auto bytes = PostingBytesRead(1);
+            printf("  one query per request, elapse = %6.3fs, QPS = %.3f, posting reads = %.1f GB (%.1f GB/s)\n",
+                   t_diff, nq_ / t_diff, bytes / 1e9, bytes / 1e9 / t_diff);
+        }
+        {
+            CALC_TIME_SPAN(index.Search(GenSparseDataSet(xq_sparse_, 0, nq_), conf, nullptr));
+            // an upper bound, the index searches fewer queries per batch if nq is small for the search pool size.
+            auto bytes = PostingBytesRead(max_batch_size_);
+            printf("  nq=%d in one request, elapse = %6.3fs, QPS = %.3f, posting reads <= %.1f GB (%.1f GB/s)\n",
+                   nq_, t_diff, nq_ / t_diff, bytes / 1e9, bytes / 1e9 / t_diff);
+        }
+        printf("================================================================================\n");
+        printf("[%.3f s] Test '%s' done\n\n", get_time_diff(), index_type_.c_str());
+    }
+
+ protected:
+    const int32_t nb_ = 1000000;
+    const int32_t nq_ = 10000;
+    const int32_t dim_ = 30522;
+    const int32_t topk_ = 10;
+    // max number of queries the inverted index searches together.
+    const int32_t max_batch_size_ = 32;
+
+    std::string index_type_;
+    std::vector<knowhere::sparse::SparseRow<float>> xb_sparse_;
+    std::vector<knowhere::sparse::SparseRow<float>> xq_sparse_;
+    std::vector<int64_t> doc_freq_;
+};
+
+TEST_F(Benchmark_sparse_qps, TEST_SPARSE_INVERTED_INDEX) {
+    index_type_ = knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX;
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = knowhere::metric::IP;
+    conf[knowhere::meta::TOPK] = topk_;
+    conf[knowhere::indexparam::DROP_RATIO_SEARCH] = 0.0f;
+    test_sparse(conf);
+}
+
+TEST_F(Benchmark_sparse_qps, TEST_SPARSE_WAND) {
+    index_type_ = knowhere::IndexEnum::INDEX_SPARSE_WAND;
+    knowhere::Json conf;
+    conf[knowhere::meta::METRIC_TYPE] = knowhere::metric::IP;
+    conf[knowhere::meta::TOPK] = topk_;
+    conf[knowhere::indexparam::DROP_RATIO_SEARCH] = 0.0f;
+    test_sparse(conf);
+}
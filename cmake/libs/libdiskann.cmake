@@ -12,12 +12,17 @@ set(DISKANN_SOURCES
     thirdparty/DiskANN/src/ann_exception.cpp
     thirdparty/DiskANN/src/aux_utils.cpp
     thirdparty/DiskANN/src/distance.cpp
+    thirdparty/DiskANN/src/fresh_index.cpp
     thirdparty/DiskANN/src/index.cpp
     thirdparty/DiskANN/src/linux_aligned_file_reader.cpp
     thirdparty/DiskANN/src/math_utils.cpp
     thirdparty/DiskANN/src/memory_mapper.cpp
+    thirdparty/DiskANN/src/nav_graph.cpp
+    thirdparty/DiskANN/src/node_cache.cpp
     thirdparty/DiskANN/src/partition_and_pq.cpp
     thirdparty/DiskANN/src/pq_flash_index.cpp
+    thirdparty/DiskANN/src/shared_sector_reads.cpp
+    thirdparty/DiskANN/src/uring_aligned_file_reader.cpp
     thirdparty/DiskANN/src/logger.cpp
     thirdparty/DiskANN/src/utils.cpp)
 
@@ -12,12 +12,21 @@
 #ifndef BITSET_H
 #define BITSET_H
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace knowhere {
+
+// When at least this fraction of rows is filtered out, searching over the list of surviving ids
+// (see BitsetView::for_each_allowed) is cheaper than testing the bitset for every row.
+constexpr float kAllowListFilterThreshold = 0.99f;
+
 class BitsetView {
  public:
     BitsetView() = default;
@@ -95,6 +104,63 @@ class BitsetView {
         return ret;
     }
 
+    // whether the filter is selective enough to prefer iterating the surviving ids
+    bool
+    prefer_allow_list() const {
+        return !empty() && filter_ratio() >= kAllowListFilterThreshold;
+    }
+
+    // Call `func(id)` for every id in [begin, end) that is not filtered out, in ascending order.
+    // The bitset is scanned a 64-bit word at a time and only the zero bits are visited via ctz,
+    // so the cost is (end - begin) / 64 word loads plus one call per surviving id.
+    template <typename Func>
+    void
+    for_each_allowed(size_t begin, size_t end, Func&& func) const {
+        if (empty()) {
+            for (size_t i = begin; i < end; i++) {
+                func(static_cast<int64_t>(i));
+            }
+            return;
+        }
+        // ids beyond num_bits_ are filtered out, as in test()
+        const size_t limit = std::min(end, num_bits_);
+        size_t i = begin;
+        for (; i < limit && (i & 63) != 0; i++) {
+            if (!test(i)) {
+                func(static_cast<int64_t>(i));
+            }
+        }
+        for (; i + 64 <= limit; i += 64) {
+            uint64_t word;
+            std::memcpy(&word, bits_ + (i >> 3), sizeof(word));
+            uint64_t allowed = ~word;
+            while (allowed) {
+                func(static_cast<int64_t>(i + __builtin_ctzll(allowed)));
+                allowed &= allowed - 1;
+            }
+        }
+        for (; i < limit; i++) {
+            if (!test(i)) {
+                func(static_cast<int64_t>(i));
+            }
+        }
+    }
+
+    template <typename Func>
+    void
+    for_each_allowed(size_t n, Func&& func) const {
+        for_each_allowed(0, n, std::forward<Func>(func));
+    }
+
+    // the compact list of ids in [0, n) that are not filtered out, in ascending order
+    std::vector<int64_t>
+    get_allowed_ids(size_t n) const {
+        std::vector<int64_t> ids;
+        ids.reserve(n > filtered_out_num_ ? n - filtered_out_num_ : 0);
+        for_each_allowed(n, [&ids](int64_t id) { ids.push_back(id); });
+        return ids;
+    }
+
     std::string
     to_string(size_t from, size_t to) const {
         if (empty()) {
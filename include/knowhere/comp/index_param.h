@@ -52,9 +52,11 @@ constexpr const char* INDEX_HNSW = "HNSW";
 constexpr const char* INDEX_HNSW_SQ8 = "HNSW_SQ8";
 constexpr const char* INDEX_HNSW_SQ8_REFINE = "HNSW_SQ8_REFINE";
 constexpr const char* INDEX_DISKANN = "DISKANN";
+constexpr const char* INDEX_VAMANA = "VAMANA";
 
 constexpr const char* INDEX_SPARSE_INVERTED_INDEX = "SPARSE_INVERTED_INDEX";
 constexpr const char* INDEX_SPARSE_WAND = "SPARSE_WAND";
+constexpr const char* INDEX_SPARSE_SEISMIC = "SPARSE_SEISMIC";
 }  // namespace IndexEnum
 
 namespace ClusterEnum {
@@ -153,6 +155,13 @@ constexpr const char* OVERVIEW_LEVELS = "overview_levels";
 // Sparse Params
 constexpr const char* DROP_RATIO_BUILD = "drop_ratio_build";
 constexpr const char* DROP_RATIO_SEARCH = "drop_ratio_search";
+constexpr const char* INVERTED_INDEX_ALGO = "inverted_index_algo";
+constexpr const char* POSTING_LIST_CODEC = "posting_list_codec";
+constexpr const char* SEISMIC_N_POSTINGS = "seismic_n_postings";
+constexpr const char* SEISMIC_CENTROID_FRACTION = "seismic_centroid_fraction";
+constexpr const char* SEISMIC_SUMMARY_ENERGY = "seismic_summary_energy";
+constexpr const char* SEISMIC_QUERY_CUT = "seismic_query_cut";
+constexpr const char* SEISMIC_HEAP_FACTOR = "seismic_heap_factor";
 
 // DISKANN Params
 
@@ -95,6 +95,15 @@ class KnowhereConfig {
     static bool
     SetAioContextPool(size_t num_ctx);
 
+    /**
+     * Whether DiskANN indexes loaded afterwards read through io_uring instead of libaio, each search thread then reads
+     * through a ring of its own. With `sqpoll`, a kernel thread polls the rings for reads so that submitting them takes
+     * no syscall, at the cost of the CPU it spins on. This function returns whether io_uring is used, which is false if
+     * the kernel doesn't support it and the indexes keep reading with libaio.
+     */
+    static bool
+    SetIoUring(bool enable, bool sqpoll = false);
+
     static void
     SetBuildThreadPoolSize(size_t num_threads);
 
@@ -147,6 +147,12 @@ class Index {
     Status
     Add(const DataSetPtr dataset, const Json& json);
 
+    Status
+    DeleteByIds(const DataSetPtr dataset);
+
+    Status
+    Flush();
+
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, const Json& json, const BitsetView& bitset) const;
 
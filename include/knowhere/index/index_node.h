@@ -60,6 +60,19 @@ class IndexNode : public Object {
     virtual Status
     Add(const DataSetPtr dataset, const Config& cfg) = 0;
 
+    // deletes the vectors of the ids of dataset, for the indexes that support deletes
+    virtual Status
+    DeleteByIds(const DataSetPtr dataset) {
+        return Status::not_implemented;
+    }
+
+    // writes the vectors added and deleted since the index was loaded to the index files, for the indexes that
+    // support updates
+    virtual Status
+    Flush() {
+        return Status::not_implemented;
+    }
+
     virtual expected<DataSetPtr>
     Search(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const = 0;
 
@@ -35,6 +35,16 @@ class IndexNodeDataMockWrapper : public IndexNode {
     Status
     Add(const DataSetPtr dataset, const Config& cfg) override;
 
+    Status
+    DeleteByIds(const DataSetPtr dataset) override {
+        return index_node_->DeleteByIds(dataset);
+    }
+
+    Status
+    Flush() override {
+        return index_node_->Flush();
+    }
+
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const override;
 
@@ -33,6 +33,16 @@ class IndexNodeThreadPoolWrapper : public IndexNode {
         return index_node_->Add(dataset, cfg);
     }
 
+    Status
+    DeleteByIds(const DataSetPtr dataset) override {
+        return index_node_->DeleteByIds(dataset);
+    }
+
+    Status
+    Flush() override {
+        return index_node_->Flush();
+    }
+
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const override;
 
@@ -70,9 +70,14 @@ static std::set<std::pair<std::string, VecType>> legal_knowhere_index = {
     {IndexEnum::INDEX_DISKANN, VecType::VECTOR_FLOAT},
     {IndexEnum::INDEX_DISKANN, VecType::VECTOR_FLOAT16},
     {IndexEnum::INDEX_DISKANN, VecType::VECTOR_BFLOAT16},
+    // vamana
+    {IndexEnum::INDEX_VAMANA, VecType::VECTOR_FLOAT},
+    {IndexEnum::INDEX_VAMANA, VecType::VECTOR_FLOAT16},
+    {IndexEnum::INDEX_VAMANA, VecType::VECTOR_BFLOAT16},
     // sparse index
     {IndexEnum::INDEX_SPARSE_INVERTED_INDEX, VecType::VECTOR_SPARSE_FLOAT},
     {IndexEnum::INDEX_SPARSE_WAND, VecType::VECTOR_SPARSE_FLOAT},
+    {IndexEnum::INDEX_SPARSE_SEISMIC, VecType::VECTOR_SPARSE_FLOAT},
 };
 
 static std::set<std::string> legal_support_mmap_knowhere_index = {
@@ -116,9 +121,14 @@ static std::set<std::string> legal_support_mmap_knowhere_index = {
     IndexEnum::INDEX_HNSW_SQ8_REFINE,
     IndexEnum::INDEX_HNSW_SQ8_REFINE,
     IndexEnum::INDEX_HNSW_SQ8_REFINE,
+    // vamana
+    IndexEnum::INDEX_VAMANA,
+    IndexEnum::INDEX_VAMANA,
+    IndexEnum::INDEX_VAMANA,
     // sparse index
     IndexEnum::INDEX_SPARSE_INVERTED_INDEX,
     IndexEnum::INDEX_SPARSE_WAND,
+    IndexEnum::INDEX_SPARSE_SEISMIC,
 
 };
 KNOWHERE_SET_STATIC_GLOBAL_INDEX_TABLE(0, KNOWHERE_STATIC_INDEX, legal_knowhere_index)
@@ -112,4 +112,6 @@ DECLARE_PROMETHEUS_HISTOGRAM(hnsw_search_hops, PROMETHEUS_LABEL_KNOWHERE);
 DECLARE_PROMETHEUS_HISTOGRAM(diskann_bitset_ratio, PROMETHEUS_LABEL_KNOWHERE);
 DECLARE_PROMETHEUS_HISTOGRAM(diskann_search_hops, PROMETHEUS_LABEL_KNOWHERE);
 DECLARE_PROMETHEUS_HISTOGRAM(diskann_range_search_iters, PROMETHEUS_LABEL_KNOWHERE);
+DECLARE_PROMETHEUS_HISTOGRAM(diskann_cache_hit_ratio, PROMETHEUS_LABEL_KNOWHERE);
+DECLARE_PROMETHEUS_COUNTER(diskann_cache_promotions, PROMETHEUS_LABEL_KNOWHERE);
 }  // namespace knowhere
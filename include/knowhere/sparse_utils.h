@@ -44,19 +44,40 @@ using SparseIdVal = IdVal<table_t, T>;
 template <typename T>
 using DocValueComputer = std::function<float(const T&, const float)>;
 
+// Concrete computer types. Hot loops templated on the computer type use these
+// directly so the per-posting call is inlined, they are also convertible to
+// DocValueComputer where a type-erased computer is needed.
+template <typename T>
+struct DocValueOriginalComputer {
+    float
+    operator()(const T& right, const float) const {
+        return right;
+    }
+};
+
 template <typename T>
 auto
 GetDocValueOriginalComputer() {
-    static DocValueComputer<T> lambda = [](const T& right, const float) -> float { return right; };
+    static DocValueComputer<T> lambda = DocValueOriginalComputer<T>();
     return lambda;
 }
 
+template <typename T>
+struct DocValueBM25Computer {
+    float k1;
+    float b;
+    float avgdl;
+
+    float
+    operator()(const T& tf, const float doc_len) const {
+        return tf * (k1 + 1) / (tf + k1 * (1 - b + b * (doc_len / avgdl)));
+    }
+};
+
 template <typename T>
 auto
 GetDocValueBM25Computer(float k1, float b, float avgdl) {
-    return [k1, b, avgdl](const T& tf, const float doc_len) -> float {
-        return tf * (k1 + 1) / (tf + k1 * (1 - b + b * (doc_len / avgdl)));
-    };
+    return DocValueBM25Computer<T>{k1, b, avgdl};
 }
 
 template <typename T>
@@ -274,4 +295,115 @@ class MaxMinHeap {
     std::vector<SparseIdVal<T>> pool_;
 };  // class MaxMinHeap
 
+// Dense per doc score accumulator of a query that is reused across queries.
+// Entries are tagged with the epoch of the query that wrote them, so starting
+// a new query doesn't need to zero all docs, and the docs written by the query
+// are tracked so that only they are visited when collecting results.
+//
+// Acquire() returns the accumulator of the calling thread, which keeps the
+// memory of the segments it searches, unless it has been much larger than the
+// segments searched for a while.
+template <typename T>
+class ScoreAccumulator {
+ public:
+    // the memory is released if it is kept for more than kShrinkRatio times the docs of the segments searched by this
+    // many consecutive resets, and for more than kMinShrinkDocs docs, so that a thread searching large and small
+    // segments in turn doesn't reallocate it each time.
+    static constexpr size_t kShrinkAfterResets = 64;
+
+    static ScoreAccumulator&
+    Acquire(size_t n) {
+        thread_local ScoreAccumulator accumulator;
+        accumulator.reset(n);
+        return accumulator;
+    }
+
+    void
+    reset(size_t n) {
+        touched_.clear();
+        if (++epoch_ == 0) {
+            std::fill(epochs_.begin(), epochs_.end(), 0);
+            epoch_ = 1;
+        }
+        if (n > scores_.size()) {
+            scores_.resize(n);
+            epochs_.resize(n, 0);
+        }
+        if (scores_.size() > kMinShrinkDocs && scores_.size() / kShrinkRatio > n) {
+            small_n_ = small_resets_ == 0 ? n : std::max(small_n_, n);
+            if (++small_resets_ == kShrinkAfterResets) {
+                // a thread that searched a large segment once doesn't keep its memory for the small ones.
+                scores_ = std::vector<T>(small_n_);
+                epochs_ = std::vector<uint32_t>(small_n_, 0);
+                touched_ = std::vector<table_t>();
+                small_resets_ = 0;
+            }
+        } else {
+            small_resets_ = 0;
+        }
+        n_ = n;
+    }
+
+    // # of docs the accumulator keeps memory for.
+    [[nodiscard]] size_t
+    capacity() const {
+        return scores_.size();
+    }
+
+    void
+    add(table_t id, T val) {
+        if (epochs_[id] != epoch_) {
+            epochs_[id] = epoch_;
+            scores_[id] = val;
+            touched_.push_back(id);
+        } else {
+            scores_[id] += val;
+        }
+    }
+
+    // whether the doc has been written since reset().
+    [[nodiscard]] bool
+    contains(table_t id) const {
+        return epochs_[id] == epoch_;
+    }
+
+    [[nodiscard]] size_t
+    num_touched() const {
+        return touched_.size();
+    }
+
+    // calls func(id, score) for each doc written since reset(), in ascending id order.
+    template <typename Func>
+    void
+    for_each(Func func) {
+        // sorting the touched ids costs more than a scan of all docs if many are touched.
+        if (touched_.size() > n_ / kDenseScanRatio) {
+            for (size_t i = 0; i < n_; ++i) {
+                if (epochs_[i] == epoch_) {
+                    func(static_cast<table_t>(i), scores_[i]);
+                }
+            }
+            return;
+        }
+        std::sort(touched_.begin(), touched_.end());
+        for (auto id : touched_) {
+            func(id, scores_[id]);
+        }
+    }
+
+ private:
+    static constexpr size_t kDenseScanRatio = 16;
+    static constexpr size_t kShrinkRatio = 4;
+    static constexpr size_t kMinShrinkDocs = 64 * 1024;
+
+    std::vector<T> scores_;
+    std::vector<uint32_t> epochs_;
+    std::vector<table_t> touched_;
+    uint32_t epoch_ = 0;
+    size_t n_ = 0;
+    // # of consecutive resets to segments much smaller than the memory kept, and the largest of those segments.
+    size_t small_resets_ = 0;
+    size_t small_n_ = 0;
+};  // class ScoreAccumulator
+
 }  // namespace knowhere::sparse
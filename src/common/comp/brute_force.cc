@@ -11,6 +11,12 @@
 
 #include "knowhere/comp/brute_force.h"
 
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <vector>
 
 #include "common/metric.h"
@@ -26,6 +32,7 @@
 #include "knowhere/range_util.h"
 #include "knowhere/sparse_utils.h"
 #include "knowhere/utils.h"
+#include "simd/hook.h"
 
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
 #include "knowhere/tracer.h"
@@ -35,7 +42,18 @@ namespace knowhere {
 
 /* knowhere wrapper API to call faiss brute force search for all metric types */
 
-class BruteForceConfig : public BaseConfig {};
+class BruteForceConfig : public BaseConfig {
+ public:
+    CFG_INT bf_tile_size_mb;
+    KNOHWERE_DECLARE_CONFIG(BruteForceConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(bf_tile_size_mb)
+            .set_default(0)
+            .description("if positive, float base rows are scanned in sequential tiles of this many MB, "
+                         "each tile is read once for all queries of the batch")
+            .for_search()
+            .set_range(0, 65536);
+    }
+};
 
 namespace {
 
@@ -59,18 +77,348 @@ GetDocValueComputer(const BruteForceConfig& cfg) {
     }
 }
 
+// fp16/bf16 base rows are scored in place by the mixed precision kernels in simd/hook.h, so that only the queries
+// need to be converted to fp32 and no fp32 copy of the base dataset is materialized per call.
+template <typename DataType>
+struct RowDistance {};
+
+template <>
+struct RowDistance<fp32> {
+    static float
+    L2sqr(const float* x, const fp32* y, size_t d) {
+        return faiss::fvec_L2sqr(x, y, d);
+    }
+    static float
+    InnerProduct(const float* x, const fp32* y, size_t d) {
+        return faiss::fvec_inner_product(x, y, d);
+    }
+    static float
+    NormL2sqr(const fp32* x, size_t d) {
+        return faiss::fvec_norm_L2sqr(x, d);
+    }
+};
+
+template <>
+struct RowDistance<fp16> {
+    static float
+    L2sqr(const float* x, const fp16* y, size_t d) {
+        return faiss::fp16_vec_L2sqr(x, y, d);
+    }
+    static float
+    InnerProduct(const float* x, const fp16* y, size_t d) {
+        return faiss::fp16_vec_inner_product(x, y, d);
+    }
+    static float
+    NormL2sqr(const fp16* x, size_t d) {
+        return faiss::fp16_vec_norm_L2sqr(x, d);
+    }
+};
+
+template <>
+struct RowDistance<bf16> {
+    static float
+    L2sqr(const float* x, const bf16* y, size_t d) {
+        return faiss::bf16_vec_L2sqr(x, y, d);
+    }
+    static float
+    InnerProduct(const float* x, const bf16* y, size_t d) {
+        return faiss::bf16_vec_inner_product(x, y, d);
+    }
+    static float
+    NormL2sqr(const bf16* x, size_t d) {
+        return faiss::bf16_vec_norm_L2sqr(x, d);
+    }
+};
+
+// call `func(id, distance)` for every base row in [begin, end) that is not filtered out by the bitset,
+// query must be fp32 and already normalized for cosine
+template <typename DataType, typename Func>
+Status
+ForEachRowDistance(const float* query, const DataType* xb, int64_t begin, int64_t end, int64_t dim,
+                   faiss::MetricType metric_type, bool is_cosine, const BitsetView& bitset, Func&& func) {
+    using Distance = RowDistance<DataType>;
+    auto scan = [&](auto&& dis_func) {
+        bitset.for_each_allowed(begin, end, [&](int64_t j) { func(j, dis_func(xb + j * dim)); });
+    };
+    switch (metric_type) {
+        case faiss::METRIC_L2: {
+            scan([&](const DataType* y) { return Distance::L2sqr(query, y, dim); });
+            break;
+        }
+        case faiss::METRIC_INNER_PRODUCT: {
+            if (is_cosine) {
+                // a zero row has no direction, its similarity to any query is 0
+                scan([&](const DataType* y) {
+                    auto norm = Distance::NormL2sqr(y, dim);
+                    return norm > 0.0f ? Distance::InnerProduct(query, y, dim) / sqrtf(norm) : 0.0f;
+                });
+            } else {
+                scan([&](const DataType* y) { return Distance::InnerProduct(query, y, dim); });
+            }
+            break;
+        }
+        default: {
+            return Status::invalid_metric_type;
+        }
+    }
+    return Status::success;
+}
+
+template <typename C, typename DataType>
+Status
+HalfPrecisionHeapSearch(const float* query, const DataType* xb, int64_t nb, int64_t dim, int topk,
+                        faiss::MetricType metric_type, bool is_cosine, const BitsetView& bitset, int64_t* labels,
+                        float* distances) {
+    faiss::heap_heapify<C>(topk, distances, labels);
+    auto status = ForEachRowDistance(query, xb, 0, nb, dim, metric_type, is_cosine, bitset, [&](int64_t id, float dis) {
+        if (C::cmp(distances[0], dis)) {
+            faiss::heap_replace_top<C>(topk, distances, labels, dis, id);
+        }
+    });
+    faiss::heap_reorder<C>(topk, distances, labels);
+    return status;
+}
+
+template <typename DataType>
+Status
+HalfPrecisionSearch(const float* query, const DataType* xb, int64_t nb, int64_t dim, int topk,
+                    faiss::MetricType metric_type, bool is_cosine, const BitsetView& bitset, int64_t* labels,
+                    float* distances) {
+    if (metric_type == faiss::METRIC_L2) {
+        return HalfPrecisionHeapSearch<faiss::CMax<float, int64_t>>(query, xb, nb, dim, topk, metric_type, is_cosine,
+                                                                     bitset, labels, distances);
+    }
+    if (is_cosine) {
+        auto copied_query = CopyAndNormalizeVecs(query, 1, dim);
+        return HalfPrecisionHeapSearch<faiss::CMin<float, int64_t>>(copied_query.get(), xb, nb, dim, topk,
+                                                                     metric_type, is_cosine, bitset, labels, distances);
+    }
+    return HalfPrecisionHeapSearch<faiss::CMin<float, int64_t>>(query, xb, nb, dim, topk, metric_type, is_cosine,
+                                                                 bitset, labels, distances);
+}
+
+// madvise() takes page aligned addresses, so the range is widened to whole pages. The advice is only a hint,
+// failures are logged and otherwise ignored.
+void
+AdviseRange(const void* addr, size_t size, int advice) {
+    static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+    auto begin = reinterpret_cast<uintptr_t>(addr) & ~(page_size - 1);
+    auto end = reinterpret_cast<uintptr_t>(addr) + size;
+    if (size == 0 || madvise(reinterpret_cast<void*>(begin), end - begin, advice) != 0) {
+        LOG_KNOWHERE_DEBUG_ << "madvise " << advice << " skipped: " << strerror(errno);
+    }
+}
+
+// Scan the base in sequential tiles of `tile_rows` rows and evaluate every query against a tile before moving on
+// to the next one, instead of letting each query walk the whole base on its own. When the base is mmapped from
+// cold storage, every page is then faulted in once per batch in file order, and the next tile is read ahead while
+// the current one is scored. Finished tiles are marked cold, so that the kernel reclaims them before other pages
+// under memory pressure. The madvise() hints act on the pages now and leave the advice of the caller's mapping as
+// it was.
+//
+// A tile is scored by one task per query, and also split into parts scored by separate tasks when there are fewer
+// queries than search threads. Each part keeps its own heaps, which are merged at the end.
+template <typename C, typename DataType>
+Status
+TiledHeapSearch(const float* xq, int64_t nq, const DataType* xb, int64_t nb, int64_t dim, int topk,
+                int64_t tile_rows, faiss::MetricType metric_type, bool is_cosine, const BitsetView& bitset,
+                int64_t* labels, float* distances) {
+    const size_t row_size = sizeof(DataType) * dim;
+    auto pool = ThreadPool::GetGlobalSearchThreadPool();
+    const int64_t threads = pool->size();
+    const int64_t parts = std::clamp<int64_t>(threads / std::max<int64_t>(nq, 1), 1, tile_rows);
+    std::vector<int64_t> part_labels;
+    std::vector<float> part_distances;
+    auto heap_labels = labels;
+    auto heap_distances = distances;
+    if (parts > 1) {
+        part_labels.resize(parts * nq * topk);
+        part_distances.resize(parts * nq * topk);
+        heap_labels = part_labels.data();
+        heap_distances = part_distances.data();
+    }
+    for (int64_t i = 0; i < parts * nq; ++i) {
+        faiss::heap_heapify<C>(topk, heap_distances + i * topk, heap_labels + i * topk);
+    }
+
+    AdviseRange(xb, std::min(tile_rows, nb) * row_size, MADV_WILLNEED);
+    auto status = Status::success;
+    for (int64_t begin = 0; begin < nb && status == Status::success; begin += tile_rows) {
+        const int64_t end = std::min(begin + tile_rows, nb);
+        if (end < nb) {
+            AdviseRange(xb + end * dim, (std::min(end + tile_rows, nb) - end) * row_size, MADV_WILLNEED);
+        }
+        std::vector<folly::Future<Status>> futs;
+        futs.reserve(parts * nq);
+        for (int64_t part = 0; part < parts; ++part) {
+            const int64_t part_begin = begin + (end - begin) * part / parts;
+            const int64_t part_end = begin + (end - begin) * (part + 1) / parts;
+            for (int64_t i = 0; i < nq; ++i) {
+                futs.emplace_back(pool->push([&, index = i, heap = part * nq + i, part_begin, part_end] {
+                    ThreadPool::ScopedOmpSetter setter(1);
+                    auto cur_labels = heap_labels + topk * heap;
+                    auto cur_distances = heap_distances + topk * heap;
+                    return ForEachRowDistance(xq + dim * index, xb, part_begin, part_end, dim, metric_type,
+                                              is_cosine, bitset, [&](int64_t id, float dis) {
+                                                  if (C::cmp(cur_distances[0], dis)) {
+                                                      faiss::heap_replace_top<C>(topk, cur_distances, cur_labels,
+                                                                                 dis, id);
+                                                  }
+                                              });
+                }));
+            }
+        }
+        status = WaitAllSuccess(futs);
+#ifdef MADV_COLD
+        AdviseRange(xb + begin * dim, (end - begin) * row_size, MADV_COLD);
+#endif
+    }
+
+    for (int64_t i = 0; i < nq; ++i) {
+        auto cur_labels = labels + i * topk;
+        auto cur_distances = distances + i * topk;
+        if (parts > 1) {
+            faiss::heap_heapify<C>(topk, cur_distances, cur_labels);
+            for (int64_t part = 0; part < parts; ++part) {
+                auto offset = (part * nq + i) * topk;
+                for (int j = 0; j < topk; ++j) {
+                    if (part_labels[offset + j] != -1 && C::cmp(cur_distances[0], part_distances[offset + j])) {
+                        faiss::heap_replace_top<C>(topk, cur_distances, cur_labels, part_distances[offset + j],
+                                                   part_labels[offset + j]);
+                    }
+                }
+            }
+        }
+        faiss::heap_reorder<C>(topk, cur_distances, cur_labels);
+    }
+    return status;
+}
+
+// queries must be fp32, base rows are fp32/fp16/bf16
+template <typename DataType>
+Status
+TiledSearch(const float* xq, int64_t nq, const DataType* xb, int64_t nb, int64_t dim, int topk, size_t tile_size,
+            faiss::MetricType metric_type, bool is_cosine, const BitsetView& bitset, int64_t* labels,
+            float* distances) {
+    const int64_t tile_rows = std::max<int64_t>(1, tile_size / (sizeof(DataType) * dim));
+    if (metric_type == faiss::METRIC_L2) {
+        return TiledHeapSearch<faiss::CMax<float, int64_t>>(xq, nq, xb, nb, dim, topk, tile_rows, metric_type,
+                                                             is_cosine, bitset, labels, distances);
+    }
+    if (metric_type != faiss::METRIC_INNER_PRODUCT) {
+        return Status::invalid_metric_type;
+    }
+    if (is_cosine) {
+        auto copied_query = CopyAndNormalizeVecs(xq, nq, dim);
+        return TiledHeapSearch<faiss::CMin<float, int64_t>>(copied_query.get(), nq, xb, nb, dim, topk, tile_rows,
+                                                             metric_type, is_cosine, bitset, labels, distances);
+    }
+    return TiledHeapSearch<faiss::CMin<float, int64_t>>(xq, nq, xb, nb, dim, topk, tile_rows, metric_type, is_cosine,
+                                                         bitset, labels, distances);
+}
+
+// The term-at-a-time scan pays one pass over the base to collect postings, after which each query only touches
+// the postings of its own terms, so it is used when the queries are shorter than the rows on average.
+bool
+PreferSparseTermAtATime(const sparse::SparseRow<float>* base, int64_t rows, const sparse::SparseRow<float>* xq,
+                        int64_t nq) {
+    size_t base_nnz = 0;
+    for (int64_t i = 0; i < rows; ++i) {
+        base_nnz += base[i].size();
+    }
+    size_t query_nnz = 0;
+    for (int64_t i = 0; i < nq; ++i) {
+        query_nnz += xq[i].size();
+    }
+    // avg query nnz < avg row nnz
+    return rows > 0 && query_nnz * rows < base_nnz * nq;
+}
+
+// Term-at-a-time scan for a batch of sparse queries. One pass over the rows allowed by the bitset collects the
+// postings of only the terms that appear in the batch, with the doc value (e.g. the BM25 tf normalization) already
+// applied. Each query then accumulates its scores into a dense array and selects the top-k from it. Scores are
+// summed in the same term order as SparseRow::dot, so the results match the row-by-row scan.
+void
+SearchSparseTermAtATime(const sparse::SparseRow<float>* base, int64_t rows, const sparse::SparseRow<float>* xq,
+                        int64_t nq, int topk, const sparse::DocValueComputer<float>& computer, bool is_bm25,
+                        const BitsetView& bitset, sparse::label_t* labels, float* distances) {
+    std::vector<sparse::table_t> terms;
+    for (int64_t i = 0; i < nq; ++i) {
+        for (size_t k = 0; k < xq[i].size(); ++k) {
+            terms.push_back(xq[i][k].id);
+        }
+    }
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+    std::vector<std::vector<sparse::SparseIdVal<float>>> postings(terms.size());
+    bitset.for_each_allowed(rows, [&](int64_t j) {
+        const auto& row = base[j];
+        float row_sum = 0;
+        if (is_bm25) {
+            for (size_t k = 0; k < row.size(); ++k) {
+                row_sum += row[k].val;
+            }
+        }
+        auto term = terms.begin();
+        for (size_t k = 0; k < row.size() && term != terms.end(); ++k) {
+            auto [id, val] = row[k];
+            term = std::lower_bound(term, terms.end(), id);
+            if (term != terms.end() && *term == id) {
+                postings[term - terms.begin()].push_back({(sparse::table_t)j, computer(val, row_sum)});
+            }
+        }
+    });
+
+    auto pool = ThreadPool::GetGlobalSearchThreadPool();
+    std::vector<folly::Future<folly::Unit>> futs;
+    futs.reserve(nq);
+    for (int64_t i = 0; i < nq; ++i) {
+        futs.emplace_back(pool->push([&, index = i] {
+            const auto& row = xq[index];
+            if (row.size() == 0) {
+                return;
+            }
+            auto& scores = sparse::ScoreAccumulator<float>::Acquire(rows);
+            auto term = terms.begin();
+            for (size_t k = 0; k < row.size(); ++k) {
+                auto [id, q_val] = row[k];
+                term = std::lower_bound(term, terms.end(), id);
+                for (const auto& posting : postings[term - terms.begin()]) {
+                    scores.add(posting.id, q_val * posting.val);
+                }
+            }
+            sparse::MaxMinHeap<float> heap(topk);
+            scores.for_each([&](sparse::table_t j, float score) {
+                if (score > 0) {
+                    heap.push(j, score);
+                }
+            });
+            auto cur_labels = labels + topk * index;
+            auto cur_distances = distances + topk * index;
+            int result_size = heap.size();
+            for (int j = result_size - 1; j >= 0; --j) {
+                cur_labels[j] = heap.top().id;
+                cur_distances[j] = heap.top().val;
+                heap.pop();
+            }
+        }));
+    }
+    WaitAllSuccess(futs);
+}
+
 }  // namespace
 
 template <typename DataType>
 expected<DataSetPtr>
 BruteForce::Search(const DataSetPtr base_dataset, const DataSetPtr query_dataset, const Json& config,
                    const BitsetView& bitset) {
-    auto base = ConvertFromDataTypeIfNeeded<DataType>(base_dataset);
+    // fp16/bf16 base rows are read in place, only the queries are converted to fp32
     auto query = ConvertFromDataTypeIfNeeded<DataType>(query_dataset);
 
-    auto xb = base->GetTensor();
-    auto nb = base->GetRows();
-    auto dim = base->GetDim();
+    auto xb = base_dataset->GetTensor();
+    auto nb = base_dataset->GetRows();
+    auto dim = base_dataset->GetDim();
 
     auto xq = query->GetTensor();
     auto nq = query->GetRows();
@@ -107,6 +455,31 @@ BruteForce::Search(const DataSetPtr base_dataset, const DataSetPtr query_dataset
     auto labels = std::make_unique<int64_t[]>(nq * topk);
     auto distances = std::make_unique<float[]>(nq * topk);
 
+    if constexpr (KnowhereFloatTypeCheck<DataType>::value) {
+        if (cfg.bf_tile_size_mb.value() > 0) {
+            auto ret = TiledSearch((const float*)xq, nq, (const DataType*)xb, nb, dim, topk,
+                                   (size_t)cfg.bf_tile_size_mb.value() << 20, faiss_metric_type, is_cosine, bitset,
+                                   labels.get(), distances.get());
+            if (ret != Status::success) {
+                LOG_KNOWHERE_ERROR_ << "Invalid metric type: " << cfg.metric_type.value();
+                return expected<DataSetPtr>::Err(ret, "failed to brute force search");
+            }
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+            if (cfg.trace_id.has_value()) {
+                span->End();
+            }
+#endif
+            return GenResultDataSet(nq, cfg.k.value(), std::move(labels), std::move(distances));
+        }
+    }
+
+    // for extremely selective filters, only the surviving rows are scanned
+    const bool use_allow_list = std::is_same_v<DataType, fp32> && bitset.prefer_allow_list();
+    std::vector<int64_t> allowed_ids;
+    if (use_allow_list) {
+        allowed_ids = bitset.get_allowed_ids(nb);
+    }
+
     auto pool = ThreadPool::GetGlobalSearchThreadPool();
     std::vector<folly::Future<Status>> futs;
     futs.reserve(nq);
@@ -116,8 +489,23 @@ BruteForce::Search(const DataSetPtr base_dataset, const DataSetPtr query_dataset
             auto cur_labels = labels_ptr + topk * index;
             auto cur_distances = distances_ptr + topk * index;
 
+            if constexpr (KnowhereHalfPrecisionFloatPointTypeCheck<DataType>::value) {
+                auto cur_query = (const float*)xq + dim * index;
+                auto status = HalfPrecisionSearch(cur_query, (const DataType*)xb, nb, dim, topk,
+                                                  faiss_metric_type, is_cosine, bitset, cur_labels, cur_distances);
+                if (status != Status::success) {
+                    LOG_KNOWHERE_ERROR_ << "Invalid metric type: " << cfg.metric_type.value();
+                }
+                return status;
+            }
+
             BitsetViewIDSelector bw_idselector(bitset);
+            faiss::IDSelectorArray allow_list_idselector(allowed_ids.size(), allowed_ids.data());
             faiss::IDSelector* id_selector = (bitset.empty()) ? nullptr : &bw_idselector;
+            if (use_allow_list) {
+                // faiss brute force only visits the listed ids
+                id_selector = &allow_list_idselector;
+            }
 
             switch (faiss_metric_type) {
                 case faiss::METRIC_L2: {
@@ -189,12 +577,12 @@ template <typename DataType>
 Status
 BruteForce::SearchWithBuf(const DataSetPtr base_dataset, const DataSetPtr query_dataset, int64_t* ids, float* dis,
                           const Json& config, const BitsetView& bitset) {
-    auto base = ConvertFromDataTypeIfNeeded<DataType>(base_dataset);
+    // fp16/bf16 base rows are read in place, only the queries are converted to fp32
     auto query = ConvertFromDataTypeIfNeeded<DataType>(query_dataset);
 
-    auto xb = base->GetTensor();
-    auto nb = base->GetRows();
-    auto dim = base->GetDim();
+    auto xb = base_dataset->GetTensor();
+    auto nb = base_dataset->GetRows();
+    auto dim = base_dataset->GetDim();
 
     auto xq = query->GetTensor();
     auto nq = query->GetRows();
@@ -227,6 +615,31 @@ BruteForce::SearchWithBuf(const DataSetPtr base_dataset, const DataSetPtr query_
     auto labels = ids;
     auto distances = dis;
 
+    if constexpr (KnowhereFloatTypeCheck<DataType>::value) {
+        if (cfg.bf_tile_size_mb.value() > 0) {
+            auto ret = TiledSearch((const float*)xq, nq, (const DataType*)xb, nb, dim, topk,
+                                   (size_t)cfg.bf_tile_size_mb.value() << 20, faiss_metric_type, is_cosine, bitset,
+                                   labels, distances);
+            if (ret != Status::success) {
+                LOG_KNOWHERE_ERROR_ << "Invalid metric type: " << cfg.metric_type.value();
+                return ret;
+            }
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+            if (cfg.trace_id.has_value()) {
+                span->End();
+            }
+#endif
+            return Status::success;
+        }
+    }
+
+    // for extremely selective filters, only the surviving rows are scanned
+    const bool use_allow_list = std::is_same_v<DataType, fp32> && bitset.prefer_allow_list();
+    std::vector<int64_t> allowed_ids;
+    if (use_allow_list) {
+        allowed_ids = bitset.get_allowed_ids(nb);
+    }
+
     auto pool = ThreadPool::GetGlobalSearchThreadPool();
     std::vector<folly::Future<Status>> futs;
     futs.reserve(nq);
@@ -236,8 +649,23 @@ BruteForce::SearchWithBuf(const DataSetPtr base_dataset, const DataSetPtr query_
             auto cur_labels = labels + topk * index;
             auto cur_distances = distances + topk * index;
 
+            if constexpr (KnowhereHalfPrecisionFloatPointTypeCheck<DataType>::value) {
+                auto cur_query = (const float*)xq + dim * index;
+                auto status = HalfPrecisionSearch(cur_query, (const DataType*)xb, nb, dim, topk,
+                                                  faiss_metric_type, is_cosine, bitset, cur_labels, cur_distances);
+                if (status != Status::success) {
+                    LOG_KNOWHERE_ERROR_ << "Invalid metric type: " << cfg.metric_type.value();
+                }
+                return status;
+            }
+
             BitsetViewIDSelector bw_idselector(bitset);
+            faiss::IDSelectorArray allow_list_idselector(allowed_ids.size(), allowed_ids.data());
             faiss::IDSelector* id_selector = (bitset.empty()) ? nullptr : &bw_idselector;
+            if (use_allow_list) {
+                // faiss brute force only visits the listed ids
+                id_selector = &allow_list_idselector;
+            }
 
             switch (faiss_metric_type) {
                 case faiss::METRIC_L2: {
@@ -307,16 +735,15 @@ template <typename DataType>
 expected<DataSetPtr>
 BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_dataset, const Json& config,
                         const BitsetView& bitset) {
-    DataSetPtr base(base_dataset);
     DataSetPtr query(query_dataset);
     bool is_sparse = std::is_same<DataType, knowhere::sparse::SparseRow<float>>::value;
     if (!is_sparse) {
-        base = ConvertFromDataTypeIfNeeded<DataType>(base_dataset);
+        // fp16/bf16 base rows are read in place, only the queries are converted to fp32
         query = ConvertFromDataTypeIfNeeded<DataType>(query_dataset);
     }
-    auto xb = base->GetTensor();
-    auto nb = base->GetRows();
-    auto dim = base->GetDim();
+    auto xb = base_dataset->GetTensor();
+    auto nb = base_dataset->GetRows();
+    auto dim = base_dataset->GetDim();
 
     auto xq = query->GetTensor();
     auto nq = query->GetRows();
@@ -348,6 +775,7 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
     const bool is_bm25 = IsMetricType(metric_str, metric::BM25);
 
     faiss::MetricType faiss_metric_type;
+    bool is_ip = false;
     sparse::DocValueComputer<float> sparse_computer;
     if (!is_sparse) {
         auto result = Str2FaissMetricType(metric_str);
@@ -355,6 +783,7 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
             return expected<DataSetPtr>::Err(result.error(), result.what());
         }
         faiss_metric_type = result.value();
+        is_ip = faiss_metric_type == faiss::METRIC_INNER_PRODUCT;
     } else {
         auto computer_or = GetDocValueComputer<float>(cfg);
         if (!computer_or.has_value()) {
@@ -366,7 +795,6 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
     bool is_cosine = IsMetricType(metric_str, metric::COSINE);
 
     auto radius = cfg.radius.value();
-    bool is_ip = false;
     float range_filter = cfg.range_filter.value();
 
     auto pool = ThreadPool::GetGlobalSearchThreadPool();
@@ -381,10 +809,7 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
             if (is_sparse) {
                 auto cur_query = (const sparse::SparseRow<float>*)xq + index;
                 auto xb_sparse = (const sparse::SparseRow<float>*)xb;
-                for (int j = 0; j < nb; ++j) {
-                    if (!bitset.empty() && bitset.test(j)) {
-                        continue;
-                    }
+                bitset.for_each_allowed(nb, [&](int64_t j) {
                     float row_sum = 0;
                     if (is_bm25) {
                         for (size_t k = 0; k < xb_sparse[j].size(); ++k) {
@@ -397,10 +822,35 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
                         result_id_array[index].push_back(j);
                         result_dist_array[index].push_back(dist);
                     }
-                }
+                });
                 return Status::success;
             }
             // else not sparse:
+            if constexpr (KnowhereHalfPrecisionFloatPointTypeCheck<DataType>::value) {
+                auto cur_query = (const float*)xq + dim * index;
+                std::unique_ptr<float[]> copied_query = nullptr;
+                if (is_cosine) {
+                    copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
+                    cur_query = copied_query.get();
+                }
+                auto status =
+                    ForEachRowDistance(cur_query, (const DataType*)xb, 0, nb, dim, faiss_metric_type, is_cosine, bitset,
+                                       [&](int64_t id, float dis) {
+                                           if (is_ip ? dis > radius : dis < radius) {
+                                               result_id_array[index].push_back(id);
+                                               result_dist_array[index].push_back(dis);
+                                           }
+                                       });
+                if (status != Status::success) {
+                    LOG_KNOWHERE_ERROR_ << "Invalid metric type: " << cfg.metric_type.value();
+                    return status;
+                }
+                if (cfg.range_filter.value() != defaultRangeFilter) {
+                    FilterRangeSearchResultForOneNq(result_dist_array[index], result_id_array[index], is_ip, radius,
+                                                    range_filter);
+                }
+                return Status::success;
+            }
             ThreadPool::ScopedOmpSetter setter(1);
             faiss::RangeSearchResult res(1);
 
@@ -414,7 +864,6 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
                     break;
                 }
                 case faiss::METRIC_INNER_PRODUCT: {
-                    is_ip = true;
                     auto cur_query = (const float*)xq + dim * index;
                     if (is_cosine) {
                         auto copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
@@ -521,6 +970,16 @@ BruteForce::SearchSparseWithBuf(const DataSetPtr base_dataset, const DataSetPtr
     std::fill(distances, distances + nq * topk, std::numeric_limits<float>::quiet_NaN());
     std::fill(labels, labels + nq * topk, -1);
 
+    if (PreferSparseTermAtATime(base, rows, xq, nq)) {
+        SearchSparseTermAtATime(base, rows, xq, nq, topk, computer, is_bm25, bitset, labels, distances);
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+        if (cfg.trace_id.has_value()) {
+            span->End();
+        }
+#endif
+        return Status::success;
+    }
+
     auto pool = ThreadPool::GetGlobalSearchThreadPool();
     std::vector<folly::Future<folly::Unit>> futs;
     futs.reserve(nq);
@@ -534,10 +993,7 @@ BruteForce::SearchSparseWithBuf(const DataSetPtr base_dataset, const DataSetPtr
                 return;
             }
             sparse::MaxMinHeap<float> heap(topk);
-            for (int64_t j = 0; j < rows; ++j) {
-                if (!bitset.empty() && bitset.test(j)) {
-                    continue;
-                }
+            bitset.for_each_allowed(rows, [&](int64_t j) {
                 float row_sum = 0;
                 if (is_bm25) {
                     for (size_t k = 0; k < base[j].size(); ++k) {
@@ -549,7 +1005,7 @@ BruteForce::SearchSparseWithBuf(const DataSetPtr base_dataset, const DataSetPtr
                 if (dist > 0) {
                     heap.push(j, dist);
                 }
-            }
+            });
             int result_size = heap.size();
             for (int j = result_size - 1; j >= 0; --j) {
                 cur_labels[j] = heap.top().id;
@@ -592,12 +1048,12 @@ template <typename DataType>
 expected<std::vector<IndexNode::IteratorPtr>>
 BruteForce::AnnIterator(const DataSetPtr base_dataset, const DataSetPtr query_dataset, const Json& config,
                         const BitsetView& bitset) {
-    auto base = ConvertFromDataTypeIfNeeded<DataType>(base_dataset);
+    // fp16/bf16 base rows are read in place, only the queries are converted to fp32
     auto query = ConvertFromDataTypeIfNeeded<DataType>(query_dataset);
 
-    auto xb = base->GetTensor();
-    auto nb = base->GetRows();
-    auto dim = base->GetDim();
+    auto xb = base_dataset->GetTensor();
+    auto nb = base_dataset->GetRows();
+    auto dim = base_dataset->GetDim();
 
     auto xq = query->GetTensor();
     auto nq = query->GetRows();
@@ -642,6 +1098,24 @@ BruteForce::AnnIterator(const DataSetPtr base_dataset, const DataSetPtr query_da
             auto max_dis = larger_is_closer ? std::numeric_limits<float>::lowest() : std::numeric_limits<float>::max();
             std::vector<DistId> distances_ids(nb, {-1, max_dis});
 
+            if constexpr (KnowhereHalfPrecisionFloatPointTypeCheck<DataType>::value) {
+                auto cur_query = (const float*)xq + dim * index;
+                std::unique_ptr<float[]> copied_query = nullptr;
+                if (is_cosine) {
+                    copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
+                    cur_query = copied_query.get();
+                }
+                auto status =
+                    ForEachRowDistance(cur_query, (const DataType*)xb, 0, nb, dim, faiss_metric_type, is_cosine, bitset,
+                                       [&](int64_t id, float dis) { distances_ids[id] = {id, dis}; });
+                if (status != Status::success) {
+                    LOG_KNOWHERE_ERROR_ << "Invalid metric type: " << cfg.metric_type.value();
+                    return status;
+                }
+                vec[index] = std::make_shared<PrecomputedDistanceIterator>(std::move(distances_ids), larger_is_closer);
+                return Status::success;
+            }
+
             switch (faiss_metric_type) {
                 case faiss::METRIC_L2: {
                     auto cur_query = (const float*)xq + dim * index;
@@ -735,10 +1209,7 @@ BruteForce::AnnIterator<knowhere::sparse::SparseRow<float>>(const DataSetPtr bas
             const auto& row = xq[index];
             std::vector<DistId> distances_ids;
             if (row.size() > 0) {
-                for (int64_t j = 0; j < rows; ++j) {
-                    if (!bitset.empty() && bitset.test(j)) {
-                        continue;
-                    }
+                bitset.for_each_allowed(rows, [&](int64_t j) {
                     float row_sum = 0;
                     if (is_bm25) {
                         for (size_t k = 0; k < base[j].size(); ++k) {
@@ -750,7 +1221,7 @@ BruteForce::AnnIterator<knowhere::sparse::SparseRow<float>>(const DataSetPtr bas
                     if (dist > 0) {
                         distances_ids.emplace_back(j, dist);
                     }
-                }
+                });
             }
             vec[index] = std::make_shared<PrecomputedDistanceIterator>(std::move(distances_ids), true);
         }));
@@ -15,6 +15,7 @@
 
 #ifdef KNOWHERE_WITH_DISKANN
 #include "diskann/aio_context_pool.h"
+#include "diskann/uring_aligned_file_reader.h"
 #endif
 #include "faiss/Clustering.h"
 #include "faiss/utils/distances.h"
@@ -146,6 +147,14 @@ KnowhereConfig::SetAioContextPool(size_t num_ctx) {
     return true;
 }
 
+bool
+KnowhereConfig::SetIoUring(bool enable, bool sqpoll) {
+#ifdef KNOWHERE_WITH_DISKANN
+    return UringAlignedFileReader::InitGlobalUring(enable, sqpoll);
+#endif
+    return false;
+}
+
 void
 KnowhereConfig::SetBuildThreadPoolSize(size_t num_threads) {
     knowhere::ThreadPool::SetGlobalBuildThreadPoolSize(num_threads);
@@ -72,4 +72,10 @@ DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(diskann_range_search_iters, "DISKANN range se
 DEFINE_PROMETHEUS_HISTOGRAM_WITH_BUCKETS(diskann_range_search_iters, PROMETHEUS_LABEL_KNOWHERE,
                                          diskannRangeSearchIterBuckets)
 
+DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(diskann_cache_hit_ratio, "DISKANN ratio of the nodes of a search found in cache")
+DEFINE_PROMETHEUS_HISTOGRAM_WITH_BUCKETS(diskann_cache_hit_ratio, PROMETHEUS_LABEL_KNOWHERE, ratioBuckets)
+
+DEFINE_PROMETHEUS_COUNTER_FAMILY(diskann_cache_promotions, "DISKANN nodes read into cache by the adaptive cache")
+DEFINE_PROMETHEUS_COUNTER(diskann_cache_promotions, PROMETHEUS_LABEL_KNOWHERE)
+
 }  // namespace knowhere
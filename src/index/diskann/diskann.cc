@@ -14,8 +14,10 @@
 #include <cstdint>
 
 #include "diskann/aux_utils.h"
+#include "diskann/fresh_index.h"
 #include "diskann/linux_aligned_file_reader.h"
 #include "diskann/pq_flash_index.h"
+#include "diskann/uring_aligned_file_reader.h"
 #include "fmt/core.h"
 #include "index/diskann/diskann_config.h"
 #include "knowhere/comp/index_param.h"
@@ -53,9 +55,13 @@ class DiskANNIndexNode : public IndexNode {
     }
 
     Status
-    Add(const DataSetPtr dataset, const Config& cfg) override {
-        return Status::not_implemented;
-    }
+    Add(const DataSetPtr dataset, const Config& cfg) override;
+
+    Status
+    DeleteByIds(const DataSetPtr dataset) override;
+
+    Status
+    Flush() override;
 
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const override;
@@ -115,11 +121,11 @@ class DiskANNIndexNode : public IndexNode {
 
     int64_t
     Size() const override {
-        if (!is_prepared_.load() || !pq_flash_index_) {
+        if (!is_prepared_.load() || !fresh_index_) {
             LOG_KNOWHERE_ERROR_ << "Diskann not loaded.";
             return 0;
         }
-        return pq_flash_index_->cal_size();
+        return fresh_index_->snapshot().disk->cal_size() + fresh_index_->cal_size();
     }
 
     int64_t
@@ -138,7 +144,7 @@ class DiskANNIndexNode : public IndexNode {
 
     expected<std::vector<std::shared_ptr<IndexNode::iterator>>>
     AnnIterator(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const override {
-        if (pq_flash_index_ == nullptr) {
+        if (fresh_index_ == nullptr) {
             LOG_KNOWHERE_WARNING_ << "creating iterator on empty index";
             return expected<std::vector<std::shared_ptr<IndexNode::iterator>>>::Err(Status::empty_index,
                                                                                     "index not loaded");
@@ -153,12 +159,16 @@ class DiskANNIndexNode : public IndexNode {
         futs.reserve(nq);
         auto vec = std::vector<std::shared_ptr<IndexNode::iterator>>(nq, nullptr);
 
+        // the iterators go over the points of the disk index, not over the ones inserted since it was written
+        auto pq_flash_index = fresh_index_->snapshot().disk;
+        std::shared_ptr<const std::vector<uint8_t>> deleted_bits;
+        auto filter = fresh_index_->filter_deleted(bitset, deleted_bits);
         for (int i = 0; i < nq; i++) {
             futs.emplace_back(search_pool_->push([&, i]() {
                 auto single_query = (void*)xq + i * dim;
                 auto it = std::make_shared<iterator>(true, single_query, ef, diskann_cfg.beamwidth, true,
-                                                     diskann_cfg.filter_threshold, diskann_cfg.for_tuning, 
-                                                     bitset,  pq_flash_index_.get());
+                                                     diskann_cfg.filter_threshold, diskann_cfg.for_tuning, filter,
+                                                     pq_flash_index, deleted_bits);
                 it->initialize();
                 vec[i] = it;
             }));
@@ -174,9 +184,11 @@ class DiskANNIndexNode : public IndexNode {
         iterator(const bool transform, void* query_data, const std::optional<int>& ef,
                  const std::optional<int>& beam_width, const bool use_reorder_data,
                  const std::optional<float>& filter_ratio_in, const std::optional<bool>& for_tun,
-                 const knowhere::BitsetView& bitset, diskann::PQFlashIndex<DataType>* index)
+                 const knowhere::BitsetView& bitset, std::shared_ptr<diskann::PQFlashIndex<DataType>> index,
+                 std::shared_ptr<const std::vector<uint8_t>> bitset_buf)
             : IndexIterator(transform),
-              index_(index),
+              index_(std::move(index)),
+              bitset_buf_(std::move(bitset_buf)),
               transform_(transform),
               workspace_(index_->getIteratorWorkspace(query_data, ef.value_or(0), beam_width.value_or(0),
                                                   use_reorder_data, filter_ratio_in.value_or(0.0f), 
@@ -201,7 +213,9 @@ class DiskANNIndexNode : public IndexNode {
         }
 
      private:
-        diskann::PQFlashIndex<DataType>* index_;
+        std::shared_ptr<diskann::PQFlashIndex<DataType>> index_;
+        // the bits of the bitset, with the deleted points filtered out
+        std::shared_ptr<const std::vector<uint8_t>> bitset_buf_;
         const bool transform_;
         std::unique_ptr<diskann::IteratorWorkspace> workspace_;
     };
@@ -227,11 +241,16 @@ class DiskANNIndexNode : public IndexNode {
     uint64_t
     GetCachedNodeNum(const float cache_dram_budget, const uint64_t data_dim, const uint64_t max_degree);
 
+    // loads the disk index of index_prefix_, its cache and warm up included
+    Status
+    LoadDiskIndex(const DiskANNConfig& prep_conf, std::shared_ptr<diskann::PQFlashIndex<DataType>>& pq_flash_index);
+
     std::string index_prefix_;
     mutable std::mutex preparation_lock_;
     std::atomic_bool is_prepared_;
     std::shared_ptr<FileManager> file_manager_;
-    std::unique_ptr<diskann::PQFlashIndex<DataType>> pq_flash_index_;
+    // the disk index, with the points inserted and deleted since it was written
+    std::unique_ptr<diskann::FreshIndex<DataType>> fresh_index_;
     std::atomic_int64_t dim_;
     std::atomic_int64_t count_;
     std::shared_ptr<ThreadPool> search_pool_;
@@ -289,7 +308,10 @@ GetOptionalFilenames(const std::string& prefix) {
     auto disk_index_filename = diskann::get_disk_index_filename(prefix);
     filenames.push_back(diskann::get_disk_index_centroids_filename(disk_index_filename));
     filenames.push_back(diskann::get_disk_index_medoids_filename(disk_index_filename));
+    filenames.push_back(diskann::get_disk_index_layout_filename(disk_index_filename));
+    filenames.push_back(diskann::get_disk_index_nav_graph_filename(disk_index_filename));
     filenames.push_back(diskann::get_cached_nodes_file(prefix));
+    filenames.push_back(diskann::get_disk_index_deleted_filename(disk_index_filename));
     return filenames;
 }
 
@@ -379,7 +401,9 @@ DiskANNIndexNode<DataType>::Build(const DataSetPtr dataset, const Config& cfg) {
                                                        false,
                                                        build_conf.accelerate_build.value(),
                                                        static_cast<uint32_t>(num_nodes_to_cache),
-                                                       build_conf.shuffle_build.value()};
+                                                       build_conf.shuffle_build.value(),
+                                                       build_conf.page_aware_layout.value(),
+                                                       static_cast<double>(build_conf.nav_graph_budget_ratio.value())};
     RETURN_IF_ERROR(TryDiskANNCall([&]() {
         int res = diskann::build_disk_index<DataType>(diskann_internal_build_config);
         if (res != 0)
@@ -405,6 +429,64 @@ DiskANNIndexNode<DataType>::Build(const DataSetPtr dataset, const Config& cfg) {
     return Status::success;
 }
 
+/*
+ * Inserts the vectors of dataset, which take the ids following the ones of the index: the ids of dataset are ignored.
+ * The index is expected to be loaded, and not to hold PQ codes or reorder data in its nodes.
+ */
+template <typename DataType>
+Status
+DiskANNIndexNode<DataType>::Add(const DataSetPtr dataset, const Config& cfg) {
+    if (!is_prepared_.load() || !fresh_index_) {
+        LOG_KNOWHERE_ERROR_ << "Failed to load diskann.";
+        return Status::empty_index;
+    }
+    if (!fresh_index_->supports_updates()) {
+        LOG_KNOWHERE_ERROR_ << "DiskANN index with disk PQ or reorder data doesn't support inserts.";
+        return Status::not_implemented;
+    }
+    if (dataset->GetDim() != Dim()) {
+        LOG_KNOWHERE_ERROR_ << "Dimension of the vectors to add " << dataset->GetDim() << " isn't the one of the index "
+                            << Dim() << ".";
+        return Status::invalid_args;
+    }
+    auto rows = dataset->GetRows();
+    auto data = static_cast<const DataType*>(dataset->GetTensor());
+    RETURN_IF_ERROR(TryDiskANNCall([&]() { fresh_index_->insert(data, rows); }));
+    count_.store(fresh_index_->get_num_points());
+    return Status::success;
+}
+
+/*
+ * The deleted points keep their ids, which the searches leave out. Count() includes them.
+ */
+template <typename DataType>
+Status
+DiskANNIndexNode<DataType>::DeleteByIds(const DataSetPtr dataset) {
+    if (!is_prepared_.load() || !fresh_index_) {
+        LOG_KNOWHERE_ERROR_ << "Failed to load diskann.";
+        return Status::empty_index;
+    }
+    if (!fresh_index_->supports_updates()) {
+        LOG_KNOWHERE_ERROR_ << "DiskANN index with disk PQ or reorder data doesn't support deletes.";
+        return Status::not_implemented;
+    }
+    return TryDiskANNCall([&]() { fresh_index_->remove(dataset->GetIds(), dataset->GetRows()); });
+}
+
+/*
+ * The index files are written by the build, and by the merges of the vectors added and deleted since: flushing
+ * merges the ones pending, and hands the merged files to the file manager.
+ */
+template <typename DataType>
+Status
+DiskANNIndexNode<DataType>::Flush() {
+    if (!is_prepared_.load() || !fresh_index_) {
+        LOG_KNOWHERE_ERROR_ << "Failed to load diskann.";
+        return Status::empty_index;
+    }
+    return TryDiskANNCall([&]() { fresh_index_->merge(); });
+}
+
 template <typename DataType>
 Status
 DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, const Config& cfg) {
@@ -424,16 +506,6 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, const Config& c
     bool is_ip = IsMetricType(prep_conf.metric_type.value(), knowhere::metric::IP);
     bool need_norm = IsMetricType(prep_conf.metric_type.value(), knowhere::metric::IP) ||
                      IsMetricType(prep_conf.metric_type.value(), knowhere::metric::COSINE);
-    auto diskann_metric = [m = prep_conf.metric_type.value()] {
-        if (IsMetricType(m, knowhere::metric::L2)) {
-            return diskann::Metric::L2;
-        } else if (IsMetricType(m, knowhere::metric::COSINE)) {
-            return diskann::Metric::COSINE;
-        } else {
-            return diskann::Metric::INNER_PRODUCT;
-        }
-    }();
-
     // Load file from file manager.
     for (auto& filename : GetNecessaryFilenames(
              index_prefix_, need_norm, prep_conf.search_cache_budget_gb.value() > 0 && !prep_conf.use_bfs_cache.value(),
@@ -456,16 +528,86 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, const Config& c
     // set thread pool
     search_pool_ = ThreadPool::GetGlobalSearchThreadPool();
 
+    // the files of a merge interrupted by a crash are either all replaced or none is
+    if (TryDiskANNCall([&]() {
+            if (diskann::recover_merge(index_prefix_)) {
+                LOG_KNOWHERE_INFO_ << "Completed the interrupted merge of " << index_prefix_;
+            }
+        }) != Status::success) {
+        LOG_KNOWHERE_ERROR_ << "Failed to recover the interrupted merge of DiskANN.";
+        return Status::disk_file_error;
+    }
+
+    std::shared_ptr<diskann::PQFlashIndex<DataType>> pq_flash_index;
+    RETURN_IF_ERROR(LoadDiskIndex(prep_conf, pq_flash_index));
+
+    count_.store(pq_flash_index->get_num_points());
+    // DiskANN will add one more dim for IP type.
+    if (is_ip) {
+        dim_.store(pq_flash_index->get_data_dim() - 1);
+    } else {
+        dim_.store(pq_flash_index->get_data_dim());
+    }
+
+    // the merges of the inserts and deletes rewrite the index files, which are then loaded again
+    auto loader = [this, prep_conf, need_norm]() {
+        for (auto& filename : GetNecessaryFilenames(index_prefix_, need_norm, false, false)) {
+            if (!AddFile(filename)) {
+                throw diskann::ANNException("Failed to add file " + filename, -1);
+            }
+        }
+        for (auto& filename : GetOptionalFilenames(index_prefix_)) {
+            if (file_exists(filename) && !AddFile(filename)) {
+                throw diskann::ANNException("Failed to add file " + filename, -1);
+            }
+        }
+        std::shared_ptr<diskann::PQFlashIndex<DataType>> pq_flash_index;
+        if (LoadDiskIndex(prep_conf, pq_flash_index) != Status::success) {
+            throw diskann::ANNException("Failed to load the merged DiskANN index", -1);
+        }
+        return pq_flash_index;
+    };
+    if (TryDiskANNCall([&]() {
+            fresh_index_ = std::make_unique<diskann::FreshIndex<DataType>>(
+                pq_flash_index, index_prefix_, loader, prep_conf.delta_merge_threshold.value());
+        }) != Status::success) {
+        LOG_KNOWHERE_ERROR_ << "Failed to load the deleted points of DiskANN.";
+        return Status::diskann_inner_error;
+    }
+
+    is_prepared_.store(true);
+    LOG_KNOWHERE_INFO_ << "End of diskann loading.";
+    return Status::success;
+}
+
+template <typename DataType>
+Status
+DiskANNIndexNode<DataType>::LoadDiskIndex(const DiskANNConfig& prep_conf,
+                                          std::shared_ptr<diskann::PQFlashIndex<DataType>>& pq_flash_index) {
+    auto diskann_metric = [m = prep_conf.metric_type.value()] {
+        if (IsMetricType(m, knowhere::metric::L2)) {
+            return diskann::Metric::L2;
+        } else if (IsMetricType(m, knowhere::metric::COSINE)) {
+            return diskann::Metric::COSINE;
+        } else {
+            return diskann::Metric::INNER_PRODUCT;
+        }
+    }();
+
     // load diskann pq code and meta info
     std::shared_ptr<AlignedFileReader> reader = nullptr;
 
-    reader.reset(new LinuxAlignedFileReader());
+    if (UringAlignedFileReader::IsEnabled()) {
+        reader.reset(new UringAlignedFileReader());
+    } else {
+        reader.reset(new LinuxAlignedFileReader());
+    }
 
-    pq_flash_index_ = std::make_unique<diskann::PQFlashIndex<DataType>>(reader, diskann_metric);
+    pq_flash_index = std::make_shared<diskann::PQFlashIndex<DataType>>(reader, diskann_metric);
     auto disk_ann_call = [&]() {
-        int res = pq_flash_index_->load(search_pool_->size(), index_prefix_.c_str());
+        int res = pq_flash_index->load(search_pool_->size(), index_prefix_.c_str());
         if (res != 0) {
-            throw diskann::ANNException("pq_flash_index_->load returned non-zero value: " + std::to_string(res), -1);
+            throw diskann::ANNException("pq_flash_index->load returned non-zero value: " + std::to_string(res), -1);
         }
     };
     if (TryDiskANNCall(disk_ann_call) != Status::success) {
@@ -473,18 +615,19 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, const Config& c
         return Status::diskann_inner_error;
     }
 
-    count_.store(pq_flash_index_->get_num_points());
-    // DiskANN will add one more dim for IP type.
-    if (is_ip) {
-        dim_.store(pq_flash_index_->get_data_dim() - 1);
-    } else {
-        dim_.store(pq_flash_index_->get_data_dim());
-    }
-
     std::string warmup_query_file = diskann::get_sample_data_filename(index_prefix_);
     // load cache
     auto cached_nodes_file = diskann::get_cached_nodes_file(index_prefix_);
     std::vector<uint32_t> node_list;
+    if (prep_conf.cache_refresh_interval.value() > 0) {
+        auto num_nodes_to_cache = GetCachedNodeNum(prep_conf.search_cache_budget_gb.value(),
+                                                   pq_flash_index->get_data_dim(), pq_flash_index->get_max_degree());
+        if (num_nodes_to_cache > 0) {
+            LOG_KNOWHERE_INFO_ << "Refreshing the cache of " << num_nodes_to_cache << " nodes every "
+                               << prep_conf.cache_refresh_interval.value() << " searches.";
+            pq_flash_index->enable_adaptive_cache(num_nodes_to_cache, prep_conf.cache_refresh_interval.value());
+        }
+    }
     if (file_exists(cached_nodes_file)) {
         LOG_KNOWHERE_INFO_ << "Reading cached nodes from file.";
         size_t num_nodes, nodes_id_dim;
@@ -493,8 +636,8 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, const Config& c
         node_list.assign(cached_nodes_ids.get(), cached_nodes_ids.get() + num_nodes);
     } else {
         auto num_nodes_to_cache = GetCachedNodeNum(prep_conf.search_cache_budget_gb.value(),
-                                                   pq_flash_index_->get_data_dim(), pq_flash_index_->get_max_degree());
-        if (num_nodes_to_cache > pq_flash_index_->get_num_points() / 3) {
+                                                   pq_flash_index->get_data_dim(), pq_flash_index->get_max_degree());
+        if (num_nodes_to_cache > pq_flash_index->get_num_points() / 3) {
             LOG_KNOWHERE_ERROR_ << "Failed to generate cache, num_nodes_to_cache(" << num_nodes_to_cache
                                 << ") is larger than 1/3 of the total data number.";
             return Status::invalid_args;
@@ -503,7 +646,7 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, const Config& c
             LOG_KNOWHERE_INFO_ << "Caching " << num_nodes_to_cache << " sample nodes around medoid(s).";
             if (prep_conf.use_bfs_cache.value()) {
                 LOG_KNOWHERE_INFO_ << "Use bfs to generate cache list";
-                if (TryDiskANNCall([&]() { pq_flash_index_->cache_bfs_levels(num_nodes_to_cache, node_list); }) !=
+                if (TryDiskANNCall([&]() { pq_flash_index->cache_bfs_levels(num_nodes_to_cache, node_list); }) !=
                     Status::success) {
                     LOG_KNOWHERE_ERROR_ << "Failed to generate bfs cache for DiskANN.";
                     return Status::diskann_inner_error;
@@ -511,8 +654,8 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, const Config& c
             } else {
                 LOG_KNOWHERE_INFO_ << "Use sample_queries to generate cache list";
                 if (TryDiskANNCall([&]() {
-                        pq_flash_index_->async_generate_cache_list_from_sample_queries(warmup_query_file, 15, 6,
-                                                                                       num_nodes_to_cache);
+                        pq_flash_index->async_generate_cache_list_from_sample_queries(warmup_query_file, 15, 6,
+                                                                                      num_nodes_to_cache);
                     }) != Status::success) {
                     LOG_KNOWHERE_ERROR_ << "Failed to generate cache from sample queries for DiskANN.";
                     return Status::diskann_inner_error;
@@ -523,7 +666,7 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, const Config& c
     }
 
     if (node_list.size() > 0) {
-        if (TryDiskANNCall([&]() { pq_flash_index_->load_cache_list(node_list); }) != Status::success) {
+        if (TryDiskANNCall([&]() { pq_flash_index->load_cache_list(node_list); }) != Status::success) {
             LOG_KNOWHERE_ERROR_ << "Failed to load cache for DiskANN.";
             return Status::diskann_inner_error;
         }
@@ -551,9 +694,9 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, const Config& c
         futures.reserve(warmup_num);
         for (_s64 i = 0; i < (int64_t)warmup_num; ++i) {
             futures.emplace_back(search_pool_->push([&, index = i]() {
-                pq_flash_index_->cached_beam_search(warmup + (index * warmup_aligned_dim), 1, warmup_L,
-                                                    warmup_result_ids_64.data() + (index * 1),
-                                                    warmup_result_dists.data() + (index * 1), 4);
+                pq_flash_index->cached_beam_search(warmup + (index * warmup_aligned_dim), 1, warmup_L,
+                                                   warmup_result_ids_64.data() + (index * 1),
+                                                   warmup_result_dists.data() + (index * 1), 4);
             }));
         }
 
@@ -569,15 +712,13 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, const Config& c
         }
     }
 
-    is_prepared_.store(true);
-    LOG_KNOWHERE_INFO_ << "End of diskann loading.";
     return Status::success;
 }
 
 template <typename DataType>
 expected<DataSetPtr>
 DiskANNIndexNode<DataType>::Search(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const {
-    if (!is_prepared_.load() || !pq_flash_index_) {
+    if (!is_prepared_.load() || !fresh_index_) {
         LOG_KNOWHERE_ERROR_ << "Failed to load diskann.";
         return expected<DataSetPtr>::Err(Status::empty_index, "DiskANN not loaded");
     }
@@ -589,6 +730,7 @@ DiskANNIndexNode<DataType>::Search(const DataSetPtr dataset, const Config& cfg,
     auto k = static_cast<uint64_t>(search_conf.k.value());
     auto lsearch = static_cast<uint64_t>(search_conf.search_list_size.value());
     auto beamwidth = static_cast<uint64_t>(search_conf.beamwidth.value());
+    auto io_depth = static_cast<uint64_t>(search_conf.search_io_depth.value());
     auto filter_ratio = static_cast<float>(search_conf.filter_threshold.value());
     auto for_tuning = static_cast<bool>(search_conf.for_tuning.value());
 
@@ -609,16 +751,34 @@ DiskANNIndexNode<DataType>::Search(const DataSetPtr dataset, const Config& cfg,
     auto p_id = std::make_unique<int64_t[]>(k * nq);
     auto p_dist = std::make_unique<DistType[]>(k * nq);
 
+    // the queries search the same index, whether or not a merge replaces it meanwhile
+    auto snapshot = fresh_index_->snapshot();
+    std::shared_ptr<const std::vector<uint8_t>> deleted_bits;
+    auto filter = fresh_index_->filter_deleted(bitset, deleted_bits);
+
+    // kept until all the queries are done
+    std::unique_ptr<diskann::SharedSectorReads> shared_reads;
+    auto shared_reads_budget = static_cast<uint64_t>(search_conf.search_shared_reads_budget_gb.value() * 1024 * 1024 *
+                                                     1024);
+    if (nq > 1 && shared_reads_budget > 0) {
+        shared_reads = std::make_unique<diskann::SharedSectorReads>(snapshot.disk->get_read_len_for_node(),
+                                                                    shared_reads_budget);
+    }
+
     std::vector<folly::Future<folly::Unit>> futures;
     futures.reserve(nq);
     for (int64_t row = 0; row < nq; ++row) {
         futures.emplace_back(search_pool_->push([&, index = row, p_id_ptr = p_id.get(), p_dist_ptr = p_dist.get()]() {
             diskann::QueryStats stats;
-            pq_flash_index_->cached_beam_search(xq + (index * dim), k, lsearch, p_id_ptr + (index * k),
-                                                p_dist_ptr + (index * k), beamwidth, false, &stats, feder_result,
-                                                bitset, filter_ratio, for_tuning);
+            fresh_index_->search(snapshot, xq + (index * dim), k, lsearch, p_id_ptr + (index * k),
+                                 p_dist_ptr + (index * k), beamwidth, &stats, feder_result, filter, filter_ratio,
+                                 for_tuning, io_depth, shared_reads.get());
 #ifdef NOT_COMPILE_FOR_SWIG
             knowhere_diskann_search_hops.Observe(stats.n_hops);
+            if (stats.n_cache_hits + stats.n_ios > 0) {
+                knowhere_diskann_cache_hit_ratio.Observe(static_cast<double>(stats.n_cache_hits) /
+                                                         (stats.n_cache_hits + stats.n_ios));
+            }
 #endif
         }));
     }
@@ -643,7 +803,7 @@ DiskANNIndexNode<DataType>::Search(const DataSetPtr dataset, const Config& cfg,
 template <typename DataType>
 expected<DataSetPtr>
 DiskANNIndexNode<DataType>::RangeSearch(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const {
-    if (!is_prepared_.load() || !pq_flash_index_) {
+    if (!is_prepared_.load() || !fresh_index_) {
         LOG_KNOWHERE_ERROR_ << "Failed to load diskann.";
         return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
     }
@@ -663,8 +823,11 @@ DiskANNIndexNode<DataType>::RangeSearch(const DataSetPtr dataset, const Config&
 
     auto radius = search_conf.radius.value();
     auto range_filter = search_conf.range_filter.value();
-    bool is_ip = (pq_flash_index_->get_metric() == diskann::Metric::INNER_PRODUCT ||
-                  pq_flash_index_->get_metric() == diskann::Metric::COSINE);
+    auto snapshot = fresh_index_->snapshot();
+    std::shared_ptr<const std::vector<uint8_t>> deleted_bits;
+    auto filter = fresh_index_->filter_deleted(bitset, deleted_bits);
+    bool is_ip = (snapshot.disk->get_metric() == diskann::Metric::INNER_PRODUCT ||
+                  snapshot.disk->get_metric() == diskann::Metric::COSINE);
 
     auto dim = dataset->GetDim();
     auto nq = dataset->GetRows();
@@ -678,8 +841,8 @@ DiskANNIndexNode<DataType>::RangeSearch(const DataSetPtr dataset, const Config&
     for (int64_t row = 0; row < nq; ++row) {
         futures.emplace_back(search_pool_->push([&, index = row]() {
             diskann::QueryStats stats;
-            pq_flash_index_->range_search(xq + (index * dim), radius, min_k, max_k, result_id_array[index],
-                                          result_dist_array[index], beamwidth, bitset, &stats);
+            fresh_index_->range_search(snapshot, xq + (index * dim), radius, min_k, max_k, result_id_array[index],
+                                       result_dist_array[index], beamwidth, filter, &stats);
 #ifdef NOT_COMPILE_FOR_SWIG
             knowhere_diskann_range_search_iters.Observe(stats.n_iters);
 #endif
@@ -707,7 +870,7 @@ DiskANNIndexNode<DataType>::RangeSearch(const DataSetPtr dataset, const Config&
 template <typename DataType>
 expected<DataSetPtr>
 DiskANNIndexNode<DataType>::GetVectorByIds(const DataSetPtr dataset) const {
-    if (!is_prepared_.load() || !pq_flash_index_) {
+    if (!is_prepared_.load() || !fresh_index_) {
         LOG_KNOWHERE_ERROR_ << "Failed to load diskann.";
         return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
     }
@@ -720,7 +883,8 @@ DiskANNIndexNode<DataType>::GetVectorByIds(const DataSetPtr dataset) const {
         return expected<DataSetPtr>::Err(Status::malloc_error, "failed to allocate memory for data");
     }
 
-    if (TryDiskANNCall([&]() { pq_flash_index_->get_vector_by_ids(ids, rows, data); }) != Status::success) {
+    if (TryDiskANNCall([&]() { fresh_index_->get_vector_by_ids(fresh_index_->snapshot(), ids, rows, data); }) !=
+        Status::success) {
         delete[] data;
         return expected<DataSetPtr>::Err(Status::diskann_inner_error, "failed to get vector");
     };
@@ -732,8 +896,9 @@ template <typename DataType>
 expected<DataSetPtr>
 DiskANNIndexNode<DataType>::GetIndexMeta(const Config& cfg) const {
     std::vector<int64_t> entry_points;
-    for (size_t i = 0; i < pq_flash_index_->get_num_medoids(); i++) {
-        entry_points.push_back(pq_flash_index_->get_medoids()[i]);
+    auto pq_flash_index = fresh_index_->snapshot().disk;
+    for (size_t i = 0; i < pq_flash_index->get_num_medoids(); i++) {
+        entry_points.push_back(pq_flash_index->get_medoids()[i]);
     }
     auto diskann_conf = static_cast<const DiskANNConfig&>(cfg);
     feder::diskann::DiskANNMeta meta(diskann_conf.data_path.value(), diskann_conf.max_degree.value(),
@@ -50,6 +50,15 @@ class DiskANNConfig : public BaseConfig {
     // This is the flag to enable fast build, in which we will not build vamana graph by full 2 round. This can
     // accelerate index build ~30% with an ~1% recall regression.
     CFG_BOOL accelerate_build;
+    // Store the neighbors of each node in the graph in the same sectors as it, rather than nodes of consecutive ids.
+    // The search then expands the neighbors it needs that come with each sector read without reading them again,
+    // reading fewer sectors for the same recall, at the cost of a pass over the disk index at the end of the build
+    // and 8 bytes of memory per vector to locate the nodes.
+    CFG_BOOL page_aware_layout;
+    // Fraction of pq_code_budget_gb spent on a navigation graph: a small in-memory graph over a sample of the
+    // vectors, searched first to pick entry points close to the query, so the disk search reads fewer sectors to
+    // reach its neighborhood. The PQ codes get the rest of the budget. 0 disables it.
+    CFG_FLOAT nav_graph_budget_ratio;
     // While serving the index, the entire graph is stored on SSD. For faster search performance, you can cache a few
     // frequently accessed nodes in memory.
     CFG_FLOAT search_cache_budget_gb;
@@ -59,11 +68,28 @@ class DiskANNConfig : public BaseConfig {
     // cached the nodes on the search paths; 2. do bfs from the entry point and cache them. The first method is suitable
     // for TopK query heavy circumstances and the second one performed better in range search.
     CFG_BOOL use_bfs_cache;
+    // Refresh the cache every this many searches with the nodes the searches expand most often, 0 to keep the nodes
+    // cached at load. The cache then follows the query workload as it drifts rather than until the index is reloaded,
+    // at the cost of a byte of access count per node and a background scan of the counts at each refresh.
+    CFG_INT cache_refresh_interval;
+    // The number of inserted points, or of deleted ones, from which the inserts and deletes made since the index was
+    // loaded are merged into its files. Until then the inserted points are searched in memory and the deleted ones
+    // are filtered out of the results; a merge rewrites the index files in a single pass over them in the background.
+    CFG_INT delta_merge_threshold;
     // The beamwidth to be used for search. This is the maximum number of IO requests each query will issue per
     // iteration of search code. Larger beamwidth will result in fewer IO round-trips per query but might result in
     // slightly higher total number of IO requests to SSD per query. For the highest query throughput with a fixed SSD
     // IOps rating, use W=1. For best latency, use W=4,8 or higher complexity search.
     CFG_INT beamwidth;
+    // The number of sector reads each query keeps in flight with the pipelined search, 0 to search beam by beam. The
+    // pipelined search expands each node as soon as its read completes and refills the freed read with the best
+    // candidate at that time, rather than waiting for the whole beam, which keeps the SSD busy while nodes are expanded
+    // and lowers the latency of a query at the cost of a few more reads.
+    CFG_INT search_io_depth;
+    // Memory the queries of a search request may use to share the sectors they read: the first query needing a
+    // sector reads it, and the queries needing it at the same time or later in the request use that read rather than
+    // reading it again, which saves reads when the queries are alike. 0 disables it.
+    CFG_FLOAT search_shared_reads_budget_gb;
     // DiskANN uses TopK search to simulate range search by double the K in every round. This is the start K.
     CFG_INT min_k;
     // DiskANN uses TopK search to simulate range search by double the K in every round. This is the largest K.
@@ -102,6 +128,15 @@ class DiskANNConfig : public BaseConfig {
             .description("a flag to enbale fast build.")
             .set_default(false)
             .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(page_aware_layout)
+            .description("store graph neighbors in the same sectors on disk.")
+            .set_default(false)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(nav_graph_budget_ratio)
+            .description("the fraction of the PQ code budget used by the navigation graph.")
+            .set_default(0.0f)
+            .set_range(0.0f, 1.0f)
+            .for_train();
         KNOWHERE_CONFIG_DECLARE_FIELD(search_cache_budget_gb)
             .description("the size of cached nodes in GB.")
             .set_default(0)
@@ -116,6 +151,16 @@ class DiskANNConfig : public BaseConfig {
             .description("should bfs strategy to cache nodes.")
             .set_default(false)
             .for_deserialize();
+        KNOWHERE_CONFIG_DECLARE_FIELD(cache_refresh_interval)
+            .description("the number of searches between refreshes of the cache, 0 to keep the nodes cached at load.")
+            .set_default(0)
+            .set_range(0, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_deserialize();
+        KNOWHERE_CONFIG_DECLARE_FIELD(delta_merge_threshold)
+            .description("the number of inserted or deleted points from which they are merged into the index files.")
+            .set_default(100000)
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_deserialize();
         KNOWHERE_CONFIG_DECLARE_FIELD(beamwidth)
             .description("the maximum number of IO requests each query will issue per iteration of search code.")
             .set_default(8)
@@ -123,6 +168,16 @@ class DiskANNConfig : public BaseConfig {
             .for_search()
             .for_range_search()
             .for_iterator();
+        KNOWHERE_CONFIG_DECLARE_FIELD(search_io_depth)
+            .description("the number of sector reads each query keeps in flight, 0 to search beam by beam.")
+            .set_default(0)
+            .set_range(0, 128)
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(search_shared_reads_budget_gb)
+            .description("the size of the sectors the queries of a search share in GB, 0 to disable.")
+            .set_default(0.0f)
+            .set_range(0.0f, std::numeric_limits<CFG_FLOAT::value_type>::max())
+            .for_search();
         KNOWHERE_CONFIG_DECLARE_FIELD(min_k)
             .description("the min l_search size used in range search.")
             .set_default(100)
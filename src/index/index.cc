@@ -68,6 +68,18 @@ Index<T>::Add(const DataSetPtr dataset, const Json& json) {
     return this->node->Add(dataset, *cfg);
 }
 
+template <typename T>
+inline Status
+Index<T>::DeleteByIds(const DataSetPtr dataset) {
+    return this->node->DeleteByIds(dataset);
+}
+
+template <typename T>
+inline Status
+Index<T>::Flush() {
+    return this->node->Flush();
+}
+
 template <typename T>
 inline expected<DataSetPtr>
 Index<T>::Search(const DataSetPtr dataset, const Json& json, const BitsetView& bitset_) const {
@@ -21,6 +21,8 @@
 #include "faiss/IndexScaNN.h"
 #include "faiss/IndexScalarQuantizer.h"
 #include "faiss/index_io.h"
+#include "faiss/utils/Heap.h"
+#include "faiss/utils/distances.h"
 #include "index/ivf/ivf_config.h"
 #include "io/memory_io.h"
 #include "knowhere/bitsetview_idselector.h"
@@ -255,6 +257,16 @@ class IvfIndexNode : public IndexNode {
                std::is_same_v<IndexType, faiss::IndexScaNN>;
     }
 
+    static constexpr bool
+    SupportsAllowListSearch() {
+        return std::is_same_v<IndexType, faiss::IndexIVFFlat> || std::is_same_v<IndexType, faiss::IndexIVFFlatCC>;
+    }
+
+    // exact top-k over the rows that survive the filter, reading the raw vectors through the direct map
+    void
+    SearchAllowList(const float* query, const std::vector<int64_t>& allowed_ids, int64_t k, float* distances,
+                    int64_t* labels) const;
+
  private:
     // only support IVFFlat and IVFFlatCC
     // iterator will own the copied_norm_query
@@ -641,6 +653,20 @@ IvfIndexNode<DataType, IndexType>::Search(const DataSetPtr dataset, const Config
     auto k = ivf_cfg.k.value();
     auto nprobe = ivf_cfg.nprobe.value();
 
+    // when the filter leaves fewer rows than the nprobe lists would scan anyway, score the survivors exactly
+    // instead of walking inverted lists that are almost entirely filtered out
+    std::vector<int64_t> allowed_ids;
+    bool use_allow_list = false;
+    if constexpr (SupportsAllowListSearch()) {
+        if (!bitset.empty() && index_->direct_map.type != faiss::DirectMap::NoMap) {
+            auto num_allowed = index_->ntotal > (faiss::idx_t)bitset.count() ? index_->ntotal - bitset.count() : 0;
+            if (num_allowed <= (nprobe * 1.0 / index_->nlist) * index_->ntotal) {
+                allowed_ids = bitset.get_allowed_ids(index_->ntotal);
+                use_allow_list = true;
+            }
+        }
+    }
+
     auto ids = std::make_unique<int64_t[]>(rows * k);
     auto distances = std::make_unique<float[]>(rows * k);
     try {
@@ -652,6 +678,18 @@ IvfIndexNode<DataType, IndexType>::Search(const DataSetPtr dataset, const Config
                 auto offset = k * index;
                 std::unique_ptr<float[]> copied_query = nullptr;
 
+                if constexpr (SupportsAllowListSearch()) {
+                    if (use_allow_list) {
+                        auto cur_query = (const float*)data + index * dim;
+                        if (is_cosine) {
+                            copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
+                            cur_query = copied_query.get();
+                        }
+                        SearchAllowList(cur_query, allowed_ids, k, distances.get() + offset, ids.get() + offset);
+                        return;
+                    }
+                }
+
                 BitsetViewIDSelector bw_idselector(bitset);
                 faiss::IDSelector* id_selector = (bitset.empty()) ? nullptr : &bw_idselector;
 
@@ -739,6 +777,40 @@ IvfIndexNode<DataType, IndexType>::Search(const DataSetPtr dataset, const Config
     return res;
 }
 
+template <typename DataType, typename IndexType>
+void
+IvfIndexNode<DataType, IndexType>::SearchAllowList(const float* query, const std::vector<int64_t>& allowed_ids,
+                                                   int64_t k, float* distances, int64_t* labels) const {
+    const auto dim = index_->d;
+    std::vector<float> code(dim);
+    if (index_->metric_type == faiss::METRIC_L2) {
+        faiss::maxheap_heapify(k, distances, labels);
+        for (auto id : allowed_ids) {
+            index_->reconstruct(id, code.data());
+            auto dis = faiss::fvec_L2sqr(query, code.data(), dim);
+            if (dis < distances[0]) {
+                faiss::maxheap_replace_top(k, distances, labels, dis, id);
+            }
+        }
+        faiss::maxheap_reorder(k, distances, labels);
+    } else {
+        faiss::minheap_heapify(k, distances, labels);
+        for (auto id : allowed_ids) {
+            index_->reconstruct(id, code.data());
+            auto dis = faiss::fvec_inner_product(query, code.data(), dim);
+            if (index_->is_cosine) {
+                // raw vectors are kept unnormalized for cosine
+                auto norm = faiss::fvec_norm_L2sqr(code.data(), dim);
+                dis = norm > 0 ? dis / std::sqrt(norm) : 0.0f;
+            }
+            if (dis > distances[0]) {
+                faiss::minheap_replace_top(k, distances, labels, dis, id);
+            }
+        }
+        faiss::minheap_reorder(k, distances, labels);
+    }
+}
+
 template <typename DataType, typename IndexType>
 expected<DataSetPtr>
 IvfIndexNode<DataType, IndexType>::RangeSearch(const DataSetPtr dataset, const Config& cfg,
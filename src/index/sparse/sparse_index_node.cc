@@ -11,8 +11,12 @@
 
 #include <sys/mman.h>
 
+#include <algorithm>
+#include <numeric>
+
 #include "index/sparse/sparse_inverted_index.h"
 #include "index/sparse/sparse_inverted_index_config.h"
+#include "index/sparse/sparse_seismic_index.h"
 #include "io/file_io.h"
 #include "io/memory_io.h"
 #include "knowhere/comp/thread_pool.h"
@@ -27,10 +31,9 @@
 
 namespace knowhere {
 
-// Inverted Index impl for sparse vectors. May optionally use WAND algorithm to speed up search.
-//
-// Not overriding RangeSerach, will use the default implementation in IndexNode.
-template <typename T, bool use_wand>
+// Inverted Index impl for sparse vectors. May optionally use WAND algorithm to speed up search, or be the approximate
+// SeismicIndex if seismic is true.
+template <typename T, bool use_wand, bool seismic = false>
 class SparseInvertedIndexNode : public IndexNode {
     static_assert(std::is_same_v<T, fp32>, "SparseInvertedIndexNode only support float");
 
@@ -94,22 +97,98 @@ class SparseInvertedIndexNode : public IndexNode {
         auto k = cfg.k.value();
         auto refine_factor = cfg.refine_factor.value_or(10);
         auto drop_ratio_search = cfg.drop_ratio_search.value_or(0.0f);
+        auto algo = sparse::ParseInvertedIndexAlgo(cfg.inverted_index_algo.value_or("DAAT_BLOCK_MAX_WAND"));
+        if (!algo.has_value()) {
+            return expected<DataSetPtr>::Err(Status::invalid_args,
+                                             "unknown inverted_index_algo: " + cfg.inverted_index_algo.value());
+        }
+
+        sparse::SeismicSearchParams seismic_params;
+        seismic_params.query_cut = cfg.seismic_query_cut.value();
+        seismic_params.heap_factor = cfg.seismic_heap_factor.value();
 
         auto p_id = std::make_unique<sparse::label_t[]>(nq * k);
         auto p_dist = std::make_unique<float[]>(nq * k);
 
+        // the inverted index searches large nq in batches that share posting list reads, while keeping at least one
+        // batch per search thread.
+        int64_t batch_size = 1;
+        if constexpr (!use_wand && !seismic) {
+            batch_size = std::clamp<int64_t>(nq / search_pool_->size(), 1, kMaxSearchBatchSize);
+        }
         std::vector<folly::Future<folly::Unit>> futs;
-        futs.reserve(nq);
-        for (int64_t idx = 0; idx < nq; ++idx) {
+        futs.reserve((nq + batch_size - 1) / batch_size);
+        for (int64_t idx = 0; idx < nq; idx += batch_size) {
             futs.emplace_back(search_pool_->push([&, idx = idx, p_id = p_id.get(), p_dist = p_dist.get()]() {
-                index_->Search(queries[idx], k, drop_ratio_search, p_dist + idx * k, p_id + idx * k, refine_factor,
-                               bitset, computer);
+                auto n = std::min(batch_size, nq - idx);
+                if constexpr (seismic) {
+                    static_cast<const sparse::BaseSeismicIndex<T>*>(index_)->Search(
+                        queries[idx], k, drop_ratio_search, p_dist + idx * k, p_id + idx * k, bitset, computer,
+                        seismic_params);
+                } else if (n == 1) {
+                    index_->Search(queries[idx], k, drop_ratio_search, p_dist + idx * k, p_id + idx * k,
+                                   refine_factor, bitset, computer, algo.value());
+                } else {
+                    index_->SearchBatch(queries + idx, n, k, drop_ratio_search, p_dist + idx * k, p_id + idx * k,
+                                        refine_factor, bitset, computer, algo.value());
+                }
             }));
         }
         WaitAllSuccess(futs);
         return GenResultDataSet(nq, k, p_id.release(), p_dist.release());
     }
 
+    // Searches the index for the docs in range directly instead of going through AnnIterator, which scores every
+    // doc. range_search_k keeps the closest range_search_k docs of each query.
+    [[nodiscard]] expected<DataSetPtr>
+    RangeSearch(const DataSetPtr dataset, const Config& config, const BitsetView& bitset) const override {
+        if (!index_) {
+            LOG_KNOWHERE_ERROR_ << "Could not range search empty " << Type();
+            return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+        }
+        auto cfg = static_cast<const SparseInvertedIndexConfig&>(config);
+        auto computer_or = index_->GetDocValueComputer(cfg);
+        if (!computer_or.has_value()) {
+            return expected<DataSetPtr>::Err(computer_or.error(), computer_or.what());
+        }
+        auto computer = computer_or.value();
+        auto nq = dataset->GetRows();
+        auto queries = static_cast<const sparse::SparseRow<T>*>(dataset->GetTensor());
+        auto radius = cfg.radius.value();
+        auto range_filter = cfg.range_filter.value();
+        auto range_search_k = cfg.range_search_k.value();
+        auto drop_ratio_search = cfg.drop_ratio_search.value_or(0.0f);
+
+        std::vector<std::vector<sparse::label_t>> ids(nq);
+        std::vector<std::vector<float>> distances(nq);
+        std::vector<folly::Future<folly::Unit>> futs;
+        futs.reserve(nq);
+        for (int64_t i = 0; i < nq; ++i) {
+            futs.emplace_back(search_pool_->push([&, i]() {
+                index_->RangeSearch(queries[i], radius, range_filter, drop_ratio_search, bitset, computer, ids[i],
+                                    distances[i]);
+                if (range_search_k > 0 && ids[i].size() > static_cast<size_t>(range_search_k)) {
+                    keep_closest(ids[i], distances[i], range_search_k);
+                }
+            }));
+        }
+        WaitAllSuccess(futs);
+
+        RangeSearchResult result;
+        result.lims = std::make_unique<size_t[]>(nq + 1);
+        result.lims[0] = 0;
+        for (int64_t i = 0; i < nq; ++i) {
+            result.lims[i + 1] = result.lims[i] + ids[i].size();
+        }
+        result.labels = std::make_unique<int64_t[]>(result.lims[nq]);
+        result.distances = std::make_unique<float[]>(result.lims[nq]);
+        for (int64_t i = 0; i < nq; ++i) {
+            std::copy(ids[i].begin(), ids[i].end(), result.labels.get() + result.lims[i]);
+            std::copy(distances[i].begin(), distances[i].end(), result.distances.get() + result.lims[i]);
+        }
+        return GenResultDataSet(nq, std::move(result));
+    }
+
     // TODO: for now inverted index and wand use the same impl for AnnIterator.
     [[nodiscard]] expected<std::vector<IndexNode::IteratorPtr>>
     AnnIterator(const DataSetPtr dataset, const Config& config, const BitsetView& bitset) const override {
@@ -268,14 +347,29 @@ class SparseInvertedIndexNode : public IndexNode {
 
     [[nodiscard]] std::string
     Type() const override {
+        if constexpr (seismic) {
+            return knowhere::IndexEnum::INDEX_SPARSE_SEISMIC;
+        }
         return use_wand ? knowhere::IndexEnum::INDEX_SPARSE_WAND : knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX;
     }
 
  private:
     expected<sparse::BaseInvertedIndex<T>*>
     CreateIndex(const SparseInvertedIndexConfig& cfg) const {
+        if constexpr (seismic) {
+            return CreateSeismicIndex(cfg);
+        }
+        // a loaded index keeps the codec it was saved with if none is given.
+        std::optional<sparse::PostingListCodec> codec;
+        if (cfg.posting_list_codec.has_value()) {
+            codec = sparse::ParsePostingListCodec(cfg.posting_list_codec.value());
+            if (!codec.has_value()) {
+                return expected<sparse::BaseInvertedIndex<T>*>::Err(
+                    Status::invalid_args, "unknown posting_list_codec: " + cfg.posting_list_codec.value());
+            }
+        }
         if (IsMetricType(cfg.metric_type.value(), metric::BM25)) {
-            auto idx = new sparse::InvertedIndex<T, use_wand, true>();
+            auto idx = new sparse::InvertedIndex<T, use_wand, true>(codec);
             if (!cfg.bm25_k1.has_value() || !cfg.bm25_b.has_value() || !cfg.bm25_avgdl.has_value()) {
                 return expected<sparse::BaseInvertedIndex<T>*>::Err(
                     Status::invalid_args, "BM25 parameters k1, b, and avgdl must be set when building/loading");
@@ -287,10 +381,45 @@ class SparseInvertedIndexNode : public IndexNode {
             idx->SetBM25Params(k1, b, avgdl, max_score_ratio);
             return idx;
         } else {
-            return new sparse::InvertedIndex<T, use_wand, false>();
+            return new sparse::InvertedIndex<T, use_wand, false>(codec);
         }
     }
 
+    expected<sparse::BaseInvertedIndex<T>*>
+    CreateSeismicIndex(const SparseInvertedIndexConfig& cfg) const {
+        sparse::SeismicBuildParams build_params;
+        build_params.n_postings = cfg.seismic_n_postings.value();
+        build_params.centroid_fraction = cfg.seismic_centroid_fraction.value();
+        build_params.summary_energy = cfg.seismic_summary_energy.value();
+        if (IsMetricType(cfg.metric_type.value(), metric::BM25)) {
+            if (!cfg.bm25_k1.has_value() || !cfg.bm25_b.has_value() || !cfg.bm25_avgdl.has_value()) {
+                return expected<sparse::BaseInvertedIndex<T>*>::Err(
+                    Status::invalid_args, "BM25 parameters k1, b, and avgdl must be set when building/loading");
+            }
+            auto idx = new sparse::SeismicIndex<T, true>(build_params);
+            idx->SetBM25Params(cfg.bm25_k1.value(), cfg.bm25_b.value(), cfg.bm25_avgdl.value());
+            return idx;
+        }
+        return new sparse::SeismicIndex<T, false>(build_params);
+    }
+
+    // keeps the k docs with the largest distances, in ascending id order.
+    static void
+    keep_closest(std::vector<sparse::label_t>& ids, std::vector<float>& distances, size_t k) {
+        std::vector<size_t> order(ids.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::nth_element(order.begin(), order.begin() + k - 1, order.end(),
+                         [&](size_t a, size_t b) { return distances[a] > distances[b]; });
+        order.resize(k);
+        std::sort(order.begin(), order.end());
+        for (size_t i = 0; i < k; ++i) {
+            ids[i] = ids[order[i]];
+            distances[i] = distances[order[i]];
+        }
+        ids.resize(k);
+        distances.resize(k);
+    }
+
     void
     DeleteExistingIndex() {
         if (index_ != nullptr) {
@@ -307,6 +436,9 @@ class SparseInvertedIndexNode : public IndexNode {
         }
     }
 
+    // max number of queries searched together by the inverted index, see BaseInvertedIndex::SearchBatch().
+    static constexpr int64_t kMaxSearchBatchSize = 32;
+
     sparse::BaseInvertedIndex<T>* index_{};
     std::shared_ptr<ThreadPool> search_pool_;
 
@@ -317,5 +449,6 @@ class SparseInvertedIndexNode : public IndexNode {
 
 KNOWHERE_SIMPLE_REGISTER_GLOBAL(SPARSE_INVERTED_INDEX, SparseInvertedIndexNode, fp32, /*use_wand=*/false);
 KNOWHERE_SIMPLE_REGISTER_GLOBAL(SPARSE_WAND, SparseInvertedIndexNode, fp32, /*use_wand=*/true);
+KNOWHERE_SIMPLE_REGISTER_GLOBAL(SPARSE_SEISMIC, SparseInvertedIndexNode, fp32, /*use_wand=*/false, /*seismic=*/true);
 
 }  // namespace knowhere
@@ -12,15 +12,22 @@
 #ifndef SPARSE_INVERTED_INDEX_H
 #define SPARSE_INVERTED_INDEX_H
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <queue>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
 #include "index/sparse/sparse_inverted_index_config.h"
+#include "index/sparse/sparse_posting_list.h"
 #include "io/memory_io.h"
 #include "knowhere/bitsetview.h"
+#include "knowhere/comp/thread_pool.h"
 #include "knowhere/expected.h"
 #include "knowhere/log.h"
 #include "knowhere/sparse_utils.h"
@@ -46,7 +53,20 @@ class BaseInvertedIndex {
 
     virtual void
     Search(const SparseRow<T>& query, size_t k, float drop_ratio_search, float* distances, label_t* labels,
-           size_t refine_factor, const BitsetView& bitset, const DocValueComputer<T>& computer) const = 0;
+           size_t refine_factor, const BitsetView& bitset, const DocValueComputer<T>& computer,
+           InvertedIndexAlgo algo) const = 0;
+
+    // searches nq queries together, the results of queries[i] go to distances + i * k and labels + i * k.
+    virtual void
+    SearchBatch(const SparseRow<T>* queries, size_t nq, size_t k, float drop_ratio_search, float* distances,
+                label_t* labels, size_t refine_factor, const BitsetView& bitset, const DocValueComputer<T>& computer,
+                InvertedIndexAlgo algo) const = 0;
+
+    // appends the docs whose distance to query is in (radius, range_filter] to ids and distances.
+    virtual void
+    RangeSearch(const SparseRow<T>& query, float radius, float range_filter, float drop_ratio_search,
+                const BitsetView& bitset, const DocValueComputer<T>& computer, std::vector<label_t>& ids,
+                std::vector<float>& distances) const = 0;
 
     virtual std::vector<float>
     GetAllDistances(const SparseRow<T>& query, float drop_ratio_search, const BitsetView& bitset,
@@ -68,10 +88,40 @@ class BaseInvertedIndex {
     n_cols() const = 0;
 };
 
+// Calls func with the computer unwrapped to its concrete type, so that the
+// scoring loops instantiated for it can inline the per-posting call. A
+// computer not created by GetDocValueComputer() is passed through as is.
+template <typename T, bool bm25, typename Func>
+void
+WithConcreteComputer(const DocValueComputer<T>& computer, Func&& func) {
+    using Concrete = std::conditional_t<bm25, DocValueBM25Computer<T>, DocValueOriginalComputer<T>>;
+    if (auto concrete = computer.template target<Concrete>(); concrete != nullptr) {
+        func(*concrete);
+    } else {
+        func(computer);
+    }
+}
+
+// the drop_ratio_search-th percentile of the absolute values of a non-empty query, smaller values are dropped.
+template <typename T>
+T
+GetQueryThreshold(const SparseRow<T>& query, float drop_ratio_search) {
+    std::vector<T> values(query.size());
+    for (size_t i = 0; i < query.size(); ++i) {
+        values[i] = std::abs(query[i].val);
+    }
+    auto pos = values.begin() + static_cast<size_t>(drop_ratio_search * values.size());
+    std::nth_element(values.begin(), pos, values.end());
+    return *pos;
+}
+
 template <typename T, bool use_wand = false, bool bm25 = false>
 class InvertedIndex : public BaseInvertedIndex<T> {
  public:
-    explicit InvertedIndex() {
+    // the posting lists are built with codec, NONE by default. A loaded index keeps the codec it was saved with,
+    // unless a different one is given.
+    explicit InvertedIndex(std::optional<PostingListCodec> codec = std::nullopt)
+        : codec_(codec.value_or(PostingListCodec::NONE)), codec_given_(codec.has_value()) {
     }
 
     void
@@ -120,30 +170,54 @@ class InvertedIndex : public BaseInvertedIndex<T> {
     Status
     Save(MemoryIOWriter& writer) override {
         /**
-         * zero copy is not yet implemented, now serializing in a zero copy
-         * compatible way while still copying during deserialization.
-         *
          * Layout:
          *
-         * 1. int32_t rows, sign indicates whether to use wand
-         * 2. int32_t cols
-         * 3. for each row:
-         *     1. int32_t len
+         * 1. int64_t kFlatFormatMarker, in place of the row count of the
+         *    legacy layout, which only has the rows below and rebuilds
+         *    everything else during deserialization.
+         * 2. uint32_t kFlatFormatVersion
+         * 3. uint32_t codec, uint8_t use_wand, uint8_t bm25,
+         *    uint8_t drop_during_build
+         * 4. uint64_t rows, uint64_t cols, T value_threshold
+         * 5. float k1, b, avgdl, max_score_ratio, the BM25 params the max
+         *    scores were computed with, zeros if not BM25.
+         * 6. for each row:
+         *     1. size_t len
          *     2. for each non-zero value:
          *        1. table_t idx
          *        2. T val
-         *     With zero copy deserization, each SparseRow object should
-         *     reference(not owning) the memory address of the first element.
+         * 7. if BM25, FlatArray<float> row sums
+         * 8. FlatArray<table_t> dims that have a posting list, in term id
+         *    order, see dim_map_.
+         * 9. FlatArray<uint64_t> offset of the posting list of each term,
+         *    relative to the start of 10.
+         * 10. padding to kSerializedAlignment, then for each term:
+         *     1. PostingList<T>
+         *     2. T max value, and if BM25, float min row sum
+         *     3. if WAND, T max score and FlatArray<float> block max scores
          *
-         * inverted_lut_ and max_score_in_dim_ not serialized, they will be
-         * constructed dynamically during deserialization.
-         *
-         * Data are densly packed in serialized bytes and no padding is added.
+         * All arrays are aligned to kSerializedAlignment bytes from the start
+         * of the serialized index, so that the index can be searched in place
+         * in the serialized memory, e.g. an mmapped file, see Load().
          */
         std::shared_lock<std::shared_mutex> lock(mu_);
-        writeBinaryPOD(writer, n_rows_internal());
-        writeBinaryPOD(writer, n_cols_internal());
+        writeBinaryPOD(writer, kFlatFormatMarker);
+        writeBinaryPOD(writer, kFlatFormatVersion);
+        writeBinaryPOD(writer, static_cast<uint32_t>(codec_));
+        writeBinaryPOD(writer, static_cast<uint8_t>(use_wand));
+        writeBinaryPOD(writer, static_cast<uint8_t>(bm25));
+        writeBinaryPOD(writer, static_cast<uint8_t>(drop_during_build_));
+        writeBinaryPOD(writer, static_cast<uint64_t>(n_rows_internal()));
+        writeBinaryPOD(writer, static_cast<uint64_t>(n_cols_internal()));
         writeBinaryPOD(writer, value_threshold_);
+        float bm25_params[4] = {};
+        if constexpr (bm25) {
+            bm25_params[0] = bm25_params_->k1;
+            bm25_params[1] = bm25_params_->b;
+            bm25_params[2] = bm25_params_->avgdl;
+            bm25_params[3] = bm25_params_->max_score_ratio;
+        }
+        writer.write(bm25_params, sizeof(bm25_params));
         for (size_t i = 0; i < n_rows_internal(); ++i) {
             auto& row = raw_data_[i];
             writeBinaryPOD(writer, row.size());
@@ -152,14 +226,60 @@ class InvertedIndex : public BaseInvertedIndex<T> {
             }
             writer.write(row.data(), row.size() * SparseRow<T>::element_size());
         }
+        if constexpr (bm25) {
+            bm25_params_->row_sums.Save(writer);
+        }
+
+        // posting lists are written to a separate buffer first as their
+        // offsets go before them.
+        MemoryIOWriter postings_writer;
+        FlatArray<uint64_t> offsets;
+        offsets.reserve(term_dims_.size());
+        for (size_t term = 0; term < term_dims_.size(); ++term) {
+            offsets.push_back(postings_writer.tellg());
+            inverted_lut_[term].Save(postings_writer);
+            writeBinaryPOD(postings_writer, max_value_in_dim_[term]);
+            if constexpr (bm25) {
+                writeBinaryPOD(postings_writer, min_row_sum_in_dim_[term]);
+            }
+            if constexpr (use_wand) {
+                writeBinaryPOD(postings_writer, max_score_in_dim_[term]);
+                block_max_scores_[term].Save(postings_writer);
+            }
+            WriteAlignmentPadding(postings_writer);
+        }
+        std::unique_ptr<uint8_t[]> postings(postings_writer.data());
+        term_dims_.Save(writer);
+        offsets.Save(writer);
+        WriteAlignmentPadding(writer);
+        if (postings_writer.tellg() > 0) {
+            writer.write(postings.get(), postings_writer.tellg());
+        }
         return Status::success;
     }
 
+    // The flat layout is used in place without rebuilding the posting lists.
+    // If is_mmap, reader memory must outlive the index, otherwise it is copied
+    // once. The posting lists are rebuilt from the rows if they were saved
+    // with different BM25 params or by an older version of the flat layout,
+    // and for the legacy layout. Loading fails if the codec given to the
+    // constructor differs from the saved one.
     Status
     Load(MemoryIOReader& reader, bool is_mmap) override {
         std::unique_lock<std::shared_mutex> lock(mu_);
         int64_t rows;
         readBinaryPOD(reader, rows);
+        if (rows == kFlatFormatMarker) {
+            if (!is_mmap) {
+                serialized_size_ = reader.total_;
+                serialized_ = std::make_unique<uint8_t[]>(serialized_size_);
+                std::memcpy(serialized_.get(), reader.data(), serialized_size_);
+                MemoryIOReader owned_reader(serialized_.get(), serialized_size_);
+                owned_reader.advance(reader.tellg());
+                return load_flat(owned_reader);
+            }
+            return load_flat(reader);
+        }
         // previous versions used the signness of rows to indicate whether to
         // use wand. now we use a template parameter to control this thus simply
         // take the absolute value of rows.
@@ -168,6 +288,9 @@ class InvertedIndex : public BaseInvertedIndex<T> {
         readBinaryPOD(reader, value_threshold_);
 
         raw_data_.reserve(rows);
+        if constexpr (bm25) {
+            bm25_params_->row_sums.reserve(rows);
+        }
 
         for (int64_t i = 0; i < rows; ++i) {
             size_t count;
@@ -182,8 +305,9 @@ class InvertedIndex : public BaseInvertedIndex<T> {
                 }
                 reader.read(raw_data_[i].data(), count * SparseRow<T>::element_size());
             }
-            add_row_to_index(raw_data_[i], i);
+            RETURN_IF_ERROR(check_row_values(raw_data_[i]));
         }
+        add_rows_to_index(0, rows);
 
         return Status::success;
     }
@@ -223,20 +347,23 @@ class InvertedIndex : public BaseInvertedIndex<T> {
             LOG_KNOWHERE_ERROR_ << "Not allowed to add data to a built index with drop_ratio_build > 0.";
             return Status::invalid_args;
         }
+        for (size_t i = 0; i < rows; ++i) {
+            RETURN_IF_ERROR(check_row_values(data[i]));
+        }
         if ((size_t)dim > max_dim_) {
             max_dim_ = dim;
         }
 
         raw_data_.insert(raw_data_.end(), data, data + rows);
-        for (size_t i = 0; i < rows; ++i) {
-            add_row_to_index(data[i], current_rows + i);
-        }
+        add_rows_to_index(current_rows, current_rows + rows);
         return Status::success;
     }
 
+    // algo selects the query processing algorithm of the WAND index and is ignored otherwise.
     void
     Search(const SparseRow<T>& query, size_t k, float drop_ratio_search, float* distances, label_t* labels,
-           size_t refine_factor, const BitsetView& bitset, const DocValueComputer<T>& computer) const override {
+           size_t refine_factor, const BitsetView& bitset, const DocValueComputer<T>& computer,
+           InvertedIndexAlgo algo) const override {
         // initially set result distances to NaN and labels to -1
         std::fill(distances, distances + k, std::numeric_limits<float>::quiet_NaN());
         std::fill(labels, labels + k, -1);
@@ -244,49 +371,109 @@ class InvertedIndex : public BaseInvertedIndex<T> {
             return;
         }
 
-        std::vector<T> values(query.size());
-        for (size_t i = 0; i < query.size(); ++i) {
-            values[i] = std::abs(query[i].val);
-        }
-        auto pos = values.begin() + static_cast<size_t>(drop_ratio_search * values.size());
-        std::nth_element(values.begin(), pos, values.end());
-        auto q_threshold = *pos;
+        auto q_threshold = GetQueryThreshold(query, drop_ratio_search);
 
         std::shared_lock<std::shared_mutex> lock(mu_);
-        // if no data was dropped during both build and search, no refinement is
-        // needed.
-        if (!drop_during_build_ && drop_ratio_search == 0) {
+        // if no data was dropped during both build and search and the posting
+        // lists store the exact values, no refinement is needed.
+        if (!drop_during_build_ && drop_ratio_search == 0 && codec_ != PostingListCodec::BITPACK_FP16) {
             refine_factor = 1;
         }
         MaxMinHeap<T> heap(k * refine_factor);
-        if constexpr (!use_wand) {
-            search_brute_force(query, q_threshold, heap, bitset, computer);
-        } else {
-            search_wand(query, q_threshold, heap, bitset, computer);
-        }
+        WithConcreteComputer<T, bm25>(computer, [&](const auto& doc_computer) {
+            if constexpr (!use_wand) {
+                search_brute_force(query, q_threshold, heap, bitset, doc_computer);
+            } else if (algo == InvertedIndexAlgo::DAAT_MAXSCORE) {
+                search_maxscore(query, q_threshold, heap, bitset, doc_computer);
+            } else {
+                search_wand(query, q_threshold, heap, bitset, doc_computer,
+                            algo == InvertedIndexAlgo::DAAT_BLOCK_MAX_WAND);
+            }
+
+            if (refine_factor == 1) {
+                collect_result(heap, distances, labels);
+            } else {
+                refine_and_collect(query, heap, k, distances, labels, doc_computer);
+            }
+        });
+    }
 
-        if (refine_factor == 1) {
-            collect_result(heap, distances, labels);
+    // The term at a time index reads each posting list once for the whole batch and scores the queries that share the
+    // term together, the WAND index searches the queries one by one.
+    void
+    SearchBatch(const SparseRow<T>* queries, size_t nq, size_t k, float drop_ratio_search, float* distances,
+                label_t* labels, size_t refine_factor, const BitsetView& bitset, const DocValueComputer<T>& computer,
+                InvertedIndexAlgo algo) const override {
+        if constexpr (use_wand) {
+            for (size_t i = 0; i < nq; ++i) {
+                Search(queries[i], k, drop_ratio_search, distances + i * k, labels + i * k, refine_factor, bitset,
+                       computer, algo);
+            }
         } else {
-            refine_and_collect(query, heap, k, distances, labels, computer);
+            std::fill(distances, distances + nq * k, std::numeric_limits<float>::quiet_NaN());
+            std::fill(labels, labels + nq * k, -1);
+            std::vector<T> q_thresholds(nq);
+            for (size_t i = 0; i < nq; ++i) {
+                q_thresholds[i] = queries[i].size() == 0 ? 0 : GetQueryThreshold(queries[i], drop_ratio_search);
+            }
+
+            std::shared_lock<std::shared_mutex> lock(mu_);
+            if (!drop_during_build_ && drop_ratio_search == 0 && codec_ != PostingListCodec::BITPACK_FP16) {
+                refine_factor = 1;
+            }
+            std::vector<MaxMinHeap<T>> heaps;
+            heaps.reserve(nq);
+            for (size_t i = 0; i < nq; ++i) {
+                heaps.emplace_back(k * refine_factor);
+            }
+            WithConcreteComputer<T, bm25>(computer, [&](const auto& doc_computer) {
+                search_brute_force_batch(queries, nq, q_thresholds.data(), heaps, bitset, doc_computer);
+                for (size_t i = 0; i < nq; ++i) {
+                    if (refine_factor == 1) {
+                        collect_result(heaps[i], distances + i * k, labels + i * k);
+                    } else {
+                        refine_and_collect(queries[i], heaps[i], k, distances + i * k, labels + i * k,
+                                           doc_computer);
+                    }
+                }
+            });
         }
     }
 
+    void
+    RangeSearch(const SparseRow<T>& query, float radius, float range_filter, float drop_ratio_search,
+                const BitsetView& bitset, const DocValueComputer<T>& computer, std::vector<label_t>& ids,
+                std::vector<float>& distances) const override {
+        auto q_threshold = query.size() == 0 ? 0 : GetQueryThreshold(query, drop_ratio_search);
+        std::shared_lock<std::shared_mutex> lock(mu_);
+        WithConcreteComputer<T, bm25>(computer, [&](const auto& doc_computer) {
+            if (radius >= 0) {
+                range_search_taat(query, q_threshold, radius, range_filter, bitset, doc_computer, ids, distances);
+                return;
+            }
+            // docs that share no term with the query score 0, which is in range too.
+            auto scores = compute_all_distances(query, q_threshold, doc_computer);
+            for (size_t i = 0; i < scores.size(); ++i) {
+                if ((bitset.empty() || !bitset.test(i)) && scores[i] > radius && scores[i] <= range_filter) {
+                    ids.push_back(i);
+                    distances.push_back(scores[i]);
+                }
+            }
+        });
+    }
+
     std::vector<float>
     GetAllDistances(const SparseRow<T>& query, float drop_ratio_search, const BitsetView& bitset,
                     const DocValueComputer<T>& computer) const override {
         if (query.size() == 0) {
             return {};
         }
-        std::vector<T> values(query.size());
-        for (size_t i = 0; i < query.size(); ++i) {
-            values[i] = std::abs(query[i].val);
-        }
-        auto pos = values.begin() + static_cast<size_t>(drop_ratio_search * values.size());
-        std::nth_element(values.begin(), pos, values.end());
-        auto q_threshold = *pos;
+        auto q_threshold = GetQueryThreshold(query, drop_ratio_search);
         std::shared_lock<std::shared_mutex> lock(mu_);
-        auto distances = compute_all_distances(query, q_threshold, computer);
+        std::vector<float> distances;
+        WithConcreteComputer<T, bm25>(computer, [&](const auto& doc_computer) {
+            distances = compute_all_distances(query, q_threshold, doc_computer);
+        });
         for (size_t i = 0; i < distances.size(); ++i) {
             if (bitset.empty() || !bitset.test(i)) {
                 continue;
@@ -311,13 +498,23 @@ class InvertedIndex : public BaseInvertedIndex<T> {
             res += row.memory_usage();
         }
 
-        res += (sizeof(table_t) + sizeof(std::vector<SparseIdVal<T>>)) * inverted_lut_.size();
-        for (const auto& [idx, lut] : inverted_lut_) {
-            res += sizeof(SparseIdVal<T>) * lut.capacity();
+        res += (sizeof(table_t) + sizeof(uint32_t)) * dim_map_.size() + term_dims_.memory_usage();
+        res += sizeof(PostingList<T>) * inverted_lut_.capacity();
+        res += sizeof(T) * max_value_in_dim_.capacity() + sizeof(float) * min_row_sum_in_dim_.capacity();
+        for (const auto& lut : inverted_lut_) {
+            res += lut.memory_usage();
         }
         if constexpr (use_wand) {
-            res += (sizeof(table_t) + sizeof(T)) * max_score_in_dim_.size();
+            res += sizeof(T) * max_score_in_dim_.capacity();
+            res += sizeof(FlatArray<float>) * block_max_scores_.capacity();
+            for (const auto& block_max : block_max_scores_) {
+                res += block_max.memory_usage();
+            }
         }
+        if constexpr (bm25) {
+            res += bm25_params_->row_sums.memory_usage();
+        }
+        res += serialized_size_;
         return res;
     }
 
@@ -344,83 +541,421 @@ class InvertedIndex : public BaseInvertedIndex<T> {
         return max_dim_;
     }
 
-    std::vector<float>
-    compute_all_distances(const SparseRow<T>& q_vec, T q_threshold, const DocValueComputer<T>& computer) const {
-        std::vector<float> scores(n_rows_internal(), 0.0f);
+    // computed doc value of the posting (doc_id, val).
+    template <typename Computer>
+    inline float
+    doc_value(const Computer& computer, table_t doc_id, T val) const {
+        if constexpr (bm25) {
+            return computer(val, bm25_params_->row_sums[doc_id]);
+        } else {
+            return computer(val, 0);
+        }
+    }
+
+    // calls add(id, score) for each posting of the terms of q_vec, any value in q_vec that is smaller than
+    // q_threshold and any value with dimension >= n_cols() will be ignored.
+    template <typename Computer, typename Add>
+    void
+    accumulate_scores(const SparseRow<T>& q_vec, T q_threshold, const Computer& computer, Add add) const {
         for (size_t idx = 0; idx < q_vec.size(); ++idx) {
             auto [i, v] = q_vec[idx];
             if (v < q_threshold || i >= n_cols_internal()) {
                 continue;
             }
-            auto lut_it = inverted_lut_.find(i);
-            if (lut_it == inverted_lut_.end()) {
+            auto dim_it = dim_map_.find(i);
+            if (dim_it == dim_map_.end()) {
                 continue;
             }
             // TODO: improve with SIMD
-            auto& lut = lut_it->second;
-            for (size_t j = 0; j < lut.size(); j++) {
-                auto [idx, val] = lut[j];
-                T val_sum = bm25 ? bm25_params_->row_sums.at(idx) : 0;
-                scores[idx] += v * computer(val, val_sum);
+            auto& lut = inverted_lut_[dim_it->second];
+            PostingBlock<T> buf;
+            for (size_t b = 0; b < lut.num_blocks(); ++b) {
+                const table_t* ids;
+                const T* vals;
+                auto n = lut.block(b, buf, ids, vals);
+                for (size_t j = 0; j < n; ++j) {
+                    add(ids[j], v * doc_value(computer, ids[j], vals[j]));
+                }
             }
         }
+    }
+
+    template <typename Computer>
+    std::vector<float>
+    compute_all_distances(const SparseRow<T>& q_vec, T q_threshold, const Computer& computer) const {
+        std::vector<float> scores(n_rows_internal(), 0.0f);
+        accumulate_scores(q_vec, q_threshold, computer, [&](table_t id, float score) { scores[id] += score; });
         return scores;
     }
 
     // find the top-k candidates using brute force search, k as specified by the capacity of the heap.
     // any value in q_vec that is smaller than q_threshold and any value with dimension >= n_cols() will be ignored.
+    // Scores are accumulated in the reusable accumulator of the calling thread, and only the docs that have a posting
+    // of the query terms are visited.
     // TODO: may switch to row-wise brute force if filter rate is high. Benchmark needed.
+    template <typename Computer>
     void
     search_brute_force(const SparseRow<T>& q_vec, T q_threshold, MaxMinHeap<T>& heap, const BitsetView& bitset,
-                       const DocValueComputer<T>& computer) const {
-        auto scores = compute_all_distances(q_vec, q_threshold, computer);
-        for (size_t i = 0; i < n_rows_internal(); ++i) {
-            if ((bitset.empty() || !bitset.test(i)) && scores[i] != 0) {
-                heap.push(i, scores[i]);
+                       const Computer& computer) const {
+        auto& scores = ScoreAccumulator<float>::Acquire(n_rows_internal());
+        accumulate_scores(q_vec, q_threshold, computer, [&](table_t id, float score) { scores.add(id, score); });
+        scores.for_each([&](table_t id, float score) {
+            if ((bitset.empty() || !bitset.test(id)) && score != 0) {
+                heap.push(id, score);
+            }
+        });
+    }
+
+    // batched search_brute_force(), heaps[i] gets the candidates of queries[i]. Each posting list is streamed once for
+    // all queries that have the term, scattering into per query accumulators. Docs are processed in tiles small enough
+    // for the accumulators of the whole batch to stay in L2, and only the docs of a tile that have a posting are reset
+    // and collected. Falls back to searching the queries one by one if they share few postings.
+    template <typename Computer>
+    void
+    search_brute_force_batch(const SparseRow<T>* queries, size_t nq, const T* q_thresholds,
+                             std::vector<MaxMinHeap<T>>& heaps, const BitsetView& bitset,
+                             const Computer& computer) const {
+        // (term, query, query value) of every query term, grouped by term.
+        struct TermQuery {
+            uint32_t term;
+            uint32_t query;
+            T val;
+        };
+        std::vector<TermQuery> term_queries;
+        for (size_t q = 0; q < nq; ++q) {
+            for (size_t j = 0; j < queries[q].size(); ++j) {
+                auto [i, v] = queries[q][j];
+                if (v < q_thresholds[q] || i >= n_cols_internal()) {
+                    continue;
+                }
+                auto dim_it = dim_map_.find(i);
+                if (dim_it == dim_map_.end()) {
+                    continue;
+                }
+                term_queries.push_back({dim_it->second, static_cast<uint32_t>(q), v});
+            }
+        }
+        std::sort(term_queries.begin(), term_queries.end(),
+                  [](const TermQuery& a, const TermQuery& b) { return a.term < b.term; });
+        // term_queries[group_begin[g], group_begin[g + 1]) share a term.
+        std::vector<size_t> group_begin;
+        for (size_t j = 0; j < term_queries.size(); ++j) {
+            if (j == 0 || term_queries[j].term != term_queries[j - 1].term) {
+                group_begin.push_back(j);
+            }
+        }
+        auto num_groups = group_begin.size();
+        group_begin.push_back(term_queries.size());
+
+        // postings read by the batch vs by the queries one by one, a posting list of a term is read once per query
+        // that has it if searched one by one.
+        size_t batch_postings = 0;
+        size_t query_postings = 0;
+        for (size_t g = 0; g < num_groups; ++g) {
+            auto len = inverted_lut_[term_queries[group_begin[g]].term].size();
+            batch_postings += len;
+            query_postings += len * (group_begin[g + 1] - group_begin[g]);
+        }
+        if (batch_postings * kMinBatchPostingSharing > query_postings) {
+            for (size_t q = 0; q < nq; ++q) {
+                search_brute_force(queries[q], q_thresholds[q], heaps[q], bitset, computer);
+            }
+            return;
+        }
+
+        auto rows = n_rows_internal();
+        size_t tile_rows = std::max(kPostingBlockSize, kBatchAccumulatorBytes / (sizeof(float) * nq));
+        tile_rows = std::min(tile_rows, rows);
+        // scores[i * nq + q] accumulates the score of doc tile_begin + i for query q, so that the queries sharing a
+        // term update adjacent entries for each posting.
+        std::vector<float> scores(nq * tile_rows);
+        // docs of the tile that have a posting, by offset in the tile.
+        std::vector<uint8_t> is_touched(tile_rows, 0);
+        std::vector<uint32_t> touched;
+        // position of each group in its posting list, as tiles are processed in ascending doc order.
+        std::vector<size_t> next_block(num_groups, 0);
+        std::vector<size_t> next_pos(num_groups, 0);
+        PostingBlock<T> buf;
+        for (size_t tile_begin = 0; tile_begin < rows; tile_begin += tile_rows) {
+            auto tile_end = std::min(tile_begin + tile_rows, rows);
+            for (size_t g = 0; g < num_groups; ++g) {
+                auto& lut = inverted_lut_[term_queries[group_begin[g]].term];
+                auto group = term_queries.data() + group_begin[g];
+                auto group_size = group_begin[g + 1] - group_begin[g];
+                auto& b = next_block[g];
+                auto& pos = next_pos[g];
+                while (b < lut.num_blocks()) {
+                    const table_t* ids;
+                    const T* vals;
+                    auto n = lut.block(b, buf, ids, vals);
+                    for (; pos < n && ids[pos] < tile_end; ++pos) {
+                        auto val = doc_value(computer, ids[pos], vals[pos]);
+                        auto offset = ids[pos] - tile_begin;
+                        if (!is_touched[offset]) {
+                            is_touched[offset] = 1;
+                            touched.push_back(offset);
+                        }
+                        auto acc = scores.data() + offset * nq;
+                        for (size_t j = 0; j < group_size; ++j) {
+                            acc[group[j].query] += group[j].val * val;
+                        }
+                    }
+                    if (pos < n) {
+                        break;
+                    }
+                    ++b;
+                    pos = 0;
+                }
+            }
+            // in doc order, so that ties are kept as a scan of the tile would.
+            std::sort(touched.begin(), touched.end());
+            for (auto offset : touched) {
+                is_touched[offset] = 0;
+                auto doc_scores = scores.data() + offset * nq;
+                auto i = tile_begin + offset;
+                if (bitset.empty() || !bitset.test(i)) {
+                    for (size_t q = 0; q < nq; ++q) {
+                        if (doc_scores[q] != 0) {
+                            heaps[q].push(i, doc_scores[q]);
+                        }
+                    }
+                }
+                std::fill(doc_scores, doc_scores + nq, 0.0f);
+            }
+            touched.clear();
+        }
+    }
+
+    // upper bound of the contribution of term to the score of a query whose value of the term is q_val, infinity if
+    // the computer is not known to be bounded by the max value of the term. Never negative, as the docs without a
+    // posting of the term get 0 from it.
+    template <typename Computer>
+    float
+    max_contribution(uint32_t term, T q_val, const Computer& computer) const {
+        if (q_val < 0) {
+            return std::numeric_limits<float>::infinity();
+        }
+        if constexpr (std::is_same_v<Computer, DocValueOriginalComputer<T>>) {
+            return std::max(0.0f, static_cast<float>(q_val * max_value_in_dim_[term]));
+        } else if constexpr (std::is_same_v<Computer, DocValueBM25Computer<T>>) {
+            // BM25 doc values increase with the term frequency and decrease with the doc length.
+            return std::max(0.0f,
+                            static_cast<float>(q_val * computer(max_value_in_dim_[term], min_row_sum_in_dim_[term])));
+        } else {
+            return std::numeric_limits<float>::infinity();
+        }
+    }
+
+    // Term at a time range search, radius must be non-negative so that docs without a score are out of range. Query
+    // terms are visited in descending order of their max contributions. Once the max contributions of the remaining
+    // terms add up to no more than radius, no doc without a score yet can get past radius, so the remaining terms
+    // only add to the candidates that still can, and only the posting list blocks that contain candidates are read.
+    template <typename Computer>
+    void
+    range_search_taat(const SparseRow<T>& q_vec, T q_threshold, float radius, float range_filter,
+                      const BitsetView& bitset, const Computer& computer, std::vector<label_t>& ids,
+                      std::vector<float>& distances) const {
+        struct QueryTerm {
+            uint32_t term;
+            T val;
+            float max_contribution;
+        };
+        std::vector<QueryTerm> terms;
+        for (size_t idx = 0; idx < q_vec.size(); ++idx) {
+            auto [i, v] = q_vec[idx];
+            if (v < q_threshold || i >= n_cols_internal()) {
+                continue;
+            }
+            auto dim_it = dim_map_.find(i);
+            if (dim_it == dim_map_.end()) {
+                continue;
+            }
+            terms.push_back({dim_it->second, v, max_contribution(dim_it->second, v, computer)});
+        }
+        std::sort(terms.begin(), terms.end(),
+                  [](const QueryTerm& a, const QueryTerm& b) { return a.max_contribution > b.max_contribution; });
+        // remaining[i] is the sum of the max contributions of terms[i, terms.size()).
+        std::vector<float> remaining(terms.size() + 1, 0.0f);
+        for (size_t i = terms.size(); i-- > 0;) {
+            remaining[i] = remaining[i + 1] + terms[i].max_contribution;
+        }
+
+        // terms[0, num_essential) are read in full, the others only for candidates.
+        size_t num_essential = 0;
+        size_t essential_postings = 0;
+        for (; num_essential < terms.size() && remaining[num_essential] > radius; ++num_essential) {
+            essential_postings += inverted_lut_[terms[num_essential].term].size();
+        }
+        PostingBlock<T> buf;
+        auto for_each_posting = [&](const QueryTerm& term, auto func) {
+            auto& lut = inverted_lut_[term.term];
+            for (size_t b = 0; b < lut.num_blocks(); ++b) {
+                const table_t* block_ids;
+                const T* vals;
+                auto n = lut.block(b, buf, block_ids, vals);
+                for (size_t j = 0; j < n; ++j) {
+                    func(block_ids[j], term.val * doc_value(computer, block_ids[j], vals[j]));
+                }
+            }
+        };
+        // candidates in ascending id order. A doc without a score can't be a candidate, as remaining[num_essential]
+        // is no more than radius. The scores are final if all terms are essential.
+        std::vector<table_t> candidates;
+        std::vector<float> candidate_scores;
+        auto add_candidate = [&](table_t id, float score) {
+            if (score + remaining[num_essential] <= radius || (!bitset.empty() && bitset.test(id))) {
+                return;
+            }
+            if (num_essential < terms.size()) {
+                candidates.push_back(id);
+                candidate_scores.push_back(score);
+            } else if (score <= range_filter) {
+                ids.push_back(id);
+                distances.push_back(score);
+            }
+        };
+        size_t t = num_essential;
+        if (essential_postings * kDenseRangeSearchRatio >= n_rows_internal()) {
+            // tracking the scored docs costs more than a scan of all docs if many are scored.
+            thread_local std::vector<float> dense_scores;
+            dense_scores.assign(n_rows_internal(), 0.0f);
+            for (size_t i = 0; i < num_essential; ++i) {
+                for_each_posting(terms[i], [&](table_t id, float score) { dense_scores[id] += score; });
+            }
+            for (size_t i = 0; i < dense_scores.size(); ++i) {
+                add_candidate(i, dense_scores[i]);
+            }
+            if (candidates.size() * kDenseRangeSearchRatio >= n_rows_internal()) {
+                // few blocks can be skipped with this many candidates, so the other terms are read in full too.
+                for (; t < terms.size(); ++t) {
+                    for_each_posting(terms[t], [&](table_t id, float score) { dense_scores[id] += score; });
+                }
+                for (size_t i = 0; i < candidates.size(); ++i) {
+                    candidate_scores[i] = dense_scores[candidates[i]];
+                }
+            }
+        } else {
+            auto& scores = ScoreAccumulator<float>::Acquire(n_rows_internal());
+            for (size_t i = 0; i < num_essential; ++i) {
+                for_each_posting(terms[i], [&](table_t id, float score) { scores.add(id, score); });
+            }
+            scores.for_each(add_candidate);
+        }
+        for (; t < terms.size() && !candidates.empty(); ++t) {
+            auto& lut = inverted_lut_[terms[t].term];
+            size_t c = 0;
+            for (size_t b = 0; b < lut.num_blocks() && c < candidates.size(); ++b) {
+                if (lut.block_last_id(b) < candidates[c]) {
+                    continue;
+                }
+                const table_t* block_ids;
+                const T* vals;
+                auto n = lut.block(b, buf, block_ids, vals);
+                for (size_t j = 0; j < n && c < candidates.size(); ++j) {
+                    while (c < candidates.size() && candidates[c] < block_ids[j]) {
+                        ++c;
+                    }
+                    if (c < candidates.size() && candidates[c] == block_ids[j]) {
+                        candidate_scores[c] += terms[t].val * doc_value(computer, block_ids[j], vals[j]);
+                        ++c;
+                    }
+                }
+            }
+            // drop the candidates that can no longer get past radius.
+            size_t kept = 0;
+            for (size_t i = 0; i < candidates.size(); ++i) {
+                if (candidate_scores[i] + remaining[t + 1] > radius) {
+                    candidates[kept] = candidates[i];
+                    candidate_scores[kept] = candidate_scores[i];
+                    ++kept;
+                }
+            }
+            candidates.resize(kept);
+            candidate_scores.resize(kept);
+        }
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (candidate_scores[i] > radius && candidate_scores[i] <= range_filter) {
+                ids.push_back(candidates[i]);
+                distances.push_back(candidate_scores[i]);
             }
         }
     }
 
-    // LUT supports size() and operator[] which returns an SparseIdVal.
-    template <typename LUT>
+    // Cursor over the posting list of one query term, skipping docs filtered out by the bitset. Postings are read one
+    // block at a time, compressed blocks are decoded into buf. Block max scores are used by Block-Max WAND. Cursors are
+    // plain values so they can be kept and reordered in a flat vector.
     class Cursor {
      public:
-        Cursor(const LUT& lut, size_t num_vec, float max_score, float q_value, const BitsetView bitset)
-            : lut_(lut), num_vec_(num_vec), max_score_(max_score), q_value_(q_value), bitset_(bitset) {
-            while (loc_ < lut_.size() && !bitset_.empty() && bitset_.test(cur_vec_id())) {
-                loc_++;
-            }
+        Cursor(const PostingList<T>& lut, const FlatArray<float>& block_max_scores, PostingBlock<T>* buf,
+               size_t num_vec, float max_score, float q_value, const BitsetView& bitset)
+            : lut_(&lut),
+              num_blocks_(lut.num_blocks()),
+              block_max_scores_(block_max_scores.data()),
+              buf_(buf),
+              num_vec_(num_vec),
+              max_score_(max_score),
+              q_value_(q_value),
+              bitset_(bitset) {
+            load_block(0);
+            skip_filtered();
         }
-        Cursor(const Cursor& rhs) = delete;
 
         void
         next() {
-            loc_++;
-            while (loc_ < lut_.size() && !bitset_.empty() && bitset_.test(cur_vec_id())) {
-                loc_++;
-            }
+            advance();
+            skip_filtered();
         }
         // advance loc until cur_vec_id() >= vec_id
         void
         seek(table_t vec_id) {
-            while (loc_ < lut_.size() && cur_vec_id() < vec_id) {
-                next();
+            if (cur_vec_id() >= vec_id) {
+                return;
+            }
+            // skip whole blocks whose last posting is still before vec_id.
+            auto block = block_;
+            while (block < num_blocks_ && lut_->block_last_id(block) < vec_id) {
+                block++;
+            }
+            if (block != block_) {
+                load_block(block);
+            }
+            if (!is_end()) {
+                pos_ = std::lower_bound(ids_ + pos_, ids_ + block_size_, vec_id) - ids_;
+            }
+            skip_filtered();
+        }
+        // move the block pointer to the block that may contain vec_id without moving the cursor.
+        void
+        shallow_seek(table_t vec_id) {
+            shallow_block_ = std::max(shallow_block_, block_);
+            while (shallow_block_ < num_blocks_ && lut_->block_last_id(shallow_block_) < vec_id) {
+                shallow_block_++;
             }
         }
+        // max score of the current block, valid after shallow_seek().
+        [[nodiscard]] float
+        block_max_score() const {
+            return shallow_block_ < num_blocks_ ? block_max_scores_[shallow_block_] * q_value_ : 0.0f;
+        }
+        // last doc id of the current block, valid after shallow_seek().
+        [[nodiscard]] table_t
+        block_last_vec_id() const {
+            return shallow_block_ < num_blocks_ ? lut_->block_last_id(shallow_block_) : num_vec_;
+        }
         [[nodiscard]] table_t
         cur_vec_id() const {
             if (is_end()) {
                 return num_vec_;
             }
-            return lut_[loc_].id;
+            return ids_[pos_];
         }
         T
         cur_vec_val() const {
-            return lut_[loc_].val;
+            return vals_[pos_];
         }
         [[nodiscard]] bool
         is_end() const {
-            return loc_ >= size();
+            return block_ >= num_blocks_;
         }
         [[nodiscard]] float
         q_value() const {
@@ -428,7 +963,7 @@ class InvertedIndex : public BaseInvertedIndex<T> {
         }
         [[nodiscard]] size_t
         size() const {
-            return lut_.size();
+            return lut_->size();
         }
         [[nodiscard]] float
         max_score() const {
@@ -436,53 +971,102 @@ class InvertedIndex : public BaseInvertedIndex<T> {
         }
 
      private:
-        const LUT& lut_;
-        size_t loc_ = 0;
+        void
+        load_block(size_t block) {
+            block_ = block;
+            pos_ = 0;
+            block_size_ = block < num_blocks_ ? lut_->block(block, *buf_, ids_, vals_) : 0;
+        }
+
+        void
+        advance() {
+            if (++pos_ == block_size_) {
+                load_block(block_ + 1);
+            }
+        }
+
+        void
+        skip_filtered() {
+            while (!is_end() && !bitset_.empty() && bitset_.test(ids_[pos_])) {
+                advance();
+            }
+        }
+
+        const PostingList<T>* lut_;
+        size_t num_blocks_ = 0;
+        const float* block_max_scores_;
+        PostingBlock<T>* buf_;
+        // the current block, the position in it and the postings of it.
+        size_t block_ = 0;
+        size_t pos_ = 0;
+        size_t block_size_ = 0;
+        const table_t* ids_ = nullptr;
+        const T* vals_ = nullptr;
+        size_t shallow_block_ = 0;
         size_t num_vec_ = 0;
         float max_score_ = 0.0f;
         float q_value_ = 0.0f;
-        const BitsetView bitset_;
+        BitsetView bitset_;
     };  // class Cursor
 
-    // any value in q_vec that is smaller than q_threshold will be ignored.
-    void
-    search_wand(const SparseRow<T>& q_vec, T q_threshold, MaxMinHeap<T>& heap, const BitsetView& bitset,
-                const DocValueComputer<T>& computer) const {
-        auto q_dim = q_vec.size();
-        std::vector<std::shared_ptr<Cursor<std::vector<SparseIdVal<T>>>>> cursors(q_dim);
-        auto valid_q_dim = 0;
-        for (size_t i = 0; i < q_dim; ++i) {
+    // one cursor for each query term that has a posting list, any value in q_vec that is smaller than q_threshold
+    // will be ignored. buffers provides the decoding space of the cursors and must outlive them.
+    std::vector<Cursor>
+    make_cursors(const SparseRow<T>& q_vec, T q_threshold, const BitsetView& bitset,
+                 std::vector<PostingBlock<T>>& buffers) const {
+        std::vector<Cursor> cursors;
+        cursors.reserve(q_vec.size());
+        buffers.resize(q_vec.size());
+        for (size_t i = 0; i < q_vec.size(); ++i) {
             auto [idx, val] = q_vec[i];
             if (std::abs(val) < q_threshold || idx >= n_cols_internal()) {
                 continue;
             }
-            auto lut_it = inverted_lut_.find(idx);
-            if (lut_it == inverted_lut_.end()) {
+            auto dim_it = dim_map_.find(idx);
+            if (dim_it == dim_map_.end()) {
                 continue;
             }
-            auto& lut = lut_it->second;
-            cursors[valid_q_dim++] = std::make_shared<Cursor<std::vector<SparseIdVal<T>>>>(
-                lut, n_rows_internal(), max_score_in_dim_.find(idx)->second * val, val, bitset);
+            auto term = dim_it->second;
+            cursors.emplace_back(inverted_lut_[term], block_max_scores_[term], &buffers[cursors.size()],
+                                 n_rows_internal(), max_score_in_dim_[term] * val, val, bitset);
+        }
+        return cursors;
+    }
+
+    // restore the ascending cur_vec_id() order of cursors after the first n of them have been advanced, the rest
+    // must still be sorted. Cheaper than a full sort as usually only a few cursors move and not far.
+    static void
+    reorder_cursors(std::vector<Cursor>& cursors, size_t n) {
+        for (size_t i = n; i-- > 0;) {
+            for (size_t j = i; j + 1 < cursors.size() && cursors[j].cur_vec_id() > cursors[j + 1].cur_vec_id(); ++j) {
+                std::swap(cursors[j], cursors[j + 1]);
+            }
         }
-        if (valid_q_dim == 0) {
+    }
+
+    // WAND, or Block-Max WAND if block_max is true, which additionally checks the block max scores of the candidate
+    // and skips the whole block range when the candidate can't make it into the heap.
+    template <typename Computer>
+    void
+    search_wand(const SparseRow<T>& q_vec, T q_threshold, MaxMinHeap<T>& heap, const BitsetView& bitset,
+                const Computer& computer, bool block_max) const {
+        std::vector<PostingBlock<T>> buffers;
+        auto cursors = make_cursors(q_vec, q_threshold, bitset, buffers);
+        if (cursors.empty()) {
             return;
         }
-        cursors.resize(valid_q_dim);
-        auto sort_cursors = [&cursors] {
-            std::sort(cursors.begin(), cursors.end(),
-                      [](auto& x, auto& y) { return x->cur_vec_id() < y->cur_vec_id(); });
-        };
-        sort_cursors();
+        std::sort(cursors.begin(), cursors.end(),
+                  [](const auto& x, const auto& y) { return x.cur_vec_id() < y.cur_vec_id(); });
         auto score_above_threshold = [&heap](float x) { return !heap.full() || x > heap.top().val; };
         while (true) {
             float upper_bound = 0;
             size_t pivot;
             bool found_pivot = false;
             for (pivot = 0; pivot < cursors.size(); ++pivot) {
-                if (cursors[pivot]->is_end()) {
+                if (cursors[pivot].is_end()) {
                     break;
                 }
-                upper_bound += cursors[pivot]->max_score();
+                upper_bound += cursors[pivot].max_score();
                 if (score_above_threshold(upper_bound)) {
                     found_pivot = true;
                     break;
@@ -491,44 +1075,123 @@ class InvertedIndex : public BaseInvertedIndex<T> {
             if (!found_pivot) {
                 break;
             }
-            table_t pivot_id = cursors[pivot]->cur_vec_id();
-            if (pivot_id == cursors[0]->cur_vec_id()) {
-                float score = 0;
-                for (auto& cursor : cursors) {
-                    if (cursor->cur_vec_id() != pivot_id) {
-                        break;
+            table_t pivot_id = cursors[pivot].cur_vec_id();
+            // all cursors at pivot_id contribute to its score.
+            while (pivot + 1 < cursors.size() && cursors[pivot + 1].cur_vec_id() == pivot_id) {
+                ++pivot;
+            }
+            if (block_max) {
+                float block_upper_bound = 0;
+                for (size_t i = 0; i <= pivot; ++i) {
+                    cursors[i].shallow_seek(pivot_id);
+                    block_upper_bound += cursors[i].block_max_score();
+                }
+                if (!score_above_threshold(block_upper_bound)) {
+                    // no doc before the end of the shortest current block, or before the next cursor after the
+                    // pivot, can score above the threshold.
+                    table_t next_id = pivot + 1 < cursors.size() ? cursors[pivot + 1].cur_vec_id() : n_rows_internal();
+                    for (size_t i = 0; i <= pivot; ++i) {
+                        next_id = std::min<table_t>(next_id, cursors[i].block_last_vec_id() + 1);
+                    }
+                    for (size_t i = 0; i <= pivot; ++i) {
+                        cursors[i].seek(next_id);
                     }
-                    T cur_vec_sum = bm25 ? bm25_params_->row_sums.at(cursor->cur_vec_id()) : 0;
-                    score += cursor->q_value() * computer(cursor->cur_vec_val(), cur_vec_sum);
-                    cursor->next();
+                    reorder_cursors(cursors, pivot + 1);
+                    continue;
+                }
+            }
+            if (pivot_id == cursors[0].cur_vec_id()) {
+                float score = 0;
+                for (size_t i = 0; i <= pivot; ++i) {
+                    score += cursors[i].q_value() * doc_value(computer, pivot_id, cursors[i].cur_vec_val());
+                    cursors[i].next();
                 }
                 heap.push(pivot_id, score);
-                sort_cursors();
+                reorder_cursors(cursors, pivot + 1);
             } else {
                 size_t next_list = pivot;
-                for (; cursors[next_list]->cur_vec_id() == pivot_id; --next_list) {
+                for (; cursors[next_list].cur_vec_id() == pivot_id; --next_list) {
                 }
-                cursors[next_list]->seek(pivot_id);
-                for (size_t i = next_list + 1; i < cursors.size(); ++i) {
-                    if (cursors[i]->cur_vec_id() >= cursors[i - 1]->cur_vec_id()) {
-                        break;
-                    }
-                    std::swap(cursors[i], cursors[i - 1]);
+                cursors[next_list].seek(pivot_id);
+                reorder_cursors(cursors, next_list + 1);
+            }
+        }
+    }
+
+    // MaxScore: cursors are ordered by max score and split into non-essential ones, whose max scores sum to no more
+    // than the threshold, and essential ones. Only docs in the essential posting lists are candidates, and the
+    // non-essential lists are probed only while the candidate can still make it into the heap.
+    template <typename Computer>
+    void
+    search_maxscore(const SparseRow<T>& q_vec, T q_threshold, MaxMinHeap<T>& heap, const BitsetView& bitset,
+                    const Computer& computer) const {
+        std::vector<PostingBlock<T>> buffers;
+        auto cursors = make_cursors(q_vec, q_threshold, bitset, buffers);
+        if (cursors.empty()) {
+            return;
+        }
+        std::sort(cursors.begin(), cursors.end(),
+                  [](const auto& x, const auto& y) { return x.max_score() < y.max_score(); });
+        // upper_bounds[i] is the sum of max scores of cursors[0..i].
+        std::vector<float> upper_bounds(cursors.size());
+        float upper_bound = 0;
+        for (size_t i = 0; i < cursors.size(); ++i) {
+            upper_bound += cursors[i].max_score();
+            upper_bounds[i] = upper_bound;
+        }
+        auto score_above_threshold = [&heap](float x) { return !heap.full() || x > heap.top().val; };
+        // cursors[0, first_essential) are non-essential.
+        size_t first_essential = 0;
+        while (first_essential < cursors.size()) {
+            table_t candidate = n_rows_internal();
+            for (size_t i = first_essential; i < cursors.size(); ++i) {
+                candidate = std::min(candidate, cursors[i].cur_vec_id());
+            }
+            if (candidate >= n_rows_internal()) {
+                break;
+            }
+            float score = 0;
+            for (size_t i = first_essential; i < cursors.size(); ++i) {
+                if (cursors[i].cur_vec_id() == candidate) {
+                    score += cursors[i].q_value() * doc_value(computer, candidate, cursors[i].cur_vec_val());
+                    cursors[i].next();
+                }
+            }
+            bool pruned = false;
+            for (size_t i = first_essential; i-- > 0;) {
+                if (!score_above_threshold(score + upper_bounds[i])) {
+                    pruned = true;
+                    break;
+                }
+                cursors[i].seek(candidate);
+                if (cursors[i].cur_vec_id() == candidate) {
+                    score += cursors[i].q_value() * doc_value(computer, candidate, cursors[i].cur_vec_val());
                 }
             }
+            if (pruned) {
+                continue;
+            }
+            heap.push(candidate, score);
+            while (first_essential < cursors.size() && !score_above_threshold(upper_bounds[first_essential])) {
+                ++first_essential;
+            }
         }
     }
 
+    template <typename Computer>
     void
     refine_and_collect(const SparseRow<T>& q_vec, MaxMinHeap<T>& inaccurate, size_t k, float* distances,
-                       label_t* labels, const DocValueComputer<T>& computer) const {
+                       label_t* labels, const Computer& computer) const {
         std::priority_queue<SparseIdVal<T>, std::vector<SparseIdVal<T>>, std::greater<SparseIdVal<T>>> heap;
 
         while (!inaccurate.empty()) {
             auto [u, d] = inaccurate.top();
             inaccurate.pop();
 
-            T u_sum = bm25 ? bm25_params_->row_sums.at(u) : 0;
+            float u_sum = 0;
+            if constexpr (bm25) {
+                u_sum = bm25_params_->row_sums[u];
+            }
 
             auto dist_acc = q_vec.dot(raw_data_[u], computer, u_sum);
             if (heap.size() < k) {
@@ -541,6 +1204,125 @@ class InvertedIndex : public BaseInvertedIndex<T> {
         collect_result(heap, distances, labels);
     }
 
+    // loads the flat layout written by Save() after kFlatFormatMarker, reader memory must outlive the index.
+    Status
+    load_flat(MemoryIOReader& reader) {
+        uint32_t version;
+        uint32_t codec;
+        uint8_t saved_use_wand;
+        uint8_t saved_bm25;
+        uint8_t drop_during_build;
+        uint64_t rows;
+        uint64_t cols;
+        float saved_bm25_params[4];
+        readBinaryPOD(reader, version);
+        if (version == 0 || version > kFlatFormatVersion) {
+            LOG_KNOWHERE_ERROR_ << "Unsupported sparse inverted index format version " << version;
+            return Status::invalid_binary_set;
+        }
+        readBinaryPOD(reader, codec);
+        if (codec > static_cast<uint32_t>(PostingListCodec::BITPACK_FP16)) {
+            LOG_KNOWHERE_ERROR_ << "Unknown sparse inverted index posting list codec " << codec;
+            return Status::invalid_binary_set;
+        }
+        if (codec != static_cast<uint32_t>(codec_)) {
+            if (codec_given_) {
+                LOG_KNOWHERE_ERROR_ << "Sparse inverted index saved with posting list codec " << codec
+                                    << ", loaded with codec " << static_cast<uint32_t>(codec_);
+                return Status::invalid_args;
+            }
+            codec_ = static_cast<PostingListCodec>(codec);
+        }
+        readBinaryPOD(reader, saved_use_wand);
+        readBinaryPOD(reader, saved_bm25);
+        readBinaryPOD(reader, drop_during_build);
+        readBinaryPOD(reader, rows);
+        readBinaryPOD(reader, cols);
+        readBinaryPOD(reader, value_threshold_);
+        reader.read(saved_bm25_params, sizeof(saved_bm25_params));
+        max_dim_ = cols;
+        drop_during_build_ = drop_during_build;
+
+        raw_data_.reserve(rows);
+        for (uint64_t i = 0; i < rows; ++i) {
+            size_t count;
+            readBinaryPOD(reader, count);
+            raw_data_.emplace_back(count, reader.data() + reader.tellg(), false);
+            reader.advance(count * SparseRow<T>::element_size());
+        }
+
+        // the rows are laid out the same by all versions.
+        bool reusable = version == kFlatFormatVersion && saved_use_wand == use_wand && saved_bm25 == bm25;
+        if constexpr (bm25) {
+            reusable = reusable && saved_bm25_params[0] == bm25_params_->k1 &&
+                       saved_bm25_params[1] == bm25_params_->b && saved_bm25_params[2] == bm25_params_->avgdl &&
+                       saved_bm25_params[3] == bm25_params_->max_score_ratio;
+        }
+        if (!reusable) {
+            LOG_KNOWHERE_INFO_ << "Sparse inverted index saved with different format or BM25 params, rebuilding";
+            if constexpr (bm25) {
+                bm25_params_->row_sums.reserve(rows);
+            }
+            for (uint64_t i = 0; i < rows; ++i) {
+                RETURN_IF_ERROR(check_row_values(raw_data_[i]));
+            }
+            add_rows_to_index(0, rows);
+            return Status::success;
+        }
+
+        if constexpr (bm25) {
+            bm25_params_->row_sums.LoadView(reader);
+        }
+        FlatArray<uint64_t> offsets;
+        term_dims_.LoadView(reader);
+        offsets.LoadView(reader);
+        SkipAlignmentPadding(reader);
+        auto postings_begin = reader.tellg();
+        auto num_terms = term_dims_.size();
+        dim_map_.reserve(num_terms);
+        inverted_lut_.reserve(num_terms);
+        max_value_in_dim_.resize(num_terms);
+        if constexpr (bm25) {
+            min_row_sum_in_dim_.resize(num_terms);
+        }
+        if constexpr (use_wand) {
+            max_score_in_dim_.resize(num_terms);
+            block_max_scores_.resize(num_terms);
+        }
+        for (size_t term = 0; term < num_terms; ++term) {
+            dim_map_.emplace(term_dims_[term], term);
+            MemoryIOReader lut_reader(reader.data(), reader.total_);
+            lut_reader.advance(postings_begin + offsets[term]);
+            inverted_lut_.emplace_back(codec_);
+            inverted_lut_.back().LoadView(lut_reader);
+            readBinaryPOD(lut_reader, max_value_in_dim_[term]);
+            if constexpr (bm25) {
+                readBinaryPOD(lut_reader, min_row_sum_in_dim_[term]);
+            }
+            if constexpr (use_wand) {
+                readBinaryPOD(lut_reader, max_score_in_dim_[term]);
+                block_max_scores_[term].LoadView(lut_reader);
+            }
+        }
+        return Status::success;
+    }
+
+    // BITPACK_UINT8 posting lists can only hold integer values up to 255.
+    Status
+    check_row_values(const SparseRow<T>& row) const {
+        if (codec_ != PostingListCodec::BITPACK_UINT8) {
+            return Status::success;
+        }
+        for (size_t j = 0; j < row.size(); ++j) {
+            if (!PostingList<T>::is_lossless(codec_, row[j].val)) {
+                LOG_KNOWHERE_ERROR_ << "BITPACK_UINT8 posting lists require integer values in [0, 255], got "
+                                    << row[j].val;
+                return Status::invalid_args;
+            }
+        }
+        return Status::success;
+    }
+
     template <typename HeapType>
     void
     collect_result(HeapType& heap, float* distances, label_t* labels) const {
@@ -552,8 +1334,23 @@ class InvertedIndex : public BaseInvertedIndex<T> {
         }
     }
 
-    inline void
-    add_row_to_index(const SparseRow<T>& row, table_t id) {
+    // a posting computed from a row, with the max score it contributes to its term for the WAND index.
+    struct PendingPosting {
+        table_t id;
+        T val;
+        float score;
+    };
+
+    // postings of a range of rows grouped by dim, dims in the order they are first seen.
+    struct PendingPostings {
+        std::vector<table_t> dims;
+        std::vector<std::vector<PendingPosting>> lists;
+    };
+
+    // calls add(dim, posting) for each posting of row, and returns the row sum of row.
+    template <typename Add>
+    T
+    row_postings(const SparseRow<T>& row, table_t id, Add add) const {
         [[maybe_unused]] T row_sum = 0;
         for (size_t j = 0; j < row.size(); ++j) {
             auto [idx, val] = row[j];
@@ -565,30 +1362,183 @@ class InvertedIndex : public BaseInvertedIndex<T> {
             if (val == 0 || (drop_during_build_ && fabs(val) < value_threshold_)) {
                 continue;
             }
-            if (inverted_lut_.find(idx) == inverted_lut_.end()) {
-                inverted_lut_[idx];
-                if constexpr (use_wand) {
-                    max_score_in_dim_[idx] = 0;
-                }
+            // max scores must bound the values actually read back during search.
+            val = PostingList<T>::stored_value(codec_, val);
+            float score = val;
+            if constexpr (use_wand && bm25) {
+                score = bm25_params_->max_score_ratio * bm25_params_->wand_max_score_computer(val, row_sum);
+            }
+            add(idx, PendingPosting{id, val, score});
+        }
+        return row_sum;
+    }
+
+    // term id of dim, creating an empty posting list for it if it has none.
+    uint32_t
+    get_or_add_term(table_t dim) {
+        auto [dim_it, inserted] = dim_map_.try_emplace(dim, inverted_lut_.size());
+        if (inserted) {
+            term_dims_.push_back(dim);
+            inverted_lut_.emplace_back(codec_);
+            max_value_in_dim_.push_back(std::numeric_limits<T>::lowest());
+            if constexpr (bm25) {
+                min_row_sum_in_dim_.push_back(std::numeric_limits<float>::max());
             }
-            inverted_lut_[idx].emplace_back(id, val);
             if constexpr (use_wand) {
-                auto score = val;
-                if constexpr (bm25) {
-                    score = bm25_params_->max_score_ratio * bm25_params_->wand_max_score_computer(val, row_sum);
-                }
-                max_score_in_dim_[idx] = std::max(max_score_in_dim_[idx], score);
+                max_score_in_dim_.push_back(0);
+                block_max_scores_.emplace_back();
             }
         }
+        return dim_it->second;
+    }
+
+    // postings of a term must be added in ascending doc id order, after the row sum of the doc for BM25.
+    void
+    add_posting(uint32_t term, const PendingPosting& posting) {
+        auto& lut = inverted_lut_[term];
+        lut.push_back(posting.id, posting.val);
+        max_value_in_dim_[term] = std::max(max_value_in_dim_[term], posting.val);
+        if constexpr (bm25) {
+            min_row_sum_in_dim_[term] = std::min(min_row_sum_in_dim_[term], bm25_params_->row_sums[posting.id]);
+        }
+        if constexpr (use_wand) {
+            max_score_in_dim_[term] = std::max(max_score_in_dim_[term], posting.score);
+            auto& block_max = block_max_scores_[term];
+            if ((lut.size() - 1) % kPostingBlockSize == 0) {
+                block_max.push_back(0);
+            }
+            block_max.mutable_data()[block_max.size() - 1] = std::max(block_max.back(), posting.score);
+        }
+    }
+
+    inline void
+    add_row_to_index(const SparseRow<T>& row, table_t id) {
+        if constexpr (bm25) {
+            T row_sum = 0;
+            for (size_t j = 0; j < row.size(); ++j) {
+                row_sum += row[j].val;
+            }
+            auto& row_sums = bm25_params_->row_sums;
+            if (id >= row_sums.size()) {
+                row_sums.resize(id + 1);
+            }
+            row_sums.mutable_data()[id] = row_sum;
+        }
+        row_postings(row, id,
+                     [&](table_t dim, const PendingPosting& posting) { add_posting(get_or_add_term(dim), posting); });
+    }
+
+    // adds raw_data_[begin, end) to the index. Large ranges are split across the build pool: each task collects the
+    // postings of a contiguous range of rows, then terms are assigned in the order the rows first use them and the
+    // posting lists are filled in parallel by term, in doc id order. The result is identical to adding the rows one
+    // by one with add_row_to_index().
+    void
+    add_rows_to_index(size_t begin, size_t end) {
+        auto build_pool = ThreadPool::GetGlobalBuildThreadPool();
+        size_t num_tasks = std::min<size_t>(build_pool->size(), (end - begin) / kMinRowsPerBuildTask);
+        if (num_tasks <= 1) {
+            for (size_t i = begin; i < end; ++i) {
+                add_row_to_index(raw_data_[i], i);
+            }
+            return;
+        }
         if constexpr (bm25) {
-            bm25_params_->row_sums[id] = row_sum;
+            if (end > bm25_params_->row_sums.size()) {
+                bm25_params_->row_sums.resize(end);
+            }
         }
+        auto run_tasks = [&](auto task) {
+            std::vector<folly::Future<folly::Unit>> futs;
+            futs.reserve(num_tasks);
+            for (size_t t = 0; t < num_tasks; ++t) {
+                futs.emplace_back(build_pool->push([&, t]() { task(t); }));
+            }
+            WaitAllSuccess(futs);
+        };
+
+        std::vector<PendingPostings> pending(num_tasks);
+        auto rows_per_task = (end - begin + num_tasks - 1) / num_tasks;
+        [[maybe_unused]] auto row_sums = bm25 ? bm25_params_->row_sums.mutable_data() : nullptr;
+        run_tasks([&](size_t t) {
+            auto& postings = pending[t];
+            std::unordered_map<table_t, size_t> lists;
+            auto task_end = std::min(end, begin + (t + 1) * rows_per_task);
+            for (auto i = begin + t * rows_per_task; i < task_end; ++i) {
+                [[maybe_unused]] auto row_sum =
+                    row_postings(raw_data_[i], i, [&](table_t dim, const PendingPosting& posting) {
+                        auto [it, inserted] = lists.try_emplace(dim, postings.lists.size());
+                        if (inserted) {
+                            postings.dims.push_back(dim);
+                            postings.lists.emplace_back();
+                        }
+                        postings.lists[it->second].push_back(posting);
+                    });
+                if constexpr (bm25) {
+                    row_sums[i] = row_sum;
+                }
+            }
+        });
+
+        // terms[t][j] is the term id of pending[t].dims[j].
+        std::vector<std::vector<uint32_t>> terms(num_tasks);
+        for (size_t t = 0; t < num_tasks; ++t) {
+            terms[t].reserve(pending[t].dims.size());
+            for (auto dim : pending[t].dims) {
+                terms[t].push_back(get_or_add_term(dim));
+            }
+        }
+        auto num_terms = inverted_lut_.size();
+        auto terms_per_task = (num_terms + num_tasks - 1) / num_tasks;
+        run_tasks([&](size_t task) {
+            auto term_begin = task * terms_per_task;
+            auto term_end = std::min(num_terms, term_begin + terms_per_task);
+            for (size_t t = 0; t < num_tasks; ++t) {
+                for (size_t j = 0; j < terms[t].size(); ++j) {
+                    auto term = terms[t][j];
+                    if (term < term_begin || term >= term_end) {
+                        continue;
+                    }
+                    for (const auto& posting : pending[t].lists[j]) {
+                        add_posting(term, posting);
+                    }
+                    // release memory as soon as possible.
+                    std::vector<PendingPosting>().swap(pending[t].lists[j]);
+                }
+            }
+        });
     }
 
+    // rows below which adding rows to the index is not worth another build task.
+    static constexpr size_t kMinRowsPerBuildTask = 10000;
+    // range_search_taat() accumulates scores densely if the terms it reads in full have at least 1 / ratio as many
+    // postings as there are rows, and reads all terms in full if there are at least 1 / ratio as many candidates.
+    static constexpr size_t kDenseRangeSearchRatio = 16;
+    // accumulator memory of a search_brute_force_batch() tile.
+    static constexpr size_t kBatchAccumulatorBytes = 512 * 1024;
+    // search_brute_force_batch() searches the queries one by one unless they would read at least this many times as
+    // many postings one by one as together.
+    static constexpr size_t kMinBatchPostingSharing = 2;
+
+    // marks the flat layout, see Save().
+    static constexpr int64_t kFlatFormatMarker = std::numeric_limits<int64_t>::min();
+    // 2 added the max value and min row sum of each term.
+    static constexpr uint32_t kFlatFormatVersion = 2;
+
     std::vector<SparseRow<T>> raw_data_;
     mutable std::shared_mutex mu_;
+    // copy of the serialized index used in place after a non-mmap load.
+    std::unique_ptr<uint8_t[]> serialized_;
+    size_t serialized_size_ = 0;
 
-    std::unordered_map<table_t, std::vector<SparseIdVal<T>>> inverted_lut_;
+    PostingListCodec codec_;
+    bool codec_given_;
+    // maps each dim that has a posting list to a dense term id, in the order
+    // the dims are first seen, so that per term data is kept in vectors
+    // indexed by term id and a query needs one hash lookup per term.
+    std::unordered_map<table_t, uint32_t> dim_map_;
+    // dim of each term id, the inverse of dim_map_.
+    FlatArray<table_t> term_dims_;
+    std::vector<PostingList<T>> inverted_lut_;
     // If we want to drop small values during build, we must first train the
     // index with all the data to compute value_threshold_.
     bool drop_during_build_ = false;
@@ -596,7 +1546,16 @@ class InvertedIndex : public BaseInvertedIndex<T> {
     // will not be added to inverted_lut_. value_threshold_ is set to the
     // drop_ratio_build-th percentile of all absolute values in the index.
     T value_threshold_ = 0.0f;
-    std::unordered_map<table_t, T> max_score_in_dim_;
+    // max value in the posting list of each term, and for BM25 the min row
+    // sum of the docs in it, which bound the contribution of the term to a
+    // score, indexed by term id.
+    std::vector<T> max_value_in_dim_;
+    std::vector<float> min_row_sum_in_dim_;
+    // indexed by term id, only for WAND index.
+    std::vector<T> max_score_in_dim_;
+    // max score of each block of kPostingBlockSize postings in inverted_lut_,
+    // indexed by term id, only for WAND index.
+    std::vector<FlatArray<float>> block_max_scores_;
     size_t max_dim_ = 0;
 
     struct BM25Params {
@@ -604,7 +1563,8 @@ class InvertedIndex : public BaseInvertedIndex<T> {
         float b;
         // row_sums is used to cache the sum of values of each row, which
         // corresponds to the document length of each doc in the BM25 formula.
-        std::unordered_map<size_t, T> row_sums;
+        // Indexed by doc id.
+        FlatArray<float> row_sums;
 
         // below are used only for WAND index.
         // BM25Params::avgdl is segment level average document length, used only
@@ -612,7 +1572,7 @@ class InvertedIndex : public BaseInvertedIndex<T> {
         // computing.
         float avgdl;
         float max_score_ratio;
-        DocValueComputer<T> wand_max_score_computer;
+        DocValueBM25Computer<T> wand_max_score_computer;
 
         BM25Params(float k1, float b, float avgdl, float max_score_ratio)
             : k1(k1),
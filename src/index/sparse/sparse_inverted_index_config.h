@@ -12,17 +12,74 @@
 #ifndef SPARSE_INVERTED_INDEX_CONFIG_H
 #define SPARSE_INVERTED_INDEX_CONFIG_H
 
+#include <optional>
+#include <string>
+
 #include "knowhere/comp/index_param.h"
 #include "knowhere/config.h"
 
 namespace knowhere {
 
+namespace sparse {
+// Document-at-a-time query processing algorithms of SPARSE_WAND.
+enum class InvertedIndexAlgo {
+    DAAT_WAND,
+    DAAT_BLOCK_MAX_WAND,
+    DAAT_MAXSCORE,
+};
+
+inline std::optional<InvertedIndexAlgo>
+ParseInvertedIndexAlgo(const std::string& name) {
+    if (name == "DAAT_WAND") {
+        return InvertedIndexAlgo::DAAT_WAND;
+    } else if (name == "DAAT_BLOCK_MAX_WAND") {
+        return InvertedIndexAlgo::DAAT_BLOCK_MAX_WAND;
+    } else if (name == "DAAT_MAXSCORE") {
+        return InvertedIndexAlgo::DAAT_MAXSCORE;
+    }
+    return std::nullopt;
+}
+
+// Storage format of the posting lists of the inverted index.
+enum class PostingListCodec {
+    // doc ids and fp32 values stored as is.
+    NONE,
+    // doc ids delta encoded and bit-packed per block, fp32 values.
+    BITPACK,
+    // as BITPACK with uint8 values, for integer values up to 255 such as BM25 term frequencies.
+    BITPACK_UINT8,
+    // as BITPACK with fp16 values, for learned sparse weights. Lossy, search results are refined with the raw rows.
+    BITPACK_FP16,
+};
+
+inline std::optional<PostingListCodec>
+ParsePostingListCodec(const std::string& name) {
+    if (name == "NONE") {
+        return PostingListCodec::NONE;
+    } else if (name == "BITPACK") {
+        return PostingListCodec::BITPACK;
+    } else if (name == "BITPACK_UINT8") {
+        return PostingListCodec::BITPACK_UINT8;
+    } else if (name == "BITPACK_FP16") {
+        return PostingListCodec::BITPACK_FP16;
+    }
+    return std::nullopt;
+}
+}  // namespace sparse
+
 class SparseInvertedIndexConfig : public BaseConfig {
  public:
     CFG_FLOAT drop_ratio_build;
     CFG_FLOAT drop_ratio_search;
     CFG_INT refine_factor;
     CFG_FLOAT wand_bm25_max_score_ratio;
+    CFG_STRING inverted_index_algo;
+    CFG_STRING posting_list_codec;
+    CFG_INT seismic_n_postings;
+    CFG_FLOAT seismic_centroid_fraction;
+    CFG_FLOAT seismic_summary_energy;
+    CFG_INT seismic_query_cut;
+    CFG_FLOAT seismic_heap_factor;
     KNOHWERE_DECLARE_CONFIG(SparseInvertedIndexConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(drop_ratio_build)
             .description("drop ratio for build")
@@ -60,6 +117,77 @@ class SparseInvertedIndexConfig : public BaseConfig {
             .for_train()
             .for_deserialize()
             .for_deserialize_from_file();
+        // Only used by SPARSE_WAND. SPARSE_INVERTED_INDEX always scores the
+        // posting lists term at a time.
+        KNOWHERE_CONFIG_DECLARE_FIELD(inverted_index_algo)
+            .description("DAAT_WAND, DAAT_BLOCK_MAX_WAND or DAAT_MAXSCORE")
+            .set_default("DAAT_BLOCK_MAX_WAND")
+            .for_search();
+        // NONE when building. When loading, the codec the index was saved
+        // with; loading fails if a different one is given.
+        KNOWHERE_CONFIG_DECLARE_FIELD(posting_list_codec)
+            .description("NONE, BITPACK, BITPACK_UINT8 or BITPACK_FP16")
+            .allow_empty_without_default()
+            .for_train()
+            .for_deserialize()
+            .for_deserialize_from_file();
+        // Only used by SPARSE_SEISMIC, whose posting lists are built once from
+        // all rows: each posting list keeps the seismic_n_postings postings
+        // with the largest values, clustered into
+        // seismic_centroid_fraction * seismic_n_postings blocks. A block is
+        // summarized by the per dim max values of its docs, keeping the
+        // largest ones that add up to seismic_summary_energy of the total.
+        KNOWHERE_CONFIG_DECLARE_FIELD(seismic_n_postings)
+            .description("max number of postings kept per posting list")
+            .set_default(4000)
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(seismic_centroid_fraction)
+            .description("number of blocks per posting list as a fraction of its length")
+            .set_default(0.1f)
+            .set_range(0.0f, 1.0f)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(seismic_summary_energy)
+            .description("fraction of the total value of a block summary kept")
+            .set_default(0.4f)
+            .set_range(0.0f, 1.0f)
+            .for_train();
+        // a query visits the posting lists of its seismic_query_cut largest
+        // values, and skips a block if its summary score is at most the
+        // current k-th score divided by seismic_heap_factor. Smaller factors
+        // skip more blocks.
+        KNOWHERE_CONFIG_DECLARE_FIELD(seismic_query_cut)
+            .description("max number of query terms searched")
+            .set_default(10)
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(seismic_heap_factor)
+            .description("block skipping factor, in (0, 1]")
+            .set_default(0.9f)
+            .set_range(0.0f, 1.0f)
+            .for_search();
+    }
+
+    Status
+    CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
+        if (param_type == PARAM_TYPE::SEARCH && !sparse::ParseInvertedIndexAlgo(inverted_index_algo.value())) {
+            *err_msg = "unknown inverted_index_algo: " + inverted_index_algo.value();
+            LOG_KNOWHERE_ERROR_ << *err_msg;
+            return Status::invalid_args;
+        }
+        if ((param_type == PARAM_TYPE::TRAIN || param_type == PARAM_TYPE::DESERIALIZE ||
+             param_type == PARAM_TYPE::DESERIALIZE_FROM_FILE) &&
+            posting_list_codec.has_value() && !sparse::ParsePostingListCodec(posting_list_codec.value())) {
+            *err_msg = "unknown posting_list_codec: " + posting_list_codec.value();
+            LOG_KNOWHERE_ERROR_ << *err_msg;
+            return Status::invalid_args;
+        }
+        if (param_type == PARAM_TYPE::SEARCH && seismic_heap_factor.value() <= 0.0f) {
+            *err_msg = "seismic_heap_factor must be in (0, 1]";
+            LOG_KNOWHERE_ERROR_ << *err_msg;
+            return Status::invalid_args;
+        }
+        return Status::success;
     }
 };  // class SparseInvertedIndexConfig
 
@@ -0,0 +1,509 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef SPARSE_POSTING_LIST_H
+#define SPARSE_POSTING_LIST_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "index/sparse/sparse_inverted_index_config.h"
+#include "io/memory_io.h"
+#include "knowhere/operands.h"
+#include "knowhere/sparse_utils.h"
+#include "knowhere/utils.h"
+
+namespace knowhere::sparse {
+
+namespace bitpacking {
+
+// Packs kCount values of kBits bits each, value i starting at bit i * kBits of
+// the little endian word stream. With kBits and kCount known at compile time
+// the loops fully unroll into constant shifts and masks.
+template <uint32_t kBits, size_t kCount>
+inline void
+pack(const uint32_t* in, uint32_t* out) {
+    if constexpr (kBits == 0) {
+        return;
+    } else {
+        std::memset(out, 0, (kCount * kBits + 31) / 32 * sizeof(uint32_t));
+        for (size_t i = 0; i < kCount; ++i) {
+            constexpr uint64_t mask = (uint64_t{1} << kBits) - 1;
+            const size_t pos = i * kBits;
+            const uint64_t v = (in[i] & mask) << (pos & 31);
+            out[pos >> 5] |= static_cast<uint32_t>(v);
+            if ((pos & 31) + kBits > 32) {
+                out[(pos >> 5) + 1] |= static_cast<uint32_t>(v >> 32);
+            }
+        }
+    }
+}
+
+template <uint32_t kBits, size_t kCount>
+inline void
+unpack(const uint32_t* in, uint32_t* out) {
+    if constexpr (kBits == 0) {
+        std::fill(out, out + kCount, 0);
+    } else {
+        for (size_t i = 0; i < kCount; ++i) {
+            constexpr uint64_t mask = (uint64_t{1} << kBits) - 1;
+            const size_t pos = i * kBits;
+            uint64_t v = in[pos >> 5];
+            if ((pos & 31) + kBits > 32) {
+                v |= uint64_t{in[(pos >> 5) + 1]} << 32;
+            }
+            out[i] = static_cast<uint32_t>((v >> (pos & 31)) & mask);
+        }
+    }
+}
+
+template <size_t kCount>
+struct Codec {
+    using Fn = void (*)(const uint32_t*, uint32_t*);
+
+    template <uint32_t... kBits>
+    static constexpr std::array<Fn, sizeof...(kBits)>
+    packers(std::integer_sequence<uint32_t, kBits...>) {
+        return {&pack<kBits, kCount>...};
+    }
+
+    template <uint32_t... kBits>
+    static constexpr std::array<Fn, sizeof...(kBits)>
+    unpackers(std::integer_sequence<uint32_t, kBits...>) {
+        return {&unpack<kBits, kCount>...};
+    }
+
+    // indexed by bit width, 0 to 32.
+    static constexpr auto kPack = packers(std::make_integer_sequence<uint32_t, 33>{});
+    static constexpr auto kUnpack = unpackers(std::make_integer_sequence<uint32_t, 33>{});
+};
+
+inline uint32_t
+bit_width(uint32_t v) {
+    return v == 0 ? 0 : 32 - __builtin_clz(v);
+}
+
+}  // namespace bitpacking
+
+// Serialized arrays start at multiples of this many bytes from the start of
+// the serialized index, so that they can be used in place.
+constexpr size_t kSerializedAlignment = 8;
+
+inline void
+WriteAlignmentPadding(MemoryIOWriter& writer) {
+    static const uint8_t zeros[kSerializedAlignment] = {};
+    auto pad = (kSerializedAlignment - writer.tellg() % kSerializedAlignment) % kSerializedAlignment;
+    if (pad > 0) {
+        writer.write(zeros, pad);
+    }
+}
+
+inline void
+SkipAlignmentPadding(MemoryIOReader& reader) {
+    reader.advance((kSerializedAlignment - reader.tellg() % kSerializedAlignment) % kSerializedAlignment);
+}
+
+// Array of trivially copyable elements that either owns them or is a view of
+// serialized memory, e.g. an mmapped index file, which must outlive it. A view
+// is copied into owned memory on the first modification.
+template <typename U>
+class FlatArray {
+ public:
+    FlatArray() = default;
+    FlatArray(const FlatArray& other) : owned_(other.data_, other.data_ + other.size_) {
+        sync();
+    }
+    FlatArray(FlatArray&& other) noexcept {
+        move_from(other);
+    }
+    FlatArray&
+    operator=(const FlatArray& other) {
+        if (this != &other) {
+            owned_.assign(other.data_, other.data_ + other.size_);
+            sync();
+        }
+        return *this;
+    }
+    FlatArray&
+    operator=(FlatArray&& other) noexcept {
+        if (this != &other) {
+            move_from(other);
+        }
+        return *this;
+    }
+
+    [[nodiscard]] size_t
+    size() const {
+        return size_;
+    }
+    [[nodiscard]] bool
+    empty() const {
+        return size_ == 0;
+    }
+    const U*
+    data() const {
+        return data_;
+    }
+    const U&
+    operator[](size_t i) const {
+        return data_[i];
+    }
+    const U&
+    back() const {
+        return data_[size_ - 1];
+    }
+
+    U*
+    mutable_data() {
+        make_owned();
+        return owned_.data();
+    }
+    void
+    push_back(const U& v) {
+        make_owned();
+        owned_.push_back(v);
+        sync();
+    }
+    void
+    resize(size_t n) {
+        make_owned();
+        owned_.resize(n);
+        sync();
+    }
+    void
+    reserve(size_t n) {
+        make_owned();
+        owned_.reserve(n);
+        sync();
+    }
+    void
+    clear() {
+        owned_.clear();
+        sync();
+    }
+
+    // owned memory only, a view doesn't count.
+    [[nodiscard]] size_t
+    memory_usage() const {
+        return owned_.capacity() * sizeof(U);
+    }
+
+    // Layout: uint64_t size, padding to kSerializedAlignment, the elements.
+    void
+    Save(MemoryIOWriter& writer) const {
+        writeBinaryPOD(writer, static_cast<uint64_t>(size_));
+        WriteAlignmentPadding(writer);
+        if (size_ > 0) {
+            writer.write(data_, sizeof(U), size_);
+        }
+    }
+
+    // points to the elements in reader memory without copying them.
+    void
+    LoadView(MemoryIOReader& reader) {
+        uint64_t size;
+        readBinaryPOD(reader, size);
+        SkipAlignmentPadding(reader);
+        owned_.clear();
+        owned_.shrink_to_fit();
+        size_ = size;
+        data_ = reinterpret_cast<const U*>(reader.data() + reader.tellg());
+        reader.advance(size * sizeof(U));
+    }
+
+ private:
+    [[nodiscard]] bool
+    is_view() const {
+        return size_ > 0 && data_ != owned_.data();
+    }
+    void
+    make_owned() {
+        if (is_view()) {
+            owned_.assign(data_, data_ + size_);
+            sync();
+        }
+    }
+    void
+    sync() {
+        data_ = owned_.data();
+        size_ = owned_.size();
+    }
+    void
+    move_from(FlatArray& other) {
+        bool view = other.is_view();
+        auto data = other.data_;
+        auto size = other.size_;
+        owned_ = std::move(other.owned_);
+        data_ = view ? data : owned_.data();
+        size_ = size;
+        other.owned_.clear();
+        other.sync();
+    }
+
+    std::vector<U> owned_;
+    const U* data_ = nullptr;
+    size_t size_ = 0;
+};  // class FlatArray
+
+// number of postings in a block of a posting list.
+constexpr size_t kPostingBlockSize = 64;
+
+// Scratch space a posting list block is decoded into.
+template <typename T>
+struct PostingBlock {
+    table_t ids[kPostingBlockSize];
+    T vals[kPostingBlockSize];
+};
+
+// Posting list of a single dimension: doc ids in ascending order and their values, accessed block by block. Blocks
+// hold kPostingBlockSize postings, the last one may be partial.
+//
+// With PostingListCodec::NONE ids and values are stored as is and blocks are read in place. Otherwise every full
+// block is compressed once it fills up: doc ids are delta encoded against the last id of the previous block and
+// bit-packed with the width of the largest delta, values are stored as fp32, uint8 or fp16. The last, partial block is
+// kept uncompressed so rows can still be appended. The compressed blocks are allocated with the first one, so that the
+// many short posting lists of an index, and all of them with PostingListCodec::NONE, don't pay for them.
+//
+// A posting list can be saved and then used in place from the serialized memory, see Save() and LoadView().
+template <typename T>
+class PostingList {
+ public:
+    explicit PostingList(PostingListCodec codec = PostingListCodec::NONE) : codec_(codec) {
+    }
+
+    // whether val can be stored by codec without loss.
+    static bool
+    is_lossless(PostingListCodec codec, T val) {
+        switch (codec) {
+            case PostingListCodec::BITPACK_UINT8:
+                return val >= 0 && val <= 255 && std::floor(val) == val;
+            case PostingListCodec::BITPACK_FP16:
+                return static_cast<T>(fp16(val)) == val;
+            default:
+                return true;
+        }
+    }
+
+    // the value that will be read back after storing val.
+    static T
+    stored_value(PostingListCodec codec, T val) {
+        switch (codec) {
+            case PostingListCodec::BITPACK_UINT8:
+                return static_cast<uint8_t>(std::clamp<T>(std::round(val), 0, 255));
+            case PostingListCodec::BITPACK_FP16:
+                return static_cast<T>(fp16(val));
+            default:
+                return val;
+        }
+    }
+
+    void
+    push_back(table_t id, T val) {
+        ids_.push_back(id);
+        vals_.push_back(val);
+        size_++;
+        if (codec_ != PostingListCodec::NONE && ids_.size() == kPostingBlockSize) {
+            compress_tail();
+        }
+    }
+
+    [[nodiscard]] size_t
+    size() const {
+        return size_;
+    }
+
+    [[nodiscard]] size_t
+    num_blocks() const {
+        return (size_ + kPostingBlockSize - 1) / kPostingBlockSize;
+    }
+
+    // last doc id of block b, without decoding it.
+    [[nodiscard]] table_t
+    block_last_id(size_t b) const {
+        if (b < num_packed_blocks()) {
+            return packed_->last_ids[b];
+        }
+        auto end = std::min((b - num_packed_blocks() + 1) * kPostingBlockSize, ids_.size());
+        return ids_[end - 1];
+    }
+
+    // returns the number of postings in block b and points ids/vals to them, either in place or decoded into buf.
+    size_t
+    block(size_t b, PostingBlock<T>& buf, const table_t*& ids, const T*& vals) const {
+        if (b >= num_packed_blocks()) {
+            auto begin = (b - num_packed_blocks()) * kPostingBlockSize;
+            ids = ids_.data() + begin;
+            vals = vals_.data() + begin;
+            return std::min(kPostingBlockSize, ids_.size() - begin);
+        }
+        decode_block(b, buf);
+        ids = buf.ids;
+        vals = buf.vals;
+        return kPostingBlockSize;
+    }
+
+    // memory usage of the postings, excluding sizeof(*this) and serialized memory used in place.
+    [[nodiscard]] size_t
+    memory_usage() const {
+        auto usage = ids_.memory_usage() + vals_.memory_usage();
+        if (packed_) {
+            usage += sizeof(PackedBlocks) + packed_->ids.memory_usage() + packed_->vals.memory_usage() +
+                     packed_->offsets.memory_usage() + packed_->bits.memory_usage() +
+                     packed_->last_ids.memory_usage();
+        }
+        return usage;
+    }
+
+    // Layout: uint64_t size, followed by the FlatArrays ids, vals, packed_ids,
+    // packed_vals, packed_offsets, packed_bits and packed_last_ids, the packed
+    // ones empty if no block is compressed. The codec is not saved and must be
+    // known by the reader.
+    void
+    Save(MemoryIOWriter& writer) const {
+        static const PackedBlocks no_packed_blocks;
+        const auto& packed = packed_ ? *packed_ : no_packed_blocks;
+        writeBinaryPOD(writer, static_cast<uint64_t>(size_));
+        ids_.Save(writer);
+        vals_.Save(writer);
+        packed.ids.Save(writer);
+        packed.vals.Save(writer);
+        packed.offsets.Save(writer);
+        packed.bits.Save(writer);
+        packed.last_ids.Save(writer);
+    }
+
+    void
+    LoadView(MemoryIOReader& reader) {
+        uint64_t size;
+        readBinaryPOD(reader, size);
+        size_ = size;
+        ids_.LoadView(reader);
+        vals_.LoadView(reader);
+        auto packed = std::make_unique<PackedBlocks>();
+        packed->ids.LoadView(reader);
+        packed->vals.LoadView(reader);
+        packed->offsets.LoadView(reader);
+        packed->bits.LoadView(reader);
+        packed->last_ids.LoadView(reader);
+        packed_ = packed->last_ids.empty() ? nullptr : std::move(packed);
+    }
+
+ private:
+    // compressed full blocks.
+    struct PackedBlocks {
+        FlatArray<uint32_t> ids;
+        FlatArray<uint8_t> vals;
+        FlatArray<uint32_t> offsets;
+        FlatArray<uint8_t> bits;
+        FlatArray<table_t> last_ids;
+    };
+
+    [[nodiscard]] size_t
+    num_packed_blocks() const {
+        return packed_ ? packed_->last_ids.size() : 0;
+    }
+
+    [[nodiscard]] size_t
+    value_size() const {
+        switch (codec_) {
+            case PostingListCodec::BITPACK_UINT8:
+                return sizeof(uint8_t);
+            case PostingListCodec::BITPACK_FP16:
+                return sizeof(fp16);
+            default:
+                return sizeof(T);
+        }
+    }
+
+    void
+    compress_tail() {
+        using Codec = bitpacking::Codec<kPostingBlockSize>;
+        if (!packed_) {
+            packed_ = std::make_unique<PackedBlocks>();
+        }
+        auto& packed = *packed_;
+        table_t prev = packed.last_ids.empty() ? 0 : packed.last_ids.back();
+        uint32_t deltas[kPostingBlockSize];
+        uint32_t max_delta = 0;
+        for (size_t i = 0; i < kPostingBlockSize; ++i) {
+            deltas[i] = ids_[i] - prev;
+            prev = ids_[i];
+            max_delta = std::max(max_delta, deltas[i]);
+        }
+        auto bits = bitpacking::bit_width(max_delta);
+        packed.offsets.push_back(packed.ids.size());
+        packed.bits.push_back(bits);
+        packed.last_ids.push_back(ids_.back());
+        packed.ids.resize(packed.ids.size() + kPostingBlockSize * bits / 32);
+        Codec::kPack[bits](deltas, packed.ids.mutable_data() + packed.offsets.back());
+
+        auto val_offset = packed.vals.size();
+        packed.vals.resize(val_offset + kPostingBlockSize * value_size());
+        auto* out = packed.vals.mutable_data() + val_offset;
+        for (size_t i = 0; i < kPostingBlockSize; ++i) {
+            if (codec_ == PostingListCodec::BITPACK_UINT8) {
+                out[i] = static_cast<uint8_t>(stored_value(codec_, vals_[i]));
+            } else if (codec_ == PostingListCodec::BITPACK_FP16) {
+                fp16 v(vals_[i]);
+                std::memcpy(out + i * sizeof(fp16), &v, sizeof(fp16));
+            } else {
+                std::memcpy(out + i * sizeof(T), &vals_[i], sizeof(T));
+            }
+        }
+        ids_.clear();
+        vals_.clear();
+    }
+
+    void
+    decode_block(size_t b, PostingBlock<T>& buf) const {
+        using Codec = bitpacking::Codec<kPostingBlockSize>;
+        const auto& packed = *packed_;
+        Codec::kUnpack[packed.bits[b]](packed.ids.data() + packed.offsets[b], buf.ids);
+        table_t prev = b == 0 ? 0 : packed.last_ids[b - 1];
+        for (size_t i = 0; i < kPostingBlockSize; ++i) {
+            prev += buf.ids[i];
+            buf.ids[i] = prev;
+        }
+
+        const auto* in = packed.vals.data() + b * kPostingBlockSize * value_size();
+        if (codec_ == PostingListCodec::BITPACK_UINT8) {
+            for (size_t i = 0; i < kPostingBlockSize; ++i) {
+                buf.vals[i] = in[i];
+            }
+        } else if (codec_ == PostingListCodec::BITPACK_FP16) {
+            fp16 v[kPostingBlockSize];
+            std::memcpy(v, in, sizeof(v));
+            for (size_t i = 0; i < kPostingBlockSize; ++i) {
+                buf.vals[i] = v[i];
+            }
+        } else {
+            std::memcpy(buf.vals, in, kPostingBlockSize * sizeof(T));
+        }
+    }
+
+    PostingListCodec codec_;
+    size_t size_ = 0;
+    // uncompressed postings: all of them with PostingListCodec::NONE, otherwise the last partial block.
+    FlatArray<table_t> ids_;
+    FlatArray<T> vals_;
+    // null until a block is compressed.
+    std::unique_ptr<PackedBlocks> packed_;
+};  // class PostingList
+
+}  // namespace knowhere::sparse
+
+#endif  // SPARSE_POSTING_LIST_H
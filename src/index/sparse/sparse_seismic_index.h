@@ -0,0 +1,763 @@
+// Copyright (C) 2019-2024 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef SPARSE_SEISMIC_INDEX_H
+#define SPARSE_SEISMIC_INDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "index/sparse/sparse_inverted_index.h"
+#include "index/sparse/sparse_inverted_index_config.h"
+#include "index/sparse/sparse_posting_list.h"
+#include "io/memory_io.h"
+#include "knowhere/bitsetview.h"
+#include "knowhere/comp/thread_pool.h"
+#include "knowhere/expected.h"
+#include "knowhere/log.h"
+#include "knowhere/sparse_utils.h"
+
+namespace knowhere::sparse {
+
+// see the seismic_* fields of SparseInvertedIndexConfig.
+struct SeismicBuildParams {
+    size_t n_postings = 4000;
+    float centroid_fraction = 0.1f;
+    float summary_energy = 0.4f;
+};
+
+struct SeismicSearchParams {
+    size_t query_cut = 10;
+    float heap_factor = 0.9f;
+};
+
+template <typename T>
+class BaseSeismicIndex : public BaseInvertedIndex<T> {
+ public:
+    virtual void
+    Search(const SparseRow<T>& query, size_t k, float drop_ratio_search, float* distances, label_t* labels,
+           const BitsetView& bitset, const DocValueComputer<T>& computer, const SeismicSearchParams& params) const = 0;
+
+    // the searches of the inverted index don't take the seismic search params, they must be given to the overload
+    // above.
+    void
+    Search(const SparseRow<T>& /*query*/, size_t /*k*/, float /*drop_ratio_search*/, float* /*distances*/,
+           label_t* /*labels*/, size_t /*refine_factor*/, const BitsetView& /*bitset*/,
+           const DocValueComputer<T>& /*computer*/, InvertedIndexAlgo /*algo*/) const final {
+        throw std::runtime_error("SPARSE_SEISMIC searches take SeismicSearchParams");
+    }
+
+    void
+    SearchBatch(const SparseRow<T>* /*queries*/, size_t /*nq*/, size_t /*k*/, float /*drop_ratio_search*/,
+                float* /*distances*/, label_t* /*labels*/, size_t /*refine_factor*/, const BitsetView& /*bitset*/,
+                const DocValueComputer<T>& /*computer*/, InvertedIndexAlgo /*algo*/) const final {
+        throw std::runtime_error("SPARSE_SEISMIC searches take SeismicSearchParams");
+    }
+};
+
+// Approximate inverted index after Seismic (Bruch et al., "Efficient Inverted Indexes for Approximate Retrieval over
+// Learned Sparse Representations", SIGIR 2024).
+//
+// Each posting list keeps only the postings with the largest doc values, and its docs are clustered into blocks by
+// the similarity of their rows. A block has a summary, the per dim max doc value over its docs with the smallest ones
+// pruned, whose inner product with the query approximately bounds the score of any doc in the block. A query visits
+// the posting lists of its largest values, skips the blocks whose summary can't beat the current top-k, and scores
+// the docs of the other blocks exactly with the rows, which also serve GetVectorById().
+//
+// The posting lists are built once from all rows, a built index can't be added to. Summaries use the doc values of
+// the BM25 params the index is built with.
+template <typename T, bool bm25 = false>
+class SeismicIndex : public BaseSeismicIndex<T> {
+ public:
+    explicit SeismicIndex(const SeismicBuildParams& build_params = {}) : build_params_(build_params) {
+    }
+
+    void
+    SetBM25Params(float k1, float b, float avgdl) {
+        bm25_params_ = std::make_unique<BM25Params>(BM25Params{k1, b, GetDocValueBM25Computer<T>(k1, b, avgdl)});
+    }
+
+    expected<DocValueComputer<T>>
+    GetDocValueComputer(const SparseInvertedIndexConfig& cfg) const override {
+        auto metric_type = cfg.metric_type;
+        if constexpr (!bm25) {
+            if (metric_type.has_value() && !IsMetricType(metric_type.value(), metric::IP)) {
+                auto msg =
+                    "metric type not match, expected: " + std::string(metric::IP) + ", got: " + metric_type.value();
+                return expected<DocValueComputer<T>>::Err(Status::invalid_metric_type, msg);
+            }
+            return GetDocValueOriginalComputer<T>();
+        }
+        if (metric_type.has_value() && !IsMetricType(metric_type.value(), metric::BM25)) {
+            auto msg =
+                "metric type not match, expected: " + std::string(metric::BM25) + ", got: " + metric_type.value();
+            return expected<DocValueComputer<T>>::Err(Status::invalid_metric_type, msg);
+        }
+        if (!cfg.bm25_avgdl.has_value()) {
+            return expected<DocValueComputer<T>>::Err(Status::invalid_args, "avgdl must be supplied during searching");
+        }
+        // search time k1/b may override load time config, the scores of the visited docs are exact.
+        auto k1 = cfg.bm25_k1.has_value() ? cfg.bm25_k1.value() : bm25_params_->k1;
+        auto b = cfg.bm25_b.has_value() ? cfg.bm25_b.value() : bm25_params_->b;
+        return GetDocValueBM25Computer<T>(k1, b, cfg.bm25_avgdl.value());
+    }
+
+    Status
+    Save(MemoryIOWriter& writer) override {
+        /**
+         * Layout:
+         *
+         * 1. uint32_t kFormatVersion, uint8_t bm25
+         * 2. uint64_t rows, uint64_t cols
+         * 3. for each row:
+         *     1. size_t len
+         *     2. for each non-zero value:
+         *        1. table_t idx
+         *        2. T val
+         * 4. if BM25, FlatArray<float> row sums
+         * 5. FlatArray<table_t> term_dims_
+         * 6. FlatArray<uint64_t> term_blocks_
+         * 7. FlatArray<uint64_t> block_docs_begin_, FlatArray<table_t> block_docs_
+         * 8. FlatArray<uint64_t> summaries_begin_, FlatArray<uint32_t> summary_terms_, FlatArray<T> summary_vals_
+         *
+         * The arrays are aligned as in the InvertedIndex layout so that the
+         * index can be searched in place in the serialized memory.
+         */
+        std::shared_lock<std::shared_mutex> lock(mu_);
+        writeBinaryPOD(writer, kFormatVersion);
+        writeBinaryPOD(writer, static_cast<uint8_t>(bm25));
+        writeBinaryPOD(writer, static_cast<uint64_t>(n_rows_internal()));
+        writeBinaryPOD(writer, static_cast<uint64_t>(max_dim_));
+        for (const auto& row : raw_data_) {
+            writeBinaryPOD(writer, row.size());
+            if (row.size() == 0) {
+                continue;
+            }
+            writer.write(row.data(), row.size() * SparseRow<T>::element_size());
+        }
+        if constexpr (bm25) {
+            row_sums_.Save(writer);
+        }
+        term_dims_.Save(writer);
+        term_blocks_.Save(writer);
+        block_docs_begin_.Save(writer);
+        block_docs_.Save(writer);
+        summaries_begin_.Save(writer);
+        summary_terms_.Save(writer);
+        summary_vals_.Save(writer);
+        return Status::success;
+    }
+
+    // The index is used in place in the serialized memory. If is_mmap, reader memory must outlive the index,
+    // otherwise it is copied once.
+    Status
+    Load(MemoryIOReader& reader, bool is_mmap) override {
+        std::unique_lock<std::shared_mutex> lock(mu_);
+        if (!is_mmap) {
+            serialized_size_ = reader.total_;
+            serialized_ = std::make_unique<uint8_t[]>(serialized_size_);
+            std::memcpy(serialized_.get(), reader.data(), serialized_size_);
+            MemoryIOReader owned_reader(serialized_.get(), serialized_size_);
+            owned_reader.advance(reader.tellg());
+            return load_view(owned_reader);
+        }
+        return load_view(reader);
+    }
+
+    // postings are pruned by count rather than by value, thus drop_ratio_build is ignored.
+    Status
+    Train(const SparseRow<T>* /*data*/, size_t /*rows*/, float /*drop_ratio_build*/) override {
+        return Status::success;
+    }
+
+    Status
+    Add(const SparseRow<T>* data, size_t rows, int64_t dim) override {
+        std::unique_lock<std::shared_mutex> lock(mu_);
+        if (n_rows_internal() > 0) {
+            LOG_KNOWHERE_ERROR_ << "Not allowed to add data to a built SPARSE_SEISMIC index.";
+            return Status::invalid_args;
+        }
+        raw_data_.assign(data, data + rows);
+        max_dim_ = std::max<size_t>(max_dim_, dim);
+        build();
+        return Status::success;
+    }
+
+    using BaseSeismicIndex<T>::Search;
+
+    // the visited docs are scored exactly.
+    void
+    Search(const SparseRow<T>& query, size_t k, float drop_ratio_search, float* distances, label_t* labels,
+           const BitsetView& bitset, const DocValueComputer<T>& computer,
+           const SeismicSearchParams& params) const override {
+        std::fill(distances, distances + k, std::numeric_limits<float>::quiet_NaN());
+        std::fill(labels, labels + k, -1);
+        if (query.size() == 0) {
+            return;
+        }
+        auto q_threshold = GetQueryThreshold(query, drop_ratio_search);
+
+        std::shared_lock<std::shared_mutex> lock(mu_);
+        MaxMinHeap<T> heap(k);
+        WithConcreteComputer<T, bm25>(computer, [&](const auto& doc_computer) {
+            search_blocks(query, q_threshold, heap, bitset, doc_computer, params);
+        });
+        for (auto i = static_cast<int64_t>(heap.size()) - 1; i >= 0; --i) {
+            labels[i] = heap.top().id;
+            distances[i] = heap.top().val;
+            heap.pop();
+        }
+    }
+
+    // exact, scores every row.
+    void
+    RangeSearch(const SparseRow<T>& query, float radius, float range_filter, float drop_ratio_search,
+                const BitsetView& bitset, const DocValueComputer<T>& computer, std::vector<label_t>& ids,
+                std::vector<float>& distances) const override {
+        auto q_vec = thresholded_query(query, drop_ratio_search);
+        std::shared_lock<std::shared_mutex> lock(mu_);
+        WithConcreteComputer<T, bm25>(computer, [&](const auto& doc_computer) {
+            for (size_t i = 0; i < n_rows_internal(); ++i) {
+                if (!bitset.empty() && bitset.test(i)) {
+                    continue;
+                }
+                auto distance = q_vec.dot(raw_data_[i], doc_computer, row_sum(i));
+                if (distance > radius && distance <= range_filter) {
+                    ids.push_back(i);
+                    distances.push_back(distance);
+                }
+            }
+        });
+    }
+
+    std::vector<float>
+    GetAllDistances(const SparseRow<T>& query, float drop_ratio_search, const BitsetView& bitset,
+                    const DocValueComputer<T>& computer) const override {
+        if (query.size() == 0) {
+            return {};
+        }
+        auto q_vec = thresholded_query(query, drop_ratio_search);
+
+        std::shared_lock<std::shared_mutex> lock(mu_);
+        std::vector<float> distances(n_rows_internal(), 0.0f);
+        WithConcreteComputer<T, bm25>(computer, [&](const auto& doc_computer) {
+            for (size_t i = 0; i < distances.size(); ++i) {
+                if (bitset.empty() || !bitset.test(i)) {
+                    distances[i] = q_vec.dot(raw_data_[i], doc_computer, row_sum(i));
+                }
+            }
+        });
+        return distances;
+    }
+
+    void
+    GetVectorById(const label_t id, SparseRow<T>& output) const override {
+        output = raw_data_[id];
+    }
+
+    [[nodiscard]] size_t
+    size() const override {
+        std::shared_lock<std::shared_mutex> lock(mu_);
+        size_t res = sizeof(*this);
+        for (const auto& row : raw_data_) {
+            res += row.memory_usage();
+        }
+        res += (sizeof(table_t) + sizeof(uint32_t)) * dim_map_.size();
+        res += row_sums_.memory_usage() + term_dims_.memory_usage() + term_blocks_.memory_usage();
+        res += block_docs_begin_.memory_usage() + block_docs_.memory_usage();
+        res += summaries_begin_.memory_usage() + summary_terms_.memory_usage() + summary_vals_.memory_usage();
+        res += serialized_size_;
+        return res;
+    }
+
+    [[nodiscard]] size_t
+    n_rows() const override {
+        std::shared_lock<std::shared_mutex> lock(mu_);
+        return n_rows_internal();
+    }
+
+    [[nodiscard]] size_t
+    n_cols() const override {
+        std::shared_lock<std::shared_mutex> lock(mu_);
+        return max_dim_;
+    }
+
+ private:
+    size_t
+    n_rows_internal() const {
+        return raw_data_.size();
+    }
+
+    // query without the values dropped by drop_ratio_search.
+    static SparseRow<T>
+    thresholded_query(const SparseRow<T>& query, float drop_ratio_search) {
+        if (query.size() == 0) {
+            return {};
+        }
+        auto q_threshold = GetQueryThreshold(query, drop_ratio_search);
+        size_t count = 0;
+        for (size_t i = 0; i < query.size(); ++i) {
+            count += query[i].val >= q_threshold;
+        }
+        SparseRow<T> q_vec(count);
+        for (size_t i = 0, j = 0; i < query.size(); ++i) {
+            if (query[i].val >= q_threshold) {
+                q_vec.set_at(j++, query[i].id, query[i].val);
+            }
+        }
+        return q_vec;
+    }
+
+    [[nodiscard]] float
+    row_sum(size_t id) const {
+        if constexpr (bm25) {
+            return row_sums_[id];
+        } else {
+            return 0;
+        }
+    }
+
+    // doc value of a posting with the BM25 params the index is built with, which postings are pruned and summaries
+    // are computed by.
+    [[nodiscard]] float
+    build_doc_value(table_t id, T val) const {
+        if constexpr (bm25) {
+            return bm25_params_->build_computer(val, row_sums_[id]);
+        } else {
+            return val;
+        }
+    }
+
+    // the values of q_vec that are at least q_threshold and have a posting list are scattered into a dense vector
+    // indexed by term id to score the summaries, and the posting lists of the params.query_cut largest of them are
+    // visited. A block is skipped once the heap is full if its summary score is at most the k-th score divided by
+    // params.heap_factor, otherwise each doc in it not yet scored is scored exactly.
+    template <typename Computer>
+    void
+    search_blocks(const SparseRow<T>& q_vec, T q_threshold, MaxMinHeap<T>& heap, const BitsetView& bitset,
+                  const Computer& computer, const SeismicSearchParams& params) const {
+        thread_local std::vector<float> q_dense;
+        if (q_dense.size() < term_dims_.size()) {
+            q_dense.resize(term_dims_.size(), 0.0f);
+        }
+        std::vector<SparseIdVal<T>> q_terms;
+        for (size_t i = 0; i < q_vec.size(); ++i) {
+            auto [dim, val] = q_vec[i];
+            if (val < q_threshold) {
+                continue;
+            }
+            auto dim_it = dim_map_.find(dim);
+            if (dim_it == dim_map_.end()) {
+                continue;
+            }
+            q_dense[dim_it->second] = val;
+            q_terms.push_back({dim_it->second, val});
+        }
+        auto cut = std::min(q_terms.size(), params.query_cut);
+        std::partial_sort(q_terms.begin(), q_terms.begin() + cut, q_terms.end(),
+                          [](const auto& a, const auto& b) { return a.val > b.val; });
+
+        // docs already scored by this query.
+        auto& visited = ScoreAccumulator<float>::Acquire(n_rows_internal());
+        for (size_t t = 0; t < cut; ++t) {
+            auto term = q_terms[t].id;
+            for (auto block = term_blocks_[term]; block < term_blocks_[term + 1]; ++block) {
+                if (heap.full()) {
+                    float summary_score = 0.0f;
+                    for (auto s = summaries_begin_[block]; s < summaries_begin_[block + 1]; ++s) {
+                        summary_score += q_dense[summary_terms_[s]] * summary_vals_[s];
+                    }
+                    if (summary_score <= heap.top().val / params.heap_factor) {
+                        continue;
+                    }
+                }
+                for (auto d = block_docs_begin_[block]; d < block_docs_begin_[block + 1]; ++d) {
+                    auto id = block_docs_[d];
+                    if (visited.contains(id)) {
+                        continue;
+                    }
+                    visited.add(id, 0.0f);
+                    if (!bitset.empty() && bitset.test(id)) {
+                        continue;
+                    }
+                    auto score = q_vec.dot(raw_data_[id], computer, row_sum(id));
+                    if (score != 0) {
+                        heap.push(id, score);
+                    }
+                }
+            }
+        }
+        for (const auto& q_term : q_terms) {
+            q_dense[q_term.id] = 0.0f;
+        }
+    }
+
+    // blocks of a single posting list, each block is the ascending doc ids and the summary of the docs.
+    struct TermBlocks {
+        std::vector<std::vector<table_t>> docs;
+        std::vector<std::vector<std::pair<uint32_t, T>>> summaries;
+    };
+
+    // raw_data_ by term id while building: the non-zero values of row i are terms[begin[i], begin[i + 1]) and their
+    // doc values.
+    struct RowTerms {
+        std::vector<size_t> begin;
+        std::vector<uint32_t> terms;
+        std::vector<float> doc_values;
+    };
+
+    // per build task memory, reused across the terms the task builds. The terms of the docs of the posting list
+    // being built are given dense slots, so that the memory is sized to the terms the docs have rather than to all
+    // terms of the index.
+    struct BuildScratch {
+        // slot of term, the next free one if the term has none yet.
+        uint32_t
+        slot(uint32_t term) {
+            if ((slot_terms.size() + 1) * 2 > table.size()) {
+                rehash(std::max<size_t>(table.size() * 2, 1024));
+            }
+            auto mask = table.size() - 1;
+            for (size_t pos = (term * 0x9E3779B1u) & mask;; pos = (pos + 1) & mask) {
+                if (table[pos] == kNoSlot) {
+                    table[pos] = slot_terms.size();
+                    slot_terms.push_back(term);
+                    slot_positions.push_back(pos);
+                    return table[pos];
+                }
+                if (slot_terms[table[pos]] == term) {
+                    return table[pos];
+                }
+            }
+        }
+
+        // frees all slots, at the cost of the slots used rather than of the table.
+        void
+        clear_slots() {
+            for (auto pos : slot_positions) {
+                table[pos] = kNoSlot;
+            }
+            slot_terms.clear();
+            slot_positions.clear();
+        }
+
+        void
+        rehash(size_t size) {
+            table.assign(size, kNoSlot);
+            for (size_t s = 0; s < slot_terms.size(); ++s) {
+                size_t pos = (slot_terms[s] * 0x9E3779B1u) & (size - 1);
+                while (table[pos] != kNoSlot) {
+                    pos = (pos + 1) & (size - 1);
+                }
+                table[pos] = s;
+                slot_positions[s] = pos;
+            }
+        }
+
+        static constexpr uint32_t kNoSlot = std::numeric_limits<uint32_t>::max();
+        // open addressing hash table of the slots of the terms, at most half full, and the term of each slot and
+        // its position in the table.
+        std::vector<uint32_t> table;
+        std::vector<uint32_t> slot_terms;
+        std::vector<size_t> slot_positions;
+        // the slots of the terms of the i-th posting are posting_slots[posting_begin[i], posting_begin[i + 1]), in
+        // the order of row_terms.
+        std::vector<uint32_t> posting_slots;
+        std::vector<size_t> posting_begin;
+        // (centroid, doc value) of the centroids that have each slot.
+        std::vector<std::vector<std::pair<uint32_t, float>>> centroid_lut;
+        // max doc value of each slot in a block, -inf for the slots not in summary_slots.
+        std::vector<float> summary;
+        std::vector<uint32_t> summary_slots;
+    };
+
+    // builds the posting lists of raw_data_. Terms are assigned in the order the rows first use them, then the
+    // posting lists are pruned, clustered and summarized in parallel on the build pool.
+    void
+    build() {
+        auto rows = n_rows_internal();
+        if constexpr (bm25) {
+            row_sums_.resize(rows);
+            auto row_sums = row_sums_.mutable_data();
+            for (size_t i = 0; i < rows; ++i) {
+                row_sums[i] = 0;
+                for (size_t j = 0; j < raw_data_[i].size(); ++j) {
+                    row_sums[i] += raw_data_[i][j].val;
+                }
+            }
+        }
+        // postings[term] is the (doc id, doc value) of each posting of the term.
+        std::vector<std::vector<SparseIdVal<float>>> postings;
+        RowTerms row_terms;
+        row_terms.begin.reserve(rows + 1);
+        row_terms.begin.push_back(0);
+        for (size_t i = 0; i < rows; ++i) {
+            const auto& row = raw_data_[i];
+            for (size_t j = 0; j < row.size(); ++j) {
+                auto [dim, val] = row[j];
+                if (val == 0) {
+                    continue;
+                }
+                auto [dim_it, inserted] = dim_map_.try_emplace(dim, postings.size());
+                if (inserted) {
+                    term_dims_.push_back(dim);
+                    postings.emplace_back();
+                }
+                auto doc_value = build_doc_value(i, val);
+                postings[dim_it->second].push_back({static_cast<table_t>(i), doc_value});
+                row_terms.terms.push_back(dim_it->second);
+                row_terms.doc_values.push_back(doc_value);
+            }
+            row_terms.begin.push_back(row_terms.terms.size());
+        }
+
+        auto num_terms = postings.size();
+        std::vector<TermBlocks> blocks(num_terms);
+        auto build_pool = ThreadPool::GetGlobalBuildThreadPool();
+        size_t num_tasks = std::min<size_t>(build_pool->size(), num_terms);
+        auto build_terms = [&](size_t task) {
+            BuildScratch scratch;
+            // interleaved as the long posting lists of the frequent terms tend to come first.
+            for (auto term = task; term < num_terms; term += std::max<size_t>(num_tasks, 1)) {
+                blocks[term] = build_term(term, postings[term], row_terms, scratch);
+                std::vector<SparseIdVal<float>>().swap(postings[term]);
+            }
+        };
+        if (num_tasks <= 1) {
+            build_terms(0);
+        } else {
+            std::vector<folly::Future<folly::Unit>> futs;
+            futs.reserve(num_tasks);
+            for (size_t t = 0; t < num_tasks; ++t) {
+                futs.emplace_back(build_pool->push([&, t]() { build_terms(t); }));
+            }
+            WaitAllSuccess(futs);
+        }
+
+        term_blocks_.push_back(0);
+        block_docs_begin_.push_back(0);
+        summaries_begin_.push_back(0);
+        for (auto& term : blocks) {
+            for (size_t b = 0; b < term.docs.size(); ++b) {
+                for (auto id : term.docs[b]) {
+                    block_docs_.push_back(id);
+                }
+                block_docs_begin_.push_back(block_docs_.size());
+                for (auto [summary_term, val] : term.summaries[b]) {
+                    summary_terms_.push_back(summary_term);
+                    summary_vals_.push_back(val);
+                }
+                summaries_begin_.push_back(summary_terms_.size());
+            }
+            term_blocks_.push_back(block_docs_begin_.size() - 1);
+            // release memory as soon as possible.
+            term = TermBlocks();
+        }
+    }
+
+    // prunes the postings of a term to the n_postings largest doc values, picks centroid_fraction of the kept docs at
+    // random as centroids, and puts each doc in the block of the centroid with the largest inner product with it.
+    TermBlocks
+    build_term(uint32_t term, std::vector<SparseIdVal<float>>& list, const RowTerms& row_terms,
+               BuildScratch& scratch) const {
+        if (list.size() > build_params_.n_postings) {
+            std::nth_element(list.begin(), list.begin() + build_params_.n_postings, list.end(),
+                             [](const auto& a, const auto& b) { return a.val > b.val; });
+            list.resize(build_params_.n_postings);
+        }
+        auto n_centroids = std::clamp<size_t>(std::ceil(build_params_.centroid_fraction * list.size()), 1, list.size());
+        // seeded by the term so that builds are reproducible.
+        std::mt19937 rng(term);
+        std::vector<size_t> order(list.size());
+        std::iota(order.begin(), order.end(), 0);
+        for (size_t c = 0; c < n_centroids; ++c) {
+            std::swap(order[c], order[c + rng() % (list.size() - c)]);
+        }
+        scratch.clear_slots();
+        scratch.posting_slots.clear();
+        scratch.posting_begin.assign(1, 0);
+        for (const auto& posting : list) {
+            for (auto j = row_terms.begin[posting.id]; j < row_terms.begin[posting.id + 1]; ++j) {
+                scratch.posting_slots.push_back(scratch.slot(row_terms.terms[j]));
+            }
+            scratch.posting_begin.push_back(scratch.posting_slots.size());
+        }
+        if (scratch.summary.size() < scratch.slot_terms.size()) {
+            scratch.centroid_lut.resize(scratch.slot_terms.size());
+            scratch.summary.resize(scratch.slot_terms.size(), -std::numeric_limits<float>::infinity());
+        }
+        // calls func(slot, doc value) for each term of the i-th posting.
+        auto for_each_term = [&](size_t i, auto func) {
+            const auto* doc_values = row_terms.doc_values.data() + row_terms.begin[list[i].id];
+            for (auto j = scratch.posting_begin[i]; j < scratch.posting_begin[i + 1]; ++j) {
+                func(scratch.posting_slots[j], doc_values[j - scratch.posting_begin[i]]);
+            }
+        };
+
+        auto& centroid_lut = scratch.centroid_lut;
+        for (size_t c = 0; c < n_centroids; ++c) {
+            for_each_term(order[c], [&](uint32_t slot, float val) { centroid_lut[slot].emplace_back(c, val); });
+        }
+        // postings of each centroid's block.
+        std::vector<std::vector<size_t>> clusters(n_centroids);
+        std::vector<float> scores(n_centroids);
+        for (size_t i = 0; i < list.size(); ++i) {
+            std::fill(scores.begin(), scores.end(), 0.0f);
+            for_each_term(i, [&](uint32_t slot, float val) {
+                for (auto [c, centroid_val] : centroid_lut[slot]) {
+                    scores[c] += val * centroid_val;
+                }
+            });
+            auto best = std::max_element(scores.begin(), scores.end()) - scores.begin();
+            clusters[best].push_back(i);
+        }
+        for (size_t c = 0; c < n_centroids; ++c) {
+            for_each_term(order[c], [&](uint32_t slot, float) { centroid_lut[slot].clear(); });
+        }
+
+        TermBlocks blocks;
+        for (auto& postings : clusters) {
+            if (postings.empty()) {
+                continue;
+            }
+            std::sort(postings.begin(), postings.end(), [&](size_t a, size_t b) { return list[a].id < list[b].id; });
+            std::vector<table_t> docs;
+            docs.reserve(postings.size());
+            for (auto i : postings) {
+                docs.push_back(list[i].id);
+                for_each_term(i, [&](uint32_t slot, float val) {
+                    auto& max_value = scratch.summary[slot];
+                    if (max_value == -std::numeric_limits<float>::infinity()) {
+                        scratch.summary_slots.push_back(slot);
+                    }
+                    max_value = std::max(max_value, val);
+                });
+            }
+            blocks.docs.push_back(std::move(docs));
+            blocks.summaries.push_back(prune_summary(scratch));
+        }
+        return blocks;
+    }
+
+    // the largest values of the summary in scratch that add up to summary_energy of its total, as (term id, value)
+    // in term order. Resets the summary in scratch.
+    std::vector<std::pair<uint32_t, T>>
+    prune_summary(BuildScratch& scratch) const {
+        std::vector<std::pair<uint32_t, T>> entries;
+        entries.reserve(scratch.summary_slots.size());
+        float total = 0;
+        for (auto slot : scratch.summary_slots) {
+            entries.emplace_back(scratch.slot_terms[slot], scratch.summary[slot]);
+            total += std::abs(scratch.summary[slot]);
+            scratch.summary[slot] = -std::numeric_limits<float>::infinity();
+        }
+        scratch.summary_slots.clear();
+        std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+        float kept = 0;
+        size_t n = 0;
+        while (n < entries.size() && (n == 0 || kept < build_params_.summary_energy * total)) {
+            kept += std::abs(entries[n++].second);
+        }
+        entries.resize(n);
+        std::sort(entries.begin(), entries.end());
+        return entries;
+    }
+
+    // loads the layout written by Save(), reader memory must outlive the index.
+    Status
+    load_view(MemoryIOReader& reader) {
+        uint32_t version;
+        uint8_t saved_bm25;
+        uint64_t rows;
+        uint64_t cols;
+        readBinaryPOD(reader, version);
+        if (version != kFormatVersion) {
+            LOG_KNOWHERE_ERROR_ << "Unsupported sparse seismic index format version " << version;
+            return Status::invalid_binary_set;
+        }
+        readBinaryPOD(reader, saved_bm25);
+        if (saved_bm25 != bm25) {
+            LOG_KNOWHERE_ERROR_ << "Sparse seismic index saved with a different metric type";
+            return Status::invalid_binary_set;
+        }
+        readBinaryPOD(reader, rows);
+        readBinaryPOD(reader, cols);
+        max_dim_ = cols;
+        raw_data_.reserve(rows);
+        for (uint64_t i = 0; i < rows; ++i) {
+            size_t count;
+            readBinaryPOD(reader, count);
+            raw_data_.emplace_back(count, reader.data() + reader.tellg(), false);
+            reader.advance(count * SparseRow<T>::element_size());
+        }
+        if constexpr (bm25) {
+            row_sums_.LoadView(reader);
+        }
+        term_dims_.LoadView(reader);
+        term_blocks_.LoadView(reader);
+        block_docs_begin_.LoadView(reader);
+        block_docs_.LoadView(reader);
+        summaries_begin_.LoadView(reader);
+        summary_terms_.LoadView(reader);
+        summary_vals_.LoadView(reader);
+        dim_map_.reserve(term_dims_.size());
+        for (size_t term = 0; term < term_dims_.size(); ++term) {
+            dim_map_.emplace(term_dims_[term], term);
+        }
+        return Status::success;
+    }
+
+    static constexpr uint32_t kFormatVersion = 1;
+
+    SeismicBuildParams build_params_;
+    std::vector<SparseRow<T>> raw_data_;
+    mutable std::shared_mutex mu_;
+    // copy of the serialized index used in place after a non-mmap load.
+    std::unique_ptr<uint8_t[]> serialized_;
+    size_t serialized_size_ = 0;
+    size_t max_dim_ = 0;
+
+    // dense term id of each dim that has a posting list, see InvertedIndex::dim_map_.
+    std::unordered_map<table_t, uint32_t> dim_map_;
+    FlatArray<table_t> term_dims_;
+    // the blocks of term t are [term_blocks_[t], term_blocks_[t + 1]).
+    FlatArray<uint64_t> term_blocks_;
+    // the docs of block b are block_docs_[block_docs_begin_[b], block_docs_begin_[b + 1]).
+    FlatArray<uint64_t> block_docs_begin_;
+    FlatArray<table_t> block_docs_;
+    // the summary of block b is the (term id, value) pairs of summary_terms_ and summary_vals_ in
+    // [summaries_begin_[b], summaries_begin_[b + 1]).
+    FlatArray<uint64_t> summaries_begin_;
+    FlatArray<uint32_t> summary_terms_;
+    FlatArray<T> summary_vals_;
+    // sum of values of each row, the document length in BM25. Only for BM25.
+    FlatArray<float> row_sums_;
+
+    struct BM25Params {
+        float k1;
+        float b;
+        // computes the doc values of build_doc_value() with the avgdl of the build.
+        DocValueBM25Computer<T> build_computer;
+    };
+    std::unique_ptr<BM25Params> bm25_params_;
+};  // class SeismicIndex
+
+}  // namespace knowhere::sparse
+
+#endif  // SPARSE_SEISMIC_INDEX_H
@@ -0,0 +1,421 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <sys/mman.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "index/vamana/vamana_config.h"
+#include "index/vamana/vamana_index.h"
+#include "io/file_io.h"
+#include "io/memory_io.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/comp/thread_pool.h"
+#include "knowhere/comp/time_recorder.h"
+#include "knowhere/config.h"
+#include "knowhere/dataset.h"
+#include "knowhere/expected.h"
+#include "knowhere/index/index_factory.h"
+#include "knowhere/index/index_node.h"
+#include "knowhere/log.h"
+#include "knowhere/range_util.h"
+#include "knowhere/utils.h"
+
+namespace knowhere {
+
+// In-memory index over a Vamana graph, the graph of DiskANN, see vamana::VamanaIndex.
+//
+// The graph is static once built: vectors can't be added to it, and deletes are left to the bitset.
+template <typename DataType>
+class VamanaIndexNode : public IndexNode {
+    static_assert(KnowhereFloatTypeCheck<DataType>::value, "Vamana only supports floating point data");
+
+ public:
+    VamanaIndexNode(const int32_t& /*version*/, const Object& /*object*/) {
+        search_pool_ = ThreadPool::GetGlobalSearchThreadPool();
+    }
+
+    ~VamanaIndexNode() override {
+        DeleteExistingIndex();
+    }
+
+    Status
+    Build(const DataSetPtr dataset, const Config& cfg) override {
+        auto vamana_cfg = static_cast<const VamanaConfig&>(cfg);
+        auto metric = ParseMetric(vamana_cfg.metric_type.value());
+        if (!metric.has_value()) {
+            LOG_KNOWHERE_ERROR_ << "Invalid metric type for Vamana: " << vamana_cfg.metric_type.value();
+            return Status::invalid_metric_type;
+        }
+        auto rows = dataset->GetRows();
+        if (rows <= 0) {
+            LOG_KNOWHERE_ERROR_ << "Can not build Vamana index on empty data.";
+            return Status::empty_index;
+        }
+        if (rows > std::numeric_limits<uint32_t>::max()) {
+            LOG_KNOWHERE_ERROR_ << "Vamana index supports at most " << std::numeric_limits<uint32_t>::max()
+                                << " vectors, got " << rows;
+            return Status::invalid_args;
+        }
+        DeleteExistingIndex();
+
+        knowhere::TimeRecorder build_time("Building Vamana cost", 2);
+        auto index = std::make_unique<vamana::VamanaIndex<DataType>>();
+        RETURN_IF_ERROR(TryVamanaCall([&]() {
+            index->Build(static_cast<const DataType*>(dataset->GetTensor()), rows, dataset->GetDim(), metric.value(),
+                         vamana_cfg.max_degree.value(), vamana_cfg.search_list_size.value(),
+                         vamana_cfg.alpha.value());
+        }));
+        build_time.RecordSection("graph build");
+        index_ = std::move(index);
+        return Status::success;
+    }
+
+    Status
+    Train(const DataSetPtr dataset, const Config& cfg) override {
+        return Status::not_implemented;
+    }
+
+    Status
+    Add(const DataSetPtr dataset, const Config& cfg) override {
+        LOG_KNOWHERE_ERROR_ << "Vamana index is static, vectors can't be added to it.";
+        return Status::not_implemented;
+    }
+
+    expected<DataSetPtr>
+    Search(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const override {
+        if (!index_) {
+            LOG_KNOWHERE_WARNING_ << "search on empty index";
+            return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+        }
+        auto vamana_cfg = static_cast<const VamanaConfig&>(cfg);
+        auto nq = dataset->GetRows();
+        auto xq = static_cast<const DataType*>(dataset->GetTensor());
+        auto k = vamana_cfg.k.value();
+        auto search_list_size = vamana_cfg.search_list_size.value();
+        bool transform = index_->metric() != vamana::Metric::L2;
+
+        auto p_id = std::make_unique<int64_t[]>(k * nq);
+        auto p_dist = std::make_unique<float[]>(k * nq);
+        std::vector<folly::Future<folly::Unit>> futs;
+        futs.reserve(nq);
+        for (int64_t i = 0; i < nq; ++i) {
+            futs.emplace_back(search_pool_->push([&, idx = i, p_id_ptr = p_id.get(), p_dist_ptr = p_dist.get()]() {
+                auto query = PrepareQuery(xq + idx * Dim());
+                auto p_single_id = p_id_ptr + idx * k;
+                auto p_single_dis = p_dist_ptr + idx * k;
+                index_->Search(query.data(), k, search_list_size, bitset, p_single_id, p_single_dis);
+                if (transform) {
+                    for (int64_t j = 0; j < k && p_single_id[j] != -1; ++j) {
+                        p_single_dis[j] = -p_single_dis[j];
+                    }
+                }
+            }));
+        }
+        WaitAllSuccess(futs);
+        return GenResultDataSet(nq, k, std::move(p_id), std::move(p_dist));
+    }
+
+    expected<DataSetPtr>
+    RangeSearch(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const override {
+        if (!index_) {
+            LOG_KNOWHERE_WARNING_ << "range search on empty index";
+            return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+        }
+        auto vamana_cfg = static_cast<const VamanaConfig&>(cfg);
+        auto nq = dataset->GetRows();
+        auto xq = static_cast<const DataType*>(dataset->GetTensor());
+        auto search_list_size = vamana_cfg.search_list_size.value();
+        bool is_ip = index_->metric() != vamana::Metric::L2;
+        float range_filter = vamana_cfg.range_filter.value();
+        float radius_for_calc = is_ip ? -vamana_cfg.radius.value() : vamana_cfg.radius.value();
+        float radius_for_filter = vamana_cfg.radius.value();
+
+        std::vector<std::vector<int64_t>> result_id_array(nq);
+        std::vector<std::vector<float>> result_dist_array(nq);
+        std::vector<folly::Future<folly::Unit>> futs;
+        futs.reserve(nq);
+        for (int64_t i = 0; i < nq; ++i) {
+            futs.emplace_back(search_pool_->push([&, idx = i]() {
+                auto query = PrepareQuery(xq + idx * Dim());
+                auto rst = index_->RangeSearch(query.data(), radius_for_calc, search_list_size, bitset);
+                result_dist_array[idx].resize(rst.size());
+                result_id_array[idx].resize(rst.size());
+                for (size_t j = 0; j < rst.size(); ++j) {
+                    result_dist_array[idx][j] = is_ip ? -rst[j].first : rst[j].first;
+                    result_id_array[idx][j] = rst[j].second;
+                }
+                if (range_filter != defaultRangeFilter) {
+                    FilterRangeSearchResultForOneNq(result_dist_array[idx], result_id_array[idx], is_ip,
+                                                    radius_for_filter, range_filter);
+                }
+            }));
+        }
+        WaitAllSuccess(futs);
+
+        auto range_search_result =
+            GetRangeSearchResult(result_dist_array, result_id_array, is_ip, nq, radius_for_filter, range_filter);
+        return GenResultDataSet(nq, std::move(range_search_result));
+    }
+
+ private:
+    class iterator : public IndexIterator {
+     public:
+        iterator(const vamana::VamanaIndex<DataType>* index, std::vector<float>&& query, const bool transform,
+                 const BitsetView& bitset, const size_t search_list_size)
+            : IndexIterator(transform),
+              index_(index),
+              transform_(transform),
+              search_list_size_(search_list_size),
+              workspace_(index_->CreateIteratorWorkspace(query.data(), bitset)) {
+        }
+
+     protected:
+        void
+        next_batch(std::function<void(const std::vector<DistId>&)> batch_handler) override {
+            index_->NextBatch(*workspace_, search_list_size_, dists_);
+            if (transform_) {
+                for (auto& p : dists_) {
+                    p.val = -p.val;
+                }
+            }
+            batch_handler(dists_);
+            dists_.clear();
+        }
+
+     private:
+        const vamana::VamanaIndex<DataType>* index_;
+        const bool transform_;
+        const size_t search_list_size_;
+        std::unique_ptr<typename vamana::VamanaIndex<DataType>::IteratorWorkspace> workspace_;
+        std::vector<DistId> dists_;
+    };
+
+ public:
+    expected<std::vector<IndexNode::IteratorPtr>>
+    AnnIterator(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const override {
+        if (!index_) {
+            LOG_KNOWHERE_WARNING_ << "creating iterator on empty index";
+            return expected<std::vector<IndexNode::IteratorPtr>>::Err(Status::empty_index, "index not loaded");
+        }
+        auto vamana_cfg = static_cast<const VamanaConfig&>(cfg);
+        auto nq = dataset->GetRows();
+        auto xq = static_cast<const DataType*>(dataset->GetTensor());
+        auto search_list_size = vamana_cfg.search_list_size.value_or(kVamanaIteratorSeedListSize);
+        bool transform = index_->metric() != vamana::Metric::L2;
+
+        auto vec = std::vector<IndexNode::IteratorPtr>(nq, nullptr);
+        std::vector<folly::Future<folly::Unit>> futs;
+        futs.reserve(nq);
+        for (int64_t i = 0; i < nq; ++i) {
+            futs.emplace_back(search_pool_->push([&, i]() {
+                auto it = std::make_shared<iterator>(index_.get(), PrepareQuery(xq + i * Dim()), transform, bitset,
+                                                     search_list_size);
+                it->initialize();
+                vec[i] = it;
+            }));
+        }
+        // wait for the initial search of the iterators to finish
+        WaitAllSuccess(futs);
+        return vec;
+    }
+
+    expected<DataSetPtr>
+    GetVectorByIds(const DataSetPtr dataset) const override {
+        if (!index_) {
+            return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
+        }
+        auto dim = Dim();
+        auto rows = dataset->GetRows();
+        auto ids = dataset->GetIds();
+        auto data = std::make_unique<DataType[]>(dim * rows);
+        for (int64_t i = 0; i < rows; i++) {
+            int64_t id = ids[i];
+            if (id < 0 || id >= Count()) {
+                return expected<DataSetPtr>::Err(Status::invalid_args, "id " + std::to_string(id) + " out of range");
+            }
+            std::copy_n(index_->GetRow(id), dim, data.get() + i * dim);
+        }
+        return GenResultDataSet(rows, dim, data.release());
+    }
+
+    bool
+    HasRawData(const std::string& metric_type) const override {
+        return true;
+    }
+
+    expected<DataSetPtr>
+    GetIndexMeta(const Config& cfg) const override {
+        return expected<DataSetPtr>::Err(Status::not_implemented, "GetIndexMeta not implemented");
+    }
+
+    Status
+    Serialize(BinarySet& binset) const override {
+        if (!index_) {
+            LOG_KNOWHERE_ERROR_ << "Can not serialize empty Vamana index.";
+            return Status::empty_index;
+        }
+        return TryVamanaCall([&]() {
+            MemoryIOWriter writer;
+            index_->Save(writer);
+            std::shared_ptr<uint8_t[]> data(writer.data());
+            binset.Append(Type(), data, writer.tellg());
+        });
+    }
+
+    Status
+    Deserialize(const BinarySet& binset, const Config& config) override {
+        DeleteExistingIndex();
+        auto binary = binset.GetByName(Type());
+        if (binary == nullptr) {
+            LOG_KNOWHERE_ERROR_ << "Invalid binary set.";
+            return Status::invalid_binary_set;
+        }
+        MemoryIOReader reader(binary->data.get(), binary->size);
+        auto index = std::make_unique<vamana::VamanaIndex<DataType>>();
+        RETURN_IF_ERROR(index->Load(reader, false));
+        index_ = std::move(index);
+        return Status::success;
+    }
+
+    // With enable_mmap the index is searched in place in the mapped file, otherwise the file is read into memory.
+    Status
+    DeserializeFromFile(const std::string& filename, const Config& config) override {
+        DeleteExistingIndex();
+        auto cfg = static_cast<const VamanaConfig&>(config);
+        const bool use_mmap = cfg.enable_mmap.value();
+        Status status = Status::success;
+        try {
+            auto reader = knowhere::FileReader(filename);
+            map_size_ = reader.size();
+            int map_flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+            if (cfg.enable_mmap_pop.has_value() && cfg.enable_mmap_pop.value()) {
+                map_flags |= MAP_POPULATE;
+            }
+#endif
+            map_ = static_cast<char*>(mmap(nullptr, map_size_, PROT_READ, map_flags, reader.descriptor(), 0));
+            if (map_ == MAP_FAILED) {
+                LOG_KNOWHERE_ERROR_ << "Failed to mmap file: " << strerror(errno);
+                map_ = nullptr;
+                map_size_ = 0;
+                return Status::disk_file_error;
+            }
+            if (madvise(map_, map_size_, MADV_RANDOM) != 0) {
+                LOG_KNOWHERE_WARNING_ << "Failed to madvise file: " << strerror(errno);
+            }
+            MemoryIOReader map_reader((uint8_t*)map_, map_size_);
+            auto index = std::make_unique<vamana::VamanaIndex<DataType>>();
+            status = index->Load(map_reader, use_mmap);
+            if (status == Status::success) {
+                index_ = std::move(index);
+            }
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "Vamana inner error: " << e.what();
+            status = Status::diskann_inner_error;
+        }
+        if (status != Status::success || !use_mmap) {
+            UnmapFile();
+        }
+        return status;
+    }
+
+    std::unique_ptr<BaseConfig>
+    CreateConfig() const override {
+        return std::make_unique<VamanaConfig>();
+    }
+
+    int64_t
+    Dim() const override {
+        return index_ ? index_->dim() : 0;
+    }
+
+    int64_t
+    Size() const override {
+        return index_ ? index_->size() : 0;
+    }
+
+    int64_t
+    Count() const override {
+        return index_ ? index_->n_rows() : 0;
+    }
+
+    std::string
+    Type() const override {
+        return knowhere::IndexEnum::INDEX_VAMANA;
+    }
+
+ private:
+    static std::optional<vamana::Metric>
+    ParseMetric(const std::string& metric_type) {
+        if (IsMetricType(metric_type, metric::L2)) {
+            return vamana::Metric::L2;
+        } else if (IsMetricType(metric_type, metric::IP)) {
+            return vamana::Metric::IP;
+        } else if (IsMetricType(metric_type, metric::COSINE)) {
+            return vamana::Metric::COSINE;
+        }
+        return std::nullopt;
+    }
+
+    template <typename Func>
+    static Status
+    TryVamanaCall(Func&& func) {
+        try {
+            func();
+        } catch (const std::exception& e) {
+            LOG_KNOWHERE_WARNING_ << "Vamana inner error: " << e.what();
+            return Status::diskann_inner_error;
+        }
+        return Status::success;
+    }
+
+    // the fp32 query the index searches with, normalized for COSINE
+    std::vector<float>
+    PrepareQuery(const DataType* xq) const {
+        std::vector<float> query(xq, xq + Dim());
+        if (index_->metric() == vamana::Metric::COSINE) {
+            NormalizeVec(query.data(), Dim());
+        }
+        return query;
+    }
+
+    void
+    UnmapFile() {
+        if (map_ != nullptr) {
+            if (munmap(map_, map_size_) != 0) {
+                LOG_KNOWHERE_ERROR_ << "Failed to munmap when trying to delete index: " << strerror(errno);
+            }
+            map_ = nullptr;
+            map_size_ = 0;
+        }
+    }
+
+    void
+    DeleteExistingIndex() {
+        index_.reset();
+        UnmapFile();
+    }
+
+    std::unique_ptr<vamana::VamanaIndex<DataType>> index_;
+    std::shared_ptr<ThreadPool> search_pool_;
+
+    // if map_ is not nullptr, the index is searched in place in the file mapped there.
+    char* map_ = nullptr;
+    size_t map_size_ = 0;
+};
+
+KNOWHERE_SIMPLE_REGISTER_GLOBAL(VAMANA, VamanaIndexNode, fp32);
+KNOWHERE_SIMPLE_REGISTER_GLOBAL(VAMANA, VamanaIndexNode, fp16);
+KNOWHERE_SIMPLE_REGISTER_GLOBAL(VAMANA, VamanaIndexNode, bf16);
+
+}  // namespace knowhere
@@ -0,0 +1,95 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef VAMANA_CONFIG_H
+#define VAMANA_CONFIG_H
+
+#include "knowhere/config.h"
+
+namespace knowhere {
+
+namespace {
+
+constexpr const CFG_INT::value_type kVamanaSearchListSizeMinValue = 16;
+constexpr const CFG_INT::value_type kVamanaDefaultSearchListSizeForBuild = 128;
+constexpr const CFG_INT::value_type kVamanaDefaultRangeSearchListSize = 16;
+constexpr const CFG_INT::value_type kVamanaIteratorSeedListSize = 40;
+
+}  // namespace
+
+class VamanaConfig : public BaseConfig {
+ public:
+    // The maximum out degree of the graph. Larger values give better recall per hop at the cost of memory, 4 bytes
+    // per neighbor per vector, and of a longer build.
+    CFG_INT max_degree;
+    // The size of the search list during the index build or (knn/range) search, the ef of HNSW. Larger values take
+    // more time but give better recall; for search it must not be smaller than k.
+    CFG_INT search_list_size;
+    // The pruning slack of the build. A neighbor is dropped only if a kept neighbor is alpha times closer to it than
+    // the node is, so values above 1 keep longer edges that let the search reach far parts of the graph in fewer hops.
+    CFG_FLOAT alpha;
+    KNOHWERE_DECLARE_CONFIG(VamanaConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(max_degree)
+            .description("the degree of the graph index.")
+            .set_default(48)
+            .set_range(1, 2048)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(search_list_size)
+            .description("the size of search list during the index build or search.")
+            .allow_empty_without_default()
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_train()
+            .for_search()
+            .for_range_search()
+            .for_iterator();
+        KNOWHERE_CONFIG_DECLARE_FIELD(alpha)
+            .description("the pruning slack of the graph build.")
+            .set_default(1.2f)
+            .set_range(1.0f, 2.0f)
+            .for_train();
+    }
+
+    Status
+    CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
+        switch (param_type) {
+            case PARAM_TYPE::TRAIN: {
+                if (!search_list_size.has_value()) {
+                    search_list_size = kVamanaDefaultSearchListSizeForBuild;
+                }
+                break;
+            }
+            case PARAM_TYPE::SEARCH: {
+                if (!search_list_size.has_value()) {
+                    search_list_size = std::max(k.value(), kVamanaSearchListSizeMinValue);
+                } else if (k.value() > search_list_size.value()) {
+                    *err_msg = "search_list_size(" + std::to_string(search_list_size.value()) +
+                               ") should be larger than k(" + std::to_string(k.value()) + ")";
+                    LOG_KNOWHERE_ERROR_ << *err_msg;
+                    return Status::out_of_range_in_json;
+                }
+                break;
+            }
+            case PARAM_TYPE::RANGE_SEARCH: {
+                if (!search_list_size.has_value()) {
+                    search_list_size = kVamanaDefaultRangeSearchListSize;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        return Status::success;
+    }
+};
+
+}  // namespace knowhere
+
+#endif /* VAMANA_CONFIG_H */
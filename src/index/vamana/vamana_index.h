@@ -0,0 +1,648 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef VAMANA_INDEX_H
+#define VAMANA_INDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "diskann/index.h"
+#include "io/memory_io.h"
+#include "knowhere/bitsetview.h"
+#include "knowhere/expected.h"
+#include "knowhere/log.h"
+#include "knowhere/operands.h"
+#include "knowhere/utils.h"
+#include "simd/hook.h"
+#include "tsl/robin_set.h"
+
+namespace knowhere::vamana {
+
+enum class Metric : uint32_t {
+    L2 = 0,
+    IP = 1,
+    COSINE = 2,
+};
+
+// distances between a fp32 query and a base row, that is read in place.
+template <typename DataType>
+struct RowDistance {};
+
+template <>
+struct RowDistance<fp32> {
+    static float
+    L2sqr(const float* x, const fp32* y, size_t d) {
+        return faiss::fvec_L2sqr(x, y, d);
+    }
+    static float
+    InnerProduct(const float* x, const fp32* y, size_t d) {
+        return faiss::fvec_inner_product(x, y, d);
+    }
+    static float
+    NormL2sqr(const fp32* x, size_t d) {
+        return faiss::fvec_norm_L2sqr(x, d);
+    }
+};
+
+template <>
+struct RowDistance<fp16> {
+    static float
+    L2sqr(const float* x, const fp16* y, size_t d) {
+        return faiss::fp16_vec_L2sqr(x, y, d);
+    }
+    static float
+    InnerProduct(const float* x, const fp16* y, size_t d) {
+        return faiss::fp16_vec_inner_product(x, y, d);
+    }
+    static float
+    NormL2sqr(const fp16* x, size_t d) {
+        return faiss::fp16_vec_norm_L2sqr(x, d);
+    }
+};
+
+template <>
+struct RowDistance<bf16> {
+    static float
+    L2sqr(const float* x, const bf16* y, size_t d) {
+        return faiss::bf16_vec_L2sqr(x, y, d);
+    }
+    static float
+    InnerProduct(const float* x, const bf16* y, size_t d) {
+        return faiss::bf16_vec_inner_product(x, y, d);
+    }
+    static float
+    NormL2sqr(const bf16* x, size_t d) {
+        return faiss::bf16_vec_norm_L2sqr(x, d);
+    }
+};
+
+// A Vamana graph over the raw vectors, searched in memory.
+//
+// The graph is built by diskann::Index, the builder of the DiskANN disk index, over fp32 copies of the vectors in
+// which L2 distance orders the neighbors as the metric does: normalized vectors for COSINE, and for IP the vectors
+// scaled by the max norm M with an extra coordinate sqrt(1 - |x|^2 / M^2), the same transform as the disk index.
+// It is then flattened into a fixed degree adjacency array next to the raw vectors, and searched with the metric
+// itself, so no transformed copy is kept.
+//
+// Distances are "smaller is closer" inside the index: L2 distances, and negated IP or cosine similarities.
+//
+// The index is a single read only buffer, laid out as:
+//  1. a Header
+//  2. for each node, its number of neighbors then max_degree neighbor ids, all uint32_t
+//  3. for COSINE, the inverse norm of each vector, as float
+//  4. the vectors, as DataType
+// Each part starts at a multiple of kSerializedAlignment bytes from the start of the buffer. The buffer is
+// also the serialized index, so a serialized index can be searched in place, e.g. in an mmapped file.
+template <typename DataType>
+class VamanaIndex {
+ public:
+    // (distance, id), so that the default comparison orders by distance.
+    using Candidate = std::pair<float, uint32_t>;
+
+    // The rows a search visited, and a buffer for the neighbors of a node it did not.
+    struct SearchScratch {
+        tsl::robin_set<uint32_t> visited;
+        std::vector<uint32_t> unvisited;
+    };
+
+    // Builds the index over `n` rows of `dim` values. Throws diskann::ANNException if the graph build fails.
+    void
+    Build(const DataType* data, size_t n, size_t dim, Metric metric, uint32_t max_degree, uint32_t search_list_size,
+          float alpha) {
+        const bool is_ip = metric == Metric::IP;
+        const size_t graph_dim = is_ip ? dim + 1 : dim;
+        std::vector<float> graph_data(n * graph_dim);
+        float max_norm = 0.0f;
+        if (is_ip) {
+            for (size_t i = 0; i < n; i++) {
+                max_norm = std::max(max_norm, RowDistance<DataType>::NormL2sqr(data + i * dim, dim));
+            }
+            max_norm = max_norm > 0.0f ? std::sqrt(max_norm) : 1.0f;
+        }
+        for (size_t i = 0; i < n; i++) {
+            const DataType* src = data + i * dim;
+            float* dst = graph_data.data() + i * graph_dim;
+            for (size_t j = 0; j < dim; j++) {
+                dst[j] = (float)src[j];
+            }
+            if (metric == Metric::COSINE) {
+                NormalizeVec(dst, dim);
+            } else if (is_ip) {
+                for (size_t j = 0; j < dim; j++) {
+                    dst[j] /= max_norm;
+                }
+                dst[dim] = std::sqrt(std::max(0.0f, 1.0f - faiss::fvec_norm_L2sqr(dst, dim)));
+            }
+        }
+
+        diskann::Parameters params;
+        params.Set<unsigned>("L", search_list_size);
+        params.Set<unsigned>("R", max_degree);
+        params.Set<unsigned>("C", kBuildMaxCandidates);
+        params.Set<float>("alpha", alpha);
+        params.Set<unsigned>("num_rnds", 2);
+        params.Set<bool>("saturate_graph", false);
+        params.Set<bool>("accelerate_build", false);
+        params.Set<bool>("shuffle_build", false);
+        // the builder, with its copy of the vectors, is gone before the graph is laid out.
+        std::vector<std::vector<unsigned>> graph;
+        uint32_t entry_point = 0;
+        {
+            diskann::Index<float> builder(diskann::Metric::L2, is_ip, graph_dim, n, false, false);
+            builder.build(graph_data.data(), n, params);
+            graph = builder.release_graph();
+            entry_point = builder.get_entry_point();
+        }
+        std::vector<float>().swap(graph_data);
+
+        graph.resize(n);
+        auto repaired = RepairConnectivity(graph, entry_point, max_degree);
+        size_t width = 0;
+        for (size_t i = 0; i < n; i++) {
+            width = std::max(width, graph[i].size());
+        }
+
+        Header header{kFormatMarker, static_cast<uint32_t>(metric), dim, n, static_cast<uint32_t>(width),
+                      entry_point};
+        owned_size_ = LayoutSize(header);
+        owned_ = std::make_unique<uint8_t[]>(owned_size_);
+        std::memset(owned_.get(), 0, owned_size_);
+        std::memcpy(owned_.get(), &header, sizeof(header));
+        Bind(owned_.get(), owned_size_);
+
+        uint32_t* nhoods = const_cast<uint32_t*>(nhoods_);
+        for (size_t i = 0; i < n; i++) {
+            uint32_t* nhood = nhoods + i * (width + 1);
+            nhood[0] = graph[i].size();
+            std::copy(graph[i].begin(), graph[i].end(), nhood + 1);
+            std::vector<unsigned>().swap(graph[i]);
+        }
+        std::memcpy(const_cast<DataType*>(data_), data, n * dim * sizeof(DataType));
+        if (metric == Metric::COSINE) {
+            float* inv_norms = const_cast<float*>(inv_norms_);
+            for (size_t i = 0; i < n; i++) {
+                float norm = std::sqrt(RowDistance<DataType>::NormL2sqr(data + i * dim, dim));
+                inv_norms[i] = norm > 0.0f ? 1.0f / norm : 0.0f;
+            }
+        }
+        LOG_KNOWHERE_INFO_ << "Vamana graph built over " << n << " vectors, max degree " << width << ", entry point "
+                           << entry_point_ << ", " << repaired << " unreachable vectors linked";
+    }
+
+    void
+    Save(MemoryIOWriter& writer) const {
+        writer.write(base_, size_);
+    }
+
+    // The layout is used in place. If is_mmap, reader memory must outlive the index, otherwise it is copied once. The
+    // neighbor ids are checked, only those of the entry point if is_mmap, as a mapped layout isn't read through.
+    Status
+    Load(MemoryIOReader& reader, bool is_mmap) {
+        const uint8_t* base = reader.data() + reader.tellg();
+        const size_t size = reader.total_ - reader.tellg();
+        Header header;
+        if (size < sizeof(header)) {
+            LOG_KNOWHERE_ERROR_ << "Vamana index is truncated: " << size << " bytes";
+            return Status::invalid_binary_set;
+        }
+        std::memcpy(&header, base, sizeof(header));
+        if (header.marker != kFormatMarker || header.metric > static_cast<uint32_t>(Metric::COSINE) ||
+            LayoutSize(header) > size || (header.n > 0 && header.entry_point >= header.n)) {
+            LOG_KNOWHERE_ERROR_ << "Invalid Vamana index layout.";
+            return Status::invalid_binary_set;
+        }
+        const size_t layout_size = LayoutSize(header);
+        const size_t check_begin = is_mmap ? header.entry_point : 0;
+        const size_t check_end = is_mmap ? std::min<size_t>(header.n, header.entry_point + 1) : header.n;
+        if (!ValidNhoods(base, header, check_begin, check_end)) {
+            LOG_KNOWHERE_ERROR_ << "Invalid Vamana index neighbors.";
+            return Status::invalid_binary_set;
+        }
+        if (!is_mmap) {
+            owned_size_ = layout_size;
+            owned_ = std::make_unique<uint8_t[]>(owned_size_);
+            std::memcpy(owned_.get(), base, owned_size_);
+            base = owned_.get();
+        }
+        Bind(base, layout_size);
+        reader.advance(layout_size);
+        return Status::success;
+    }
+
+    // Writes the `k` closest rows allowed by `bitset` to `ids` and `distances`, closest first, padded with -1 ids
+    // and infinite distances. `query` is fp32 and normalized for COSINE.
+    void
+    Search(const float* query, size_t k, size_t search_list_size, const BitsetView& bitset, int64_t* ids,
+           float* distances) const {
+        std::vector<Candidate> result;
+        if (n_ > 0 && bitset.count() < n_) {
+            if (bitset.count() >= n_ * kBruteForceFilterThreshold) {
+                result = BruteForceSearch(query, k, bitset);
+            } else {
+                SearchScratch scratch;
+                std::priority_queue<Candidate> top;
+                BeamSearch(query, std::max(k, search_list_size), bitset, scratch, top, [](const Candidate&) {});
+                while (top.size() > k) {
+                    top.pop();
+                }
+                result.resize(top.size());
+                for (size_t i = top.size(); i > 0; i--) {
+                    result[i - 1] = top.top();
+                    top.pop();
+                }
+            }
+        }
+        for (size_t i = 0; i < k; i++) {
+            if (i < result.size()) {
+                distances[i] = result[i].first;
+                ids[i] = result[i].second;
+            } else {
+                distances[i] = std::numeric_limits<float>::infinity();
+                ids[i] = -1;
+            }
+        }
+    }
+
+    // Returns the rows allowed by `bitset` closer than `radius` in an arbitrary order. The graph is searched for the
+    // closest rows first, then expanded from the rows within the radius until no neighbor of them is.
+    std::vector<Candidate>
+    RangeSearch(const float* query, float radius, size_t search_list_size, const BitsetView& bitset) const {
+        std::vector<Candidate> result;
+        if (n_ == 0 || bitset.count() >= n_) {
+            return result;
+        }
+        SearchScratch scratch;
+        std::priority_queue<Candidate> top;
+        std::vector<uint32_t> frontier;
+        auto visit = [&](const Candidate& c) {
+            if (c.first < radius) {
+                frontier.push_back(c.second);
+                if (!Filtered(bitset, c.second)) {
+                    result.push_back(c);
+                }
+            }
+        };
+        BeamSearch(query, search_list_size, bitset, scratch, top, visit);
+        while (!frontier.empty()) {
+            auto id = frontier.back();
+            frontier.pop_back();
+            ExpandNode(query, id, scratch, visit);
+        }
+        return result;
+    }
+
+    // The state of an iterator over the rows closest to a query.
+    struct IteratorWorkspace {
+        std::vector<float> query;
+        SearchScratch scratch;
+        // the visited rows not expanded by the iterator, and whether they were returned.
+        std::priority_queue<std::tuple<float, uint32_t, bool>, std::vector<std::tuple<float, uint32_t, bool>>,
+                            std::greater<>>
+            to_visit;
+        BitsetView bitset;
+        bool initial_search_done = false;
+    };
+
+    std::unique_ptr<IteratorWorkspace>
+    CreateIteratorWorkspace(const float* query, const BitsetView& bitset) const {
+        auto workspace = std::make_unique<IteratorWorkspace>();
+        workspace->query.assign(query, query + dim_);
+        workspace->bitset = bitset;
+        return workspace;
+    }
+
+    // The first batch is every row the search for the closest `search_list_size` rows visits, later batches are the
+    // next closest unreturned row found by expanding the closest row not expanded yet, as hnswlib's iterator does.
+    void
+    NextBatch(IteratorWorkspace& workspace, size_t search_list_size, std::vector<DistId>& batch) const {
+        const auto& bitset = workspace.bitset;
+        if (n_ == 0 || bitset.count() >= n_) {
+            return;
+        }
+        const float* query = workspace.query.data();
+        if (!workspace.initial_search_done) {
+            workspace.initial_search_done = true;
+            std::priority_queue<Candidate> top;
+            BeamSearch(query, search_list_size, bitset, workspace.scratch, top, [&](const Candidate& c) {
+                workspace.to_visit.emplace(c.first, c.second, true);
+                if (!Filtered(bitset, c.second)) {
+                    batch.emplace_back(c.second, c.first);
+                }
+            });
+            return;
+        }
+        while (!workspace.to_visit.empty()) {
+            auto [dist, id, returned] = workspace.to_visit.top();
+            workspace.to_visit.pop();
+            ExpandNode(query, id, workspace.scratch,
+                       [&](const Candidate& c) { workspace.to_visit.emplace(c.first, c.second, false); });
+            if (!returned && !Filtered(bitset, id)) {
+                batch.emplace_back(id, dist);
+                return;
+            }
+        }
+    }
+
+    // distance from `query` to row `id`
+    float
+    Distance(const float* query, uint32_t id) const {
+        const DataType* x = data_ + (size_t)id * dim_;
+        switch (metric_) {
+            case Metric::L2:
+                return RowDistance<DataType>::L2sqr(query, x, dim_);
+            case Metric::IP:
+                return -RowDistance<DataType>::InnerProduct(query, x, dim_);
+            default:
+                return -RowDistance<DataType>::InnerProduct(query, x, dim_) * inv_norms_[id];
+        }
+    }
+
+    const DataType*
+    GetRow(size_t id) const {
+        return data_ + id * dim_;
+    }
+
+    Metric
+    metric() const {
+        return metric_;
+    }
+
+    size_t
+    dim() const {
+        return dim_;
+    }
+
+    size_t
+    n_rows() const {
+        return n_;
+    }
+
+    size_t
+    size() const {
+        return size_;
+    }
+
+ private:
+    struct Header {
+        uint32_t marker;
+        uint32_t metric;
+        uint64_t dim;
+        uint64_t n;
+        uint32_t max_degree;
+        uint32_t entry_point;
+    };
+
+    static constexpr uint32_t kFormatMarker = 0x564d4e41;  // "ANMV"
+    static constexpr size_t kSerializedAlignment = 64;
+    static constexpr unsigned kBuildMaxCandidates = 750;
+    // same as the brute force threshold of HNSW
+    static constexpr float kBruteForceFilterThreshold = 0.93f;
+
+    // an empty bitset filters nothing out
+    static bool
+    Filtered(const BitsetView& bitset, uint32_t id) {
+        return !bitset.empty() && bitset.test(id);
+    }
+
+    static size_t
+    Align(size_t offset) {
+        return (offset + kSerializedAlignment - 1) / kSerializedAlignment * kSerializedAlignment;
+    }
+
+    static size_t
+    NhoodsOffset() {
+        return Align(sizeof(Header));
+    }
+
+    static size_t
+    InvNormsOffset(const Header& header) {
+        return Align(NhoodsOffset() + header.n * (header.max_degree + 1) * sizeof(uint32_t));
+    }
+
+    static size_t
+    DataOffset(const Header& header) {
+        size_t offset = InvNormsOffset(header);
+        if (header.metric == static_cast<uint32_t>(Metric::COSINE)) {
+            offset = Align(offset + header.n * sizeof(float));
+        }
+        return offset;
+    }
+
+    static size_t
+    LayoutSize(const Header& header) {
+        return DataOffset(header) + header.n * header.dim * sizeof(DataType);
+    }
+
+    // Whether the neighbor lists of the rows [begin, end) of the layout at `base` hold at most max_degree ids each, all
+    // of rows of the index.
+    static bool
+    ValidNhoods(const uint8_t* base, const Header& header, size_t begin, size_t end) {
+        const uint32_t* nhoods = reinterpret_cast<const uint32_t*>(base + NhoodsOffset());
+        for (size_t id = begin; id < end; id++) {
+            const uint32_t* nhood = nhoods + id * (header.max_degree + 1);
+            if (nhood[0] > header.max_degree) {
+                return false;
+            }
+            for (uint32_t i = 1; i <= nhood[0]; i++) {
+                if (nhood[i] >= header.n) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // points the index into the layout at `base`
+    void
+    Bind(const uint8_t* base, size_t size) {
+        Header header;
+        std::memcpy(&header, base, sizeof(header));
+        base_ = base;
+        size_ = size;
+        metric_ = static_cast<Metric>(header.metric);
+        dim_ = header.dim;
+        n_ = header.n;
+        width_ = header.max_degree;
+        entry_point_ = header.entry_point;
+        nhoods_ = reinterpret_cast<const uint32_t*>(base + NhoodsOffset());
+        inv_norms_ =
+            metric_ == Metric::COSINE ? reinterpret_cast<const float*>(base + InvNormsOffset(header)) : nullptr;
+        data_ = reinterpret_cast<const DataType*>(base + DataOffset(header));
+    }
+
+    // Links the vectors the search can't reach from the entry point, as the build leaves some without in edges, low
+    // norm vectors of IP mostly. Each is added to the neighbors of its reachable neighbor with the fewest, or of one of
+    // that neighbor's neighbors with room left, or of the entry point if none of its neighbors becomes reachable.
+    // Returns the number of vectors linked.
+    static size_t
+    RepairConnectivity(std::vector<std::vector<unsigned>>& graph, uint32_t entry_point, size_t max_degree) {
+        const size_t n = graph.size();
+        std::vector<bool> reachable(n, false);
+        std::vector<uint32_t> stack;
+        auto mark_reachable_from = [&](uint32_t start) {
+            reachable[start] = true;
+            stack.push_back(start);
+            while (!stack.empty()) {
+                auto id = stack.back();
+                stack.pop_back();
+                for (auto nbr : graph[id]) {
+                    if (!reachable[nbr]) {
+                        reachable[nbr] = true;
+                        stack.push_back(nbr);
+                    }
+                }
+            }
+        };
+        mark_reachable_from(entry_point);
+
+        size_t repaired = 0;
+        bool linked = true;
+        while (linked) {
+            linked = false;
+            for (uint32_t id = 0; id < n; id++) {
+                if (reachable[id]) {
+                    continue;
+                }
+                int64_t parent = -1;
+                for (auto nbr : graph[id]) {
+                    if (reachable[nbr] && (parent == -1 || graph[nbr].size() < graph[parent].size())) {
+                        parent = nbr;
+                    }
+                }
+                // the neighbors of a full parent are about as close, so one of them with room is taken instead
+                if (parent != -1 && graph[parent].size() >= max_degree) {
+                    for (auto nbr : graph[parent]) {
+                        if (reachable[nbr] && nbr != id && graph[nbr].size() < max_degree) {
+                            parent = nbr;
+                            break;
+                        }
+                    }
+                }
+                if (parent != -1) {
+                    graph[parent].push_back(id);
+                    mark_reachable_from(id);
+                    repaired++;
+                    linked = true;
+                }
+            }
+        }
+        for (uint32_t id = 0; id < n; id++) {
+            if (!reachable[id]) {
+                graph[entry_point].push_back(id);
+                mark_reachable_from(id);
+                repaired++;
+            }
+        }
+        return repaired;
+    }
+
+    // Computes the distances to the neighbors of `id` not visited yet and calls `visit` with each. The rows are
+    // prefetched first, as a node's neighbors are scattered over the data.
+    template <typename Visit>
+    void
+    ExpandNode(const float* query, uint32_t id, SearchScratch& scratch, Visit&& visit) const {
+        const uint32_t* nhood = nhoods_ + (size_t)id * (width_ + 1);
+        auto& unvisited = scratch.unvisited;
+        unvisited.clear();
+        for (uint32_t i = 1; i <= nhood[0]; i++) {
+            uint32_t nbr = nhood[i];
+            if (scratch.visited.insert(nbr).second) {
+                unvisited.push_back(nbr);
+                __builtin_prefetch(data_ + (size_t)nbr * dim_);
+            }
+        }
+        for (auto nbr : unvisited) {
+            visit(Candidate(Distance(query, nbr), nbr));
+        }
+    }
+
+    // Best first search from the entry point, that keeps the `search_list_size` closest rows allowed by the bitset in
+    // `top`. Filtered out rows are still expanded, so that the search goes through them. Calls `visit` with each row
+    // it computes the distance to.
+    template <typename Visit>
+    void
+    BeamSearch(const float* query, size_t search_list_size, const BitsetView& bitset,
+               SearchScratch& scratch, std::priority_queue<Candidate>& top, Visit&& visit) const {
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+        float lower_bound = std::numeric_limits<float>::max();
+        auto add = [&](const Candidate& c) {
+            visit(c);
+            if (top.size() < search_list_size || c.first < lower_bound) {
+                candidates.push(c);
+                if (!Filtered(bitset, c.second)) {
+                    top.push(c);
+                    if (top.size() > search_list_size) {
+                        top.pop();
+                    }
+                    if (top.size() == search_list_size) {
+                        lower_bound = top.top().first;
+                    }
+                }
+            }
+        };
+        scratch.visited.insert(entry_point_);
+        add(Candidate(Distance(query, entry_point_), entry_point_));
+        while (!candidates.empty()) {
+            auto current = candidates.top();
+            if (top.size() == search_list_size && current.first > lower_bound) {
+                break;
+            }
+            candidates.pop();
+            ExpandNode(query, current.second, scratch, add);
+        }
+    }
+
+    std::vector<Candidate>
+    BruteForceSearch(const float* query, size_t k, const BitsetView& bitset) const {
+        std::priority_queue<Candidate> top;
+        bitset.for_each_allowed(n_, [&](int64_t id) {
+            float dist = Distance(query, id);
+            if (top.size() < k) {
+                top.emplace(dist, id);
+            } else if (dist < top.top().first) {
+                top.pop();
+                top.emplace(dist, id);
+            }
+        });
+        std::vector<Candidate> result(top.size());
+        for (size_t i = top.size(); i > 0; i--) {
+            result[i - 1] = top.top();
+            top.pop();
+        }
+        return result;
+    }
+
+    std::unique_ptr<uint8_t[]> owned_;
+    size_t owned_size_ = 0;
+
+    const uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    Metric metric_ = Metric::L2;
+    size_t dim_ = 0;
+    size_t n_ = 0;
+    size_t width_ = 0;
+    uint32_t entry_point_ = 0;
+    const uint32_t* nhoods_ = nullptr;
+    const float* inv_norms_ = nullptr;
+    const DataType* data_ = nullptr;
+};
+
+}  // namespace knowhere::vamana
+
+#endif /* VAMANA_INDEX_H */
@@ -16,6 +16,7 @@
 #include <immintrin.h>
 
 #include <cassert>
+#include <cstring>
 
 #include "faiss/impl/platform_macros.h"
 #include "knowhere/operands.h"
@@ -321,5 +322,232 @@ ivec_L2sqr_avx(const int8_t* x, const int8_t* y, size_t d) {
     return res;
 }
 
+static inline float
+reduce_add_f32x8(__m256 x) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    return _mm_cvtss_f32(sum);
+}
+
+// loads 8 fp16 values and widens them to fp32
+static inline __m256
+load_fp16_f32x8(const knowhere::fp16* y) {
+    return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)y));
+}
+
+// loads 8 bf16 values and widens them to fp32
+static inline __m256
+load_bf16_f32x8(const knowhere::bf16* y) {
+    return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)y)), 16));
+}
+
+template <typename HalfT, __m256 (*load_half)(const HalfT*)>
+static inline float
+half_vec_inner_product_avx(const float* x, const HalfT* y, size_t d) {
+    __m256 msum = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= d; i += 8) {
+        msum = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), load_half(y + i), msum);
+    }
+    float res = reduce_add_f32x8(msum);
+    for (; i < d; i++) {
+        res += x[i] * (float)y[i];
+    }
+    return res;
+}
+
+template <typename HalfT, __m256 (*load_half)(const HalfT*)>
+static inline float
+half_vec_L2sqr_avx(const float* x, const HalfT* y, size_t d) {
+    __m256 msum = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= d; i += 8) {
+        const __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(x + i), load_half(y + i));
+        msum = _mm256_fmadd_ps(diff, diff, msum);
+    }
+    float res = reduce_add_f32x8(msum);
+    for (; i < d; i++) {
+        const float tmp = x[i] - (float)y[i];
+        res += tmp * tmp;
+    }
+    return res;
+}
+
+template <typename HalfT, __m256 (*load_half)(const HalfT*)>
+static inline float
+half_vec_norm_L2sqr_avx(const HalfT* x, size_t d) {
+    __m256 msum = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= d; i += 8) {
+        const __m256 mx = load_half(x + i);
+        msum = _mm256_fmadd_ps(mx, mx, msum);
+    }
+    float res = reduce_add_f32x8(msum);
+    for (; i < d; i++) {
+        const float tmp = (float)x[i];
+        res += tmp * tmp;
+    }
+    return res;
+}
+
+float
+fp16_vec_inner_product_avx(const float* x, const knowhere::fp16* y, size_t d) {
+    return half_vec_inner_product_avx<knowhere::fp16, load_fp16_f32x8>(x, y, d);
+}
+
+float
+fp16_vec_L2sqr_avx(const float* x, const knowhere::fp16* y, size_t d) {
+    return half_vec_L2sqr_avx<knowhere::fp16, load_fp16_f32x8>(x, y, d);
+}
+
+float
+fp16_vec_norm_L2sqr_avx(const knowhere::fp16* x, size_t d) {
+    return half_vec_norm_L2sqr_avx<knowhere::fp16, load_fp16_f32x8>(x, d);
+}
+
+float
+bf16_vec_inner_product_avx(const float* x, const knowhere::bf16* y, size_t d) {
+    return half_vec_inner_product_avx<knowhere::bf16, load_bf16_f32x8>(x, y, d);
+}
+
+float
+bf16_vec_L2sqr_avx(const float* x, const knowhere::bf16* y, size_t d) {
+    return half_vec_L2sqr_avx<knowhere::bf16, load_bf16_f32x8>(x, y, d);
+}
+
+float
+bf16_vec_norm_L2sqr_avx(const knowhere::bf16* x, size_t d) {
+    return half_vec_norm_L2sqr_avx<knowhere::bf16, load_bf16_f32x8>(x, d);
+}
+
+// popcount of each 64-bit lane, using the nibble lookup table of Mula et al.
+static inline __m256i
+popcount_u64x4(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1,
+                                            2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    const __m256i lo = _mm256_and_si256(v, low_mask);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    const __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+}
+
+static inline int
+reduce_add_u64x4(__m256i v) {
+    const __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return (int)(_mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1));
+}
+
+// popcount of (x op y) over the bytes [i, code_size) that do not fill a 256-bit register
+template <typename Op>
+static inline int
+bvec_popcount_tail_avx(const uint8_t* x, const uint8_t* y, size_t i, size_t code_size, Op op) {
+    int res = 0;
+    for (; i + 8 <= code_size; i += 8) {
+        uint64_t a, b;
+        std::memcpy(&a, x + i, sizeof(a));
+        std::memcpy(&b, y + i, sizeof(b));
+        res += __builtin_popcountll(op(a, b));
+    }
+    for (; i < code_size; i++) {
+        res += __builtin_popcount(op(x[i], y[i]) & 0xff);
+    }
+    return res;
+}
+
+static inline float
+jaccard_from_counts_avx(int accu_num, int accu_den) {
+    return (accu_den == 0) ? 1.0f : ((float)(accu_den - accu_num) / (float)(accu_den));
+}
+
+static inline __m256i
+load_u8x32(const uint8_t* p) {
+    return _mm256_loadu_si256((const __m256i*)p);
+}
+
+int
+bvec_hamming_dis_avx(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= code_size; i += 32) {
+        acc = _mm256_add_epi64(acc, popcount_u64x4(_mm256_xor_si256(load_u8x32(x + i), load_u8x32(y + i))));
+    }
+    return reduce_add_u64x4(acc) + bvec_popcount_tail_avx(x, y, i, code_size, [](auto a, auto b) { return a ^ b; });
+}
+
+float
+bvec_jaccard_dis_avx(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    __m256i acc_num = _mm256_setzero_si256();
+    __m256i acc_den = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= code_size; i += 32) {
+        const __m256i a = load_u8x32(x + i);
+        const __m256i b = load_u8x32(y + i);
+        acc_num = _mm256_add_epi64(acc_num, popcount_u64x4(_mm256_and_si256(a, b)));
+        acc_den = _mm256_add_epi64(acc_den, popcount_u64x4(_mm256_or_si256(a, b)));
+    }
+    const int accu_num =
+        reduce_add_u64x4(acc_num) + bvec_popcount_tail_avx(x, y, i, code_size, [](auto a, auto b) { return a & b; });
+    const int accu_den =
+        reduce_add_u64x4(acc_den) + bvec_popcount_tail_avx(x, y, i, code_size, [](auto a, auto b) { return a | b; });
+    return jaccard_from_counts_avx(accu_num, accu_den);
+}
+
+void
+bvec_hamming_dis_batch_4_avx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                             const uint8_t* y3, const size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    __m256i acc2 = _mm256_setzero_si256();
+    __m256i acc3 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= code_size; i += 32) {
+        const __m256i a = load_u8x32(x + i);
+        acc0 = _mm256_add_epi64(acc0, popcount_u64x4(_mm256_xor_si256(a, load_u8x32(y0 + i))));
+        acc1 = _mm256_add_epi64(acc1, popcount_u64x4(_mm256_xor_si256(a, load_u8x32(y1 + i))));
+        acc2 = _mm256_add_epi64(acc2, popcount_u64x4(_mm256_xor_si256(a, load_u8x32(y2 + i))));
+        acc3 = _mm256_add_epi64(acc3, popcount_u64x4(_mm256_xor_si256(a, load_u8x32(y3 + i))));
+    }
+    auto op = [](auto a, auto b) { return a ^ b; };
+    dis0 = reduce_add_u64x4(acc0) + bvec_popcount_tail_avx(x, y0, i, code_size, op);
+    dis1 = reduce_add_u64x4(acc1) + bvec_popcount_tail_avx(x, y1, i, code_size, op);
+    dis2 = reduce_add_u64x4(acc2) + bvec_popcount_tail_avx(x, y2, i, code_size, op);
+    dis3 = reduce_add_u64x4(acc3) + bvec_popcount_tail_avx(x, y3, i, code_size, op);
+}
+
+void
+bvec_jaccard_dis_batch_4_avx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                             const uint8_t* y3, const size_t code_size, float& dis0, float& dis1, float& dis2,
+                             float& dis3) {
+    const uint8_t* ys[4] = {y0, y1, y2, y3};
+    __m256i acc_num[4], acc_den[4];
+    for (int j = 0; j < 4; j++) {
+        acc_num[j] = _mm256_setzero_si256();
+        acc_den[j] = _mm256_setzero_si256();
+    }
+    size_t i = 0;
+    for (; i + 32 <= code_size; i += 32) {
+        const __m256i a = load_u8x32(x + i);
+        for (int j = 0; j < 4; j++) {
+            const __m256i b = load_u8x32(ys[j] + i);
+            acc_num[j] = _mm256_add_epi64(acc_num[j], popcount_u64x4(_mm256_and_si256(a, b)));
+            acc_den[j] = _mm256_add_epi64(acc_den[j], popcount_u64x4(_mm256_or_si256(a, b)));
+        }
+    }
+    float dis[4];
+    for (int j = 0; j < 4; j++) {
+        const int accu_num = reduce_add_u64x4(acc_num[j]) +
+                             bvec_popcount_tail_avx(x, ys[j], i, code_size, [](auto a, auto b) { return a & b; });
+        const int accu_den = reduce_add_u64x4(acc_den[j]) +
+                             bvec_popcount_tail_avx(x, ys[j], i, code_size, [](auto a, auto b) { return a | b; });
+        dis[j] = jaccard_from_counts_avx(accu_num, accu_den);
+    }
+    dis0 = dis[0];
+    dis1 = dis[1];
+    dis2 = dis[2];
+    dis3 = dis[3];
+}
+
 }  // namespace faiss
 #endif
@@ -15,6 +15,11 @@
 #include <cstddef>
 #include <cstdint>
 
+namespace knowhere {
+struct fp16;
+struct bf16;
+}  // namespace knowhere
+
 namespace faiss {
 
 /// Squared L2 distance between two vectors
@@ -64,6 +69,40 @@ ivec_inner_product_avx(const int8_t* x, const int8_t* y, size_t d);
 int32_t
 ivec_L2sqr_avx(const int8_t* x, const int8_t* y, size_t d);
 
+float
+fp16_vec_inner_product_avx(const float* x, const knowhere::fp16* y, size_t d);
+
+float
+fp16_vec_L2sqr_avx(const float* x, const knowhere::fp16* y, size_t d);
+
+float
+fp16_vec_norm_L2sqr_avx(const knowhere::fp16* x, size_t d);
+
+float
+bf16_vec_inner_product_avx(const float* x, const knowhere::bf16* y, size_t d);
+
+float
+bf16_vec_L2sqr_avx(const float* x, const knowhere::bf16* y, size_t d);
+
+float
+bf16_vec_norm_L2sqr_avx(const knowhere::bf16* x, size_t d);
+
+/// distances between two binary codes of code_size bytes
+int
+bvec_hamming_dis_avx(const uint8_t* x, const uint8_t* y, size_t code_size);
+
+float
+bvec_jaccard_dis_avx(const uint8_t* x, const uint8_t* y, size_t code_size);
+
+void
+bvec_hamming_dis_batch_4_avx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                             const uint8_t* y3, const size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3);
+
+void
+bvec_jaccard_dis_batch_4_avx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                             const uint8_t* y3, const size_t code_size, float& dis0, float& dis1, float& dis2,
+                             float& dis3);
+
 }  // namespace faiss
 
 #endif /* DISTANCES_AVX_H */
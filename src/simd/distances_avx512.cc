@@ -347,6 +347,189 @@ ivec_L2sqr_avx512(const int8_t* x, const int8_t* y, size_t d) {
     return res;
 }
 
-}  // namespace faiss
+// loads 16 fp16 values and widens them to fp32
+static inline __m512
+load_fp16_f32x16(const knowhere::fp16* y) {
+    return _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)y));
+}
+
+// loads 16 bf16 values and widens them to fp32
+static inline __m512
+load_bf16_f32x16(const knowhere::bf16* y) {
+    return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)y)), 16));
+}
+
+template <typename HalfT, __m512 (*load_half)(const HalfT*)>
+static inline float
+half_vec_inner_product_avx512(const float* x, const HalfT* y, size_t d) {
+    __m512 msum = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= d; i += 16) {
+        msum = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), load_half(y + i), msum);
+    }
+    float res = _mm512_reduce_add_ps(msum);
+    for (; i < d; i++) {
+        res += x[i] * (float)y[i];
+    }
+    return res;
+}
+
+template <typename HalfT, __m512 (*load_half)(const HalfT*)>
+static inline float
+half_vec_L2sqr_avx512(const float* x, const HalfT* y, size_t d) {
+    __m512 msum = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= d; i += 16) {
+        const __m512 diff = _mm512_sub_ps(_mm512_loadu_ps(x + i), load_half(y + i));
+        msum = _mm512_fmadd_ps(diff, diff, msum);
+    }
+    float res = _mm512_reduce_add_ps(msum);
+    for (; i < d; i++) {
+        const float tmp = x[i] - (float)y[i];
+        res += tmp * tmp;
+    }
+    return res;
+}
 
+template <typename HalfT, __m512 (*load_half)(const HalfT*)>
+static inline float
+half_vec_norm_L2sqr_avx512(const HalfT* x, size_t d) {
+    __m512 msum = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= d; i += 16) {
+        const __m512 mx = load_half(x + i);
+        msum = _mm512_fmadd_ps(mx, mx, msum);
+    }
+    float res = _mm512_reduce_add_ps(msum);
+    for (; i < d; i++) {
+        const float tmp = (float)x[i];
+        res += tmp * tmp;
+    }
+    return res;
+}
+
+float
+fp16_vec_inner_product_avx512(const float* x, const knowhere::fp16* y, size_t d) {
+    return half_vec_inner_product_avx512<knowhere::fp16, load_fp16_f32x16>(x, y, d);
+}
+
+float
+fp16_vec_L2sqr_avx512(const float* x, const knowhere::fp16* y, size_t d) {
+    return half_vec_L2sqr_avx512<knowhere::fp16, load_fp16_f32x16>(x, y, d);
+}
+
+float
+fp16_vec_norm_L2sqr_avx512(const knowhere::fp16* x, size_t d) {
+    return half_vec_norm_L2sqr_avx512<knowhere::fp16, load_fp16_f32x16>(x, d);
+}
+
+float
+bf16_vec_inner_product_avx512(const float* x, const knowhere::bf16* y, size_t d) {
+    return half_vec_inner_product_avx512<knowhere::bf16, load_bf16_f32x16>(x, y, d);
+}
+
+float
+bf16_vec_L2sqr_avx512(const float* x, const knowhere::bf16* y, size_t d) {
+    return half_vec_L2sqr_avx512<knowhere::bf16, load_bf16_f32x16>(x, y, d);
+}
+
+float
+bf16_vec_norm_L2sqr_avx512(const knowhere::bf16* x, size_t d) {
+    return half_vec_norm_L2sqr_avx512<knowhere::bf16, load_bf16_f32x16>(x, d);
+}
+
+// The binary kernels below need VPOPCNTDQ, which is not part of the AVX512 baseline this file is built for,
+// so it is enabled per function and hook.cc only selects them when the cpu reports it.
+#define KNOWHERE_AVX512_VPOPCNTDQ __attribute__((target("avx512vpopcntdq")))
+
+// loads the bytes [i, min(i + 64, code_size)) of a code, zeroing the rest of the register
+static inline __m512i
+load_code_u8x64(const uint8_t* code, size_t i, size_t code_size) {
+    const size_t rem = code_size - i;
+    if (rem >= 64) {
+        return _mm512_loadu_si512(code + i);
+    }
+    return _mm512_maskz_loadu_epi8(((__mmask64)1 << rem) - 1, code + i);
+}
+
+static inline float
+jaccard_from_counts_avx512(int64_t accu_num, int64_t accu_den) {
+    return (accu_den == 0) ? 1.0f : ((float)(accu_den - accu_num) / (float)(accu_den));
+}
+
+KNOWHERE_AVX512_VPOPCNTDQ int
+bvec_hamming_dis_avx512(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    __m512i acc = _mm512_setzero_si512();
+    for (size_t i = 0; i < code_size; i += 64) {
+        const __m512i a = load_code_u8x64(x, i, code_size);
+        const __m512i b = load_code_u8x64(y, i, code_size);
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_xor_si512(a, b)));
+    }
+    return (int)_mm512_reduce_add_epi64(acc);
+}
+
+KNOWHERE_AVX512_VPOPCNTDQ float
+bvec_jaccard_dis_avx512(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    __m512i acc_num = _mm512_setzero_si512();
+    __m512i acc_den = _mm512_setzero_si512();
+    for (size_t i = 0; i < code_size; i += 64) {
+        const __m512i a = load_code_u8x64(x, i, code_size);
+        const __m512i b = load_code_u8x64(y, i, code_size);
+        acc_num = _mm512_add_epi64(acc_num, _mm512_popcnt_epi64(_mm512_and_si512(a, b)));
+        acc_den = _mm512_add_epi64(acc_den, _mm512_popcnt_epi64(_mm512_or_si512(a, b)));
+    }
+    return jaccard_from_counts_avx512(_mm512_reduce_add_epi64(acc_num), _mm512_reduce_add_epi64(acc_den));
+}
+
+KNOWHERE_AVX512_VPOPCNTDQ void
+bvec_hamming_dis_batch_4_avx512(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                const uint8_t* y3, const size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3) {
+    __m512i acc0 = _mm512_setzero_si512();
+    __m512i acc1 = _mm512_setzero_si512();
+    __m512i acc2 = _mm512_setzero_si512();
+    __m512i acc3 = _mm512_setzero_si512();
+    for (size_t i = 0; i < code_size; i += 64) {
+        const __m512i a = load_code_u8x64(x, i, code_size);
+        acc0 = _mm512_add_epi64(acc0, _mm512_popcnt_epi64(_mm512_xor_si512(a, load_code_u8x64(y0, i, code_size))));
+        acc1 = _mm512_add_epi64(acc1, _mm512_popcnt_epi64(_mm512_xor_si512(a, load_code_u8x64(y1, i, code_size))));
+        acc2 = _mm512_add_epi64(acc2, _mm512_popcnt_epi64(_mm512_xor_si512(a, load_code_u8x64(y2, i, code_size))));
+        acc3 = _mm512_add_epi64(acc3, _mm512_popcnt_epi64(_mm512_xor_si512(a, load_code_u8x64(y3, i, code_size))));
+    }
+    dis0 = (int)_mm512_reduce_add_epi64(acc0);
+    dis1 = (int)_mm512_reduce_add_epi64(acc1);
+    dis2 = (int)_mm512_reduce_add_epi64(acc2);
+    dis3 = (int)_mm512_reduce_add_epi64(acc3);
+}
+
+KNOWHERE_AVX512_VPOPCNTDQ void
+bvec_jaccard_dis_batch_4_avx512(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                const uint8_t* y3, const size_t code_size, float& dis0, float& dis1, float& dis2,
+                                float& dis3) {
+    const uint8_t* ys[4] = {y0, y1, y2, y3};
+    __m512i acc_num[4], acc_den[4];
+    for (int j = 0; j < 4; j++) {
+        acc_num[j] = _mm512_setzero_si512();
+        acc_den[j] = _mm512_setzero_si512();
+    }
+    for (size_t i = 0; i < code_size; i += 64) {
+        const __m512i a = load_code_u8x64(x, i, code_size);
+        for (int j = 0; j < 4; j++) {
+            const __m512i b = load_code_u8x64(ys[j], i, code_size);
+            acc_num[j] = _mm512_add_epi64(acc_num[j], _mm512_popcnt_epi64(_mm512_and_si512(a, b)));
+            acc_den[j] = _mm512_add_epi64(acc_den[j], _mm512_popcnt_epi64(_mm512_or_si512(a, b)));
+        }
+    }
+    float dis[4];
+    for (int j = 0; j < 4; j++) {
+        dis[j] = jaccard_from_counts_avx512(_mm512_reduce_add_epi64(acc_num[j]), _mm512_reduce_add_epi64(acc_den[j]));
+    }
+    dis0 = dis[0];
+    dis1 = dis[1];
+    dis2 = dis[2];
+    dis3 = dis[3];
+}
+
+#undef KNOWHERE_AVX512_VPOPCNTDQ
+
+}  // namespace faiss
 #endif
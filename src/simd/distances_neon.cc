@@ -658,5 +658,92 @@ ivec_L2sqr_neon(const int8_t* x, const int8_t* y, size_t d) {
     return res;
 }
 
+// popcount of each byte of (x op y), widened and accumulated into 32-bit lanes
+template <typename Op>
+static inline uint32x4_t
+popcount_acc_neon(uint32x4_t acc, uint8x16_t a, uint8x16_t b, Op op) {
+    return vpadalq_u16(acc, vpaddlq_u8(vcntq_u8(op(a, b))));
+}
+
+// popcount of (x op y) over the bytes [i, code_size) that do not fill a 128-bit register
+template <typename Op>
+static inline int
+bvec_popcount_tail_neon(const uint8_t* x, const uint8_t* y, size_t i, size_t code_size, Op op) {
+    int res = 0;
+    for (; i < code_size; i++) {
+        res += __builtin_popcount(op(x[i], y[i]) & 0xff);
+    }
+    return res;
+}
+
+static inline float
+jaccard_from_counts_neon(int accu_num, int accu_den) {
+    return (accu_den == 0) ? 1.0f : ((float)(accu_den - accu_num) / (float)(accu_den));
+}
+
+static const auto xor_u8x16 = [](uint8x16_t a, uint8x16_t b) { return veorq_u8(a, b); };
+static const auto and_u8x16 = [](uint8x16_t a, uint8x16_t b) { return vandq_u8(a, b); };
+static const auto or_u8x16 = [](uint8x16_t a, uint8x16_t b) { return vorrq_u8(a, b); };
+static const auto xor_u8 = [](int a, int b) { return a ^ b; };
+static const auto and_u8 = [](int a, int b) { return a & b; };
+static const auto or_u8 = [](int a, int b) { return a | b; };
+
+int
+bvec_hamming_dis_neon(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    uint32x4_t acc = vdupq_n_u32(0);
+    size_t i = 0;
+    for (; i + 16 <= code_size; i += 16) {
+        acc = popcount_acc_neon(acc, vld1q_u8(x + i), vld1q_u8(y + i), xor_u8x16);
+    }
+    return vaddvq_u32(acc) + bvec_popcount_tail_neon(x, y, i, code_size, xor_u8);
+}
+
+float
+bvec_jaccard_dis_neon(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    uint32x4_t acc_num = vdupq_n_u32(0);
+    uint32x4_t acc_den = vdupq_n_u32(0);
+    size_t i = 0;
+    for (; i + 16 <= code_size; i += 16) {
+        const uint8x16_t a = vld1q_u8(x + i);
+        const uint8x16_t b = vld1q_u8(y + i);
+        acc_num = popcount_acc_neon(acc_num, a, b, and_u8x16);
+        acc_den = popcount_acc_neon(acc_den, a, b, or_u8x16);
+    }
+    const int accu_num = vaddvq_u32(acc_num) + bvec_popcount_tail_neon(x, y, i, code_size, and_u8);
+    const int accu_den = vaddvq_u32(acc_den) + bvec_popcount_tail_neon(x, y, i, code_size, or_u8);
+    return jaccard_from_counts_neon(accu_num, accu_den);
+}
+
+void
+bvec_hamming_dis_batch_4_neon(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                              const uint8_t* y3, const size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3) {
+    uint32x4_t acc0 = vdupq_n_u32(0);
+    uint32x4_t acc1 = vdupq_n_u32(0);
+    uint32x4_t acc2 = vdupq_n_u32(0);
+    uint32x4_t acc3 = vdupq_n_u32(0);
+    size_t i = 0;
+    for (; i + 16 <= code_size; i += 16) {
+        const uint8x16_t a = vld1q_u8(x + i);
+        acc0 = popcount_acc_neon(acc0, a, vld1q_u8(y0 + i), xor_u8x16);
+        acc1 = popcount_acc_neon(acc1, a, vld1q_u8(y1 + i), xor_u8x16);
+        acc2 = popcount_acc_neon(acc2, a, vld1q_u8(y2 + i), xor_u8x16);
+        acc3 = popcount_acc_neon(acc3, a, vld1q_u8(y3 + i), xor_u8x16);
+    }
+    dis0 = vaddvq_u32(acc0) + bvec_popcount_tail_neon(x, y0, i, code_size, xor_u8);
+    dis1 = vaddvq_u32(acc1) + bvec_popcount_tail_neon(x, y1, i, code_size, xor_u8);
+    dis2 = vaddvq_u32(acc2) + bvec_popcount_tail_neon(x, y2, i, code_size, xor_u8);
+    dis3 = vaddvq_u32(acc3) + bvec_popcount_tail_neon(x, y3, i, code_size, xor_u8);
+}
+
+void
+bvec_jaccard_dis_batch_4_neon(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                              const uint8_t* y3, const size_t code_size, float& dis0, float& dis1, float& dis2,
+                              float& dis3) {
+    dis0 = bvec_jaccard_dis_neon(x, y0, code_size);
+    dis1 = bvec_jaccard_dis_neon(x, y1, code_size);
+    dis2 = bvec_jaccard_dis_neon(x, y2, code_size);
+    dis3 = bvec_jaccard_dis_neon(x, y3, code_size);
+}
+
 }  // namespace faiss
 #endif
@@ -10,6 +10,7 @@
 #include "distances_ref.h"
 
 #include <cmath>
+#include <cstring>
 
 #include "knowhere/operands.h"
 
@@ -302,4 +303,121 @@ ivec_L2sqr_ref(const int8_t* x, const int8_t* y, size_t d) {
     return res;
 }
 
+float
+fp16_vec_inner_product_ref(const float* x, const knowhere::fp16* y, size_t d) {
+    size_t i;
+    float res = 0;
+    for (i = 0; i < d; i++) {
+        res += x[i] * (float)y[i];
+    }
+    return res;
+}
+
+float
+fp16_vec_L2sqr_ref(const float* x, const knowhere::fp16* y, size_t d) {
+    size_t i;
+    float res = 0;
+    for (i = 0; i < d; i++) {
+        const float tmp = x[i] - (float)y[i];
+        res += tmp * tmp;
+    }
+    return res;
+}
+
+float
+fp16_vec_norm_L2sqr_ref(const knowhere::fp16* x, size_t d) {
+    size_t i;
+    double res = 0;
+    for (i = 0; i < d; i++) {
+        const float tmp = (float)x[i];
+        res += tmp * tmp;
+    }
+    return res;
+}
+
+float
+bf16_vec_inner_product_ref(const float* x, const knowhere::bf16* y, size_t d) {
+    size_t i;
+    float res = 0;
+    for (i = 0; i < d; i++) {
+        res += x[i] * (float)y[i];
+    }
+    return res;
+}
+
+float
+bf16_vec_L2sqr_ref(const float* x, const knowhere::bf16* y, size_t d) {
+    size_t i;
+    float res = 0;
+    for (i = 0; i < d; i++) {
+        const float tmp = x[i] - (float)y[i];
+        res += tmp * tmp;
+    }
+    return res;
+}
+
+float
+bf16_vec_norm_L2sqr_ref(const knowhere::bf16* x, size_t d) {
+    size_t i;
+    double res = 0;
+    for (i = 0; i < d; i++) {
+        const float tmp = (float)x[i];
+        res += tmp * tmp;
+    }
+    return res;
+}
+
+// popcount of (x op y) over the bytes [i, code_size), a 64-bit word at a time
+template <typename Op>
+static inline int
+bvec_popcount_tail_ref(const uint8_t* x, const uint8_t* y, size_t i, size_t code_size, Op op) {
+    int res = 0;
+    for (; i + 8 <= code_size; i += 8) {
+        uint64_t a, b;
+        std::memcpy(&a, x + i, sizeof(a));
+        std::memcpy(&b, y + i, sizeof(b));
+        res += __builtin_popcountll(op(a, b));
+    }
+    for (; i < code_size; i++) {
+        res += __builtin_popcount(op(x[i], y[i]) & 0xff);
+    }
+    return res;
+}
+
+static inline float
+jaccard_from_counts_ref(int accu_num, int accu_den) {
+    return (accu_den == 0) ? 1.0f : ((float)(accu_den - accu_num) / (float)(accu_den));
+}
+
+int
+bvec_hamming_dis_ref(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    return bvec_popcount_tail_ref(x, y, 0, code_size, [](auto a, auto b) { return a ^ b; });
+}
+
+float
+bvec_jaccard_dis_ref(const uint8_t* x, const uint8_t* y, size_t code_size) {
+    const int accu_num = bvec_popcount_tail_ref(x, y, 0, code_size, [](auto a, auto b) { return a & b; });
+    const int accu_den = bvec_popcount_tail_ref(x, y, 0, code_size, [](auto a, auto b) { return a | b; });
+    return jaccard_from_counts_ref(accu_num, accu_den);
+}
+
+void
+bvec_hamming_dis_batch_4_ref(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                             const uint8_t* y3, const size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3) {
+    dis0 = bvec_hamming_dis_ref(x, y0, code_size);
+    dis1 = bvec_hamming_dis_ref(x, y1, code_size);
+    dis2 = bvec_hamming_dis_ref(x, y2, code_size);
+    dis3 = bvec_hamming_dis_ref(x, y3, code_size);
+}
+
+void
+bvec_jaccard_dis_batch_4_ref(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                             const uint8_t* y3, const size_t code_size, float& dis0, float& dis1, float& dis2,
+                             float& dis3) {
+    dis0 = bvec_jaccard_dis_ref(x, y0, code_size);
+    dis1 = bvec_jaccard_dis_ref(x, y1, code_size);
+    dis2 = bvec_jaccard_dis_ref(x, y2, code_size);
+    dis3 = bvec_jaccard_dis_ref(x, y3, code_size);
+}
+
 }  // namespace faiss
@@ -53,6 +53,22 @@ ivec_inner_product_sse(const int8_t* x, const int8_t* y, size_t d);
 int32_t
 ivec_L2sqr_sse(const int8_t* x, const int8_t* y, size_t d);
 
+/// distances between two binary codes of code_size bytes
+int
+bvec_hamming_dis_sse(const uint8_t* x, const uint8_t* y, size_t code_size);
+
+float
+bvec_jaccard_dis_sse(const uint8_t* x, const uint8_t* y, size_t code_size);
+
+void
+bvec_hamming_dis_batch_4_sse(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                             const uint8_t* y3, const size_t code_size, int& dis0, int& dis1, int& dis2, int& dis3);
+
+void
+bvec_jaccard_dis_batch_4_sse(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                             const uint8_t* y3, const size_t code_size, float& dis0, float& dis1, float& dis2,
+                             float& dis3);
+
 }  // namespace faiss
 
 #endif /* DISTANCES_SSE_H */
@@ -62,6 +62,18 @@ decltype(fvec_L2sqr_batch_4) fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_ref;
 decltype(ivec_inner_product) ivec_inner_product = ivec_inner_product_ref;
 decltype(ivec_L2sqr) ivec_L2sqr = ivec_L2sqr_ref;
 
+decltype(fp16_vec_inner_product) fp16_vec_inner_product = fp16_vec_inner_product_ref;
+decltype(fp16_vec_L2sqr) fp16_vec_L2sqr = fp16_vec_L2sqr_ref;
+decltype(fp16_vec_norm_L2sqr) fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_ref;
+decltype(bf16_vec_inner_product) bf16_vec_inner_product = bf16_vec_inner_product_ref;
+decltype(bf16_vec_L2sqr) bf16_vec_L2sqr = bf16_vec_L2sqr_ref;
+decltype(bf16_vec_norm_L2sqr) bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_ref;
+
+decltype(bvec_hamming_dis) bvec_hamming_dis = bvec_hamming_dis_ref;
+decltype(bvec_jaccard_dis) bvec_jaccard_dis = bvec_jaccard_dis_ref;
+decltype(bvec_hamming_dis_batch_4) bvec_hamming_dis_batch_4 = bvec_hamming_dis_batch_4_ref;
+decltype(bvec_jaccard_dis_batch_4) bvec_jaccard_dis_batch_4 = bvec_jaccard_dis_batch_4_ref;
+
 #if defined(__x86_64__)
 bool
 cpu_support_avx512() {
@@ -80,6 +92,12 @@ cpu_support_sse4_2() {
     InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
     return (instruction_set_inst.SSE42());
 }
+
+bool
+cpu_support_avx512_vpopcntdq() {
+    InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
+    return (cpu_support_avx512() && instruction_set_inst.AVX512VPOPCNTDQ());
+}
 #endif
 
 static std::mutex patch_bf16_mutex;
@@ -169,6 +187,25 @@ fvec_hook(std::string& simd_type) {
         ivec_inner_product = ivec_inner_product_avx512;
         ivec_L2sqr = ivec_L2sqr_avx512;
 
+        fp16_vec_inner_product = fp16_vec_inner_product_avx512;
+        fp16_vec_L2sqr = fp16_vec_L2sqr_avx512;
+        fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_avx512;
+        bf16_vec_inner_product = bf16_vec_inner_product_avx512;
+        bf16_vec_L2sqr = bf16_vec_L2sqr_avx512;
+        bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_avx512;
+
+        if (cpu_support_avx512_vpopcntdq()) {
+            bvec_hamming_dis = bvec_hamming_dis_avx512;
+            bvec_jaccard_dis = bvec_jaccard_dis_avx512;
+            bvec_hamming_dis_batch_4 = bvec_hamming_dis_batch_4_avx512;
+            bvec_jaccard_dis_batch_4 = bvec_jaccard_dis_batch_4_avx512;
+        } else {
+            bvec_hamming_dis = bvec_hamming_dis_avx;
+            bvec_jaccard_dis = bvec_jaccard_dis_avx;
+            bvec_hamming_dis_batch_4 = bvec_hamming_dis_batch_4_avx;
+            bvec_jaccard_dis_batch_4 = bvec_jaccard_dis_batch_4_avx;
+        }
+
         simd_type = "AVX512";
         support_pq_fast_scan = true;
     } else if (use_avx2 && cpu_support_avx2()) {
@@ -189,6 +226,18 @@ fvec_hook(std::string& simd_type) {
         ivec_inner_product = ivec_inner_product_avx;
         ivec_L2sqr = ivec_L2sqr_avx;
 
+        fp16_vec_inner_product = fp16_vec_inner_product_avx;
+        fp16_vec_L2sqr = fp16_vec_L2sqr_avx;
+        fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_avx;
+        bf16_vec_inner_product = bf16_vec_inner_product_avx;
+        bf16_vec_L2sqr = bf16_vec_L2sqr_avx;
+        bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_avx;
+
+        bvec_hamming_dis = bvec_hamming_dis_avx;
+        bvec_jaccard_dis = bvec_jaccard_dis_avx;
+        bvec_hamming_dis_batch_4 = bvec_hamming_dis_batch_4_avx;
+        bvec_jaccard_dis_batch_4 = bvec_jaccard_dis_batch_4_avx;
+
         simd_type = "AVX2";
         support_pq_fast_scan = true;
     } else if (use_sse4_2 && cpu_support_sse4_2()) {
@@ -209,6 +258,18 @@ fvec_hook(std::string& simd_type) {
         ivec_inner_product = ivec_inner_product_sse;
         ivec_L2sqr = ivec_L2sqr_sse;
 
+        fp16_vec_inner_product = fp16_vec_inner_product_ref;
+        fp16_vec_L2sqr = fp16_vec_L2sqr_ref;
+        fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_ref;
+        bf16_vec_inner_product = bf16_vec_inner_product_ref;
+        bf16_vec_L2sqr = bf16_vec_L2sqr_ref;
+        bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_ref;
+
+        bvec_hamming_dis = bvec_hamming_dis_sse;
+        bvec_jaccard_dis = bvec_jaccard_dis_sse;
+        bvec_hamming_dis_batch_4 = bvec_hamming_dis_batch_4_sse;
+        bvec_jaccard_dis_batch_4 = bvec_jaccard_dis_batch_4_sse;
+
         simd_type = "SSE4_2";
         support_pq_fast_scan = false;
     } else {
@@ -229,6 +290,18 @@ fvec_hook(std::string& simd_type) {
         ivec_inner_product = ivec_inner_product_ref;
         ivec_L2sqr = ivec_L2sqr_ref;
 
+        fp16_vec_inner_product = fp16_vec_inner_product_ref;
+        fp16_vec_L2sqr = fp16_vec_L2sqr_ref;
+        fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_ref;
+        bf16_vec_inner_product = bf16_vec_inner_product_ref;
+        bf16_vec_L2sqr = bf16_vec_L2sqr_ref;
+        bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_ref;
+
+        bvec_hamming_dis = bvec_hamming_dis_ref;
+        bvec_jaccard_dis = bvec_jaccard_dis_ref;
+        bvec_hamming_dis_batch_4 = bvec_hamming_dis_batch_4_ref;
+        bvec_jaccard_dis_batch_4 = bvec_jaccard_dis_batch_4_ref;
+
         simd_type = "GENERIC";
         support_pq_fast_scan = false;
     }
@@ -249,6 +322,18 @@ fvec_hook(std::string& simd_type) {
     ivec_inner_product = ivec_inner_product_neon;
     ivec_L2sqr = ivec_L2sqr_neon;
 
+    fp16_vec_inner_product = fp16_vec_inner_product_ref;
+    fp16_vec_L2sqr = fp16_vec_L2sqr_ref;
+    fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_ref;
+    bf16_vec_inner_product = bf16_vec_inner_product_ref;
+    bf16_vec_L2sqr = bf16_vec_L2sqr_ref;
+    bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_ref;
+
+    bvec_hamming_dis = bvec_hamming_dis_neon;
+    bvec_jaccard_dis = bvec_jaccard_dis_neon;
+    bvec_hamming_dis_batch_4 = bvec_hamming_dis_batch_4_neon;
+    bvec_jaccard_dis_batch_4 = bvec_jaccard_dis_batch_4_neon;
+
     simd_type = "NEON";
     support_pq_fast_scan = true;
 
@@ -270,6 +355,18 @@ fvec_hook(std::string& simd_type) {
     ivec_inner_product = ivec_inner_product_ref;
     ivec_L2sqr = ivec_L2sqr_ref;
 
+    fp16_vec_inner_product = fp16_vec_inner_product_ref;
+    fp16_vec_L2sqr = fp16_vec_L2sqr_ref;
+    fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_ref;
+    bf16_vec_inner_product = bf16_vec_inner_product_ref;
+    bf16_vec_L2sqr = bf16_vec_L2sqr_ref;
+    bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_ref;
+
+    bvec_hamming_dis = bvec_hamming_dis_ref;
+    bvec_jaccard_dis = bvec_jaccard_dis_ref;
+    bvec_hamming_dis_batch_4 = bvec_hamming_dis_batch_4_ref;
+    bvec_jaccard_dis_batch_4 = bvec_jaccard_dis_batch_4_ref;
+
     simd_type = "GENERIC";
     support_pq_fast_scan = false;
 #endif
@@ -12,7 +12,15 @@
 #ifndef HOOK_H
 #define HOOK_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+
+namespace knowhere {
+struct fp16;
+struct bf16;
+}  // namespace knowhere
+
 namespace faiss {
 
 /// inner product
@@ -74,6 +82,31 @@ extern int32_t (*ivec_inner_product)(const int8_t*, const int8_t*, size_t);
 
 extern int32_t (*ivec_L2sqr)(const int8_t*, const int8_t*, size_t);
 
+/// inner product / squared L2 distance between a fp32 vector and a half
+/// precision vector that is read in place, widening it to fp32 on the fly
+extern float (*fp16_vec_inner_product)(const float*, const knowhere::fp16*, size_t);
+extern float (*fp16_vec_L2sqr)(const float*, const knowhere::fp16*, size_t);
+extern float (*fp16_vec_norm_L2sqr)(const knowhere::fp16*, size_t);
+
+extern float (*bf16_vec_inner_product)(const float*, const knowhere::bf16*, size_t);
+extern float (*bf16_vec_L2sqr)(const float*, const knowhere::bf16*, size_t);
+extern float (*bf16_vec_norm_L2sqr)(const knowhere::bf16*, size_t);
+
+/// Hamming distance (number of differing bits) between two binary codes of
+/// code_size bytes
+extern int (*bvec_hamming_dis)(const uint8_t*, const uint8_t*, size_t);
+
+/// Jaccard distance between two binary codes of code_size bytes, 1.0 if both
+/// codes are all zero
+extern float (*bvec_jaccard_dis)(const uint8_t*, const uint8_t*, size_t);
+
+/// Special versions that compute 4 distances between x and yi, x is loaded
+/// once per register width for all of them
+extern void (*bvec_hamming_dis_batch_4)(const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*,
+                                        const size_t, int&, int&, int&, int&);
+extern void (*bvec_jaccard_dis_batch_4)(const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*,
+                                        const size_t, float&, float&, float&, float&);
+
 #if defined(__x86_64__)
 extern bool use_avx512;
 extern bool use_avx2;
@@ -89,6 +122,8 @@ bool
 cpu_support_avx2();
 bool
 cpu_support_sse4_2();
+bool
+cpu_support_avx512_vpopcntdq();
 #endif
 
 void
@@ -301,6 +301,11 @@ class InstructionSet {
         return f_7_ECX_[0];
     }
 
+    bool
+    AVX512VPOPCNTDQ() {
+        return f_7_ECX_[14];
+    }
+
     bool
     LAHF() {
         return f_81_ECX_[0];
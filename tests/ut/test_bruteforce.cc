@@ -125,6 +125,41 @@ TEST_CASE("Test Brute Force", "[float vector]") {
         check_range_search<knowhere::fp16>(train_ds, query_ds, k, metric, conf);
         check_range_search<knowhere::bf16>(train_ds, query_ds, k, metric, conf);
     }
+
+    SECTION("Test Tiled Search") {
+        // 1MB tiles split 5000 rows of 128 fp32 into 3 tiles
+        const auto large_train_ds = GenDataSet(5000, dim);
+        const auto large_query_ds = CopyDataSet(large_train_ds, nq);
+        auto tiled_conf = conf;
+        tiled_conf["bf_tile_size_mb"] = 1;
+        check_search<knowhere::fp32>(large_train_ds, large_query_ds, k, metric, tiled_conf);
+        check_search<knowhere::fp16>(large_train_ds, large_query_ds, k, metric, tiled_conf);
+        check_search_with_buf<knowhere::fp32>(large_train_ds, large_query_ds, k, metric, tiled_conf);
+        check_search_with_buf<knowhere::bf16>(large_train_ds, large_query_ds, k, metric, tiled_conf);
+
+        auto res = knowhere::BruteForce::Search<knowhere::fp32>(large_train_ds, large_query_ds, conf, nullptr);
+        auto tiled_res =
+            knowhere::BruteForce::Search<knowhere::fp32>(large_train_ds, large_query_ds, tiled_conf, nullptr);
+        REQUIRE(res.has_value());
+        REQUIRE(tiled_res.has_value());
+        for (int64_t i = 0; i < nq * k; i++) {
+            REQUIRE(res.value()->GetIds()[i] == tiled_res.value()->GetIds()[i]);
+            REQUIRE(res.value()->GetDistance()[i] == Approx(tiled_res.value()->GetDistance()[i]).epsilon(0.0001));
+        }
+
+        // the tiles of a single query are split across the search threads.
+        const auto single_query_ds = CopyDataSet(large_train_ds, 1);
+        auto single_res = knowhere::BruteForce::Search<knowhere::fp32>(large_train_ds, single_query_ds, conf, nullptr);
+        auto single_tiled_res =
+            knowhere::BruteForce::Search<knowhere::fp32>(large_train_ds, single_query_ds, tiled_conf, nullptr);
+        REQUIRE(single_res.has_value());
+        REQUIRE(single_tiled_res.has_value());
+        for (int64_t i = 0; i < k; i++) {
+            REQUIRE(single_res.value()->GetIds()[i] == single_tiled_res.value()->GetIds()[i]);
+            REQUIRE(single_res.value()->GetDistance()[i] ==
+                    Approx(single_tiled_res.value()->GetDistance()[i]).epsilon(0.0001));
+        }
+    }
 }
 
 TEST_CASE("Test Brute Force", "[binary vector]") {
@@ -9,13 +9,20 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
+#include <cstring>
+#include <numeric>
+#include <random>
 #include <string>
+#include <thread>
 
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/generators/catch_generators.hpp"
+#include "diskann/linux_aligned_file_reader.h"
+#include "diskann/uring_aligned_file_reader.h"
 #include "index/diskann/diskann_config.h"
 #include "knowhere/comp/brute_force.h"
+#include "knowhere/comp/knowhere_config.h"
 #include "knowhere/comp/local_file_manager.h"
 #include "knowhere/expected.h"
 #include "knowhere/index/index_factory.h"
@@ -293,6 +300,48 @@ base_search() {
                 REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) >= kKnnRecall);
             }
 
+            // knn search with pipelined reads
+            for (const int io_depth : {1, 4, 16}) {
+                knowhere::Json pipelined_json = knn_json;
+                pipelined_json["search_io_depth"] = io_depth;
+                auto res = diskann.Search(query_ds, pipelined_json, nullptr);
+                REQUIRE(res.has_value());
+                REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) > kKnnRecall);
+
+                auto bitset_data = GenerateBitsetWithRandomTbitsSet(kNumRows, 0.4f * kNumRows);
+                knowhere::BitsetView bitset(bitset_data.data(), kNumRows);
+                auto results = diskann.Search(query_ds, pipelined_json, bitset);
+                auto gt = knowhere::BruteForce::Search<DataType>(base_ds, query_ds, pipelined_json, bitset);
+                REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= kKnnRecall);
+            }
+
+            // knn search with the queries sharing their reads, the smaller budget runs out and the queries read the
+            // rest on their own
+            for (const float budget_gb : {0.0625f, 16.0f / (1024 * 1024)}) {
+                for (const int io_depth : {0, 4}) {
+                    knowhere::Json shared_json = knn_json;
+                    shared_json["search_shared_reads_budget_gb"] = budget_gb;
+                    shared_json["search_io_depth"] = io_depth;
+                    auto res = diskann.Search(query_ds, shared_json, nullptr);
+                    REQUIRE(res.has_value());
+                    REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) > kKnnRecall);
+                }
+            }
+
+            // knn search with the cache refreshed while searching
+            {
+                knowhere::Json adaptive_json = deserialize_json;
+                adaptive_json["cache_refresh_interval"] = 4;
+                auto diskann_adaptive =
+                    knowhere::IndexFactory::Instance().Create<DataType>("DISKANN", version, diskann_index_pack).value();
+                REQUIRE(diskann_adaptive.Deserialize(binset, adaptive_json) == knowhere::Status::success);
+                for (int round = 0; round < 20; ++round) {
+                    auto res = diskann_adaptive.Search(query_ds, knn_json, nullptr);
+                    REQUIRE(res.has_value());
+                    REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) > kKnnRecall);
+                }
+            }
+
             // knn search with bitset
             std::vector<std::function<std::vector<uint8_t>(size_t, size_t)>> gen_bitset_funcs = {
                 GenerateBitsetWithFirstTbitsSet, GenerateBitsetWithRandomTbitsSet};
@@ -334,6 +383,103 @@ TEST_CASE("Test DiskANNIndexNode.", "[diskann]") {
     base_search<knowhere::fp32>();
 }
 
+TEST_CASE("Test DiskANNIndexNode with io_uring", "[diskann]") {
+    if (!knowhere::KnowhereConfig::SetIoUring(true)) {
+        WARN("io_uring is not supported, skipped");
+        return;
+    }
+    base_search<knowhere::fp32>();
+    knowhere::KnowhereConfig::SetIoUring(false);
+}
+
+TEST_CASE("Test DiskANN aligned file readers", "[diskann]") {
+    constexpr size_t kSectorLen = 4096;
+    constexpr size_t kNumSectors = 1024;
+    fs::remove_all(kDir);
+    REQUIRE_NOTHROW(fs::create_directories(kDir));
+    std::string file_path = kDir + "/sectors";
+    std::vector<uint32_t> content(kSectorLen * kNumSectors / sizeof(uint32_t));
+    std::iota(content.begin(), content.end(), 0);
+    {
+        std::ofstream writer(file_path, std::ios::binary);
+        writer.write((char*)content.data(), content.size() * sizeof(uint32_t));
+    }
+
+    // random sector reads, more of them than a context takes at once.
+    const size_t num_reads = 300;
+    std::vector<uint64_t> sectors(num_reads);
+    std::mt19937 rng(42);
+    for (auto& sector : sectors) {
+        sector = rng() % kNumSectors;
+    }
+    char* buf = nullptr;
+    diskann::alloc_aligned((void**)&buf, num_reads * kSectorLen, kSectorLen);
+    auto check = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (memcmp(buf + i * kSectorLen, (char*)content.data() + sectors[i] * kSectorLen, kSectorLen) != 0) {
+                return false;
+            }
+        }
+        return true;
+    };
+    // returns whether all reads got the right sectors, not using REQUIRE as it may run in another thread.
+    auto test_reader = [&](std::shared_ptr<AlignedFileReader> reader) {
+        reader->open(file_path);
+        auto ctx = reader->get_ctx();
+        std::vector<AlignedRead> reqs;
+        for (size_t i = 0; i < num_reads; ++i) {
+            reqs.emplace_back(sectors[i] * kSectorLen, kSectorLen, buf + i * kSectorLen);
+        }
+        memset(buf, 0, num_reads * kSectorLen);
+        reader->read(reqs, ctx);
+        bool ok = check(0, num_reads);
+
+        // submit and wait for a batch at a time
+        memset(buf, 0, num_reads * kSectorLen);
+        const size_t batch_size = std::min<size_t>(reader->max_events_per_ctx(), 32);
+        for (size_t begin = 0; begin < num_reads; begin += batch_size) {
+            auto end = std::min(begin + batch_size, num_reads);
+            std::vector<AlignedRead> batch(reqs.begin() + begin, reqs.begin() + end);
+            reader->submit_req(ctx, batch);
+            reader->get_submitted_req(ctx, batch.size());
+            ok = ok && check(begin, end);
+        }
+        reader->put_ctx(ctx);
+        reader->close();
+        return ok;
+    };
+
+    SECTION("libaio") {
+        REQUIRE(test_reader(std::make_shared<LinuxAlignedFileReader>()));
+    }
+    SECTION("io_uring") {
+        if (UringAlignedFileReader::InitGlobalUring(true, false)) {
+            REQUIRE(test_reader(std::make_shared<UringAlignedFileReader>()));
+            // reads of a new thread go through a ring of its own.
+            bool ok = false;
+            std::thread([&] { ok = test_reader(std::make_shared<UringAlignedFileReader>()); }).join();
+            REQUIRE(ok);
+            UringAlignedFileReader::InitGlobalUring(false, false);
+        } else {
+            WARN("io_uring is not supported, skipped");
+        }
+    }
+    SECTION("io_uring with sqpoll") {
+        // falls back to a ring without sqpoll where the kernel can't poll reads of files not registered.
+        if (UringAlignedFileReader::InitGlobalUring(true, true)) {
+            REQUIRE(test_reader(std::make_shared<UringAlignedFileReader>()));
+            bool ok = false;
+            std::thread([&] { ok = test_reader(std::make_shared<UringAlignedFileReader>()); }).join();
+            REQUIRE(ok);
+            UringAlignedFileReader::InitGlobalUring(false, false);
+        } else {
+            WARN("io_uring is not supported, skipped");
+        }
+    }
+    diskann::aligned_free(buf);
+    fs::remove_all(kDir);
+}
+
 // This test case only check L2
 TEST_CASE("Test DiskANN GetVectorByIds", "[diskann]") {
     auto version = GenTestVersionList();
@@ -415,3 +561,349 @@ TEST_CASE("Test DiskANN GetVectorByIds", "[diskann]") {
     fs::remove_all(kDir);
     fs::remove(kDir);
 }
+
+// This test case only check L2
+TEST_CASE("Test DiskANN page aware layout", "[diskann]") {
+    auto version = GenTestVersionList();
+    fs::remove_all(kDir);
+    fs::remove(kDir);
+    REQUIRE_NOTHROW(fs::create_directories(kL2IndexDir));
+
+    auto base_gen = [&] {
+        knowhere::Json json;
+        json["dim"] = kDim;
+        json["metric_type"] = knowhere::metric::L2;
+        json["k"] = kK;
+        json["index_prefix"] = kL2IndexPrefix;
+        return json;
+    };
+
+    auto query_ds = GenDataSet(kNumQueries, kDim, 42);
+    auto base_ds = GenDataSet(kNumRows, kDim, 30);
+    WriteRawDataToDisk<float>(kRawDataPath, static_cast<const float*>(base_ds->GetTensor()), kNumRows, kDim);
+
+    std::shared_ptr<knowhere::FileManager> file_manager = std::make_shared<knowhere::LocalFileManager>();
+    auto diskann_index_pack = knowhere::Pack(file_manager);
+    knowhere::BinarySet binset;
+    {
+        knowhere::Json json = base_gen();
+        json["data_path"] = kRawDataPath;
+        json["max_degree"] = 56;
+        json["search_list_size"] = 128;
+        json["pq_code_budget_gb"] = sizeof(float) * kDim * kNumRows * 0.125 / (1024 * 1024 * 1024);
+        json["build_dram_budget_gb"] = 32.0;
+        json["page_aware_layout"] = true;
+        knowhere::DataSetPtr ds_ptr = nullptr;
+        auto diskann =
+            knowhere::IndexFactory::Instance().Create<knowhere::fp32>("DISKANN", version, diskann_index_pack).value();
+        REQUIRE(diskann.Build(ds_ptr, json) == knowhere::Status::success);
+        REQUIRE(fs::exists(diskann::get_disk_index_layout_filename(diskann::get_disk_index_filename(kL2IndexPrefix))));
+        diskann.Serialize(binset);
+    }
+
+    auto index =
+        knowhere::IndexFactory::Instance().Create<knowhere::fp32>("DISKANN", version, diskann_index_pack).value();
+    knowhere::Json deserialize_json = base_gen();
+    deserialize_json["search_cache_budget_gb"] = sizeof(float) * kDim * kNumRows * 0.125 / (1024 * 1024 * 1024);
+    REQUIRE(index.Deserialize(binset, deserialize_json) == knowhere::Status::success);
+
+    // the nodes are found at their new locations
+    auto ids_ds = GenIdsDataSet(kNumRows, kNumRows);
+    auto vectors = index.GetVectorByIds(ids_ds);
+    REQUIRE(vectors.has_value());
+    auto xb = static_cast<const float*>(base_ds->GetTensor());
+    auto data = static_cast<const float*>(vectors.value()->GetTensor());
+    for (size_t i = 0; i < kNumRows; ++i) {
+        auto id = ids_ds->GetIds()[i];
+        REQUIRE(memcmp(data + i * kDim, xb + id * kDim, kDim * sizeof(float)) == 0);
+    }
+
+    // the search expands the nodes read along with each node
+    knowhere::Json knn_json = base_gen();
+    knn_json["search_list_size"] = 36;
+    knn_json["beamwidth"] = 8;
+    auto knn_gt = knowhere::BruteForce::Search<knowhere::fp32>(base_ds, query_ds, knn_json, nullptr);
+    auto bitset_data = GenerateBitsetWithRandomTbitsSet(kNumRows, 0.4f * kNumRows);
+    knowhere::BitsetView bitset(bitset_data.data(), kNumRows);
+    auto bitset_gt = knowhere::BruteForce::Search<knowhere::fp32>(base_ds, query_ds, knn_json, bitset);
+    for (const int io_depth : {0, 4}) {
+        knn_json["search_io_depth"] = io_depth;
+        auto res = index.Search(query_ds, knn_json, nullptr);
+        REQUIRE(res.has_value());
+        REQUIRE(GetKNNRecall(*knn_gt.value(), *res.value()) > kKnnRecall);
+        res = index.Search(query_ds, knn_json, bitset);
+        REQUIRE(res.has_value());
+        REQUIRE(GetKNNRecall(*bitset_gt.value(), *res.value()) >= kKnnRecall);
+    }
+
+    // a layout that puts a point at two locations fails the load
+    {
+        auto layout_file = diskann::get_disk_index_layout_filename(diskann::get_disk_index_filename(kL2IndexPrefix));
+        std::fstream layout(layout_file, std::ios::binary | std::ios::in | std::ios::out);
+        uint32_t first_id;
+        layout.seekg(2 * sizeof(uint32_t));
+        layout.read((char*)&first_id, sizeof(first_id));
+        layout.seekp(3 * sizeof(uint32_t));
+        layout.write((const char*)&first_id, sizeof(first_id));
+        layout.close();
+        auto corrupted =
+            knowhere::IndexFactory::Instance().Create<knowhere::fp32>("DISKANN", version, diskann_index_pack).value();
+        REQUIRE(corrupted.Deserialize(binset, deserialize_json) != knowhere::Status::success);
+    }
+    fs::remove_all(kDir);
+    fs::remove(kDir);
+}
+
+TEST_CASE("Test DiskANN navigation graph", "[diskann]") {
+    auto version = GenTestVersionList();
+    fs::remove_all(kDir);
+    fs::remove(kDir);
+    REQUIRE_NOTHROW(fs::create_directories(kL2IndexDir));
+    REQUIRE_NOTHROW(fs::create_directories(kIPIndexDir));
+
+    auto metric_str = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP);
+    std::unordered_map<knowhere::MetricType, std::string> metric_dir_map = {
+        {knowhere::metric::L2, kL2IndexPrefix},
+        {knowhere::metric::IP, kIPIndexPrefix},
+    };
+    auto base_gen = [&] {
+        knowhere::Json json;
+        json["dim"] = kDim;
+        json["metric_type"] = metric_str;
+        json["k"] = kK;
+        json["index_prefix"] = metric_dir_map[metric_str];
+        return json;
+    };
+
+    auto query_ds = GenDataSet(kNumQueries, kDim, 42);
+    auto base_ds = GenDataSet(kNumRows, kDim, 30);
+    WriteRawDataToDisk<float>(kRawDataPath, static_cast<const float*>(base_ds->GetTensor()), kNumRows, kDim);
+
+    std::shared_ptr<knowhere::FileManager> file_manager = std::make_shared<knowhere::LocalFileManager>();
+    auto diskann_index_pack = knowhere::Pack(file_manager);
+    knowhere::BinarySet binset;
+    {
+        knowhere::Json json = base_gen();
+        json["data_path"] = kRawDataPath;
+        json["max_degree"] = 56;
+        json["search_list_size"] = 128;
+        // half of it for the navigation graph, a few hundred points
+        json["pq_code_budget_gb"] = sizeof(float) * kDim * kNumRows / (1024.0 * 1024 * 1024);
+        json["nav_graph_budget_ratio"] = 0.5f;
+        json["build_dram_budget_gb"] = 32.0;
+        knowhere::DataSetPtr ds_ptr = nullptr;
+        auto diskann =
+            knowhere::IndexFactory::Instance().Create<knowhere::fp32>("DISKANN", version, diskann_index_pack).value();
+        REQUIRE(diskann.Build(ds_ptr, json) == knowhere::Status::success);
+        auto disk_index_file = diskann::get_disk_index_filename(metric_dir_map[metric_str]);
+        REQUIRE(fs::exists(diskann::get_disk_index_nav_graph_filename(disk_index_file)));
+        diskann.Serialize(binset);
+    }
+
+    auto index =
+        knowhere::IndexFactory::Instance().Create<knowhere::fp32>("DISKANN", version, diskann_index_pack).value();
+    REQUIRE(index.Deserialize(binset, base_gen()) == knowhere::Status::success);
+
+    // the searches start from the points the navigation graph finds
+    knowhere::Json knn_json = base_gen();
+    knn_json["search_list_size"] = 36;
+    knn_json["beamwidth"] = 8;
+    auto knn_gt = knowhere::BruteForce::Search<knowhere::fp32>(base_ds, query_ds, knn_json, nullptr);
+    auto bitset_data = GenerateBitsetWithRandomTbitsSet(kNumRows, 0.4f * kNumRows);
+    knowhere::BitsetView bitset(bitset_data.data(), kNumRows);
+    auto bitset_gt = knowhere::BruteForce::Search<knowhere::fp32>(base_ds, query_ds, knn_json, bitset);
+    for (const int io_depth : {0, 4}) {
+        knn_json["search_io_depth"] = io_depth;
+        auto res = index.Search(query_ds, knn_json, nullptr);
+        REQUIRE(res.has_value());
+        REQUIRE(GetKNNRecall(*knn_gt.value(), *res.value()) > kKnnRecall);
+        res = index.Search(query_ds, knn_json, bitset);
+        REQUIRE(res.has_value());
+        REQUIRE(GetKNNRecall(*bitset_gt.value(), *res.value()) >= kKnnRecall);
+    }
+    fs::remove_all(kDir);
+    fs::remove(kDir);
+}
+
+TEST_CASE("Test DiskANN inserts and deletes", "[diskann]") {
+    auto version = GenTestVersionList();
+    fs::remove_all(kDir);
+    fs::remove(kDir);
+    REQUIRE_NOTHROW(fs::create_directories(kL2IndexDir));
+    REQUIRE_NOTHROW(fs::create_directories(kCOSINEIndexDir));
+
+    auto metric_str = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::COSINE);
+    std::unordered_map<knowhere::MetricType, std::string> metric_dir_map = {
+        {knowhere::metric::L2, kL2IndexPrefix},
+        {knowhere::metric::COSINE, kCOSINEIndexPrefix},
+    };
+    auto base_gen = [&] {
+        knowhere::Json json;
+        json["dim"] = kDim;
+        json["metric_type"] = metric_str;
+        json["k"] = kK;
+        json["index_prefix"] = metric_dir_map[metric_str];
+        json["data_path"] = kRawDataPath;
+        json["max_degree"] = 56;
+        json["search_list_size"] = 128;
+        json["pq_code_budget_gb"] = sizeof(float) * kDim * kNumRows * 0.125 / (1024 * 1024 * 1024);
+        json["build_dram_budget_gb"] = 32.0;
+        // a merge every 200 inserts or deletes
+        json["delta_merge_threshold"] = 200;
+        return json;
+    };
+
+    // the index is built with the first kNumRows points, the others are inserted
+    constexpr uint32_t kNumInserts = 500;
+    auto all_ds = GenDataSet(kNumRows + kNumInserts, kDim, 30);
+    auto all_data = static_cast<const float*>(all_ds->GetTensor());
+    auto insert_ds = knowhere::GenDataSet(kNumInserts, kDim, all_data + kNumRows * kDim);
+    auto query_ds = GenDataSet(kNumQueries, kDim, 42);
+    WriteRawDataToDisk<float>(kRawDataPath, all_data, kNumRows, kDim);
+
+    std::shared_ptr<knowhere::FileManager> file_manager = std::make_shared<knowhere::LocalFileManager>();
+    auto diskann_index_pack = knowhere::Pack(file_manager);
+    knowhere::BinarySet binset;
+    {
+        knowhere::DataSetPtr ds_ptr = nullptr;
+        auto diskann =
+            knowhere::IndexFactory::Instance().Create<knowhere::fp32>("DISKANN", version, diskann_index_pack).value();
+        REQUIRE(diskann.Build(ds_ptr, base_gen()) == knowhere::Status::success);
+        diskann.Serialize(binset);
+    }
+    const auto disk_index_file = diskann::get_disk_index_filename(metric_dir_map[metric_str]);
+    const auto built_disk_index_file = kDir + "/built_disk.index";
+    REQUIRE(fs::copy_file(disk_index_file, built_disk_index_file));
+
+    // one in five points deleted, inserted ones included
+    std::vector<int64_t> deleted_ids;
+    std::vector<uint8_t> deleted_bits((kNumRows + kNumInserts + 7) / 8, 0);
+    for (uint32_t i = 0; i < kNumRows + kNumInserts; i += 5) {
+        deleted_ids.push_back(i);
+        deleted_bits[i / 8] |= 1 << (i % 8);
+    }
+    knowhere::BitsetView deleted_view(deleted_bits.data(), kNumRows + kNumInserts);
+    knowhere::Json knn_json = base_gen();
+    knn_json["search_list_size"] = 36;
+    knn_json["beamwidth"] = 8;
+    auto knn_gt = knowhere::BruteForce::Search<knowhere::fp32>(all_ds, query_ds, knn_json, deleted_view);
+    auto check_search = [&](const knowhere::Index<knowhere::IndexNode>& index) {
+        REQUIRE(index.Count() == kNumRows + kNumInserts);
+        auto res = index.Search(query_ds, knn_json, nullptr);
+        REQUIRE(res.has_value());
+        REQUIRE(GetKNNRecall(*knn_gt.value(), *res.value()) > kKnnRecall);
+        auto ids = res.value()->GetIds();
+        for (uint32_t i = 0; i < kNumQueries * kK; i++) {
+            REQUIRE(ids[i] >= 0);
+            REQUIRE(!deleted_view.test(ids[i]));
+        }
+
+        std::vector<int64_t> vector_ids = {3, kNumRows + 3, kNumRows + kNumInserts - 1};
+        auto vectors = index.GetVectorByIds(GenIdsDataSet(vector_ids.size(), vector_ids));
+        REQUIRE(vectors.has_value());
+        auto data = static_cast<const float*>(vectors.value()->GetTensor());
+        for (size_t i = 0; i < vector_ids.size(); i++) {
+            REQUIRE(std::memcmp(data + i * kDim, all_data + vector_ids[i] * kDim, kDim * sizeof(float)) == 0);
+        }
+    };
+
+    {
+        auto index =
+            knowhere::IndexFactory::Instance().Create<knowhere::fp32>("DISKANN", version, diskann_index_pack).value();
+        REQUIRE(index.Deserialize(binset, base_gen()) == knowhere::Status::success);
+        REQUIRE(index.Add(insert_ds, base_gen()) == knowhere::Status::success);
+        REQUIRE(index.DeleteByIds(GenIdsDataSet(deleted_ids.size(), deleted_ids)) == knowhere::Status::success);
+        // some of the inserts and deletes are merged, the others are pending
+        check_search(index);
+        // merges the pending ones
+        REQUIRE(index.Flush() == knowhere::Status::success);
+        check_search(index);
+    }
+    REQUIRE(fs::exists(diskann::get_disk_index_deleted_filename(
+        diskann::get_disk_index_filename(metric_dir_map[metric_str]))));
+
+    // the index files hold the inserts and deletes
+    {
+        auto index =
+            knowhere::IndexFactory::Instance().Create<knowhere::fp32>("DISKANN", version, diskann_index_pack).value();
+        REQUIRE(index.Deserialize(binset, base_gen()) == knowhere::Status::success);
+        check_search(index);
+    }
+
+    // a merge interrupted once its manifest was written, with the disk index left to replace, is completed by the
+    // next load
+    const auto manifest = diskann::get_disk_index_merge_manifest_filename(disk_index_file);
+    fs::rename(disk_index_file, disk_index_file + ".merge");
+    REQUIRE(fs::copy_file(built_disk_index_file, disk_index_file));
+    {
+        std::ofstream writer(manifest);
+        writer << disk_index_file << '\n';
+    }
+    {
+        auto index =
+            knowhere::IndexFactory::Instance().Create<knowhere::fp32>("DISKANN", version, diskann_index_pack).value();
+        REQUIRE(index.Deserialize(binset, base_gen()) == knowhere::Status::success);
+        check_search(index);
+    }
+    REQUIRE(!fs::exists(disk_index_file + ".merge"));
+    REQUIRE(!fs::exists(manifest));
+
+    // the files of a merge interrupted before its manifest was written are left out
+    REQUIRE(fs::copy_file(built_disk_index_file, disk_index_file + ".merge"));
+    {
+        std::ofstream writer(manifest + ".merge");
+        writer << disk_index_file << '\n';
+    }
+    {
+        auto index =
+            knowhere::IndexFactory::Instance().Create<knowhere::fp32>("DISKANN", version, diskann_index_pack).value();
+        REQUIRE(index.Deserialize(binset, base_gen()) == knowhere::Status::success);
+        check_search(index);
+    }
+    REQUIRE(!fs::exists(disk_index_file + ".merge"));
+    REQUIRE(!fs::exists(manifest + ".merge"));
+    fs::remove_all(kDir);
+    fs::remove(kDir);
+}
+
+TEST_CASE("Test DiskANN updates of an index with disk PQ", "[diskann]") {
+    auto version = GenTestVersionList();
+    fs::remove_all(kDir);
+    fs::remove(kDir);
+    REQUIRE_NOTHROW(fs::create_directories(kL2IndexDir));
+
+    knowhere::Json json;
+    json["dim"] = kDim;
+    json["metric_type"] = knowhere::metric::L2;
+    json["k"] = kK;
+    json["index_prefix"] = kL2IndexPrefix;
+    json["data_path"] = kRawDataPath;
+    json["max_degree"] = 56;
+    json["search_list_size"] = 128;
+    json["pq_code_budget_gb"] = sizeof(float) * kDim * kNumRows * 0.125 / (1024 * 1024 * 1024);
+    json["build_dram_budget_gb"] = 32.0;
+    // the nodes hold PQ codes, which the merges can't rewrite
+    json["disk_pq_dims"] = kDim / 4;
+    auto base_ds = GenDataSet(kNumRows, kDim, 30);
+    WriteRawDataToDisk<float>(kRawDataPath, static_cast<const float*>(base_ds->GetTensor()), kNumRows, kDim);
+
+    std::shared_ptr<knowhere::FileManager> file_manager = std::make_shared<knowhere::LocalFileManager>();
+    auto diskann_index_pack = knowhere::Pack(file_manager);
+    knowhere::BinarySet binset;
+    {
+        knowhere::DataSetPtr ds_ptr = nullptr;
+        auto diskann =
+            knowhere::IndexFactory::Instance().Create<knowhere::fp32>("DISKANN", version, diskann_index_pack).value();
+        REQUIRE(diskann.Build(ds_ptr, json) == knowhere::Status::success);
+        diskann.Serialize(binset);
+    }
+    auto index =
+        knowhere::IndexFactory::Instance().Create<knowhere::fp32>("DISKANN", version, diskann_index_pack).value();
+    REQUIRE(index.Deserialize(binset, json) == knowhere::Status::success);
+    REQUIRE(index.Add(GenDataSet(10, kDim, 42), json) == knowhere::Status::not_implemented);
+    REQUIRE(index.DeleteByIds(GenIdsDataSet(kNumRows, 10)) == knowhere::Status::not_implemented);
+    REQUIRE(index.Count() == kNumRows);
+    REQUIRE(index.Flush() == knowhere::Status::success);
+    fs::remove_all(kDir);
+    fs::remove(kDir);
+}
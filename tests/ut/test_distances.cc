@@ -3,6 +3,7 @@
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include <random>
 
+#include "knowhere/operands.h"
 #include "simd/distances_ref.h"
 #include "simd/hook.h"
 TEST_CASE("Test Distance Compute", "[distance]") {
@@ -108,4 +109,64 @@ TEST_CASE("Test Distance Compute", "[distance]") {
             }
         }
     }
+    SECTION("Test Half Precision Distance Compute") {
+        std::uniform_real_distribution<float> half_fill_distrib(-1, 1);
+        for (int i = 0; i < 1000; ++i) {
+            CAPTURE(i);
+            auto len = distrib(rng) % 1024 + 1;
+            std::vector<float> a(len);
+            std::vector<knowhere::fp16> b_fp16(len);
+            std::vector<knowhere::bf16> b_bf16(len);
+            for (int i = 0; i < len; ++i) {
+                a[i] = half_fill_distrib(rng);
+                b_fp16[i] = half_fill_distrib(rng);
+                b_bf16[i] = half_fill_distrib(rng);
+            }
+            REQUIRE_THAT(faiss::fp16_vec_L2sqr(a.data(), b_fp16.data(), len),
+                         Catch::Matchers::WithinAbs(faiss::fp16_vec_L2sqr_ref(a.data(), b_fp16.data(), len), 0.01f));
+            REQUIRE_THAT(
+                faiss::fp16_vec_inner_product(a.data(), b_fp16.data(), len),
+                Catch::Matchers::WithinAbs(faiss::fp16_vec_inner_product_ref(a.data(), b_fp16.data(), len), 0.01f));
+            REQUIRE_THAT(faiss::fp16_vec_norm_L2sqr(b_fp16.data(), len),
+                         Catch::Matchers::WithinAbs(faiss::fp16_vec_norm_L2sqr_ref(b_fp16.data(), len), 0.01f));
+            REQUIRE_THAT(faiss::bf16_vec_L2sqr(a.data(), b_bf16.data(), len),
+                         Catch::Matchers::WithinAbs(faiss::bf16_vec_L2sqr_ref(a.data(), b_bf16.data(), len), 0.01f));
+            REQUIRE_THAT(
+                faiss::bf16_vec_inner_product(a.data(), b_bf16.data(), len),
+                Catch::Matchers::WithinAbs(faiss::bf16_vec_inner_product_ref(a.data(), b_bf16.data(), len), 0.01f));
+            REQUIRE_THAT(faiss::bf16_vec_norm_L2sqr(b_bf16.data(), len),
+                         Catch::Matchers::WithinAbs(faiss::bf16_vec_norm_L2sqr_ref(b_bf16.data(), len), 0.01f));
+        }
+    }
+
+    SECTION("Test Binary Code Distance Compute") {
+        std::uniform_int_distribution<int> byte_distrib(0, 255);
+        for (int i = 0; i < 1000; ++i) {
+            CAPTURE(i);
+            auto code_size = distrib(rng) % 512;
+            std::vector<uint8_t> x(code_size);
+            std::vector<std::vector<uint8_t>> y(4, std::vector<uint8_t>(code_size));
+            for (size_t j = 0; j < code_size; ++j) {
+                x[j] = byte_distrib(rng);
+                for (auto& yi : y) {
+                    yi[j] = byte_distrib(rng);
+                }
+            }
+            REQUIRE(faiss::bvec_hamming_dis(x.data(), y[0].data(), code_size) ==
+                    faiss::bvec_hamming_dis_ref(x.data(), y[0].data(), code_size));
+            REQUIRE(faiss::bvec_jaccard_dis(x.data(), y[0].data(), code_size) ==
+                    faiss::bvec_jaccard_dis_ref(x.data(), y[0].data(), code_size));
+
+            int hamming[4];
+            float jaccard[4];
+            faiss::bvec_hamming_dis_batch_4(x.data(), y[0].data(), y[1].data(), y[2].data(), y[3].data(), code_size,
+                                            hamming[0], hamming[1], hamming[2], hamming[3]);
+            faiss::bvec_jaccard_dis_batch_4(x.data(), y[0].data(), y[1].data(), y[2].data(), y[3].data(), code_size,
+                                            jaccard[0], jaccard[1], jaccard[2], jaccard[3]);
+            for (int j = 0; j < 4; ++j) {
+                REQUIRE(hamming[j] == faiss::bvec_hamming_dis_ref(x.data(), y[j].data(), code_size));
+                REQUIRE(jaccard[j] == faiss::bvec_jaccard_dis_ref(x.data(), y[j].data(), code_size));
+            }
+        }
+    }
 }
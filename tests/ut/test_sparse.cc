@@ -59,6 +59,30 @@ TEST_CASE("Test Mem Sparse Index With Float Vector", "[float metrics]") {
         return json;
     };
 
+    auto sparse_daat_wand_gen = [sparse_inverted_index_gen]() {
+        knowhere::Json json = sparse_inverted_index_gen();
+        json[knowhere::indexparam::INVERTED_INDEX_ALGO] = "DAAT_WAND";
+        return json;
+    };
+
+    auto sparse_daat_maxscore_gen = [sparse_inverted_index_gen]() {
+        knowhere::Json json = sparse_inverted_index_gen();
+        json[knowhere::indexparam::INVERTED_INDEX_ALGO] = "DAAT_MAXSCORE";
+        return json;
+    };
+
+    auto sparse_bitpack_gen = [sparse_inverted_index_gen]() {
+        knowhere::Json json = sparse_inverted_index_gen();
+        json[knowhere::indexparam::POSTING_LIST_CODEC] = "BITPACK";
+        return json;
+    };
+
+    auto sparse_bitpack_fp16_gen = [sparse_inverted_index_gen]() {
+        knowhere::Json json = sparse_inverted_index_gen();
+        json[knowhere::indexparam::POSTING_LIST_CODEC] = "BITPACK_FP16";
+        return json;
+    };
+
     const auto train_ds = GenSparseDataSet(nb, dim, doc_sparsity);
     // it is possible the query has more dims than the train dataset.
     const auto query_ds = GenSparseDataSet(nq, dim + 20, query_sparsity);
@@ -102,6 +126,12 @@ TEST_CASE("Test Mem Sparse Index With Float Vector", "[float metrics]") {
         auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
             make_tuple(knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX, sparse_inverted_index_gen),
             make_tuple(knowhere::IndexEnum::INDEX_SPARSE_WAND, sparse_inverted_index_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_SPARSE_WAND, sparse_daat_wand_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_SPARSE_WAND, sparse_daat_maxscore_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX, sparse_bitpack_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_SPARSE_WAND, sparse_bitpack_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX, sparse_bitpack_fp16_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_SPARSE_WAND, sparse_bitpack_fp16_gen),
         }));
         auto gt = knowhere::BruteForce::SearchSparse(train_ds, query_ds, conf, nullptr);
         check_distance_decreasing(*gt.value());
@@ -153,11 +183,163 @@ TEST_CASE("Test Mem Sparse Index With Float Vector", "[float metrics]") {
         }
     }
 
+    SECTION("Test Search Batch") {
+        // a large nq is searched in batches of queries that share posting list reads, results must match searching
+        // the queries one by one.
+        auto name = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX,
+                             knowhere::IndexEnum::INDEX_SPARSE_WAND);
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        knowhere::Json json = sparse_inverted_index_gen();
+        // without dropping, the candidates are not refined and may only differ by rounding.
+        json[knowhere::indexparam::DROP_RATIO_BUILD] = 0.0f;
+        json[knowhere::indexparam::DROP_RATIO_SEARCH] = 0.0f;
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        int64_t batch_nq = 500;
+        const auto batch_query_ds = GenSparseDataSet(batch_nq, dim, query_sparsity);
+        auto results = idx.Search(batch_query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        check_distance_decreasing(*results.value());
+        auto queries = static_cast<const knowhere::sparse::SparseRow<float>*>(batch_query_ds->GetTensor());
+        for (int64_t i = 0; i < batch_nq; ++i) {
+            auto single_ds = knowhere::GenDataSet(1, dim, queries + i);
+            single_ds->SetIsSparse(true);
+            auto single = idx.Search(single_ds, json, nullptr);
+            REQUIRE(single.has_value());
+            for (int j = 0; j < topk; ++j) {
+                auto expected = single.value()->GetDistance()[j];
+                auto actual = results.value()->GetDistance()[i * topk + j];
+                if (std::isnan(expected)) {
+                    REQUIRE(std::isnan(actual));
+                } else {
+                    REQUIRE(std::abs(actual - expected) <= 1e-5 * std::abs(expected));
+                }
+            }
+        }
+    }
+
+    SECTION("Test Seismic Search") {
+        auto gt = knowhere::BruteForce::SearchSparse(train_ds, query_ds, conf, nullptr);
+        // keeping all postings and whole summaries, visiting all query terms and skipping a block only if its
+        // summary can't beat the k-th score makes the search exact.
+        auto exact = GENERATE(true, false);
+        auto use_mmap = GENERATE(true, false);
+        auto tmp_file = "/tmp/knowhere_sparse_seismic_index_test";
+        knowhere::Json json = sparse_inverted_index_gen();
+        if (exact) {
+            json[knowhere::indexparam::DROP_RATIO_SEARCH] = 0.0f;
+            json[knowhere::indexparam::SEISMIC_N_POSTINGS] = nb;
+            json[knowhere::indexparam::SEISMIC_SUMMARY_ENERGY] = 1.0f;
+            json[knowhere::indexparam::SEISMIC_QUERY_CUT] = dim;
+            json[knowhere::indexparam::SEISMIC_HEAP_FACTOR] = 1.0f;
+        }
+        CAPTURE(exact, use_mmap, json.dump());
+        {
+            auto idx = knowhere::IndexFactory::Instance()
+                           .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_SPARSE_SEISMIC, version)
+                           .value();
+            REQUIRE(idx.Type() == knowhere::IndexEnum::INDEX_SPARSE_SEISMIC);
+            REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+            REQUIRE(idx.Count() == nb);
+
+            knowhere::BinarySet bs;
+            REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+            if (use_mmap) {
+                auto binary = bs.GetByName(idx.Type());
+                std::remove(tmp_file);
+                std::ofstream out(tmp_file, std::ios::binary);
+                out.write((const char*)binary->data.get(), binary->size);
+                out.close();
+                REQUIRE(idx.DeserializeFromFile(tmp_file, json) == knowhere::Status::success);
+            } else {
+                REQUIRE(idx.Deserialize(bs, json) == knowhere::Status::success);
+            }
+
+            auto results = idx.Search(query_ds, json, nullptr);
+            REQUIRE(results.has_value());
+            check_distance_decreasing(*results.value());
+            float recall = GetKNNRecall(*gt.value(), *results.value());
+            if (exact) {
+                REQUIRE(recall == 1);
+            } else {
+                // the default params trade recall for speed, lowest on the BM25 cases with few query terms.
+                REQUIRE(recall >= 0.6);
+            }
+
+            auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, 0.4f * nb);
+            knowhere::BitsetView bitset(bitset_data.data(), nb);
+            auto filtered = idx.Search(query_ds, json, bitset);
+            REQUIRE(filtered.has_value());
+            check_result_match_filter(*filtered.value(), bitset);
+            // idx to destruct and munmap
+        }
+        if (use_mmap) {
+            REQUIRE(std::remove(tmp_file) == 0);
+        }
+    }
+
+    SECTION("Test Posting List Codec Rejects Non Integer Values") {
+        auto name = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX,
+                             knowhere::IndexEnum::INDEX_SPARSE_WAND);
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        knowhere::Json json = sparse_inverted_index_gen();
+        json[knowhere::indexparam::POSTING_LIST_CODEC] = "BITPACK_UINT8";
+        // GenSparseDataSet generates float values in [0, 1).
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::invalid_args);
+        json[knowhere::indexparam::POSTING_LIST_CODEC] = "UNKNOWN";
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::invalid_args);
+    }
+
+    SECTION("Test Brute Force Term At A Time") {
+        // the queries are sparser than the docs, so brute force takes the term-at-a-time path; compare it against a
+        // row by row scan.
+        auto gen_bitset_fn = GENERATE(GenerateBitsetWithFirstTbitsSet, GenerateBitsetWithRandomTbitsSet);
+        auto bitset_data = gen_bitset_fn(nb, 0.4f * nb);
+        knowhere::BitsetView bitset(bitset_data.data(), nb);
+        auto res = knowhere::BruteForce::SearchSparse(train_ds, query_ds, conf, bitset);
+        REQUIRE(res.has_value());
+        check_result_match_filter(*res.value(), bitset);
+        check_distance_decreasing(*res.value());
+
+        auto base = static_cast<const knowhere::sparse::SparseRow<float>*>(train_ds->GetTensor());
+        auto queries = static_cast<const knowhere::sparse::SparseRow<float>*>(query_ds->GetTensor());
+        auto computer = metric == knowhere::metric::BM25
+                            ? knowhere::sparse::GetDocValueBM25Computer<float>(1.2, 0.75, 100)
+                            : knowhere::sparse::GetDocValueOriginalComputer<float>();
+        auto ids = res.value()->GetIds();
+        auto distances = res.value()->GetDistance();
+        for (int64_t i = 0; i < nq; ++i) {
+            knowhere::sparse::MaxMinHeap<float> heap(topk);
+            for (int32_t j = 0; j < nb; ++j) {
+                if (bitset.test(j)) {
+                    continue;
+                }
+                float row_sum = 0;
+                if (metric == knowhere::metric::BM25) {
+                    for (size_t k = 0; k < base[j].size(); ++k) {
+                        row_sum += base[j][k].val;
+                    }
+                }
+                float dist = queries[i].dot(base[j], computer, row_sum);
+                if (dist > 0) {
+                    heap.push(j, dist);
+                }
+            }
+            for (int j = heap.size() - 1; j >= 0; --j) {
+                REQUIRE(ids[i * topk + j] == heap.top().id);
+                REQUIRE(distances[i * topk + j] == heap.top().val);
+                heap.pop();
+            }
+        }
+    }
+
     SECTION("Test Search with Bitset") {
         using std::make_tuple;
         auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
             make_tuple(knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX, sparse_inverted_index_gen),
             make_tuple(knowhere::IndexEnum::INDEX_SPARSE_WAND, sparse_inverted_index_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_SPARSE_WAND, sparse_daat_wand_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_SPARSE_WAND, sparse_daat_maxscore_gen),
         }));
         auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
         auto cfg_json = gen().dump();
@@ -297,6 +479,89 @@ TEST_CASE("Test Mem Sparse Index With Float Vector", "[float metrics]") {
         // most above 0.95, only a few between 0.9 and 0.85
         REQUIRE(actual_count * 1.0f / gt_count >= 0.85);
     }
+
+    SECTION("Test Sparse Range Search Matches Brute Force") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX, sparse_inverted_index_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX, sparse_bitpack_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_SPARSE_WAND, sparse_inverted_index_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_SPARSE_SEISMIC, sparse_inverted_index_gen),
+        }));
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        knowhere::Json json = gen();
+        // range search is exact if no values are dropped.
+        json[knowhere::indexparam::DROP_RATIO_BUILD] = 0.0f;
+        json[knowhere::indexparam::DROP_RATIO_SEARCH] = 0.0f;
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        // large radiuses leave some query terms to only score the docs that other terms have scored.
+        auto [radius, range_filter] = GENERATE(table<float, float>({
+            {-1, 1},
+            {0, 10000},
+            {0.5, 1},
+            {1, 10000},
+            {3, 10000},
+        }));
+        json[knowhere::meta::RADIUS] = radius;
+        json[knowhere::meta::RANGE_FILTER] = range_filter;
+        auto filtered = GENERATE(false, true);
+        auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, 0.4f * nb);
+        auto bitset = filtered ? knowhere::BitsetView(bitset_data.data(), nb) : knowhere::BitsetView();
+        CAPTURE(name, json.dump(), filtered);
+
+        auto results = idx.RangeSearch(query_ds, json, bitset);
+        REQUIRE(results.has_value());
+        auto gt =
+            knowhere::BruteForce::RangeSearch<knowhere::sparse::SparseRow<float>>(train_ds, query_ds, json, bitset);
+        REQUIRE(gt.has_value());
+
+        auto ids = results.value()->GetIds();
+        auto lims = results.value()->GetLims();
+        auto distances = results.value()->GetDistance();
+        auto ids_gt = gt.value()->GetIds();
+        auto lims_gt = gt.value()->GetLims();
+        auto distances_gt = gt.value()->GetDistance();
+        // scores summed in a different order may differ in the last bits, which only matters at the bounds.
+        auto close = [](float a, float b) { return std::abs(a - b) <= 1e-4f * std::max(1.0f, std::abs(b)); };
+        auto at_bound = [&](float dist) { return close(dist, radius) || close(dist, range_filter); };
+        for (int i = 0; i < nq; ++i) {
+            std::unordered_map<int64_t, float> gt_distances;
+            for (size_t j = lims_gt[i]; j < lims_gt[i + 1]; ++j) {
+                gt_distances.emplace(ids_gt[j], distances_gt[j]);
+            }
+            for (size_t j = lims[i]; j < lims[i + 1]; ++j) {
+                REQUIRE(distances[j] > radius);
+                REQUIRE(distances[j] <= range_filter);
+                REQUIRE((bitset.empty() || !bitset.test(ids[j])));
+                auto it = gt_distances.find(ids[j]);
+                if (it == gt_distances.end()) {
+                    REQUIRE(at_bound(distances[j]));
+                } else {
+                    REQUIRE(close(distances[j], it->second));
+                    gt_distances.erase(it);
+                }
+            }
+            for (auto [id, dist] : gt_distances) {
+                REQUIRE(at_bound(dist));
+            }
+        }
+
+        // range_search_k keeps the closest docs in range.
+        json[knowhere::meta::RANGE_SEARCH_K] = 3;
+        auto top_results = idx.RangeSearch(query_ds, json, bitset);
+        REQUIRE(top_results.has_value());
+        auto top_lims = top_results.value()->GetLims();
+        auto top_distances = top_results.value()->GetDistance();
+        for (int i = 0; i < nq; ++i) {
+            std::vector<float> all(distances + lims[i], distances + lims[i + 1]);
+            std::sort(all.begin(), all.end(), std::greater<float>());
+            std::vector<float> top(top_distances + top_lims[i], top_distances + top_lims[i + 1]);
+            std::sort(top.begin(), top.end(), std::greater<float>());
+            all.resize(std::min<size_t>(all.size(), 3));
+            REQUIRE(top == all);
+        }
+    }
 }
 
 TEST_CASE("Test Mem Sparse Index GetVectorByIds", "[float metrics]") {
@@ -490,3 +755,213 @@ TEST_CASE("Test Mem Sparse Index Handle Empty Vector", "[float metrics]") {
         }
     }
 }
+
+TEST_CASE("Test Mem Sparse Index Posting List Codec Round Trip", "[float metrics]") {
+    // integer values, which all codecs can hold.
+    int32_t nb = 1000, dim = 300;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int32_t> dim_dist(0, dim - 1);
+    std::uniform_int_distribution<int32_t> val_dist(1, 20);
+    std::vector<std::map<int32_t, float>> base_data(nb);
+    for (auto& row : base_data) {
+        for (int j = 0; j < 10; ++j) {
+            row[dim_dist(rng)] = val_dist(rng);
+        }
+    }
+    const auto train_ds = GenSparseDataSet(base_data, dim);
+    const auto query_ds = GenSparseDataSet(10, dim, 0.97);
+
+    auto version = GenTestVersionList();
+    auto name = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX,
+                         knowhere::IndexEnum::INDEX_SPARSE_WAND);
+    auto codec = GENERATE(as<std::string>{}, "NONE", "BITPACK", "BITPACK_UINT8", "BITPACK_FP16");
+    auto metric = GENERATE(knowhere::metric::IP, knowhere::metric::BM25);
+    auto use_mmap = GENERATE(false, true);
+    auto gen = [&](float avgdl) {
+        knowhere::Json json;
+        json[knowhere::meta::DIM] = dim;
+        json[knowhere::meta::METRIC_TYPE] = metric;
+        json[knowhere::meta::TOPK] = 5;
+        json[knowhere::meta::BM25_K1] = 1.2;
+        json[knowhere::meta::BM25_B] = 0.75;
+        json[knowhere::meta::BM25_AVGDL] = avgdl;
+        return json;
+    };
+    CAPTURE(name, codec, metric, use_mmap);
+
+    auto build = [&](const knowhere::Json& json) {
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+        return idx;
+    };
+    auto tmp_file = "/tmp/knowhere_sparse_codec_round_trip_test";
+    auto load = [&](const knowhere::BinarySet& bs, const knowhere::Json& json) {
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        if (!use_mmap) {
+            return std::make_pair(idx.Deserialize(bs, json), idx);
+        }
+        auto binary = bs.GetByName(name);
+        std::ofstream out(tmp_file, std::ios::binary);
+        out.write((const char*)binary->data.get(), binary->size);
+        out.close();
+        return std::make_pair(idx.DeserializeFromFile(tmp_file, json), idx);
+    };
+    auto check_same_results = [&](const knowhere::Index<knowhere::IndexNode>& expected,
+                                  const knowhere::Index<knowhere::IndexNode>& actual, const knowhere::Json& json) {
+        auto expected_res = expected.Search(query_ds, json, nullptr);
+        auto actual_res = actual.Search(query_ds, json, nullptr);
+        REQUIRE(expected_res.has_value());
+        REQUIRE(actual_res.has_value());
+        auto n = query_ds->GetRows() * json[knowhere::meta::TOPK].get<int>();
+        for (int i = 0; i < n; ++i) {
+            REQUIRE(expected_res.value()->GetIds()[i] == actual_res.value()->GetIds()[i]);
+            REQUIRE(expected_res.value()->GetDistance()[i] == actual_res.value()->GetDistance()[i]);
+        }
+    };
+
+    auto json = gen(100);
+    json[knowhere::indexparam::POSTING_LIST_CODEC] = codec;
+    auto idx = build(json);
+    knowhere::BinarySet bs;
+    REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+
+    // the saved codec is used if none is given, the same one may be given.
+    auto [status, loaded] = load(bs, gen(100));
+    REQUIRE(status == knowhere::Status::success);
+    check_same_results(idx, loaded, json);
+    auto [status_same, loaded_same] = load(bs, json);
+    REQUIRE(status_same == knowhere::Status::success);
+    check_same_results(idx, loaded_same, json);
+
+    // a different codec is rejected.
+    auto other_json = gen(100);
+    other_json[knowhere::indexparam::POSTING_LIST_CODEC] = codec == "NONE" ? "BITPACK" : "NONE";
+    REQUIRE(load(bs, other_json).first != knowhere::Status::success);
+
+    // with different BM25 params the posting lists are rebuilt with the saved codec.
+    if (metric == knowhere::metric::BM25) {
+        auto rebuilt_json = gen(50);
+        auto [status_rebuilt, rebuilt] = load(bs, rebuilt_json);
+        REQUIRE(status_rebuilt == knowhere::Status::success);
+        rebuilt_json[knowhere::indexparam::POSTING_LIST_CODEC] = codec;
+        check_same_results(build(rebuilt_json), rebuilt, rebuilt_json);
+    }
+    if (use_mmap) {
+        REQUIRE(std::remove(tmp_file) == 0);
+    }
+}
+
+TEST_CASE("Test Mem Sparse Index Range Search With Negative Values", "[float metrics]") {
+    // term 0 only has negative values, so its contribution is at most 0 rather than negative: doc 1 is in range
+    // without it.
+    std::vector<std::map<int32_t, float>> base_data = {
+        {{0, -1.0f}, {1, 0.5f}},
+        {{1, 0.5f}},
+        {{0, -2.0f}, {1, 3.0f}},
+        {{0, -0.5f}},
+    };
+    auto dim = 2;
+    const auto train_ds = GenSparseDataSet(base_data, dim);
+    const auto query_ds = GenSparseDataSet({{{0, 1.0f}, {1, 1.0f}}}, dim);
+
+    auto version = GenTestVersionList();
+    auto name = GENERATE(as<std::string>{}, knowhere::IndexEnum::INDEX_SPARSE_INVERTED_INDEX,
+                         knowhere::IndexEnum::INDEX_SPARSE_WAND);
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::IP;
+    json[knowhere::meta::RADIUS] = 0.0f;
+    json[knowhere::meta::RANGE_FILTER] = 10000.0f;
+    CAPTURE(name);
+
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+    REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+    auto check_result = [](const knowhere::DataSet& ds) {
+        auto lims = ds.GetLims();
+        auto ids = ds.GetIds();
+        auto distances = ds.GetDistance();
+        std::map<int64_t, float> result;
+        for (size_t j = lims[0]; j < lims[1]; ++j) {
+            result.emplace(ids[j], distances[j]);
+        }
+        REQUIRE(result.size() == 2);
+        REQUIRE(result[1] == 0.5f);
+        REQUIRE(result[2] == 1.0f);
+    };
+    auto bf_res =
+        knowhere::BruteForce::RangeSearch<knowhere::sparse::SparseRow<float>>(train_ds, query_ds, json, nullptr);
+    REQUIRE(bf_res.has_value());
+    check_result(*bf_res.value());
+
+    auto results = idx.RangeSearch(query_ds, json, nullptr);
+    REQUIRE(results.has_value());
+    check_result(*results.value());
+}
+
+TEST_CASE("Test Sparse Score Accumulator", "[float metrics]") {
+    // touches few docs so that the touched docs are visited, then many so that all docs are scanned.
+    auto [n, num_touched] = GENERATE(table<size_t, size_t>({
+        {10000, 50},
+        {10000, 5000},
+        {1000, 500},
+    }));
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<knowhere::sparse::table_t> id_dist(0, n - 1);
+    for (int query = 0; query < 3; ++query) {
+        auto& accumulator = knowhere::sparse::ScoreAccumulator<float>::Acquire(n);
+        std::vector<float> expected(n, 0.0f);
+        std::vector<bool> written(n, false);
+        for (size_t i = 0; i < num_touched; ++i) {
+            auto id = id_dist(rng);
+            accumulator.add(id, 1.0f);
+            expected[id] += 1.0f;
+            written[id] = true;
+        }
+        int64_t prev = -1;
+        size_t visited = 0;
+        accumulator.for_each([&](knowhere::sparse::table_t id, float score) {
+            REQUIRE(static_cast<int64_t>(id) > prev);
+            REQUIRE(written[id]);
+            REQUIRE(score == expected[id]);
+            prev = id;
+            visited++;
+        });
+        REQUIRE(visited == static_cast<size_t>(std::count(written.begin(), written.end(), true)));
+    }
+}
+
+TEST_CASE("Test Sparse Score Accumulator of segments of different sizes", "[float metrics]") {
+    // large and small segments searched in turn on the same thread, then only small ones.
+    using Accumulator = knowhere::sparse::ScoreAccumulator<float>;
+    constexpr size_t large_n = 1000000;
+    constexpr size_t small_n = 1000;
+    std::vector<size_t> sizes;
+    for (size_t i = 0; i < Accumulator::kShrinkAfterResets * 2; ++i) {
+        sizes.push_back(i % 2 == 0 ? large_n : small_n);
+    }
+    sizes.push_back(large_n);
+    sizes.insert(sizes.end(), Accumulator::kShrinkAfterResets, small_n);
+    sizes.push_back(large_n);
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        auto n = sizes[i];
+        auto& accumulator = Accumulator::Acquire(n);
+        // the memory of the large segments is kept until only small ones have been searched for a while.
+        if (i + 2 < sizes.size()) {
+            REQUIRE(accumulator.capacity() == large_n);
+        } else if (i + 2 == sizes.size()) {
+            REQUIRE(accumulator.capacity() == small_n);
+        }
+        REQUIRE(accumulator.capacity() >= n);
+        accumulator.add(0, 1.0f);
+        accumulator.add(n - 1, 2.0f);
+        accumulator.add(0, 3.0f);
+        std::vector<std::pair<knowhere::sparse::table_t, float>> visited;
+        accumulator.for_each([&](knowhere::sparse::table_t id, float score) { visited.emplace_back(id, score); });
+        REQUIRE(visited.size() == 2);
+        REQUIRE(visited[0].first == 0);
+        REQUIRE(visited[0].second == 4.0f);
+        REQUIRE(visited[1].first == n - 1);
+        REQUIRE(visited[1].second == 2.0f);
+    }
+}
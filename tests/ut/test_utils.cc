@@ -81,6 +81,24 @@ TEST_CASE("Test Bitset Generation", "[utils]") {
             }
         }
     }
+
+    SECTION("Allowed Ids") {
+        for (const auto size : kBitsetSizes) {
+            for (size_t i = 0; i <= size; ++i) {
+                auto bitset_data = GenerateBitsetWithRandomTbitsSet(size, i);
+                knowhere::BitsetView bitset(bitset_data.data(), size);
+                // ids beyond the bitset are filtered out
+                auto allowed_ids = bitset.get_allowed_ids(size + 3);
+                REQUIRE(allowed_ids.size() == size - i);
+                size_t pos = 0;
+                for (size_t j = 0; j < size; ++j) {
+                    if (!bitset.test(j)) {
+                        REQUIRE(allowed_ids[pos++] == (int64_t)j);
+                    }
+                }
+            }
+        }
+    }
 }
 
 namespace {
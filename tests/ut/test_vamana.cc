@@ -0,0 +1,297 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+
+#include "catch2/catch_approx.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/generators/catch_generators.hpp"
+#include "knowhere/bitsetview.h"
+#include "knowhere/comp/brute_force.h"
+#include "knowhere/comp/index_param.h"
+#include "knowhere/comp/knowhere_config.h"
+#include "knowhere/index/index_factory.h"
+#include "knowhere/utils.h"
+#include "utils.h"
+
+namespace {
+constexpr uint32_t kNumRows = 1000;
+constexpr uint32_t kNumQueries = 10;
+constexpr uint32_t kDim = 128;
+constexpr uint32_t kK = 10;
+constexpr float kKnnRecall = 0.9;
+constexpr float kRangeAp = 0.9;
+constexpr float kIteratorRecall = 0.8;
+
+knowhere::DataSetPtr
+GetIteratorKNNResult(const std::vector<std::shared_ptr<knowhere::IndexNode::iterator>>& iterators, int k,
+                     const knowhere::BitsetView* bitset = nullptr) {
+    int nq = iterators.size();
+    auto p_id = new int64_t[nq * k];
+    auto p_dist = new float[nq * k];
+    std::fill_n(p_id, nq * k, -1);
+    for (int i = 0; i < nq; ++i) {
+        auto& iter = iterators[i];
+        for (int j = 0; j < k && iter->HasNext(); ++j) {
+            auto [id, dist] = iter->Next();
+            REQUIRE((!bitset || !bitset->test(id)));
+            p_id[i * k + j] = id;
+            p_dist[i * k + j] = dist;
+        }
+    }
+    return knowhere::GenResultDataSet(nq, k, p_id, p_dist);
+}
+
+template <typename DataType>
+void
+vamana_search() {
+    auto version = GenTestVersionList();
+    auto metric = GENERATE(as<std::string>{}, knowhere::metric::L2, knowhere::metric::IP, knowhere::metric::COSINE);
+
+    auto base_gen = [&metric]() {
+        knowhere::Json json;
+        json[knowhere::meta::DIM] = kDim;
+        json[knowhere::meta::METRIC_TYPE] = metric;
+        json[knowhere::meta::TOPK] = kK;
+        if (metric == knowhere::metric::L2) {
+            json[knowhere::meta::RADIUS] = CFG_FLOAT::value_type(200000);
+            json[knowhere::meta::RANGE_FILTER] = CFG_FLOAT::value_type(0);
+        } else if (metric == knowhere::metric::IP) {
+            json[knowhere::meta::RADIUS] = CFG_FLOAT::value_type(350000);
+            json[knowhere::meta::RANGE_FILTER] = std::numeric_limits<CFG_FLOAT::value_type>::max();
+        } else {
+            json[knowhere::meta::RADIUS] = 0.75f;
+            json[knowhere::meta::RANGE_FILTER] = 1.0f;
+        }
+        return json;
+    };
+
+    auto build_gen = [&base_gen]() {
+        knowhere::Json json = base_gen();
+        json["max_degree"] = 32;
+        json["search_list_size"] = 100;
+        return json;
+    };
+
+    auto search_gen = [&base_gen]() {
+        knowhere::Json json = base_gen();
+        json["search_list_size"] = 64;
+        return json;
+    };
+
+    auto base_ds = knowhere::ConvertToDataTypeIfNeeded<DataType>(GenDataSet(kNumRows, kDim, 30));
+    auto query_ds = knowhere::ConvertToDataTypeIfNeeded<DataType>(GenDataSet(kNumQueries, kDim, 42));
+    auto knn_gt = knowhere::BruteForce::Search<DataType>(base_ds, query_ds, base_gen(), nullptr);
+    auto range_gt = knowhere::BruteForce::RangeSearch<DataType>(base_ds, query_ds, base_gen(), nullptr);
+    REQUIRE(knn_gt.has_value());
+    REQUIRE(range_gt.has_value());
+
+    knowhere::BinarySet binset;
+    {
+        auto idx = knowhere::IndexFactory::Instance().Create<DataType>(knowhere::IndexEnum::INDEX_VAMANA, version);
+        REQUIRE(idx.has_value());
+        REQUIRE(idx.value().Type() == knowhere::IndexEnum::INDEX_VAMANA);
+        REQUIRE(idx.value().Build(base_ds, build_gen()) == knowhere::Status::success);
+        REQUIRE(idx.value().Count() == kNumRows);
+        REQUIRE(idx.value().Size() > 0);
+        REQUIRE(idx.value().Serialize(binset) == knowhere::Status::success);
+    }
+
+    auto use_mmap = GENERATE(true, false);
+    auto tmp_file = "/tmp/knowhere_vamana_index_test";
+    auto idx = knowhere::IndexFactory::Instance().Create<DataType>(knowhere::IndexEnum::INDEX_VAMANA, version).value();
+    {
+        knowhere::Json load_json = base_gen();
+        load_json["enable_mmap"] = use_mmap;
+        auto binary = binset.GetByName(idx.Type());
+        REQUIRE(binary != nullptr);
+        std::remove(tmp_file);
+        std::ofstream out(tmp_file, std::ios::binary);
+        out.write((const char*)binary->data.get(), binary->size);
+        out.close();
+        REQUIRE(idx.DeserializeFromFile(tmp_file, load_json) == knowhere::Status::success);
+        REQUIRE(idx.Count() == kNumRows);
+    }
+    CAPTURE(metric, use_mmap);
+
+    SECTION("Test search") {
+        auto results = idx.Search(query_ds, search_gen(), nullptr);
+        REQUIRE(results.has_value());
+        REQUIRE(GetKNNRecall(*knn_gt.value(), *results.value()) >= kKnnRecall);
+
+        // the index loaded from the binary set answers the same
+        auto idx_copy =
+            knowhere::IndexFactory::Instance().Create<DataType>(knowhere::IndexEnum::INDEX_VAMANA, version).value();
+        REQUIRE(idx_copy.Deserialize(binset, base_gen()) == knowhere::Status::success);
+        auto copy_results = idx_copy.Search(query_ds, search_gen(), nullptr);
+        REQUIRE(copy_results.has_value());
+        REQUIRE(std::memcmp(results.value()->GetIds(), copy_results.value()->GetIds(),
+                            kNumQueries * kK * sizeof(int64_t)) == 0);
+    }
+
+    SECTION("Test search with bitset") {
+        std::vector<std::function<std::vector<uint8_t>(size_t, size_t)>> gen_bitset_funcs = {
+            GenerateBitsetWithFirstTbitsSet, GenerateBitsetWithRandomTbitsSet};
+        for (const float percentage : {0.4f, 0.9f, 0.98f}) {
+            for (const auto& gen_func : gen_bitset_funcs) {
+                auto bitset_data = gen_func(kNumRows, percentage * kNumRows);
+                knowhere::BitsetView bitset(bitset_data.data(), kNumRows);
+                auto results = idx.Search(query_ds, search_gen(), bitset);
+                auto gt = knowhere::BruteForce::Search<DataType>(base_ds, query_ds, search_gen(), bitset);
+                REQUIRE(results.has_value());
+                CAPTURE(percentage);
+                REQUIRE(GetKNNRecall(*gt.value(), *results.value()) >= kKnnRecall);
+                auto ids = results.value()->GetIds();
+                for (uint32_t i = 0; i < kNumQueries * kK; ++i) {
+                    REQUIRE((ids[i] == -1 || !bitset.test(ids[i])));
+                }
+            }
+        }
+    }
+
+    SECTION("Test range search") {
+        auto results = idx.RangeSearch(query_ds, search_gen(), nullptr);
+        REQUIRE(results.has_value());
+        REQUIRE(GetRangeSearchRecall(*range_gt.value(), *results.value()) >= kRangeAp);
+    }
+
+    SECTION("Test iterator") {
+        auto iterators = idx.AnnIterator(query_ds, search_gen(), nullptr);
+        REQUIRE(iterators.has_value());
+        auto results = GetIteratorKNNResult(iterators.value(), kK);
+        bool dist_less_better = knowhere::IsMetricType(metric, knowhere::metric::L2);
+        REQUIRE(GetKNNRelativeRecall(*knn_gt.value(), *results, dist_less_better) >= kIteratorRecall);
+
+        // an exhausted iterator returned each row the bitset lets through once
+        auto bitset_data = GenerateBitsetWithRandomTbitsSet(kNumRows, 0.9f * kNumRows);
+        knowhere::BitsetView bitset(bitset_data.data(), kNumRows);
+        auto filtered = idx.AnnIterator(query_ds, search_gen(), bitset);
+        REQUIRE(filtered.has_value());
+        auto& iter = filtered.value()[0];
+        std::unordered_set<int64_t> returned;
+        while (iter->HasNext()) {
+            auto [id, dist] = iter->Next();
+            REQUIRE(!bitset.test(id));
+            REQUIRE(returned.insert(id).second);
+        }
+        REQUIRE(returned.size() == kNumRows - bitset.count());
+    }
+
+    SECTION("Test get vector by ids") {
+        REQUIRE(idx.HasRawData(metric));
+        auto ids_ds = GenIdsDataSet(kNumRows, kNumQueries);
+        auto results = idx.GetVectorByIds(ids_ds);
+        REQUIRE(results.has_value());
+        REQUIRE(results.value()->GetRows() == kNumQueries);
+        REQUIRE(results.value()->GetDim() == kDim);
+        auto xb = static_cast<const DataType*>(base_ds->GetTensor());
+        auto data = static_cast<const DataType*>(results.value()->GetTensor());
+        for (uint32_t i = 0; i < kNumQueries; ++i) {
+            const auto id = ids_ds->GetIds()[i];
+            REQUIRE(std::memcmp(data + i * kDim, xb + id * kDim, kDim * sizeof(DataType)) == 0);
+        }
+    }
+
+    std::remove(tmp_file);
+}
+}  // namespace
+
+TEST_CASE("Test VamanaIndexNode", "[vamana]") {
+    vamana_search<knowhere::fp32>();
+}
+
+TEST_CASE("Test VamanaIndexNode with fp16", "[vamana]") {
+    vamana_search<knowhere::fp16>();
+}
+
+TEST_CASE("Invalid vamana params test", "[vamana]") {
+    auto version = GenTestVersionList();
+    auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_VAMANA, version);
+    REQUIRE(idx.has_value());
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = kDim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    json[knowhere::meta::TOPK] = kK;
+    REQUIRE(idx.value().Build(GenDataSet(kNumRows, kDim), json) == knowhere::Status::success);
+
+    // a search list shorter than k
+    json["search_list_size"] = kK - 1;
+    auto results = idx.value().Search(GenDataSet(kNumQueries, kDim, 42), json, nullptr);
+    REQUIRE(!results.has_value());
+    REQUIRE(results.error() == knowhere::Status::out_of_range_in_json);
+
+    // the graph is static
+    REQUIRE(idx.value().Add(GenDataSet(kNumRows, kDim), json) == knowhere::Status::not_implemented);
+}
+
+TEST_CASE("Test Vamana load of corrupted neighbors", "[vamana]") {
+    auto version = GenTestVersionList();
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = kDim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    json[knowhere::meta::TOPK] = kK;
+    json["max_degree"] = 32;
+    knowhere::BinarySet binset;
+    {
+        auto idx =
+            knowhere::IndexFactory::Instance().Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_VAMANA, version);
+        REQUIRE(idx.has_value());
+        REQUIRE(idx.value().Build(GenDataSet(kNumRows, kDim), json) == knowhere::Status::success);
+        REQUIRE(idx.value().Serialize(binset) == knowhere::Status::success);
+    }
+    auto binary = binset.GetByName(knowhere::IndexEnum::INDEX_VAMANA);
+    REQUIRE(binary != nullptr);
+
+    // the header is the format marker, the metric, dim, n, max_degree and the entry point, and the neighbor lists
+    // start at the next 64 bytes
+    uint32_t max_degree, entry_point;
+    std::memcpy(&max_degree, binary->data.get() + 24, sizeof(max_degree));
+    std::memcpy(&entry_point, binary->data.get() + 28, sizeof(entry_point));
+    REQUIRE(entry_point < kNumRows);
+    const size_t nhoods_offset = 64;
+    auto corrupted = [&](uint32_t row, uint32_t pos, uint32_t value) {
+        std::shared_ptr<uint8_t[]> data(new uint8_t[binary->size]);
+        std::memcpy(data.get(), binary->data.get(), binary->size);
+        std::memcpy(data.get() + nhoods_offset + (row * (max_degree + 1) + pos) * sizeof(uint32_t), &value,
+                    sizeof(value));
+        return data;
+    };
+
+    auto tmp_file = "/tmp/knowhere_vamana_corrupted_test";
+    auto load = [&](const std::shared_ptr<uint8_t[]>& data, bool use_mmap) {
+        std::remove(tmp_file);
+        std::ofstream out(tmp_file, std::ios::binary);
+        out.write((const char*)data.get(), binary->size);
+        out.close();
+        json["enable_mmap"] = use_mmap;
+        auto idx =
+            knowhere::IndexFactory::Instance().Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_VAMANA, version);
+        return idx.value().DeserializeFromFile(tmp_file, json);
+    };
+
+    REQUIRE(load(binary->data, true) == knowhere::Status::success);
+    REQUIRE(load(binary->data, false) == knowhere::Status::success);
+
+    // a neighbor id out of range in a row other than the entry point's, found only if the layout is read
+    const uint32_t row = (entry_point + 1) % kNumRows;
+    REQUIRE(load(corrupted(row, 1, kNumRows), false) == knowhere::Status::invalid_binary_set);
+    REQUIRE(load(corrupted(row, 0, max_degree + 1), false) == knowhere::Status::invalid_binary_set);
+
+    // the neighbors of the entry point are checked even in a mapped layout
+    REQUIRE(load(corrupted(entry_point, 1, kNumRows), true) == knowhere::Status::invalid_binary_set);
+    REQUIRE(load(corrupted(entry_point, 0, max_degree + 1), true) == knowhere::Status::invalid_binary_set);
+
+    std::remove(tmp_file);
+}
@@ -18,7 +18,9 @@
 #include "tsl/robin_map.h"
 #include "utils.h"
 
-typedef io_context_t IOContext;
+// I/O context of a search, an io_context_t for LinuxAlignedFileReader and a
+// ring for UringAlignedFileReader.
+typedef void* IOContext;
 
 // NOTE :: all 3 fields must be 512-aligned
 struct AlignedRead {
@@ -50,6 +52,9 @@ class AlignedFileReader {
 
   virtual void put_ctx(IOContext) = 0;
 
+  // max number of reads submit_req() takes at once.
+  virtual size_t max_events_per_ctx() = 0;
+
   // Open & close ops
   // Blocking calls
   virtual void open(const std::string& fname) = 0;
@@ -61,6 +66,12 @@ class AlignedFileReader {
                     bool async = false) = 0;
 
   // async reads
-  virtual void get_submitted_req(io_context_t &ctx, size_t n_ops) = 0;
-  virtual void submit_req( io_context_t &ctx, std::vector<AlignedRead> &read_reqs) = 0;
+  virtual void get_submitted_req(IOContext &ctx, size_t n_ops) = 0;
+  virtual void submit_req(IOContext &ctx, std::vector<AlignedRead> &read_reqs) = 0;
+
+  // waits for at least min_n and at most max_n of the submitted reads to
+  // complete, in any order, and appends the buf of each completed read to
+  // completed.
+  virtual void get_completed_req(IOContext &ctx, size_t min_n, size_t max_n,
+                                 std::vector<void *> &completed) = 0;
 };
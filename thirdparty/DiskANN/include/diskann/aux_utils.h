@@ -40,6 +40,9 @@ namespace diskann {
   const uint32_t   NUM_NODES_TO_CACHE = 250000;
   const uint32_t   WARMUP_L = 20;
   const uint32_t   NUM_KMEANS_REPS = 12;
+  const uint32_t   NAV_GRAPH_DEGREE = 32;
+  const uint32_t   NAV_GRAPH_BUILD_L = 64;
+  const uint64_t   MIN_NAV_GRAPH_POINTS = 256;
 
   template<typename T>
   class PQFlashIndex;
@@ -129,6 +132,11 @@ namespace diskann {
     uint32_t num_nodes_to_cache = 0;
     // shuffle id to build index
     bool shuffle_build = false;
+    // store graph neighbors in the same sector, see relayout_disk_index()
+    bool page_aware_layout = false;
+    // fraction of the PQ code budget (B) used by the navigation graph, see
+    // build_nav_graph()
+    double nav_graph_budget_ratio = 0.0;
   };
 
   template<typename T>
@@ -140,4 +148,24 @@ namespace diskann {
       const std::string output_file,
       const std::string reorder_data_file = std::string(""));
 
+  // Rewrites the graph part of a disk index so that the nodes of a sector are
+  // neighbors in the graph (block shuffling as in Starling), rather than nodes
+  // of consecutive ids: each sector is started by the first node not placed
+  // yet in BFS order from the medoid, and filled with the neighbors of the
+  // nodes already in it. The node at each location is saved in layout_file,
+  // searches then get neighbors of the node read for free with each sector.
+  // Indexes whose nodes span several sectors, or whose graph doesn't fit in
+  // ram_budget_gb, are left unchanged, and the call returns false.
+  bool relayout_disk_index(const std::string &disk_index_file,
+                           _u64 disk_bytes_per_point,
+                           const std::string &layout_file,
+                           double             ram_budget_gb);
+
+  // Builds the NavGraph searches use to pick their entry points, over a
+  // random sample of num_nav_points points of data_file (the data the disk
+  // graph is built on), and saves it to nav_graph_file.
+  template<typename T>
+  void build_nav_graph(const std::string &data_file, bool ip_prepared,
+                       _u64 num_nav_points, const std::string &nav_graph_file);
+
 }  // namespace diskann
@@ -11,6 +11,14 @@ namespace diskann {
   template<typename T>
   DISTFUN<T> get_distance_function(Metric m);
 
+  // distance between a fp32 vector and a vector of T read in place, so the
+  // queries of the fp16 and bf16 indexes aren't rounded to 16 bits
+  template<typename T>
+  using MIXED_DISTFUN = std::function<float(const float *, const T *, size_t)>;
+
+  template<typename T>
+  MIXED_DISTFUN<T> get_mixed_distance_function(Metric m);
+
   template<typename T>
   float norm_l2sqr(const T *x, size_t size);
 }  // namespace diskann
@@ -0,0 +1,197 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "knowhere/bitsetview.h"
+#include "knowhere/feder/DiskANN.h"
+
+#include "pq_flash_index.h"
+#include "utils.h"
+
+namespace diskann {
+  // Inserts and deletes on a disk index, the way FreshDiskANN makes them. The
+  // points inserted since the disk index was written are kept in an in-memory
+  // graph, the delta, and the deleted points in a delete list: the searches
+  // merge the results of the disk index and of the delta, leaving out the
+  // deleted points. Once the delta holds merge_threshold points, or as many
+  // deletes are pending, a background merge writes them to the disk index in
+  // a single pass over it: it patches the neighbor lists of the nodes that
+  // lose neighbors to the deletes or gain the inserted points as neighbors,
+  // and appends the inserted points. The searches then switch to the new disk
+  // index, while the inserts go on into a new delta.
+  //
+  // The ids are positions: the inserted points take the ids following the
+  // points of the index, and the deleted points keep their ids and nodes, left
+  // out of the results for good. Only a rebuild reclaims their space.
+  // Completes the merge into the disk index files of index_prefix that was
+  // interrupted while replacing them, or removes the files written by one
+  // interrupted before, so that the files are the ones of a single merge. To
+  // be called before loading the disk index. Returns whether files were
+  // replaced.
+  bool recover_merge(const std::string &index_prefix);
+
+  template<typename T>
+  class FreshIndex {
+   public:
+    class Delta;
+
+    // The disk index and the deltas searched at a point in time. A batch of
+    // searches keeps one, as the merges replace them.
+    struct Snapshot {
+      std::shared_ptr<PQFlashIndex<T>> disk;
+      // the delta being merged into disk, if any, and the one of the inserts
+      // made since
+      std::shared_ptr<Delta> merging;
+      std::shared_ptr<Delta> delta;
+    };
+
+    // Loads the disk index files once a merge replaced them.
+    using Loader = std::function<std::shared_ptr<PQFlashIndex<T>>()>;
+
+    // The files of disk_index are the ones of index_prefix, the delete list
+    // included.
+    FreshIndex(std::shared_ptr<PQFlashIndex<T>> disk_index,
+               const std::string &index_prefix, Loader loader,
+               _u64 merge_threshold);
+    ~FreshIndex();
+    FreshIndex(const FreshIndex &) = delete;
+    FreshIndex &operator=(const FreshIndex &) = delete;
+
+    // false for the disk indexes the merges can't rewrite: the ones whose
+    // nodes hold PQ codes, or with reorder data. Their inserts and deletes
+    // throw.
+    bool supports_updates() const noexcept;
+
+    // Inserts n points, returns the id of the first one, the others follow.
+    // Waits for the merge in progress, if any, to take in more points than a
+    // delta holds.
+    _u64 insert(const T *points, _u64 n);
+
+    // Deletes the points of ids, ignoring the ids of no point.
+    void remove(const _s64 *ids, _u64 n);
+
+    // Writes the pending inserts and deletes to the disk index files.
+    void merge();
+
+    Snapshot snapshot() const;
+
+    // bitset, with the deleted points filtered out too. Unless no point is
+    // deleted, the view refers to the bits held by bits.
+    knowhere::BitsetView filter_deleted(
+        knowhere::BitsetView                         bitset,
+        std::shared_ptr<const std::vector<uint8_t>> &bits) const;
+
+    // cached_beam_search() of the disk index of snapshot and of its deltas.
+    // bitset is expected to filter out the deleted points, see
+    // filter_deleted().
+    void search(const Snapshot &snapshot, const T *query, const _u64 k_search,
+                const _u64 l_search, _s64 *res_ids, float *res_dists,
+                const _u64 beam_width, QueryStats *stats = nullptr,
+                const knowhere::feder::diskann::FederResultUniq &feder =
+                    nullptr,
+                knowhere::BitsetView bitset = nullptr,
+                const float filter_ratio = -1.0f,
+                const bool for_tuning = false, const _u64 io_depth = 0,
+                SharedSectorReads *shared_reads = nullptr) const;
+
+    _u32 range_search(const Snapshot &snapshot, const T *query,
+                      const double range, const _u64 min_l_search,
+                      const _u64 max_l_search, std::vector<_s64> &indices,
+                      std::vector<float> &distances, const _u64 beam_width,
+                      knowhere::BitsetView bitset = nullptr,
+                      QueryStats          *stats = nullptr) const;
+
+    void get_vector_by_ids(const Snapshot &snapshot, const int64_t *ids,
+                           const int64_t n, T *const output_data) const;
+
+    // # of ids, the ones of the deleted points included
+    _u64 get_num_points() const noexcept;
+
+    // memory of the deltas and of the delete list
+    _u64 cal_size() const;
+
+   private:
+    // the coordinates of a point in the space the graph is built in: the
+    // normalized ones for cosine, and the ones of the inner product
+    // preprocessing, with an extra coordinate, for inner product.
+    void to_graph_space(const T *point, float *out) const;
+    // for a query, whose extra coordinate is 0 for inner product. Returns
+    // false for a zero query with inner product or cosine, which has no
+    // results.
+    bool query_to_graph_space(const T *query, float *out) const;
+    // the distance the searches output between a query and a point
+    float distance(const T *query, const T *point) const;
+
+    // appends to results the (distance, id) of the k_search points of delta
+    // closest to query, not filtered out by bitset
+    void search_delta(const Delta &delta, const T *query, const _u64 k_search,
+                      const _u64 l_search, knowhere::BitsetView bitset,
+                      std::vector<std::pair<float, _s64>> &results) const;
+
+    // Starts merging the delta, after the merge in progress, if any. Runs the
+    // merge before returning if wait is set, or if the last one failed.
+    void start_merge(bool wait);
+    void run_merge();
+    // writes the merging delta and the pending deletes to the disk index
+    // files, then switches to them. The files are replaced once the list of
+    // them is written, see recover_merge().
+    void merge_into_disk();
+
+    const std::string index_prefix;
+    const Loader      loader;
+    const _u64        merge_threshold;
+
+    diskann::Metric metric = diskann::Metric::L2;
+    _u64            dim = 0;        // of the points
+    _u64            graph_dim = 0;  // of their coordinates in the graph
+    float           max_base_norm = 0.0f;
+    _u32            max_degree = 0;
+    bool            updatable = false;
+
+    // the disk index and the deltas
+    mutable std::shared_mutex state_mtx;
+    Snapshot                  state;
+
+    // one insert at a time, as the ids are consecutive
+    std::mutex        insert_mtx;
+    std::atomic<_u64> num_points = 0;
+
+    // bit i is set if point i is deleted, the deletes not written to the disk
+    // index yet are pending
+    mutable std::shared_mutex delete_mtx;
+    std::vector<uint8_t>      deleted;
+    _u64                      num_deleted = 0;
+    std::vector<_u32>         pending_deletes;
+
+    // the bits of deleted for the first npts points, built by
+    // filter_deleted() once per number of points and of deleted points. The
+    // searches keep the bits they filter with, a new build replaces them.
+    struct DeletedBits {
+      _u64                                        npts = 0;
+      _u64                                        num_deleted = 0;
+      std::shared_ptr<const std::vector<uint8_t>> bits;
+    };
+    mutable std::mutex  deleted_bits_mtx;
+    mutable DeletedBits deleted_bits;
+
+    std::mutex              merge_mtx;
+    std::condition_variable merge_cv;
+    bool                    merge_running = false;
+    std::exception_ptr      merge_error = nullptr;
+    // set once the files are replaced by a merge the searches can't switch
+    // to, the index can't be updated anymore
+    bool              merge_broken = false;
+    std::atomic<bool> stop_merge = false;
+  };
+}  // namespace diskann
@@ -136,6 +136,10 @@ namespace diskann {
     void build(const char *filename, const size_t num_points_to_load,
                Parameters &parameters, const char *tag_filename);
 
+    // builds the graph over num_points rows of _dim values that are already in
+    // memory, for the callers that do not go through a data file.
+    void build(const T *data, const size_t num_points, Parameters &parameters);
+
     // Added search overload that takes L as parameter, so that we
     // can customize L on a per-query basis without tampering with "Parameters"
     template<typename IDType>
@@ -194,6 +198,10 @@ namespace diskann {
     const std::vector<std::vector<unsigned>> *get_graph() const {
       return &this->_final_graph;
     }
+    // moves the graph out, leaving the index without one
+    std::vector<std::vector<unsigned>> release_graph() {
+      return std::move(this->_final_graph);
+    }
 
     unsigned get_entry_point() {
       return _ep;
@@ -17,12 +17,16 @@ class LinuxAlignedFileReader : public AlignedFileReader {
   LinuxAlignedFileReader();
   ~LinuxAlignedFileReader();
 
-  io_context_t get_ctx() override {
+  IOContext get_ctx() override {
     return ctx_pool_->pop();
   }
 
-  void put_ctx(io_context_t ctx) override {
-    ctx_pool_->push(ctx);
+  void put_ctx(IOContext ctx) override {
+    ctx_pool_->push(static_cast<io_context_t>(ctx));
+  }
+
+  size_t max_events_per_ctx() override {
+    return ctx_pool_->max_events_per_ctx();
   }
 
   // Open & close ops
@@ -36,6 +40,8 @@ class LinuxAlignedFileReader : public AlignedFileReader {
             bool async = false) override;
 
   // async reads
-  void get_submitted_req (io_context_t &ctx, size_t n_ops) override;
-  void submit_req(io_context_t &ctx, std::vector<AlignedRead> &read_reqs) override;
+  void get_submitted_req(IOContext &ctx, size_t n_ops) override;
+  void submit_req(IOContext &ctx, std::vector<AlignedRead> &read_reqs) override;
+  void get_completed_req(IOContext &ctx, size_t min_n, size_t max_n,
+                         std::vector<void *> &completed) override;
 };
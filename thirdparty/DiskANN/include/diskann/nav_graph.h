@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "distance.h"
+#include "utils.h"
+
+namespace diskann {
+  // Small in-memory graph over a sample of the points of a disk index, with
+  // their full precision vectors. A search walks it first to pick entry
+  // points close to the query, so the disk search doesn't spend its first
+  // hops (and reads) getting from the medoid to the query's neighborhood.
+  //
+  // Distances are always L2: like the disk graph, the graph is built on the
+  // data prepared for inner products.
+  class NavGraph {
+   public:
+    // bytes of memory of each point in a graph of the given dim and degree
+    static _u64 point_size(_u64 dim, _u64 degree);
+
+    // Writes the graph to file: ids of the points in the disk index, their
+    // vectors (npts * dim) and their neighbors, as positions in ids.
+    static void save(const std::string &file, const std::vector<_u32> &ids,
+                     const float *data, _u64 dim,
+                     const std::vector<std::vector<unsigned>> &graph,
+                     _u32 entry_point);
+
+    // aligned_dim is the dim of the queries, padded with zeros.
+    void load(const std::string &file, _u64 aligned_dim);
+
+    bool empty() const {
+      return ids.empty();
+    }
+
+    _u64 size() const {
+      return ids.size();
+    }
+
+    _u64 memory_size() const;
+
+    // Best-first search with a list of l_search points, the ids (in the disk
+    // index) of the closest k found are appended to result, closest first.
+    void search(const float *query, _u64 l_search, _u64 k,
+                std::vector<_u32> &result) const;
+
+   private:
+    const float *vector_of(_u32 pos) const {
+      return data.data() + (_u64) pos * aligned_dim;
+    }
+
+    const _u32 *nhood_of(_u32 pos) const {
+      return nhoods.data() + (_u64) pos * (degree + 1);
+    }
+
+    _u64               aligned_dim = 0;
+    _u64               degree = 0;
+    _u32               entry_point = 0;
+    std::vector<_u32>  ids;
+    std::vector<float> data;
+    std::vector<_u32>  nhoods;  // [nnbrs][nbrs] per point
+    DISTFUN<float>     distance = nullptr;
+  };
+}  // namespace diskann
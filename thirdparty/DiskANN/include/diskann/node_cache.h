@@ -0,0 +1,154 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "utils.h"
+
+namespace diskann {
+  // In-memory cache of graph nodes, the full precision coordinates and the
+  // neighbors of each, looked up by searches without taking any lock.
+  //
+  // The nodes are kept in a fixed number of slots, and the slot of a node is
+  // found through an open addressing table that isn't modified once
+  // published: the writer builds a new table and swaps it in, and the slots
+  // of the nodes it drops are reused only once the searches that may still
+  // use the old table are done. A search registers once through a ReadGuard
+  // rather than taking a lock for every lookup.
+  //
+  // With access counting, searches sample how often each node is expanded,
+  // and select_refresh() picks the nodes to swap to follow the workload.
+  template<typename T>
+  class NodeCache {
+    struct Table;
+
+   public:
+    struct Node {
+      T    *coords = nullptr;
+      _u32  nnbrs = 0;
+      _u32 *nbrs = nullptr;
+    };
+
+    // lookups of a search, the nodes found stay valid until it's destroyed.
+    class ReadGuard {
+     public:
+      explicit ReadGuard(const NodeCache &cache);
+      ~ReadGuard();
+      ReadGuard(const ReadGuard &) = delete;
+      ReadGuard &operator=(const ReadGuard &) = delete;
+
+      bool find(_u32 id, Node &node) const;
+
+     private:
+      const NodeCache &cache;
+      _u32             epoch;
+      const Table     *table;
+    };
+
+    NodeCache() = default;
+    ~NodeCache();
+    NodeCache(const NodeCache &) = delete;
+    NodeCache &operator=(const NodeCache &) = delete;
+
+    // allocates the slots, the first call only takes effect.
+    void init(_u64 capacity, _u64 max_degree, _u64 aligned_dim);
+
+    bool initialized() const {
+      return nhood_buf != nullptr;
+    }
+
+    _u64 capacity() const {
+      return slot_ids.size();
+    }
+
+    // # of nodes searches can find
+    _u64 size() const;
+
+    // memory of the slots, the lookup table and the access counts
+    _u64 memory_size() const;
+
+    // The writer side, calls must not overlap each other.
+    //
+    // copies a node into a free slot, returns false if there is none. The
+    // node is found by searches once publish() is called.
+    bool add(_u32 id, const T *coords, _u64 coords_bytes, _u32 nnbrs,
+             const _u32 *nbrs);
+    void publish();
+    // drops nodes from the cache, waiting for the searches that may use them.
+    void remove(const std::vector<_u32> &ids);
+    bool contains(_u32 id) const;
+
+    void enable_access_counts(_u64 num_points);
+
+    bool counts_accesses() const {
+      return access_counts != nullptr;
+    }
+
+    // lossy, concurrent increments of a node may count once.
+    void record_access(_u32 id) {
+      auto &count = access_counts[id];
+      auto  c = count.load(std::memory_order_relaxed);
+      if (c < UINT8_MAX) {
+        count.store(c + 1, std::memory_order_relaxed);
+      }
+    }
+
+    // Picks the nodes to evict and the ones to cache instead: the hottest
+    // nodes not cached fill the free slots, then each replaces the coldest
+    // cached node left if it was accessed more often (TinyLFU admission), by
+    // more than one access so that nodes as hot don't swap back and forth.
+    // The access counts are halved, so they follow the recent workload.
+    void select_refresh(std::vector<_u32> &evict, std::vector<_u32> &admit);
+
+   private:
+    static constexpr _u32 kNoNode = std::numeric_limits<_u32>::max();
+    // nodes accessed once since the last refresh aren't worth a read
+    static constexpr _u8 kMinAdmitCount = 2;
+
+    struct Table {
+      explicit Table(_u64 n_nodes);
+      _u32 find(_u32 id) const;
+      void insert(_u32 id, _u32 slot);
+
+      struct Entry {
+        _u32 id = kNoNode;
+        _u32 slot = kNoNode;
+      };
+      _u32                     bits;
+      _u64                     n_nodes;
+      std::unique_ptr<Entry[]> entries;
+    };
+
+    Node node_of_slot(_u32 slot) const {
+      _u32 *nhood = nhood_buf.get() + slot * (max_degree + 1);
+      return Node{coords_buf + slot * aligned_dim, nhood[0], nhood + 1};
+    }
+
+    void swap_table(std::unique_ptr<Table> new_table);
+    // waits until no search uses a table swapped out before the call
+    void wait_for_readers();
+
+    _u64                        max_degree = 0;
+    _u64                        aligned_dim = 0;
+    std::unique_ptr<_u32[]>     nhood_buf = nullptr;  // [nnbrs][nbrs] per slot
+    T                          *coords_buf = nullptr;
+    std::vector<_u32>           slot_ids;
+    std::vector<_u32>           free_slots;
+    std::atomic<const Table *>  table = nullptr;
+
+    // searches in each epoch, on their own cache lines
+    struct alignas(64) ReaderCount {
+      std::atomic<_u64> n = 0;
+    };
+    mutable ReaderCount       readers[2];
+    mutable std::atomic<_u32> epoch = 0;
+
+    _u64                                num_points = 0;
+    std::unique_ptr<std::atomic<_u8>[]> access_counts = nullptr;
+  };
+}  // namespace diskann
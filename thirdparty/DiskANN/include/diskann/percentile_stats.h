@@ -22,6 +22,7 @@ namespace diskann {
     unsigned n_8k = 0;          // # of 8kB reads
     unsigned n_12k = 0;         // # of 12kB reads
     unsigned n_ios = 0;         // total # of IOs issued
+    unsigned n_shared_ios = 0;  // # of reads of other searches used
     unsigned read_size = 0;     // total # of bytes read
     unsigned n_cmps_saved = 0;  // # cmps saved
     unsigned n_cmps = 0;        // # cmps
@@ -19,10 +19,13 @@
 
 #include "aligned_file_reader.h"
 #include "concurrent_queue.h"
+#include "nav_graph.h"
 #include "neighbor.h"
+#include "node_cache.h"
 #include "parameters.h"
 #include "percentile_stats.h"
 #include "pq_table.h"
+#include "shared_sector_reads.h"
 #include "utils.h"
 #include "diskann/distance.h"
 #include "knowhere/comp/thread_pool.h"
@@ -61,7 +64,6 @@ namespace diskann {
         nullptr;  // MUST BE AT LEAST diskann MAX_DEGREE
     _u8 *aligned_pq_coord_scratch =
         nullptr;  // MUST BE AT LEAST  [N_CHUNKS * MAX_DEGREE]
-    T     *aligned_query_T = nullptr;
     float *aligned_query_float = nullptr;
 
     tsl::robin_set<_u64> *visited = nullptr;
@@ -198,13 +200,23 @@ struct IteratorWorkspace {
     void cache_bfs_levels(_u64                   num_nodes_to_cache,
                           std::vector<uint32_t> &node_list);
 
+    // Keeps refreshing the cache with the nodes the searches expand most
+    // often, rather than keeping the nodes cached at load. Every
+    // refresh_interval searches, the hottest nodes not cached are read into
+    // the cache in the background in place of colder ones, within
+    // num_nodes_to_cache nodes.
+    void enable_adaptive_cache(_u64 num_nodes_to_cache, _u64 refresh_interval);
+
+    // With shared_reads, the searches of a batch running at the same time
+    // share the sectors they read, see SharedSectorReads.
     void cached_beam_search(
         const T *query, const _u64 k_search, const _u64 l_search, _s64 *res_ids,
         float *res_dists, const _u64 beam_width,
         const bool use_reorder_data = false, QueryStats *stats = nullptr,
         const knowhere::feder::diskann::FederResultUniq &feder = nullptr,
         knowhere::BitsetView                             bitset_view = nullptr,
-        const float filter_ratio = -1.0f, const bool for_tuning = false);
+        const float filter_ratio = -1.0f, const bool for_tuning = false,
+        const _u64 io_depth = 0, SharedSectorReads *shared_reads = nullptr);
 
     _u32 range_search(const T *query1, const double range,
                       const _u64 min_l_search, const _u64 max_l_search,
@@ -224,12 +236,24 @@ struct IteratorWorkspace {
 
     _u64 get_max_degree() const noexcept;
 
+    // bytes read for a node, the read_len of SharedSectorReads
+    _u64 get_read_len_for_node() const noexcept;
+
     _u32 *get_medoids() const noexcept;
 
     size_t get_num_medoids() const noexcept;
 
     diskann::Metric get_metric() const noexcept;
 
+    // the norm the base vectors are divided by for inner product, 0 otherwise
+    float get_max_base_norm() const noexcept;
+
+    // whether the nodes hold PQ codes rather than the full precision vectors
+    bool has_disk_pq() const noexcept;
+
+    // whether full precision vectors follow the nodes to rerank with
+    bool has_reorder_data() const noexcept;
+
     void getIteratorNextBatch(IteratorWorkspace* workspace);
 
     
@@ -251,21 +275,42 @@ struct IteratorWorkspace {
     _u64 get_thread_data_size();
 
    private:
+    // location of node_id in the graph part, its id unless the index has a
+    // page aware layout
+    _u64 get_node_loc(_u64 node_id) {
+      return id_to_loc.empty() ? node_id : id_to_loc[node_id];
+    }
+
     // sector # on disk where node_id is present with in the graph part
     _u64 get_node_sector_offset(_u64 node_id) {
-      return long_node ? (node_id * nsectors_per_node + 1) * SECTOR_LEN
-                       : (node_id / nnodes_per_sector + 1) * SECTOR_LEN;
+      return long_node
+                 ? (node_id * nsectors_per_node + 1) * SECTOR_LEN
+                 : (get_node_loc(node_id) / nnodes_per_sector + 1) * SECTOR_LEN;
     }
 
     // obtains region of sector containing node
     char *get_offset_to_node(char *sector_buf, _u64 node_id) {
-      return long_node
-                 ? sector_buf
-                 : sector_buf + (node_id % nnodes_per_sector) * max_node_len;
+      if (long_node) {
+        return sector_buf;
+      }
+      return sector_buf +
+             (get_node_loc(node_id) % nnodes_per_sector) * max_node_len;
     }
 
     inline void copy_vec_base_data(T *des, const int64_t des_idx, void *src);
 
+    // the node a search starts from: the closest point the navigation graph
+    // finds, or the medoid of the closest centroid if there is none.
+    _u32 select_entry_point(const float *query_float);
+
+    // Counts a search for the adaptive cache, scheduling a refresh of the
+    // cache once every cache_refresh_interval searches. Returns whether the
+    // search should record the nodes it expands.
+    bool count_search_for_cache();
+    void refresh_cache();
+    // waits for the cache refresh in progress, if any
+    void destroy_cache_refresh_task();
+
     // Init thread data and returns query norm if avaialble.
     // If there is no value, there is nothing to do with the given query
     std::optional<float> init_thread_data(ThreadData<T> &data, const T *query1);
@@ -288,8 +333,8 @@ struct IteratorWorkspace {
                                                  T *output_data);
 
     // index info
-    // nhood of node `i` is in sector: [i / nnodes_per_sector]
-    // offset in sector: [(i % nnodes_per_sector) * max_node_len]
+    // nhood of node `i` at location `l` is in sector: [l / nnodes_per_sector]
+    // offset in sector: [(l % nnodes_per_sector) * max_node_len]
     // nnbrs of node `i`: *(unsigned*) (buf)
     // nbrs of node `i`: ((unsigned*)buf) + 1
     _u64 max_node_len = 0, nnodes_per_sector = 0, max_degree = 0;
@@ -307,6 +352,11 @@ struct IteratorWorkspace {
     // used only for cosine search to re-scale the caculated distance.
     std::unique_ptr<float[]> base_norms = nullptr;
 
+    // page aware layout, the location of each node in the graph part and the
+    // node at each location. Empty if nodes are stored in the order of ids.
+    std::vector<_u32> id_to_loc;
+    std::vector<_u32> loc_to_id;
+
     // data info
     bool long_node = false;
     _u64 nsectors_per_node = 0;
@@ -339,10 +389,11 @@ struct IteratorWorkspace {
     FixedChunkPQTable pq_table;
 
     // distance comparator
-    DISTFUN<T>     dist_cmp;
-    DISTFUN<float> dist_cmp_float;
+    // the full precision vectors are compared in place with the fp32 query
+    MIXED_DISTFUN<T> dist_cmp;
+    DISTFUN<float>   dist_cmp_float;
 
-    float dist_cmp_wrap(const T *x, const T *y, size_t d, int32_t u) {
+    float dist_cmp_wrap(const float *x, const T *y, size_t d, int32_t u) {
       if (metric == Metric::COSINE) {
         return dist_cmp(x, y, d) / base_norms[u];
       } else {
@@ -375,18 +426,18 @@ struct IteratorWorkspace {
     // centroids, we pick the medoid corresponding to the
     // closest centroid as the starting point of search
     float *centroid_data = nullptr;
+    // empty unless built with a navigation graph, which then picks the entry
+    // point instead of the medoids
+    NavGraph nav_graph;
 
     // cache
-    std::shared_mutex cache_mtx;
-
-    // nhood_cache
-    std::unique_ptr<unsigned[]> nhood_cache_buf = nullptr;
-    tsl::robin_map<_u32, std::pair<_u32, _u32 *>>
-        nhood_cache;  // <id, <neihbors_num, neihbors>>
+    NodeCache<T> node_cache;
 
-    // coord_cache
-    T                        *coord_cache_buf = nullptr;
-    tsl::robin_map<_u32, T *> coord_cache;
+    // adaptive cache, 0 keeps the nodes cached at load
+    _u64              cache_refresh_interval = 0;
+    std::atomic<_u64> cache_search_counter = 0;
+    std::atomic<bool> cache_refreshing = false;
+    std::atomic<bool> stop_cache_refresh = false;
 
     // thread-specific scratch
     ConcurrentQueue<ThreadData<T>> thread_data;
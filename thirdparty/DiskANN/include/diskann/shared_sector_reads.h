@@ -0,0 +1,75 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "utils.h"
+
+namespace diskann {
+  // The sectors read by the searches of a batch of queries, so that similar
+  // queries searched at the same time read each sector from the SSD once.
+  //
+  // The first search needing a sector claims it and reads it into a buffer
+  // owned by the batch. The other searches use that buffer once the read is
+  // published, and may wait for a read in flight rather than issue their own.
+  // The buffers are kept until the batch is done, within a budget: past it,
+  // the searches read sectors on their own.
+  class SharedSectorReads {
+   public:
+    enum class Status {
+      READ,       // buf holds the sector
+      IN_FLIGHT,  // another search is reading the sector into buf, see wait()
+      CLAIMED,    // the caller reads the sector into buf, then publishes it
+      NONE,       // the budget is spent, the caller reads on its own
+    };
+
+    // read_len bytes per sector read, within max_bytes of buffers
+    SharedSectorReads(_u64 read_len, _u64 max_bytes);
+    ~SharedSectorReads();
+    SharedSectorReads(const SharedSectorReads &) = delete;
+    SharedSectorReads &operator=(const SharedSectorReads &) = delete;
+
+    Status acquire(_u64 offset, char *&buf);
+
+    // The read of a claimed sector is done: publish() when it succeeded,
+    // abandon() otherwise, the searches waiting for it then read it on
+    // their own.
+    void publish(_u64 offset);
+    void abandon(_u64 offset);
+
+    // Waits for a sector in flight into buf: READ once it's read, NONE if
+    // its read was abandoned. Without blocking, IN_FLIGHT while it's read.
+    Status wait(_u64 offset, const char *buf, bool block = true);
+
+    // # of sectors read, and of acquisitions served without a read
+    _u64 num_reads() const;
+    _u64 num_shared() const;
+
+   private:
+    struct Entry {
+      char *buf = nullptr;
+      bool  read = false;
+    };
+
+    // buffers are allocated on demand, kBlockReads reads at a time
+    static constexpr _u64 kBlockReads = 64;
+
+    const _u64 read_len;
+    const _u64 max_reads;
+
+    mutable std::mutex              mtx;
+    std::condition_variable         cv;
+    std::unordered_map<_u64, Entry> entries;
+    std::vector<char *>             blocks;
+    // buffers of abandoned reads, claimed again first
+    std::vector<char *>             free_bufs;
+    _u64                            n_claimed = 0;
+    _u64                            n_reads = 0;
+    _u64                            n_shared = 0;
+  };
+}  // namespace diskann
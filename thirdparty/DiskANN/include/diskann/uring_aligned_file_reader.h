@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "aligned_file_reader.h"
+
+// AlignedFileReader on io_uring. Each thread reads through an io_uring of its
+// own, created on first use, so searches don't queue for the contexts of a
+// shared pool as they do with libaio, and a batch of reads is submitted and
+// waited for with a single io_uring_enter() call.
+//
+// The rings are set up with the raw io_uring syscalls, so no library beyond
+// the kernel headers is needed.
+class UringAlignedFileReader : public AlignedFileReader {
+ private:
+  FileHandle file_desc;
+
+ public:
+  // Enables or disables the reader for the indexes loaded afterwards. Returns
+  // whether the reader is enabled, which is false if the kernel doesn't
+  // support io_uring reads, callers then keep using LinuxAlignedFileReader.
+  // With sqpoll, a kernel thread shared by all rings polls their submission
+  // queues, so submissions don't need a syscall, falling back to no sqpoll
+  // if it can't be set up.
+  static bool InitGlobalUring(bool enable, bool sqpoll);
+
+  static bool IsEnabled();
+
+  UringAlignedFileReader();
+  ~UringAlignedFileReader();
+
+  // ring of the calling thread, reads of a context must be issued by the
+  // thread that got it.
+  IOContext get_ctx() override;
+
+  void put_ctx(IOContext ctx) override {
+  }
+
+  size_t max_events_per_ctx() override;
+
+  // Open & close ops
+  // Blocking calls
+  void open(const std::string &fname) override;
+  void close() override;
+
+  // process batch of aligned requests in parallel
+  // NOTE :: blocking call
+  void read(std::vector<AlignedRead> &read_reqs, IOContext &ctx,
+            bool async = false) override;
+
+  // async reads
+  void get_submitted_req(IOContext &ctx, size_t n_ops) override;
+  void submit_req(IOContext &ctx, std::vector<AlignedRead> &read_reqs) override;
+  void get_completed_req(IOContext &ctx, size_t min_n, size_t max_n,
+                         std::vector<void *> &completed) override;
+};
@@ -875,6 +875,26 @@ namespace diskann {
     return disk_index_filename + "_max_base_norm.bin";
   }
 
+  inline std::string get_disk_index_layout_filename(
+      const std::string& disk_index_filename) {
+    return disk_index_filename + "_layout.bin";
+  }
+
+  inline std::string get_disk_index_nav_graph_filename(
+      const std::string& disk_index_filename) {
+    return disk_index_filename + "_nav_graph.bin";
+  }
+
+  inline std::string get_disk_index_deleted_filename(
+      const std::string& disk_index_filename) {
+    return disk_index_filename + "_deleted.bin";
+  }
+
+  inline std::string get_disk_index_merge_manifest_filename(
+      const std::string& disk_index_filename) {
+    return disk_index_filename + "_merge_manifest.txt";
+  }
+
   inline std::string get_cached_nodes_file(
       const std::string& disk_index_filename) {
     return disk_index_filename + "_cached_nodes.bin";
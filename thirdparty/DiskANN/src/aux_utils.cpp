@@ -6,6 +6,8 @@
 #include <cassert>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <numeric>
 #include <set>
 #include <string>
 #include <vector>
@@ -20,6 +22,7 @@
 #include "diskann/aux_utils.h"
 #include "diskann/cached_io.h"
 #include "diskann/index.h"
+#include "diskann/nav_graph.h"
 #include "omp.h"
 #include "diskann/partition_and_pq.h"
 #include "diskann/percentile_stats.h"
@@ -1061,6 +1064,255 @@ namespace diskann {
     LOG_KNOWHERE_DEBUG_ << "Output file written.";
   }
 
+  bool relayout_disk_index(const std::string &disk_index_file,
+                           _u64 disk_bytes_per_point,
+                           const std::string &layout_file,
+                           double             ram_budget_gb) {
+    // file size, # of nodes, medoid, max node len, # of nodes per sector
+    _u64 metadata[5];
+    {
+      std::ifstream index_metadata(disk_index_file, std::ios::binary);
+      index_metadata.read((char *) metadata, sizeof(metadata));
+      if (!index_metadata) {
+        throw ANNException("Failed to read " + disk_index_file, -1,
+                           __FUNCSIG__, __FILE__, __LINE__);
+      }
+    }
+    const _u64 file_size = metadata[0], npts = metadata[1],
+               medoid = metadata[2], max_node_len = metadata[3],
+               nnodes_per_sector = metadata[4];
+    if (max_node_len > SECTOR_LEN || nnodes_per_sector <= 1) {
+      LOG_KNOWHERE_INFO_ << "Skipping page aware layout, " << nnodes_per_sector
+                         << " node(s) per sector.";
+      return false;
+    }
+    const _u64 n_sectors =
+        ROUND_UP(npts, nnodes_per_sector) / nnodes_per_sector;
+    const _u64 graph_bytes = n_sectors * SECTOR_LEN;
+
+    // the placement needs the whole graph in memory, at most max_degree
+    // neighbors and an offset per node, plus the order and the location of
+    // each node.
+    const _u64 max_degree =
+        (max_node_len - disk_bytes_per_point - sizeof(_u32)) / sizeof(_u32);
+    const _u64 budget_bytes = (_u64) (ram_budget_gb * 1024 * 1024 * 1024);
+    const _u64 placement_bytes =
+        npts * (max_degree * sizeof(_u32) + sizeof(_u64) + 2 * sizeof(_u32));
+    if (placement_bytes > budget_bytes) {
+      LOG_KNOWHERE_INFO_ << "Skipping page aware layout, the graph of " << npts
+                         << " nodes needs " << placement_bytes
+                         << " bytes, over the budget of " << budget_bytes
+                         << " bytes.";
+      return false;
+    }
+
+    // load the graph, the neighbors of node i are
+    // nbrs[nbrs_start[i] .. nbrs_start[i + 1])
+    std::vector<_u64> nbrs_start(npts + 1, 0);
+    std::vector<_u32> nbrs;
+    {
+      cached_ifstream         reader(disk_index_file, 64 * 1024 * 1024);
+      std::unique_ptr<char[]> sector_buf = std::make_unique<char[]>(SECTOR_LEN);
+      reader.read(sector_buf.get(), SECTOR_LEN);
+      for (_u64 id = 0; id < npts; id++) {
+        if (id % nnodes_per_sector == 0) {
+          reader.read(sector_buf.get(), SECTOR_LEN);
+        }
+        const _u32 *nhood = (_u32 *) (sector_buf.get() +
+                                      (id % nnodes_per_sector) * max_node_len +
+                                      disk_bytes_per_point);
+        nbrs.insert(nbrs.end(), nhood + 1, nhood + 1 + nhood[0]);
+        nbrs_start[id + 1] = nbrs.size();
+      }
+    }
+
+    // BFS order from the medoid, then the nodes it doesn't reach
+    std::vector<_u32>       bfs_order;
+    boost::dynamic_bitset<> seen(npts);
+    bfs_order.reserve(npts);
+    bfs_order.push_back((_u32) medoid);
+    seen.set(medoid);
+    for (_u64 i = 0; i < bfs_order.size(); i++) {
+      const _u32 id = bfs_order[i];
+      for (_u64 j = nbrs_start[id]; j < nbrs_start[id + 1]; j++) {
+        if (!seen.test(nbrs[j])) {
+          seen.set(nbrs[j]);
+          bfs_order.push_back(nbrs[j]);
+        }
+      }
+    }
+    for (_u64 id = 0; id < npts; id++) {
+      if (!seen.test(id)) {
+        bfs_order.push_back((_u32) id);
+      }
+    }
+
+    std::vector<_u32>       loc_to_id;
+    boost::dynamic_bitset<> placed(npts);
+    loc_to_id.reserve(npts);
+    auto place = [&](_u32 id) {
+      placed.set(id);
+      loc_to_id.push_back(id);
+    };
+    for (auto seed : bfs_order) {
+      if (placed.test(seed)) {
+        continue;
+      }
+      place(seed);
+      // fill the sector of the seed with the neighbors of its nodes, the
+      // nodes closer to the seed first.
+      const _u64 sector_start =
+          (loc_to_id.size() - 1) / nnodes_per_sector * nnodes_per_sector;
+      for (_u64 i = sector_start; i < loc_to_id.size() &&
+                                  loc_to_id.size() % nnodes_per_sector != 0;
+           i++) {
+        const _u32 id = loc_to_id[i];
+        for (_u64 j = nbrs_start[id]; j < nbrs_start[id + 1] &&
+                                      loc_to_id.size() % nnodes_per_sector != 0;
+             j++) {
+          if (!placed.test(nbrs[j])) {
+            place(nbrs[j]);
+          }
+        }
+      }
+    }
+    std::vector<_u32>().swap(nbrs);
+    std::vector<_u64>().swap(nbrs_start);
+
+    // the location of each node, in the memory of the BFS order.
+    std::vector<_u32> &id_to_loc = bfs_order;
+    for (_u64 loc = 0; loc < npts; loc++) {
+      id_to_loc[loc_to_id[loc]] = (_u32) loc;
+    }
+
+    // write the nodes at their new locations, a chunk of sectors at a time
+    // that each takes a sequential pass over the graph, with as few passes
+    // as the budget left allows. The metadata and the reorder data after the
+    // graph are copied as is.
+    const _u64 locs_bytes = 2 * npts * sizeof(_u32);
+    const _u64 chunk_bytes = std::max<_u64>(
+        budget_bytes > locs_bytes ? budget_bytes - locs_bytes : 0,
+        64 * 1024 * 1024);
+    const _u64 chunk_sectors = std::min(n_sectors, chunk_bytes / SECTOR_LEN);
+    const std::string tmp_file = disk_index_file + ".relayout";
+    {
+      cached_ofstream         writer(tmp_file, 64 * 1024 * 1024);
+      std::unique_ptr<char[]> sector_buf = std::make_unique<char[]>(SECTOR_LEN);
+      std::unique_ptr<char[]> chunk_buf =
+          std::make_unique<char[]>(chunk_sectors * SECTOR_LEN);
+      for (_u64 chunk = 0; chunk < n_sectors; chunk += chunk_sectors) {
+        const _u64 loc_begin = chunk * nnodes_per_sector;
+        const _u64 loc_end =
+            std::min(npts, (chunk + chunk_sectors) * nnodes_per_sector);
+        const _u64 n_chunk_sectors = std::min(chunk_sectors, n_sectors - chunk);
+        memset(chunk_buf.get(), 0, n_chunk_sectors * SECTOR_LEN);
+        cached_ifstream reader(disk_index_file, 64 * 1024 * 1024);
+        reader.read(sector_buf.get(), SECTOR_LEN);
+        if (chunk == 0) {
+          writer.write(sector_buf.get(), SECTOR_LEN);
+        }
+        for (_u64 id = 0; id < npts; id++) {
+          if (id % nnodes_per_sector == 0) {
+            reader.read(sector_buf.get(), SECTOR_LEN);
+          }
+          const _u64 loc = id_to_loc[id];
+          if (loc < loc_begin || loc >= loc_end) {
+            continue;
+          }
+          const _u64 dst = (loc / nnodes_per_sector - chunk) * SECTOR_LEN +
+                           (loc % nnodes_per_sector) * max_node_len;
+          memcpy(chunk_buf.get() + dst,
+                 sector_buf.get() + (id % nnodes_per_sector) * max_node_len,
+                 max_node_len);
+        }
+        writer.write(chunk_buf.get(), n_chunk_sectors * SECTOR_LEN);
+      }
+      if (file_size > graph_bytes + SECTOR_LEN) {
+        std::ifstream reader(disk_index_file, std::ios::binary);
+        reader.seekg(graph_bytes + SECTOR_LEN, reader.beg);
+        for (_u64 offset = graph_bytes + SECTOR_LEN; offset < file_size;
+             offset += SECTOR_LEN) {
+          reader.read(sector_buf.get(), SECTOR_LEN);
+          writer.write(sector_buf.get(), SECTOR_LEN);
+        }
+        if (!reader) {
+          throw ANNException("Failed to read " + disk_index_file, -1,
+                             __FUNCSIG__, __FILE__, __LINE__);
+        }
+      }
+    }
+    // the layout goes to disk before the index is replaced, an index whose
+    // nodes were moved is never left without the locations of its ids.
+    try {
+      std::ofstream writer(layout_file, std::ios::binary);
+      writer.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+      const _s32 header[2] = {(_s32) npts, 1};
+      writer.write((const char *) header, sizeof(header));
+      writer.write((const char *) loc_to_id.data(), npts * sizeof(_u32));
+      writer.flush();
+      writer.close();
+    } catch (const std::ios_base::failure &) {
+      std::remove(layout_file.c_str());
+      std::remove(tmp_file.c_str());
+      throw ANNException("Failed to write " + layout_file, -1, __FUNCSIG__,
+                         __FILE__, __LINE__);
+    }
+    if (std::rename(tmp_file.c_str(), disk_index_file.c_str()) != 0) {
+      std::remove(layout_file.c_str());
+      std::remove(tmp_file.c_str());
+      throw ANNException("Failed to replace " + disk_index_file, -1,
+                         __FUNCSIG__, __FILE__, __LINE__);
+    }
+    return true;
+  }
+
+  template<typename T>
+  void build_nav_graph(const std::string &data_file, bool ip_prepared,
+                       _u64 num_nav_points, const std::string &nav_graph_file) {
+    size_t points_num, dim;
+    diskann::get_bin_metadata(data_file, points_num, dim);
+    num_nav_points = std::min(num_nav_points, (_u64) points_num);
+
+    // ascending ids, as retrieve_shard_data_from_ids() expects
+    std::vector<_u32> all_ids(points_num), ids;
+    std::iota(all_ids.begin(), all_ids.end(), 0);
+    ids.reserve(num_nav_points);
+    std::sample(all_ids.begin(), all_ids.end(), std::back_inserter(ids),
+                num_nav_points, std::mt19937(std::random_device()()));
+    std::vector<_u32>().swap(all_ids);
+
+    const std::string ids_file = nav_graph_file + "_ids.bin";
+    const std::string sample_file = nav_graph_file + "_data.bin";
+    save_bin<_u32>(ids_file, ids.data(), ids.size(), 1);
+    retrieve_shard_data_from_ids<T>(data_file, ids_file, sample_file);
+
+    diskann::Parameters paras;
+    paras.Set<unsigned>("L", NAV_GRAPH_BUILD_L);
+    paras.Set<unsigned>("R", NAV_GRAPH_DEGREE);
+    paras.Set<unsigned>("C", 750);
+    paras.Set<float>("alpha", 1.2f);
+    paras.Set<unsigned>("num_rnds", 2);
+    paras.Set<bool>("saturate_graph", false);
+    paras.Set<bool>("accelerate_build", false);
+    paras.Set<bool>("shuffle_build", false);
+    diskann::Index<T> nav_index(diskann::Metric::L2, ip_prepared, dim,
+                                ids.size(), false, false);
+    nav_index.build(sample_file.c_str(), ids.size(), paras);
+
+    std::unique_ptr<T[]> sample_data;
+    size_t               npts, sample_dim;
+    diskann::load_bin<T>(sample_file, sample_data, npts, sample_dim);
+    std::vector<float> nav_data(npts * sample_dim);
+    for (_u64 i = 0; i < nav_data.size(); i++) {
+      nav_data[i] = (float) sample_data[i];
+    }
+    NavGraph::save(nav_graph_file, ids, nav_data.data(), sample_dim,
+                   *nav_index.get_graph(), nav_index.get_entry_point());
+
+    std::remove(ids_file.c_str());
+    std::remove(sample_file.c_str());
+  }
+
   template<typename T>
   int build_disk_index(const BuildConfig &config) {
     if (!knowhere::KnowhereFloatTypeCheck<T>::value &&
@@ -1163,6 +1415,17 @@ namespace diskann {
 
     diskann::get_bin_metadata(data_file_to_use.c_str(), points_num, dim);
 
+    // the navigation graph takes its share of the budget from the PQ codes
+    _u64 num_nav_points = std::min(
+        (_u64) (pq_code_size_limit * config.nav_graph_budget_ratio /
+                NavGraph::point_size(dim, NAV_GRAPH_DEGREE)),
+        (_u64) points_num);
+    if (num_nav_points < MIN_NAV_GRAPH_POINTS) {
+      num_nav_points = 0;
+    }
+    pq_code_size_limit -=
+        num_nav_points * NavGraph::point_size(dim, NAV_GRAPH_DEGREE);
+
     size_t num_pq_chunks =
         (size_t) (std::floor)(_u64(pq_code_size_limit / points_num));
 
@@ -1249,6 +1512,30 @@ namespace diskann {
                                          mem_index_path, disk_index_path,
                                          data_file_to_save.c_str());
     }
+    if (config.page_aware_layout) {
+      auto layout_s = std::chrono::high_resolution_clock::now();
+      const _u64 disk_bytes_per_point =
+          use_disk_pq ? disk_pq_dims * sizeof(_u8) : dim * sizeof(T);
+      if (diskann::relayout_disk_index(
+              disk_index_path, disk_bytes_per_point,
+              get_disk_index_layout_filename(disk_index_path),
+              indexing_ram_budget)) {
+        std::chrono::duration<double> layout_diff =
+            std::chrono::high_resolution_clock::now() - layout_s;
+        LOG_KNOWHERE_INFO_ << "Page aware layout cost: " << layout_diff.count()
+                           << "s";
+      }
+    }
+    if (num_nav_points > 0) {
+      auto nav_s = std::chrono::high_resolution_clock::now();
+      diskann::build_nav_graph<T>(
+          data_file_to_use, ip_prepared, num_nav_points,
+          get_disk_index_nav_graph_filename(disk_index_path));
+      std::chrono::duration<double> nav_diff =
+          std::chrono::high_resolution_clock::now() - nav_s;
+      LOG_KNOWHERE_INFO_ << "Navigation graph of " << num_nav_points
+                         << " points cost: " << nav_diff.count() << "s";
+    }
 
     double ten_percent_points = std::ceil(points_num * 0.1);
     double num_sample_points = ten_percent_points > MAX_SAMPLE_POINTS_FOR_WARMUP
@@ -1356,6 +1643,16 @@ namespace diskann {
   // not support build uint8/int8 diskindex in knowhere
   // template int build_disk_index<int8_t>(const BuildConfig &config);
   // template int build_disk_index<uint8_t>(const BuildConfig &config);
+  template void build_nav_graph<float>(const std::string &data_file,
+                                       bool ip_prepared, _u64 num_nav_points,
+                                       const std::string &nav_graph_file);
+  template void build_nav_graph<knowhere::fp16>(
+      const std::string &data_file, bool ip_prepared, _u64 num_nav_points,
+      const std::string &nav_graph_file);
+  template void build_nav_graph<knowhere::bf16>(
+      const std::string &data_file, bool ip_prepared, _u64 num_nav_points,
+      const std::string &nav_graph_file);
+
   template int build_disk_index<float>(const BuildConfig &config);
   template int build_disk_index<knowhere::fp16>(const BuildConfig &config);
   template int build_disk_index<knowhere::bf16>(const BuildConfig &config);
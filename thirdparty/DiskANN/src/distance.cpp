@@ -52,11 +52,97 @@ namespace diskann {
     }
   }
 
+  template<typename T>
+  MIXED_DISTFUN<T> get_mixed_distance_function(diskann::Metric m) {
+    if (m == diskann::Metric::L2) {
+      return [](const float* x, const T* y, size_t size) -> float {
+        float res = 0;
+        for (size_t i = 0; i < size; i++) {
+          res += (x[i] - (float) y[i]) * (x[i] - (float) y[i]);
+        }
+        return res;
+      };
+    } else if (m == diskann::Metric::INNER_PRODUCT ||
+               m == diskann::Metric::COSINE) {
+      return [](const float* x, const T* y, size_t size) -> float {
+        float res = 0;
+        for (size_t i = 0; i < size; i++) {
+          res += x[i] * (float) y[i];
+        }
+        return -res;
+      };
+    } else {
+      std::stringstream stream;
+      stream << "Only L2 and inner product supported as for now. ";
+      LOG(ERROR) << stream.str();
+      throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__,
+                                  __LINE__);
+    }
+  }
+
+  template<>
+  MIXED_DISTFUN<float> get_mixed_distance_function(diskann::Metric m) {
+    return get_distance_function<float>(m);
+  }
+
+  // the 16 bits vectors are widened to fp32 by the simd kernels
+  template<>
+  MIXED_DISTFUN<knowhere::fp16> get_mixed_distance_function(
+      diskann::Metric m) {
+    if (m == diskann::Metric::L2) {
+      return [](const float* x, const knowhere::fp16* y,
+                size_t size) -> float {
+        return faiss::fp16_vec_L2sqr(x, y, size);
+      };
+    } else if (m == diskann::Metric::INNER_PRODUCT ||
+               m == diskann::Metric::COSINE) {
+      return [](const float* x, const knowhere::fp16* y,
+                size_t size) -> float {
+        return (-1.0) * faiss::fp16_vec_inner_product(x, y, size);
+      };
+    } else {
+      std::stringstream stream;
+      stream << "Only L2, cosine, and inner product supported for floating "
+                "point vectors as of now. ";
+      LOG(ERROR) << stream.str();
+      throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__,
+                                  __LINE__);
+    }
+  }
+
+  template<>
+  MIXED_DISTFUN<knowhere::bf16> get_mixed_distance_function(
+      diskann::Metric m) {
+    if (m == diskann::Metric::L2) {
+      return [](const float* x, const knowhere::bf16* y,
+                size_t size) -> float {
+        return faiss::bf16_vec_L2sqr(x, y, size);
+      };
+    } else if (m == diskann::Metric::INNER_PRODUCT ||
+               m == diskann::Metric::COSINE) {
+      return [](const float* x, const knowhere::bf16* y,
+                size_t size) -> float {
+        return (-1.0) * faiss::bf16_vec_inner_product(x, y, size);
+      };
+    } else {
+      std::stringstream stream;
+      stream << "Only L2, cosine, and inner product supported for floating "
+                "point vectors as of now. ";
+      LOG(ERROR) << stream.str();
+      throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__,
+                                  __LINE__);
+    }
+  }
+
   // get vector sqr norm
   template<typename T>
   float norm_l2sqr(const T* a, size_t size) {
     if constexpr (std::is_floating_point<T>::value) {
       return faiss::fvec_norm_L2sqr(a, size);
+    } else if constexpr (std::is_same_v<T, knowhere::fp16>) {
+      return faiss::fp16_vec_norm_L2sqr(a, size);
+    } else if constexpr (std::is_same_v<T, knowhere::bf16>) {
+      return faiss::bf16_vec_norm_L2sqr(a, size);
     } else {
       float res = 0;
       for (size_t i = 0; i < size; i++) {
@@ -72,6 +158,11 @@ namespace diskann {
   template DISTFUN<knowhere::fp16> get_distance_function(diskann::Metric m);
   template DISTFUN<knowhere::bf16> get_distance_function(diskann::Metric m);
 
+  template MIXED_DISTFUN<uint8_t> get_mixed_distance_function(
+      diskann::Metric m);
+  template MIXED_DISTFUN<int8_t> get_mixed_distance_function(
+      diskann::Metric m);
+
   template float norm_l2sqr(const float*, size_t);
   template float norm_l2sqr(const uint8_t*, size_t);
   template float norm_l2sqr(const int8_t*, size_t);
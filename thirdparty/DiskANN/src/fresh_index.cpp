@@ -0,0 +1,1211 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "diskann/fresh_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+
+#include "diskann/index.h"
+#include "diskann/neighbor.h"
+#include "diskann/partition_and_pq.h"
+#include "diskann/pq_table.h"
+#include "diskann/timer.h"
+#include "knowhere/comp/thread_pool.h"
+#include "knowhere/log.h"
+#include "simd/hook.h"
+
+namespace {
+  static auto merge_pool =
+      knowhere::ThreadPool::CreateFIFO(1, "DiskANN_Fresh_Merge");
+
+  // list size of the searches for the neighbors of the inserted points, in
+  // the deltas and in the disk index during the merges
+  constexpr unsigned kInsertSearchL = 128;
+  constexpr unsigned kInsertMaxCandidates = 750;
+  // the patches of the neighbor lists prune at most this many times the
+  // max degree of their closest candidates, the replacements of the deleted
+  // neighbors would make the pools of the streaming pass long
+  constexpr unsigned kPatchCandidatesPerDegree = 2;
+  // alpha of the pruning, the one of the disk index builds
+  constexpr float kPruneAlpha = 1.2f;
+  constexpr _u64  kMergeBeamWidth = 4;
+  // the merges read and write the disk index by blocks of about this size
+  constexpr _u64 kMergeBatchSize = 64 * 1024 * 1024;
+  // suffix of the files a merge writes, until they replace the index files
+  const std::string kMergeSuffix = ".merge";
+
+  // Runs func(i) for i in [0, n) on the build thread pool.
+  template<typename Func>
+  void parallel_for(_u64 n, Func &&func) {
+    auto       pool = knowhere::ThreadPool::GetGlobalBuildThreadPool();
+    const _u64 task_size = std::max<_u64>(1, DIV_ROUND_UP(n, pool->size()));
+    std::vector<folly::Future<folly::Unit>> futures;
+    for (_u64 begin = 0; begin < n; begin += task_size) {
+      futures.emplace_back(
+          pool->push([&, begin, end = std::min(n, begin + task_size)]() {
+            for (_u64 i = begin; i < end; i++) {
+              func(i);
+            }
+          }));
+    }
+    knowhere::WaitAllSuccess(futures);
+  }
+
+  // Keeps at most degree of candidates, the way Index::occlude_list() does
+  // with L2: a candidate is left out when one kept is alpha times closer to
+  // it than to node. coords_of(id, out) writes the coordinates of a
+  // candidate, only the max_pool closest candidates are considered.
+  template<typename CoordsFn>
+  void prune(const float *node, const std::vector<_u32> &candidates,
+             CoordsFn &&coords_of, _u64 dim, _u32 degree,
+             std::vector<_u32> &result,
+             _u64               max_pool = kInsertMaxCandidates) {
+    std::vector<float>          coords(candidates.size() * dim);
+    std::vector<diskann::Neighbor> pool;
+    pool.reserve(candidates.size());
+    for (_u64 i = 0; i < candidates.size(); i++) {
+      coords_of(candidates[i], coords.data() + i * dim);
+      // the ids of the pool are positions in candidates
+      pool.emplace_back((unsigned) i,
+                        faiss::fvec_L2sqr(node, coords.data() + i * dim, dim),
+                        true);
+    }
+    std::sort(pool.begin(), pool.end());
+    if (pool.size() > max_pool) {
+      pool.resize(max_pool);
+    }
+
+    result.clear();
+    std::vector<float> occlude_factor(pool.size(), 0);
+    float              cur_alpha = 1;
+    while (cur_alpha <= kPruneAlpha && result.size() < degree) {
+      for (_u64 start = 0; start < pool.size() && result.size() < degree;
+           start++) {
+        if (occlude_factor[start] > cur_alpha) {
+          continue;
+        }
+        occlude_factor[start] = std::numeric_limits<float>::max();
+        result.push_back(candidates[pool[start].id]);
+        const float *kept = coords.data() + pool[start].id * dim;
+        for (_u64 t = start + 1; t < pool.size(); t++) {
+          if (occlude_factor[t] > kPruneAlpha) {
+            continue;
+          }
+          const float djk = faiss::fvec_L2sqr(
+              coords.data() + pool[t].id * dim, kept, dim);
+          occlude_factor[t] =
+              std::max(occlude_factor[t], pool[t].distance / djk);
+        }
+      }
+      cur_alpha *= 1.2f;
+    }
+  }
+
+  bool test_bit(const std::vector<uint8_t> &bits, _u64 i) {
+    return i / 8 < bits.size() && (bits[i / 8] >> (i % 8)) & 1;
+  }
+
+  void set_bit(std::vector<uint8_t> &bits, _u64 i) {
+    bits[i / 8] |= (uint8_t) (1 << (i % 8));
+  }
+}  // namespace
+
+namespace diskann {
+  // The points inserted since the last merge, ids first_id to first_id +
+  // capacity - 1, searched with an in-memory graph built as they come.
+  template<typename T>
+  class FreshIndex<T>::Delta {
+   public:
+    Delta(_u64 first_id, _u64 capacity, _u64 dim, _u64 graph_dim,
+          _u32 max_degree)
+        : first_id(first_id), capacity(capacity),
+          points(std::make_unique<T[]>(capacity * dim)) {
+      Parameters params;
+      params.Set<unsigned>("L", kInsertSearchL);
+      params.Set<unsigned>("R", max_degree);
+      params.Set<unsigned>("C", kInsertMaxCandidates);
+      params.Set<float>("alpha", kPruneAlpha);
+      params.Set<unsigned>("num_rnds", 1);
+      params.Set<bool>("saturate_graph", false);
+      Parameters search_params;
+      search_params.Set<unsigned>("L", kInsertSearchL);
+      // the points are tagged with their ids
+      graph = std::make_unique<Index<float, _u32>>(
+          Metric::L2, false, graph_dim, capacity, true, params, search_params,
+          true);
+    }
+
+    const _u64 first_id;
+    const _u64 capacity;
+    // the points as inserted, graph holding their coordinates in the graph
+    // space
+    std::unique_ptr<T[]>                 points;
+    std::unique_ptr<Index<float, _u32>> graph;
+    // # of points inserted, the searches leave out the ones being inserted
+    std::atomic<_u64> size = 0;
+  };
+
+  template<typename T>
+  FreshIndex<T>::FreshIndex(std::shared_ptr<PQFlashIndex<T>> disk_index,
+                            const std::string &index_prefix, Loader loader,
+                            _u64 merge_threshold)
+      : index_prefix(index_prefix), loader(std::move(loader)),
+        merge_threshold(std::max<_u64>(merge_threshold, 1)) {
+    metric = disk_index->get_metric();
+    graph_dim = disk_index->get_data_dim();
+    dim = metric == Metric::INNER_PRODUCT ? graph_dim - 1 : graph_dim;
+    max_base_norm = disk_index->get_max_base_norm();
+    max_degree = (_u32) disk_index->get_max_degree();
+    num_points = disk_index->get_num_points();
+    updatable = !disk_index->has_disk_pq() && !disk_index->has_reorder_data();
+    state.disk = std::move(disk_index);
+
+    const std::string deleted_file =
+        get_disk_index_deleted_filename(get_disk_index_filename(index_prefix));
+    if (file_exists(deleted_file)) {
+      std::unique_ptr<_u32[]> ids;
+      size_t                  n_ids, n_cols;
+      load_bin<_u32>(deleted_file, ids, n_ids, n_cols);
+      deleted.assign(DIV_ROUND_UP(num_points.load(), 8), 0);
+      for (size_t i = 0; i < n_ids; i++) {
+        if (ids[i] < num_points.load() && !test_bit(deleted, ids[i])) {
+          set_bit(deleted, ids[i]);
+          num_deleted++;
+        }
+      }
+      LOG_KNOWHERE_INFO_ << "Loaded " << num_deleted << " deleted points of "
+                         << index_prefix;
+    }
+  }
+
+  template<typename T>
+  FreshIndex<T>::~FreshIndex() {
+    stop_merge = true;
+    std::unique_lock<std::mutex> lock(merge_mtx);
+    merge_cv.wait(lock, [this] { return !merge_running; });
+  }
+
+  template<typename T>
+  bool FreshIndex<T>::supports_updates() const noexcept {
+    return updatable;
+  }
+
+  template<typename T>
+  _u64 FreshIndex<T>::insert(const T *points, _u64 n) {
+    if (!updatable) {
+      throw ANNException("Can't insert into " + index_prefix +
+                             ", whose disk index can't be merged into",
+                         -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    std::lock_guard<std::mutex> lock(insert_mtx);
+    const _u64                  first_id = num_points.load();
+    if (first_id + n > std::numeric_limits<_u32>::max()) {
+      throw ANNException("Too many points to insert into " + index_prefix, -1,
+                         __FUNCSIG__, __FILE__, __LINE__);
+    }
+
+    _u64 n_inserted = 0;
+    while (n_inserted < n) {
+      std::shared_ptr<Delta> delta;
+      {
+        std::shared_lock<std::shared_mutex> guard(state_mtx);
+        delta = state.delta;
+      }
+      if (delta == nullptr) {
+        delta = std::make_shared<Delta>(num_points.load(), merge_threshold,
+                                        dim, graph_dim, max_degree);
+        std::unique_lock<std::shared_mutex> guard(state_mtx);
+        state.delta = delta;
+      } else if (delta->size.load() == delta->capacity) {
+        start_merge(false);
+        continue;
+      }
+
+      const _u64 begin = delta->size.load();
+      const _u64 count = std::min(n - n_inserted, delta->capacity - begin);
+      const T   *batch = points + n_inserted * dim;
+      memcpy(delta->points.get() + begin * dim, batch, count * dim * sizeof(T));
+      parallel_for(count, [&](_u64 i) {
+        std::vector<float> coords(graph_dim);
+        to_graph_space(batch + i * dim, coords.data());
+        const _u64 id = delta->first_id + begin + i;
+        if (delta->graph->insert_point(coords.data(), (_u32) id) != 0) {
+          throw ANNException("Failed to insert point " + std::to_string(id) +
+                                 " into " + index_prefix,
+                             -1, __FUNCSIG__, __FILE__, __LINE__);
+        }
+      });
+      delta->size = begin + count;
+      num_points += count;
+      n_inserted += count;
+    }
+
+    // starts merging a full delta right away, rather than with the next
+    // insert
+    bool full = false;
+    {
+      std::shared_lock<std::shared_mutex> guard(state_mtx);
+      full = state.delta != nullptr &&
+             state.delta->size.load() == state.delta->capacity;
+    }
+    if (full) {
+      start_merge(false);
+    }
+    return first_id;
+  }
+
+  template<typename T>
+  void FreshIndex<T>::remove(const _s64 *ids, _u64 n) {
+    if (!updatable) {
+      throw ANNException("Can't delete from " + index_prefix +
+                             ", whose disk index can't be merged into",
+                         -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    bool merge_due = false;
+    {
+      std::unique_lock<std::shared_mutex> guard(delete_mtx);
+      const _u64                          npts = num_points.load();
+      if (deleted.size() < DIV_ROUND_UP(npts, 8)) {
+        deleted.resize(DIV_ROUND_UP(npts, 8), 0);
+      }
+      for (_u64 i = 0; i < n; i++) {
+        if (ids[i] < 0 || (_u64) ids[i] >= npts ||
+            test_bit(deleted, ids[i])) {
+          continue;
+        }
+        set_bit(deleted, ids[i]);
+        num_deleted++;
+        pending_deletes.push_back((_u32) ids[i]);
+      }
+      merge_due = pending_deletes.size() >= merge_threshold;
+    }
+    if (!merge_due) {
+      return;
+    }
+    {
+      // the merge in progress leaves the deletes made since pending for the
+      // next one
+      std::lock_guard<std::mutex> lock(merge_mtx);
+      if (merge_running) {
+        return;
+      }
+    }
+    std::lock_guard<std::mutex> lock(insert_mtx);
+    start_merge(false);
+  }
+
+  template<typename T>
+  void FreshIndex<T>::merge() {
+    std::lock_guard<std::mutex> lock(insert_mtx);
+    start_merge(true);
+  }
+
+  template<typename T>
+  typename FreshIndex<T>::Snapshot FreshIndex<T>::snapshot() const {
+    std::shared_lock<std::shared_mutex> guard(state_mtx);
+    return state;
+  }
+
+  template<typename T>
+  knowhere::BitsetView FreshIndex<T>::filter_deleted(
+      knowhere::BitsetView                         bitset,
+      std::shared_ptr<const std::vector<uint8_t>> &bits) const {
+    _u64 npts = 0;
+    _u64 n_deleted = 0;
+    {
+      std::shared_lock<std::shared_mutex> guard(delete_mtx);
+      if (num_deleted == 0) {
+        return bitset;
+      }
+      // the deleted points are all below npts
+      npts = num_points.load();
+      n_deleted = num_deleted;
+      std::lock_guard<std::mutex> lock(deleted_bits_mtx);
+      if (deleted_bits.npts != npts || deleted_bits.num_deleted != n_deleted) {
+        auto rebuilt =
+            std::make_shared<std::vector<uint8_t>>(DIV_ROUND_UP(npts, 8), 0);
+        memcpy(rebuilt->data(), deleted.data(),
+               std::min(deleted.size(), rebuilt->size()));
+        deleted_bits.npts = npts;
+        deleted_bits.num_deleted = n_deleted;
+        deleted_bits.bits = std::move(rebuilt);
+      }
+      bits = deleted_bits.bits;
+    }
+    if (bitset.empty()) {
+      return knowhere::BitsetView(bits->data(), npts, n_deleted);
+    }
+
+    auto merged = std::make_shared<std::vector<uint8_t>>(*bits);
+    auto n_bytes = std::min<_u64>(bitset.byte_size(), merged->size());
+    for (_u64 i = 0; i < n_bytes; i++) {
+      (*merged)[i] |= bitset.data()[i];
+    }
+    // as BitsetView::test(), the points past the bitset are filtered out
+    if (bitset.size() < npts) {
+      if (bitset.size() % 8 != 0) {
+        (*merged)[bitset.size() / 8] |= (uint8_t) (0xff << (bitset.size() % 8));
+      }
+      std::fill(merged->begin() + DIV_ROUND_UP(bitset.size(), 8),
+                merged->end(), 0xff);
+    }
+    if (npts % 8 != 0) {
+      merged->back() &= (uint8_t) ((1 << (npts % 8)) - 1);
+    }
+    bits = merged;
+    knowhere::BitsetView view(merged->data(), npts);
+    return knowhere::BitsetView(merged->data(), npts,
+                                view.get_filtered_out_num_());
+  }
+
+  template<typename T>
+  void FreshIndex<T>::search(const Snapshot &snapshot, const T *query,
+                             const _u64 k_search, const _u64 l_search,
+                             _s64 *res_ids, float *res_dists,
+                             const _u64 beam_width, QueryStats *stats,
+                             const knowhere::feder::diskann::FederResultUniq &feder,
+                             knowhere::BitsetView bitset,
+                             const float filter_ratio, const bool for_tuning,
+                             const _u64         io_depth,
+                             SharedSectorReads *shared_reads) const {
+    if (snapshot.merging == nullptr && snapshot.delta == nullptr) {
+      snapshot.disk->cached_beam_search(
+          query, k_search, l_search, res_ids, res_dists, beam_width, false,
+          stats, feder, bitset, filter_ratio, for_tuning, io_depth,
+          shared_reads);
+      return;
+    }
+
+    std::vector<float> dists(k_search, -1.0f);
+    std::fill_n(res_ids, k_search, -1);
+    snapshot.disk->cached_beam_search(
+        query, k_search, l_search, res_ids, dists.data(), beam_width, false,
+        stats, feder, bitset, filter_ratio, for_tuning, io_depth, shared_reads);
+
+    std::vector<std::pair<float, _s64>> results;
+    for (_u64 i = 0; i < k_search && res_ids[i] != -1; i++) {
+      results.emplace_back(dists[i], res_ids[i]);
+    }
+    for (const auto &delta : {snapshot.merging, snapshot.delta}) {
+      if (delta != nullptr) {
+        search_delta(*delta, query, k_search, l_search, bitset, results);
+      }
+    }
+    if (metric == Metric::L2) {
+      std::sort(results.begin(), results.end());
+    } else {
+      std::sort(results.begin(), results.end(),
+                [](const auto &a, const auto &b) { return a > b; });
+    }
+
+    for (_u64 i = 0; i < k_search; i++) {
+      res_ids[i] = i < results.size() ? results[i].second : -1;
+      if (res_dists != nullptr) {
+        res_dists[i] = i < results.size() ? results[i].first : -1.0f;
+      }
+    }
+  }
+
+  template<typename T>
+  void FreshIndex<T>::search_delta(
+      const Delta &delta, const T *query, const _u64 k_search,
+      const _u64 l_search, knowhere::BitsetView bitset,
+      std::vector<std::pair<float, _s64>> &results) const {
+    const _u64 size = delta.size.load();
+    if (size == 0) {
+      return;
+    }
+    std::vector<float> graph_query(graph_dim);
+    if (!query_to_graph_space(query, graph_query.data())) {
+      return;
+    }
+
+    const _u64          l = std::max(l_search, k_search);
+    std::vector<_u32>   ids(l);
+    std::vector<float>  dists(l);
+    std::vector<float *> no_vectors;
+    const _u64          n_found = delta.graph->search_with_tags(
+        graph_query.data(), l, (unsigned) l, ids.data(), dists.data(),
+        no_vectors);
+    _u64 n_results = 0;
+    for (_u64 i = 0; i < n_found && n_results < k_search; i++) {
+      const _u64 id = ids[i];
+      if (id >= delta.first_id + size ||
+          (!bitset.empty() && bitset.test(id))) {
+        continue;
+      }
+      results.emplace_back(
+          distance(query, delta.points.get() + (id - delta.first_id) * dim),
+          id);
+      n_results++;
+    }
+  }
+
+  template<typename T>
+  _u32 FreshIndex<T>::range_search(const Snapshot &snapshot, const T *query,
+                                   const double range,
+                                   const _u64   min_l_search,
+                                   const _u64   max_l_search,
+                                   std::vector<_s64>  &indices,
+                                   std::vector<float> &distances,
+                                   const _u64 beam_width,
+                                   knowhere::BitsetView bitset,
+                                   QueryStats *stats) const {
+    _u32 res_count = 0;
+
+    bool stop_flag = false;
+
+    _u64 l_search = min_l_search;  // starting size of the candidate list
+    while (!stop_flag) {
+      if (stats != nullptr) {
+        stats->n_iters++;
+      }
+      indices.resize(l_search);
+      distances.resize(l_search);
+      search(snapshot, query, l_search, l_search, indices.data(),
+             distances.data(), beam_width, stats, nullptr, bitset);
+      res_count = l_search;
+      for (_u32 i = 0; i < l_search; i++) {
+        bool in_range = indices[i] != -1 &&
+                        (metric == diskann::Metric::L2
+                             ? distances[i] < (float) range
+                             : distances[i] > (float) range);
+        if (!in_range) {
+          res_count = i;
+          break;
+        }
+      }
+      if (res_count < (_u32) (l_search / 2.0))
+        stop_flag = true;
+      l_search = l_search * 2;
+      if (l_search > max_l_search)
+        stop_flag = true;
+    }
+    indices.resize(res_count);
+    distances.resize(res_count);
+    return res_count;
+  }
+
+  template<typename T>
+  void FreshIndex<T>::get_vector_by_ids(const Snapshot &snapshot,
+                                        const int64_t *ids, const int64_t n,
+                                        T *const output_data) const {
+    if (snapshot.merging == nullptr && snapshot.delta == nullptr) {
+      snapshot.disk->get_vector_by_ids(ids, n, output_data);
+      return;
+    }
+
+    const _u64           disk_npts = snapshot.disk->get_num_points();
+    std::vector<int64_t> disk_ids, disk_pos;
+    for (int64_t i = 0; i < n; i++) {
+      if (ids[i] >= 0 && (_u64) ids[i] < disk_npts) {
+        disk_ids.push_back(ids[i]);
+        disk_pos.push_back(i);
+        continue;
+      }
+      bool found = false;
+      for (const auto &delta : {snapshot.merging, snapshot.delta}) {
+        if (delta != nullptr && ids[i] >= 0 &&
+            (_u64) ids[i] >= delta->first_id &&
+            (_u64) ids[i] < delta->first_id + delta->size.load()) {
+          memcpy(output_data + i * dim,
+                 delta->points.get() + (ids[i] - delta->first_id) * dim,
+                 dim * sizeof(T));
+          found = true;
+          break;
+        }
+      }
+      if (!found) {
+        throw ANNException("Invalid id " + std::to_string(ids[i]), -1,
+                           __FUNCSIG__, __FILE__, __LINE__);
+      }
+    }
+    if (disk_ids.empty()) {
+      return;
+    }
+    std::vector<T> disk_vectors(disk_ids.size() * dim);
+    snapshot.disk->get_vector_by_ids(disk_ids.data(), disk_ids.size(),
+                                     disk_vectors.data());
+    for (_u64 i = 0; i < disk_ids.size(); i++) {
+      memcpy(output_data + disk_pos[i] * dim, disk_vectors.data() + i * dim,
+             dim * sizeof(T));
+    }
+  }
+
+  template<typename T>
+  _u64 FreshIndex<T>::get_num_points() const noexcept {
+    return num_points.load();
+  }
+
+  template<typename T>
+  _u64 FreshIndex<T>::cal_size() const {
+    _u64 size = 0;
+    {
+      std::shared_lock<std::shared_mutex> guard(state_mtx);
+      for (const auto &delta : {state.merging, state.delta}) {
+        if (delta != nullptr) {
+          size += delta->capacity * dim * sizeof(T) +
+                  (_u64) estimate_ram_usage(delta->capacity, graph_dim,
+                                            sizeof(float), max_degree);
+        }
+      }
+    }
+    std::shared_lock<std::shared_mutex> guard(delete_mtx);
+    size += deleted.size() + pending_deletes.size() * sizeof(_u32);
+    std::lock_guard<std::mutex> lock(deleted_bits_mtx);
+    return size +
+           (deleted_bits.bits == nullptr ? 0 : deleted_bits.bits->size());
+  }
+
+  template<typename T>
+  void FreshIndex<T>::to_graph_space(const T *point, float *out) const {
+    float norm = 0;
+    for (_u64 i = 0; i < dim; i++) {
+      out[i] = (float) point[i];
+      norm += out[i] * out[i];
+    }
+    if (metric == Metric::COSINE && norm > 0) {
+      norm = std::sqrt(norm);
+      for (_u64 i = 0; i < dim; i++) {
+        out[i] /= norm;
+      }
+    } else if (metric == Metric::INNER_PRODUCT) {
+      // the points past max_base_norm get an extra coordinate of 0, their
+      // inner products being off
+      const float max_norm = max_base_norm > 0 ? max_base_norm : 1.0f;
+      for (_u64 i = 0; i < dim; i++) {
+        out[i] /= max_norm;
+      }
+      out[dim] = std::sqrt(std::max(0.0f, 1 - norm / (max_norm * max_norm)));
+    }
+  }
+
+  template<typename T>
+  bool FreshIndex<T>::query_to_graph_space(const T *query, float *out) const {
+    float norm = 0;
+    for (_u64 i = 0; i < dim; i++) {
+      out[i] = (float) query[i];
+      norm += out[i] * out[i];
+    }
+    if (metric == Metric::L2) {
+      return true;
+    }
+    if (norm == 0) {
+      return false;
+    }
+    norm = std::sqrt(norm);
+    for (_u64 i = 0; i < dim; i++) {
+      out[i] /= norm;
+    }
+    if (metric == Metric::INNER_PRODUCT) {
+      out[dim] = 0;
+    }
+    return true;
+  }
+
+  template<typename T>
+  float FreshIndex<T>::distance(const T *query, const T *point) const {
+    float l2 = 0, ip = 0, query_norm = 0, point_norm = 0;
+    for (_u64 i = 0; i < dim; i++) {
+      const float q = (float) query[i], p = (float) point[i];
+      l2 += (q - p) * (q - p);
+      ip += q * p;
+      query_norm += q * q;
+      point_norm += p * p;
+    }
+    if (metric == Metric::L2) {
+      return l2;
+    }
+    if (metric == Metric::INNER_PRODUCT) {
+      return ip;
+    }
+    return query_norm > 0 && point_norm > 0
+               ? ip / std::sqrt(query_norm * point_norm)
+               : 0.0f;
+  }
+
+  template<typename T>
+  void FreshIndex<T>::start_merge(bool wait) {
+    std::unique_lock<std::mutex> lock(merge_mtx);
+    merge_cv.wait(lock, [this] { return !merge_running; });
+    if (merge_broken) {
+      throw ANNException("The files of " + index_prefix +
+                             " were replaced by a merge that failed to load",
+                         -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    {
+      // the delta of a merge that failed is merged again first
+      std::unique_lock<std::shared_mutex> guard(state_mtx);
+      if (state.merging == nullptr && state.delta != nullptr &&
+          state.delta->size.load() > 0) {
+        state.merging = std::move(state.delta);
+        state.delta = nullptr;
+      }
+    }
+    const bool retry = merge_error != nullptr;
+    merge_error = nullptr;
+    merge_running = true;
+    lock.unlock();
+
+    if (!wait && !retry) {
+      merge_pool.push([this] { run_merge(); });
+      return;
+    }
+    run_merge();
+    lock.lock();
+    if (merge_error != nullptr) {
+      std::rethrow_exception(merge_error);
+    }
+  }
+
+  template<typename T>
+  void FreshIndex<T>::run_merge() {
+    std::exception_ptr error = nullptr;
+    try {
+      merge_into_disk();
+    } catch (const std::exception &e) {
+      LOG_KNOWHERE_ERROR_ << "Failed to merge into " << index_prefix << ": "
+                          << e.what();
+      error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(merge_mtx);
+      merge_error = error;
+      merge_running = false;
+    }
+    merge_cv.notify_all();
+  }
+
+  template<typename T>
+  void FreshIndex<T>::merge_into_disk() {
+    Timer                            timer;
+    std::shared_ptr<PQFlashIndex<T>> disk;
+    std::shared_ptr<Delta>           delta;
+    {
+      std::shared_lock<std::shared_mutex> guard(state_mtx);
+      disk = state.disk;
+      delta = state.merging;
+    }
+    const _u64 npts = disk->get_num_points();
+    const _u64 n_inserts = delta == nullptr ? 0 : delta->size.load();
+    const _u64 new_npts = npts + n_inserts;
+    if (delta != nullptr && delta->first_id != npts) {
+      throw ANNException("The delta of " + index_prefix +
+                             " doesn't follow its disk index",
+                         -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+
+    // the deleted points of the merged index, newly_deleted the ones of the
+    // disk index that weren't deleted in its files
+    std::vector<uint8_t> is_deleted(DIV_ROUND_UP(new_npts, 8), 0);
+    std::vector<uint8_t> newly_deleted(DIV_ROUND_UP(npts, 8), 0);
+    std::vector<_u32>    deleted_ids;
+    std::vector<_u32>    newly_deleted_ids;
+    _u64                 n_pending;
+    {
+      std::shared_lock<std::shared_mutex> guard(delete_mtx);
+      for (_u64 i = 0; i < std::min(deleted.size(), is_deleted.size()); i++) {
+        is_deleted[i] = deleted[i];
+      }
+      n_pending = pending_deletes.size();
+      for (_u64 i = 0; i < n_pending; i++) {
+        if (pending_deletes[i] < npts) {
+          set_bit(newly_deleted, pending_deletes[i]);
+          newly_deleted_ids.push_back(pending_deletes[i]);
+        }
+      }
+    }
+    if (new_npts % 8 != 0 && !is_deleted.empty()) {
+      is_deleted.back() &= (uint8_t) ((1 << (new_npts % 8)) - 1);
+    }
+    for (_u64 id = 0; id < new_npts; id++) {
+      if (test_bit(is_deleted, id)) {
+        deleted_ids.push_back((_u32) id);
+      }
+    }
+    if (n_inserts == 0 && newly_deleted_ids.empty()) {
+      if (delta != nullptr) {
+        std::unique_lock<std::shared_mutex> guard(state_mtx);
+        state.merging = nullptr;
+      }
+      return;
+    }
+    auto check_stop = [this]() {
+      if (stop_merge) {
+        throw ANNException("The merge into " + index_prefix + " was stopped",
+                           -1, __FUNCSIG__, __FILE__, __LINE__);
+      }
+    };
+
+    const std::string disk_index_file = get_disk_index_filename(index_prefix);
+    if (file_exists(disk_index_file + "_pq_pivots.bin")) {
+      throw ANNException("Can't merge into " + disk_index_file +
+                             ", whose full precision vectors are compressed",
+                         -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    std::ifstream reader(disk_index_file, std::ios::binary);
+    std::unique_ptr<char[]> meta_buf = std::make_unique<char[]>(SECTOR_LEN);
+    reader.read(meta_buf.get(), SECTOR_LEN);
+    _u64 *meta = (_u64 *) meta_buf.get();
+    if (!reader || meta[1] != npts) {
+      throw ANNException("Failed to read the metadata of " + disk_index_file,
+                         -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    if (meta[7] != 0) {
+      throw ANNException("Can't merge into " + disk_index_file +
+                             ", which has reorder data",
+                         -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    const _u64 max_node_len = meta[3];
+    const _u64 disk_bytes_per_point = graph_dim * sizeof(T);
+    // the nodes are read and written by blocks: a sector of nodes, or the
+    // sectors of a node
+    const bool long_node = max_node_len > SECTOR_LEN;
+    const _u64 nodes_per_block = long_node ? 1 : meta[4];
+    const _u64 block_len =
+        long_node ? ROUND_UP(max_node_len, SECTOR_LEN) : SECTOR_LEN;
+    const _u64 n_old_blocks = DIV_ROUND_UP(npts, nodes_per_block);
+    const _u64 n_blocks = DIV_ROUND_UP(new_npts, nodes_per_block);
+
+    const std::string layout_file =
+        get_disk_index_layout_filename(disk_index_file);
+    std::vector<_u32> loc_to_id, id_to_loc;
+    if (file_exists(layout_file)) {
+      std::unique_ptr<_u32[]> locs;
+      size_t                  n_locs, n_cols;
+      load_bin<_u32>(layout_file, locs, n_locs, n_cols);
+      if (n_locs != npts || n_cols != 1) {
+        throw ANNException("The layout of " + disk_index_file +
+                               " doesn't match its points",
+                           -1, __FUNCSIG__, __FILE__, __LINE__);
+      }
+      loc_to_id.assign(locs.get(), locs.get() + npts);
+      id_to_loc.assign(npts, std::numeric_limits<_u32>::max());
+      for (_u64 loc = 0; loc < npts; loc++) {
+        const _u32 id = loc_to_id[loc];
+        if (id >= npts || id_to_loc[id] != std::numeric_limits<_u32>::max()) {
+          throw ANNException("The layout of " + disk_index_file +
+                                 " is not a permutation of its points",
+                             -1, __FUNCSIG__, __FILE__, __LINE__);
+        }
+        id_to_loc[id] = (_u32) loc;
+      }
+    }
+
+    // the PQ codes approximate the points of the disk index in the pruning
+    const std::string pq_pivots_file = get_pq_pivots_filename(index_prefix);
+    const std::string pq_compressed_file =
+        get_pq_compressed_filename(index_prefix);
+    std::unique_ptr<_u8[]> pq_codes;
+    size_t                 n_codes, n_chunks;
+    load_bin<_u8>(pq_compressed_file, pq_codes, n_codes, n_chunks);
+    FixedChunkPQTable pq_table;
+    pq_table.load_pq_centroid_bin(pq_pivots_file.c_str(), n_chunks);
+
+    std::vector<float> new_coords(n_inserts * graph_dim);
+    for (_u64 j = 0; j < n_inserts; j++) {
+      to_graph_space(delta->points.get() + j * dim,
+                     new_coords.data() + j * graph_dim);
+    }
+    auto coords_of = [&](_u32 id, float *out) {
+      if (id < npts) {
+        pq_table.inflate_vector(pq_codes.get() + (_u64) id * n_chunks, out);
+      } else {
+        memcpy(out, new_coords.data() + (id - npts) * graph_dim,
+               graph_dim * sizeof(float));
+      }
+    };
+
+    // the neighbors of the inserted points, among the points of the disk
+    // index and of the delta
+    std::vector<std::vector<_u32>> new_nbrs(n_inserts);
+    knowhere::BitsetView           deleted_view =
+        deleted_ids.empty()
+                      ? knowhere::BitsetView()
+                      : knowhere::BitsetView(is_deleted.data(), new_npts,
+                                             deleted_ids.size());
+    parallel_for(n_inserts, [&](_u64 j) {
+      const _u64 id = npts + j;
+      if (test_bit(is_deleted, id)) {
+        return;
+      }
+      std::vector<_u32> candidates;
+      std::vector<_s64> disk_ids(kInsertSearchL, -1);
+      std::vector<float> dists(kInsertSearchL);
+      disk->cached_beam_search(delta->points.get() + j * dim, kInsertSearchL,
+                               kInsertSearchL, disk_ids.data(), dists.data(),
+                               kMergeBeamWidth, false, nullptr, nullptr,
+                               deleted_view);
+      for (auto disk_id : disk_ids) {
+        if (disk_id >= 0) {
+          candidates.push_back((_u32) disk_id);
+        }
+      }
+      std::vector<_u32>    delta_ids(kInsertSearchL);
+      std::vector<float *> no_vectors;
+      const _u64           n_found = delta->graph->search_with_tags(
+          new_coords.data() + j * graph_dim, kInsertSearchL, kInsertSearchL,
+          delta_ids.data(), dists.data(), no_vectors);
+      for (_u64 i = 0; i < n_found; i++) {
+        if (delta_ids[i] != id && delta_ids[i] < new_npts &&
+            !test_bit(is_deleted, delta_ids[i])) {
+          candidates.push_back(delta_ids[i]);
+        }
+      }
+      prune(new_coords.data() + j * graph_dim, candidates, coords_of,
+            graph_dim, max_degree, new_nbrs[j]);
+    });
+    check_stop();
+
+    // the inserted points are added as neighbors of their neighbors
+    std::unordered_map<_u32, std::vector<_u32>> disk_rev_nbrs;
+    std::vector<std::vector<_u32>>              new_rev_nbrs(n_inserts);
+    for (_u64 j = 0; j < n_inserts; j++) {
+      for (auto nbr : new_nbrs[j]) {
+        if (nbr < npts) {
+          disk_rev_nbrs[nbr].push_back((_u32) (npts + j));
+        } else {
+          new_rev_nbrs[nbr - npts].push_back((_u32) (npts + j));
+        }
+      }
+    }
+    parallel_for(n_inserts, [&](_u64 j) {
+      if (new_rev_nbrs[j].empty()) {
+        return;
+      }
+      std::vector<_u32> candidates = new_nbrs[j];
+      candidates.insert(candidates.end(), new_rev_nbrs[j].begin(),
+                        new_rev_nbrs[j].end());
+      std::sort(candidates.begin(), candidates.end());
+      candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                       candidates.end());
+      if (candidates.size() <= max_degree) {
+        new_nbrs[j] = std::move(candidates);
+      } else {
+        prune(new_coords.data() + j * graph_dim, candidates, coords_of,
+              graph_dim, max_degree, new_nbrs[j]);
+      }
+    });
+
+    // the neighbors of the newly deleted points replace them in the lists
+    // they're in
+    auto node_offset = [&](_u64 loc) {
+      return SECTOR_LEN + loc / nodes_per_block * block_len +
+             loc % nodes_per_block * max_node_len;
+    };
+    std::unordered_map<_u32, std::vector<_u32>> deleted_nbrs;
+    {
+      std::unique_ptr<char[]> node_buf = std::make_unique<char[]>(max_node_len);
+      for (auto id : newly_deleted_ids) {
+        reader.seekg(node_offset(id_to_loc.empty() ? id : id_to_loc[id]));
+        reader.read(node_buf.get(), max_node_len);
+        if (!reader) {
+          throw ANNException("Failed to read the node " + std::to_string(id) +
+                                 " of " + disk_index_file,
+                             -1, __FUNCSIG__, __FILE__, __LINE__);
+        }
+        const _u32 *nhood = (_u32 *) (node_buf.get() + disk_bytes_per_point);
+        deleted_nbrs[id].assign(nhood + 1, nhood + 1 + nhood[0]);
+      }
+    }
+    check_stop();
+
+    auto patch_node = [&](_u32 id, char *node) {
+      _u32             *nhood = (_u32 *) (node + disk_bytes_per_point);
+      const _u32        n_nbrs = nhood[0];
+      _u32             *nbrs = nhood + 1;
+      bool              changed = false;
+      std::vector<_u32> candidates;
+      for (_u32 i = 0; i < n_nbrs; i++) {
+        if (!test_bit(newly_deleted, nbrs[i])) {
+          candidates.push_back(nbrs[i]);
+          continue;
+        }
+        changed = true;
+        auto it = deleted_nbrs.find(nbrs[i]);
+        if (it == deleted_nbrs.end()) {
+          continue;
+        }
+        for (auto nbr : it->second) {
+          if (nbr != id && !test_bit(is_deleted, nbr)) {
+            candidates.push_back(nbr);
+          }
+        }
+      }
+      auto rev = disk_rev_nbrs.find(id);
+      if (rev != disk_rev_nbrs.end()) {
+        changed = true;
+        candidates.insert(candidates.end(), rev->second.begin(),
+                          rev->second.end());
+      }
+      if (!changed) {
+        return;
+      }
+      std::sort(candidates.begin(), candidates.end());
+      candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                       candidates.end());
+      if (candidates.size() > max_degree) {
+        std::vector<float> coords(graph_dim);
+        const T           *point = (const T *) node;
+        float              norm = 0;
+        for (_u64 i = 0; i < graph_dim; i++) {
+          coords[i] = (float) point[i];
+          norm += coords[i] * coords[i];
+        }
+        if (metric == Metric::COSINE && norm > 0) {
+          for (auto &x : coords) {
+            x /= std::sqrt(norm);
+          }
+        }
+        std::vector<_u32> pruned;
+        prune(coords.data(), candidates, coords_of, graph_dim, max_degree,
+              pruned, (_u64) kPatchCandidatesPerDegree * max_degree);
+        candidates = std::move(pruned);
+      }
+      nhood[0] = (_u32) candidates.size();
+      memcpy(nbrs, candidates.data(), candidates.size() * sizeof(_u32));
+      if (candidates.size() < n_nbrs) {
+        memset(nbrs + candidates.size(), 0,
+               (n_nbrs - candidates.size()) * sizeof(_u32));
+      }
+    };
+    auto write_new_node = [&](_u32 id, char *node) {
+      const _u64 j = id - npts;
+      T         *coords = (T *) node;
+      if (metric == Metric::INNER_PRODUCT) {
+        for (_u64 i = 0; i < graph_dim; i++) {
+          coords[i] = (T) new_coords[j * graph_dim + i];
+        }
+      } else {
+        memcpy(coords, delta->points.get() + j * dim, dim * sizeof(T));
+      }
+      _u32 *nhood = (_u32 *) (node + disk_bytes_per_point);
+      if (test_bit(is_deleted, id)) {
+        nhood[0] = 0;
+        return;
+      }
+      nhood[0] = (_u32) new_nbrs[j].size();
+      memcpy(nhood + 1, new_nbrs[j].data(), new_nbrs[j].size() * sizeof(_u32));
+    };
+
+    std::vector<std::string> merge_files;
+    auto                     remove_merge_files = [&]() {
+      for (const auto &file : merge_files) {
+        std::remove(file.c_str());
+      }
+    };
+    try {
+      // the disk index, a batch of blocks at a time
+      merge_files.push_back(disk_index_file + kMergeSuffix);
+      {
+        std::ofstream writer(merge_files.back(), std::ios::binary);
+        writer.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        meta[0] = SECTOR_LEN + n_blocks * block_len;
+        meta[1] = new_npts;
+        writer.write(meta_buf.get(), SECTOR_LEN);
+
+        const _u64 blocks_per_batch =
+            std::max<_u64>(1, kMergeBatchSize / block_len);
+        std::unique_ptr<char[]> batch =
+            std::make_unique<char[]>(blocks_per_batch * block_len);
+        for (_u64 b = 0; b < n_blocks; b += blocks_per_batch) {
+          check_stop();
+          const _u64 n_batch_blocks = std::min(blocks_per_batch, n_blocks - b);
+          memset(batch.get(), 0, n_batch_blocks * block_len);
+          if (b < n_old_blocks) {
+            reader.seekg(SECTOR_LEN + b * block_len);
+            reader.read(batch.get(),
+                        std::min(n_batch_blocks, n_old_blocks - b) * block_len);
+            if (!reader) {
+              throw ANNException("Failed to read " + disk_index_file, -1,
+                                 __FUNCSIG__, __FILE__, __LINE__);
+            }
+          }
+          const _u64 first_loc = b * nodes_per_block;
+          const _u64 n_locs = std::min(n_batch_blocks * nodes_per_block,
+                                       new_npts - first_loc);
+          parallel_for(n_locs, [&](_u64 i) {
+            const _u64 loc = first_loc + i;
+            char      *node = batch.get() + (i / nodes_per_block) * block_len +
+                         (i % nodes_per_block) * max_node_len;
+            if (loc < npts) {
+              patch_node(loc_to_id.empty() ? (_u32) loc : loc_to_id[loc],
+                         node);
+            } else {
+              write_new_node((_u32) loc, node);
+            }
+          });
+          writer.write(batch.get(), n_batch_blocks * block_len);
+        }
+      }
+
+      // the PQ codes of the inserted points, encoded with the pivots of the
+      // disk index
+      merge_files.push_back(pq_compressed_file + kMergeSuffix);
+      {
+        std::unique_ptr<_u8[]> new_codes;
+        if (n_inserts > 0) {
+          const std::string data_file = index_prefix + "_merge_data.bin";
+          const std::string codes_file = index_prefix + "_merge_codes.bin";
+          merge_files.push_back(data_file);
+          merge_files.push_back(codes_file);
+          save_bin<float>(data_file, new_coords.data(), n_inserts, graph_dim);
+          generate_pq_data_from_pivots<float>(
+              data_file, NUM_PQ_CENTROIDS, (unsigned) n_chunks,
+              pq_pivots_file, codes_file);
+          size_t n_new_codes, n_new_chunks;
+          load_bin<_u8>(codes_file, new_codes, n_new_codes, n_new_chunks);
+        }
+        std::ofstream writer(merge_files[1], std::ios::binary);
+        writer.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        const _s32 header[2] = {(_s32) new_npts, (_s32) n_chunks};
+        writer.write((const char *) header, sizeof(header));
+        writer.write((const char *) pq_codes.get(), npts * n_chunks);
+        if (n_inserts > 0) {
+          writer.write((const char *) new_codes.get(), n_inserts * n_chunks);
+        }
+      }
+
+      const std::string norm_file =
+          get_disk_index_max_base_norm_file(disk_index_file);
+      if (metric == Metric::COSINE && n_inserts > 0) {
+        std::unique_ptr<float[]> norms;
+        size_t                   n_norms, n_cols;
+        load_bin<float>(norm_file, norms, n_norms, n_cols);
+        std::vector<float> new_norms(norms.get(), norms.get() + n_norms);
+        for (_u64 j = 0; j < n_inserts; j++) {
+          float norm = 0;
+          for (_u64 i = 0; i < dim; i++) {
+            const float x = (float) delta->points[j * dim + i];
+            norm += x * x;
+          }
+          new_norms.push_back(std::sqrt(norm));
+        }
+        merge_files.push_back(norm_file + kMergeSuffix);
+        save_bin<float>(merge_files.back(), new_norms.data(), new_norms.size(),
+                        1);
+      }
+      if (!loc_to_id.empty() && n_inserts > 0) {
+        for (_u64 id = npts; id < new_npts; id++) {
+          loc_to_id.push_back((_u32) id);
+        }
+        merge_files.push_back(layout_file + kMergeSuffix);
+        save_bin<_u32>(merge_files.back(), loc_to_id.data(), new_npts, 1);
+      }
+      const std::string deleted_file =
+          get_disk_index_deleted_filename(disk_index_file);
+      merge_files.push_back(deleted_file + kMergeSuffix);
+      save_bin<_u32>(merge_files.back(), deleted_ids.data(),
+                     deleted_ids.size(), 1);
+
+      // the files to replace, the disk index last, the searches of a half
+      // replaced index failing on its size
+      const std::string manifest =
+          get_disk_index_merge_manifest_filename(disk_index_file);
+      std::vector<std::string> replaced;
+      for (auto it = merge_files.rbegin(); it != merge_files.rend(); it++) {
+        if (it->size() > kMergeSuffix.size() &&
+            it->compare(it->size() - kMergeSuffix.size(), kMergeSuffix.size(),
+                        kMergeSuffix) == 0) {
+          replaced.push_back(it->substr(0, it->size() - kMergeSuffix.size()));
+        }
+      }
+      merge_files.push_back(manifest + kMergeSuffix);
+      {
+        std::ofstream writer(merge_files.back());
+        writer.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+        for (const auto &file : replaced) {
+          writer << file << '\n';
+        }
+      }
+      check_stop();
+      // the merge is done once its manifest is, the files are replaced by the
+      // next load if replacing them fails from now on
+      if (std::rename(merge_files.back().c_str(), manifest.c_str()) != 0) {
+        throw ANNException("Failed to rename " + merge_files.back() + " to " +
+                               manifest,
+                           -1, __FUNCSIG__, __FILE__, __LINE__);
+      }
+    } catch (...) {
+      remove_merge_files();
+      throw;
+    }
+    std::remove((index_prefix + "_merge_data.bin").c_str());
+    std::remove((index_prefix + "_merge_codes.bin").c_str());
+    reader.close();
+
+    std::shared_ptr<PQFlashIndex<T>> new_disk;
+    try {
+      recover_merge(index_prefix);
+      new_disk = loader();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(merge_mtx);
+      merge_broken = true;
+      throw;
+    }
+
+    {
+      std::unique_lock<std::shared_mutex> guard(state_mtx);
+      state.disk = std::move(new_disk);
+      state.merging = nullptr;
+    }
+    {
+      // the deletes of points inserted since the merge started stay pending
+      std::unique_lock<std::shared_mutex> guard(delete_mtx);
+      std::vector<_u32>                   pending;
+      for (_u64 i = 0; i < pending_deletes.size(); i++) {
+        if (i >= n_pending || pending_deletes[i] >= new_npts) {
+          pending.push_back(pending_deletes[i]);
+        }
+      }
+      pending_deletes = std::move(pending);
+    }
+    LOG_KNOWHERE_INFO_ << "Merged " << n_inserts << " inserts and "
+                       << newly_deleted_ids.size() << " deletes into "
+                       << disk_index_file << " in " << timer.elapsed() / 1e6
+                       << "s";
+  }
+
+  bool recover_merge(const std::string &index_prefix) {
+    const std::string disk_index_file = get_disk_index_filename(index_prefix);
+    const std::string manifest =
+        get_disk_index_merge_manifest_filename(disk_index_file);
+    if (file_exists(manifest)) {
+      // the files already replaced have no merge file left
+      std::ifstream reader(manifest);
+      std::string   file;
+      while (std::getline(reader, file)) {
+        const std::string merge_file = file + kMergeSuffix;
+        if (file_exists(merge_file) &&
+            std::rename(merge_file.c_str(), file.c_str()) != 0) {
+          throw ANNException("Failed to rename " + merge_file + " to " + file,
+                             -1, __FUNCSIG__, __FILE__, __LINE__);
+        }
+      }
+      reader.close();
+      std::remove(manifest.c_str());
+      return true;
+    }
+    // a merge without manifest left the files as they were
+    for (const auto &file :
+         {disk_index_file, get_pq_compressed_filename(index_prefix),
+          get_disk_index_max_base_norm_file(disk_index_file),
+          get_disk_index_layout_filename(disk_index_file),
+          get_disk_index_deleted_filename(disk_index_file), manifest}) {
+      std::remove((file + kMergeSuffix).c_str());
+    }
+    std::remove((index_prefix + "_merge_data.bin").c_str());
+    std::remove((index_prefix + "_merge_codes.bin").c_str());
+    return false;
+  }
+
+  // knowhere
+  template class FreshIndex<float>;
+  template class FreshIndex<knowhere::fp16>;
+  template class FreshIndex<knowhere::bf16>;
+}  // namespace diskann
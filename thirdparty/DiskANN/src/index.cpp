@@ -1780,6 +1780,49 @@ namespace diskann {
     _has_built = true;
   }
 
+  template<typename T, typename TagT>
+  void Index<T, TagT>::build(const T *data, const size_t num_points,
+                             Parameters &parameters) {
+    if (num_points > _max_points) {
+      std::stringstream stream;
+      stream << "ERROR: Driver requests building " << num_points
+             << " points, but index can support only " << _max_points
+             << " points as specified in constructor." << std::endl;
+      LOG(ERROR) << stream.str();
+      throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__,
+                                  __LINE__);
+    }
+    if (_enable_tags) {
+      throw diskann::ANNException(
+          "ERROR: Building from memory does not support tags.", -1,
+          __FUNCSIG__, __FILE__, __LINE__);
+    }
+
+    for (size_t i = 0; i < num_points; i++) {
+      memcpy(_data + i * _aligned_dim, data + i * _dim, _dim * sizeof(T));
+      if (_normalize_vecs) {
+        normalize(_data + i * _aligned_dim, _aligned_dim);
+      }
+    }
+    LOG_KNOWHERE_INFO_ << "Building start from memory with " << num_points
+                       << " points.";
+    _nd = num_points;
+
+    generate_frozen_point();
+    link(parameters);
+
+    if (_support_eager_delete) {
+      update_in_graph();
+    }
+
+    size_t max = 0;
+    for (size_t i = 0; i < _nd; i++) {
+      max = (std::max)(max, _final_graph[i].size());
+    }
+    _width = (std::max)((unsigned) max, _width);
+    _has_built = true;
+  }
+
   template<typename T, typename TagT>
   void Index<T, TagT>::build(const char  *filename,
                              const size_t num_points_to_load,
@@ -163,17 +163,17 @@ void LinuxAlignedFileReader::close() {
 }
 
 void LinuxAlignedFileReader::read(std::vector<AlignedRead> &read_reqs,
-                                  io_context_t &ctx, bool async) {
+                                  IOContext &ctx, bool async) {
   if (async == true) {
     diskann::cout << "Async currently not supported in linux." << std::endl;
   }
   assert(this->file_desc != -1);
 
-  execute_io(ctx, this->ctx_pool_->max_events_per_ctx(), this->file_desc,
-             read_reqs);
+  execute_io(static_cast<io_context_t>(ctx),
+             this->ctx_pool_->max_events_per_ctx(), this->file_desc, read_reqs);
 }
 
-void LinuxAlignedFileReader::submit_req(io_context_t             &ctx,
+void LinuxAlignedFileReader::submit_req(IOContext                &ctx,
                                         std::vector<AlignedRead> &read_reqs) {
   const auto maxnr = this->ctx_pool_->max_events_per_ctx();
   if (read_reqs.size() > maxnr) {
@@ -191,6 +191,8 @@ void LinuxAlignedFileReader::submit_req(io_context_t             &ctx,
   for (size_t j = 0; j < n_ops; j++) {
     io_prep_pread(cb.data() + j, fd, read_reqs[j].buf, read_reqs[j].len,
                   read_reqs[j].offset);
+    // returned in the io_event by get_completed_req()
+    cb[j].data = read_reqs[j].buf;
   }
   for (uint64_t i = 0; i < n_ops; i++) {
     cbs[i] = cb.data() + i;
@@ -199,7 +201,8 @@ void LinuxAlignedFileReader::submit_req(io_context_t             &ctx,
   int64_t ret;
   uint64_t num_submitted = 0, submit_retry = 0;
   while (num_submitted < n_ops) {
-    while ((ret = io_submit(ctx, n_ops - num_submitted,
+    while ((ret = io_submit(static_cast<io_context_t>(ctx),
+                            n_ops - num_submitted,
                             cbs.data() + num_submitted)) < 0) {
       if (-ret != EINTR) {
         std::stringstream err;
@@ -225,7 +228,7 @@ void LinuxAlignedFileReader::submit_req(io_context_t             &ctx,
   }
 }
 
-void LinuxAlignedFileReader::get_submitted_req(io_context_t &ctx, size_t n_ops) {
+void LinuxAlignedFileReader::get_submitted_req(IOContext &ctx, size_t n_ops) {
   if (n_ops > this->ctx_pool_->max_events_per_ctx()) {
     std::stringstream err;
     err << "Async does not support getting number of read requests (" << n_ops
@@ -238,7 +241,8 @@ void LinuxAlignedFileReader::get_submitted_req(io_context_t &ctx, size_t n_ops)
   uint64_t                 num_read = 0, read_retry = 0;
   std::vector<io_event_t> evts(n_ops);
   while (num_read < n_ops) {
-    while ((ret = io_getevents(ctx, n_ops - num_read, n_ops - num_read,
+    while ((ret = io_getevents(static_cast<io_context_t>(ctx),
+                               n_ops - num_read, n_ops - num_read,
                                evts.data() + num_read, nullptr)) < 0) {
       if (-ret != EINTR) {
         std::stringstream err;
@@ -262,4 +266,56 @@ void LinuxAlignedFileReader::get_submitted_req(io_context_t &ctx, size_t n_ops)
       }
     }
   }
-}
\ No newline at end of file
+}
+
+void LinuxAlignedFileReader::get_completed_req(IOContext &ctx, size_t min_n,
+                                               size_t               max_n,
+                                               std::vector<void *> &completed) {
+  if (max_n > this->ctx_pool_->max_events_per_ctx()) {
+    std::stringstream err;
+    err << "Async does not support getting number of read requests (" << max_n
+        << ") exceeds max number of events per context ("
+        << this->ctx_pool_->max_events_per_ctx() << ")";
+    throw diskann::ANNException(err.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
+  }
+
+  int64_t                 ret;
+  uint64_t                num_read = 0, read_retry = 0;
+  std::vector<io_event_t> evts(max_n);
+  while (num_read < min_n) {
+    while ((ret = io_getevents(static_cast<io_context_t>(ctx),
+                               min_n - num_read, max_n - num_read,
+                               evts.data() + num_read, nullptr)) < 0) {
+      if (-ret != EINTR) {
+        std::stringstream err;
+        err << "Unknown error occur in io_getevents, errno: " << -ret << ", "
+            << strerror(-ret);
+        throw diskann::ANNException(err.str(), -1, __FUNCSIG__, __FILE__,
+                                    __LINE__);
+      }
+    }
+    num_read += ret;
+    if (num_read < min_n) {
+      read_retry++;
+      if (read_retry <= n_retries) {
+        LOG(WARNING) << "io_getevents() failed; read: " << num_read
+                     << ", expected: " << min_n << ", retry: " << read_retry;
+      } else {
+        std::stringstream err;
+        err << "io_getevents failed after retried " << n_retries << " times";
+        throw diskann::ANNException(err.str(), -1, __FUNCSIG__, __FILE__,
+                                    __LINE__);
+      }
+    }
+  }
+  for (uint64_t i = 0; i < num_read; i++) {
+    auto res = static_cast<int64_t>(evts[i].res);
+    if (res < 0) {
+      std::stringstream err;
+      err << "aio read failed, errno: " << -res << ", " << strerror(-res);
+      throw diskann::ANNException(err.str(), -1, __FUNCSIG__, __FILE__,
+                                  __LINE__);
+    }
+    completed.push_back(evts[i].data);
+  }
+}
@@ -0,0 +1,135 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "diskann/nav_graph.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "diskann/ann_exception.h"
+#include "diskann/neighbor.h"
+#include "tsl/robin_set.h"
+
+namespace diskann {
+  _u64 NavGraph::point_size(_u64 dim, _u64 degree) {
+    return sizeof(_u32) + ROUND_UP(dim, 8) * sizeof(float) +
+           (degree + 1) * sizeof(_u32);
+  }
+
+  void NavGraph::save(const std::string &file, const std::vector<_u32> &ids,
+                      const float *data, _u64 dim,
+                      const std::vector<std::vector<unsigned>> &graph,
+                      _u32 entry_point) {
+    const _u64 npts = ids.size();
+    _u64       degree = 0;
+    for (_u64 i = 0; i < npts; i++) {
+      degree = std::max(degree, (_u64) graph[i].size());
+    }
+
+    std::ofstream writer(file, std::ios::binary | std::ios::trunc);
+    const _u64    meta[4] = {npts, dim, degree, entry_point};
+    writer.write((char *) meta, sizeof(meta));
+    writer.write((char *) ids.data(), npts * sizeof(_u32));
+    writer.write((char *) data, npts * dim * sizeof(float));
+    std::vector<_u32> nhood(degree + 1, 0);
+    for (_u64 i = 0; i < npts; i++) {
+      nhood[0] = graph[i].size();
+      std::copy(graph[i].begin(), graph[i].end(), nhood.begin() + 1);
+      writer.write((char *) nhood.data(), nhood.size() * sizeof(_u32));
+    }
+    if (!writer) {
+      throw ANNException("Failed to write navigation graph " + file, -1,
+                         __FUNCSIG__, __FILE__, __LINE__);
+    }
+  }
+
+  void NavGraph::load(const std::string &file, _u64 aligned_dim) {
+    std::ifstream reader(file, std::ios::binary);
+    _u64          meta[4] = {0, 0, 0, 0};
+    reader.read((char *) meta, sizeof(meta));
+    const _u64 npts = meta[0], dim = meta[1];
+    if (!reader || dim > aligned_dim || meta[3] >= npts) {
+      std::stringstream stream;
+      stream << "Invalid navigation graph " << file << ": " << npts
+             << " points of dim " << dim << " for an index of dim "
+             << aligned_dim;
+      throw ANNException(stream.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
+    }
+    this->aligned_dim = aligned_dim;
+    degree = meta[2];
+    entry_point = meta[3];
+
+    ids.resize(npts);
+    reader.read((char *) ids.data(), npts * sizeof(_u32));
+    data.assign(npts * aligned_dim, 0.0f);
+    for (_u64 i = 0; i < npts; i++) {
+      reader.read((char *) (data.data() + i * aligned_dim),
+                  dim * sizeof(float));
+    }
+    nhoods.resize(npts * (degree + 1));
+    reader.read((char *) nhoods.data(), nhoods.size() * sizeof(_u32));
+    if (!reader) {
+      ids.clear();
+      throw ANNException("Truncated navigation graph " + file, -1,
+                         __FUNCSIG__, __FILE__, __LINE__);
+    }
+    distance = get_distance_function<float>(Metric::L2);
+  }
+
+  _u64 NavGraph::memory_size() const {
+    return ids.size() * sizeof(_u32) + data.size() * sizeof(float) +
+           nhoods.size() * sizeof(_u32);
+  }
+
+  void NavGraph::search(const float *query, _u64 l_search, _u64 k,
+                        std::vector<_u32> &result) const {
+    if (empty()) {
+      return;
+    }
+    std::vector<Neighbor>  retset(l_search + 1);
+    tsl::robin_set<_u32>   visited(4 * l_search);
+    retset[0] = Neighbor(entry_point,
+                         distance(query, vector_of(entry_point), aligned_dim),
+                         true);
+    visited.insert(entry_point);
+    unsigned cur_list_size = 1;
+
+    unsigned k_pos = 0;
+    while (k_pos < cur_list_size) {
+      unsigned nk = cur_list_size;
+      if (retset[k_pos].flag) {
+        retset[k_pos].flag = false;
+        const _u32 *nhood = nhood_of(retset[k_pos].id);
+        for (_u32 m = 0; m < nhood[0]; m++) {
+          const _u32 id = nhood[m + 1];
+          if (!visited.insert(id).second) {
+            continue;
+          }
+          const float dist = distance(query, vector_of(id), aligned_dim);
+          if (cur_list_size == l_search &&
+              dist >= retset[cur_list_size - 1].distance) {
+            continue;
+          }
+          Neighbor nn(id, dist, true);
+          auto     r = InsertIntoPool(retset.data(), cur_list_size, nn);
+          if (cur_list_size < l_search) {
+            ++cur_list_size;
+          }
+          if (r < nk) {
+            nk = r;
+          }
+        }
+      }
+      if (nk <= k_pos) {
+        k_pos = nk;
+      } else {
+        ++k_pos;
+      }
+    }
+
+    for (unsigned i = 0; i < std::min((_u64) cur_list_size, k); i++) {
+      result.push_back(ids[retset[i].id]);
+    }
+  }
+}  // namespace diskann
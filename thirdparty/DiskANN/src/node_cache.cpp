@@ -0,0 +1,268 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "diskann/node_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+namespace diskann {
+  template<typename T>
+  NodeCache<T>::Table::Table(_u64 n_nodes) : n_nodes(n_nodes) {
+    // at most half full, so probes stay short
+    bits = 4;
+    while ((1ULL << bits) < 2 * n_nodes) {
+      bits++;
+    }
+    entries = std::make_unique<Entry[]>(1ULL << bits);
+  }
+
+  template<typename T>
+  _u32 NodeCache<T>::Table::find(_u32 id) const {
+    const _u64 mask = (1ULL << bits) - 1;
+    _u64       pos = (id * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
+    while (true) {
+      const Entry &entry = entries[pos];
+      if (entry.id == id) {
+        return entry.slot;
+      }
+      if (entry.id == kNoNode) {
+        return kNoNode;
+      }
+      pos = (pos + 1) & mask;
+    }
+  }
+
+  template<typename T>
+  void NodeCache<T>::Table::insert(_u32 id, _u32 slot) {
+    const _u64 mask = (1ULL << bits) - 1;
+    _u64       pos = (id * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
+    while (entries[pos].id != kNoNode) {
+      pos = (pos + 1) & mask;
+    }
+    entries[pos].id = id;
+    entries[pos].slot = slot;
+  }
+
+  template<typename T>
+  NodeCache<T>::ReadGuard::ReadGuard(const NodeCache &cache) : cache(cache) {
+    // register in the current epoch, retrying if the writer moved on in the
+    // meantime, so a table swapped out is either seen by wait_for_readers()
+    // or not loaded here.
+    while (true) {
+      epoch = cache.epoch.load();
+      cache.readers[epoch].n.fetch_add(1);
+      if (cache.epoch.load() == epoch) {
+        break;
+      }
+      cache.readers[epoch].n.fetch_sub(1);
+    }
+    table = cache.table.load();
+  }
+
+  template<typename T>
+  NodeCache<T>::ReadGuard::~ReadGuard() {
+    cache.readers[epoch].n.fetch_sub(1);
+  }
+
+  template<typename T>
+  bool NodeCache<T>::ReadGuard::find(_u32 id, Node &node) const {
+    if (table == nullptr) {
+      return false;
+    }
+    const _u32 slot = table->find(id);
+    if (slot == kNoNode) {
+      return false;
+    }
+    node = cache.node_of_slot(slot);
+    return true;
+  }
+
+  template<typename T>
+  NodeCache<T>::~NodeCache() {
+    delete table.load();
+    if (coords_buf != nullptr) {
+      aligned_free(coords_buf);
+    }
+  }
+
+  template<typename T>
+  void NodeCache<T>::init(_u64 capacity, _u64 max_degree, _u64 aligned_dim) {
+    if (initialized()) {
+      return;
+    }
+    this->max_degree = max_degree;
+    this->aligned_dim = aligned_dim;
+    nhood_buf = std::make_unique<_u32[]>(capacity * (max_degree + 1));
+    memset(nhood_buf.get(), 0, capacity * (max_degree + 1) * sizeof(_u32));
+    alloc_aligned((void **) &coords_buf, capacity * aligned_dim * sizeof(T),
+                  8 * sizeof(T));
+    std::fill_n(coords_buf, capacity * aligned_dim, T());
+    slot_ids.assign(capacity, kNoNode);
+    free_slots.resize(capacity);
+    // slot 0 is taken first
+    for (_u64 i = 0; i < capacity; i++) {
+      free_slots[i] = (_u32) (capacity - 1 - i);
+    }
+  }
+
+  template<typename T>
+  _u64 NodeCache<T>::size() const {
+    auto t = table.load();
+    return t == nullptr ? 0 : t->n_nodes;
+  }
+
+  template<typename T>
+  _u64 NodeCache<T>::memory_size() const {
+    _u64 size = capacity() * (max_degree + 1) * sizeof(_u32);
+    size += ROUND_UP(capacity() * aligned_dim * sizeof(T), 8 * sizeof(T));
+    size += capacity() * sizeof(_u32) * 2;
+    if (auto t = table.load(); t != nullptr) {
+      size += (1ULL << t->bits) * sizeof(typename Table::Entry);
+    }
+    if (access_counts != nullptr) {
+      size += num_points * sizeof(_u8);
+    }
+    return size;
+  }
+
+  template<typename T>
+  bool NodeCache<T>::add(_u32 id, const T *coords, _u64 coords_bytes,
+                         _u32 nnbrs, const _u32 *nbrs) {
+    if (free_slots.empty()) {
+      return false;
+    }
+    const _u32 slot = free_slots.back();
+    free_slots.pop_back();
+    slot_ids[slot] = id;
+    memcpy(coords_buf + slot * aligned_dim, coords, coords_bytes);
+    _u32 *nhood = nhood_buf.get() + slot * (max_degree + 1);
+    nhood[0] = nnbrs;
+    memcpy(nhood + 1, nbrs, nnbrs * sizeof(_u32));
+    return true;
+  }
+
+  template<typename T>
+  void NodeCache<T>::publish() {
+    auto n_nodes = std::count_if(slot_ids.begin(), slot_ids.end(),
+                                 [](_u32 id) { return id != kNoNode; });
+    auto new_table = std::make_unique<Table>(n_nodes);
+    for (_u32 slot = 0; slot < slot_ids.size(); slot++) {
+      if (slot_ids[slot] != kNoNode) {
+        new_table->insert(slot_ids[slot], slot);
+      }
+    }
+    swap_table(std::move(new_table));
+  }
+
+  template<typename T>
+  void NodeCache<T>::remove(const std::vector<_u32> &ids) {
+    std::vector<_u32> slots;
+    if (auto t = table.load(); t != nullptr) {
+      for (auto id : ids) {
+        const _u32 slot = t->find(id);
+        if (slot != kNoNode) {
+          slot_ids[slot] = kNoNode;
+          slots.push_back(slot);
+        }
+      }
+    }
+    if (slots.empty()) {
+      return;
+    }
+    // the slots are overwritten only once no search may still find them.
+    publish();
+    free_slots.insert(free_slots.end(), slots.begin(), slots.end());
+  }
+
+  template<typename T>
+  bool NodeCache<T>::contains(_u32 id) const {
+    auto t = table.load();
+    return t != nullptr && t->find(id) != kNoNode;
+  }
+
+  template<typename T>
+  void NodeCache<T>::swap_table(std::unique_ptr<Table> new_table) {
+    const Table *old_table = table.exchange(new_table.release());
+    wait_for_readers();
+    delete old_table;
+  }
+
+  template<typename T>
+  void NodeCache<T>::wait_for_readers() {
+    const _u32 old_epoch = epoch.load();
+    epoch.store(old_epoch ^ 1);
+    while (readers[old_epoch].n.load() != 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  template<typename T>
+  void NodeCache<T>::enable_access_counts(_u64 num_points) {
+    if (access_counts != nullptr) {
+      return;
+    }
+    this->num_points = num_points;
+    access_counts = std::make_unique<std::atomic<_u8>[]>(num_points);
+    for (_u64 i = 0; i < num_points; i++) {
+      access_counts[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  template<typename T>
+  void NodeCache<T>::select_refresh(std::vector<_u32> &evict,
+                                    std::vector<_u32> &admit) {
+    evict.clear();
+    admit.clear();
+    if (access_counts == nullptr || capacity() == 0) {
+      return;
+    }
+
+    // cached nodes, coldest first
+    std::vector<std::pair<_u8, _u32>> cached;
+    for (auto id : slot_ids) {
+      if (id != kNoNode) {
+        cached.emplace_back(access_counts[id].load(std::memory_order_relaxed),
+                            id);
+      }
+    }
+    std::sort(cached.begin(), cached.end());
+
+    // nodes not cached, hottest first
+    std::vector<std::pair<_u8, _u32>> hot;
+    for (_u64 id = 0; id < num_points; id++) {
+      const _u8 c = access_counts[id].load(std::memory_order_relaxed);
+      if (c == 0) {
+        continue;
+      }
+      access_counts[id].store(c / 2, std::memory_order_relaxed);
+      if (c >= kMinAdmitCount && !contains((_u32) id)) {
+        hot.emplace_back(c, (_u32) id);
+      }
+    }
+    const _u64 n_hot = std::min<_u64>(hot.size(), capacity());
+    std::partial_sort(hot.begin(), hot.begin() + n_hot, hot.end(),
+                      std::greater<>());
+
+    _u64 n_free = free_slots.size();
+    _u64 n_evicted = 0;
+    for (_u64 i = 0; i < n_hot; i++) {
+      if (n_free > 0) {
+        n_free--;
+      } else if (n_evicted < cached.size() &&
+                 hot[i].first > cached[n_evicted].first + 1) {
+        evict.push_back(cached[n_evicted++].second);
+      } else {
+        break;
+      }
+      admit.push_back(hot[i].second);
+    }
+  }
+
+  // knowhere not support uint8/int8 diskann
+  template class NodeCache<float>;
+  template class NodeCache<knowhere::fp16>;
+  template class NodeCache<knowhere::bf16>;
+}  // namespace diskann
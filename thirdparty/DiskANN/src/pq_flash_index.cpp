@@ -11,6 +11,7 @@
 #include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <numeric>
 #include <optional>
 #include <random>
 #include <thread>
@@ -55,6 +56,13 @@ namespace {
   constexpr _u64  kBruteForceTopkRefineExpansionFactor = 2;
   constexpr float kFilterThreshold = 0.93f;
   constexpr float kAlpha = 0.15f;
+  // one in kCacheAccessSampleRate searches records the nodes it expands for
+  // the adaptive cache
+  constexpr _u64  kCacheAccessSampleRate = 4;
+  // list size of the navigation graph search. Searches start from the
+  // closest point only: starting from a few more of them didn't read fewer
+  // sectors, the first hops being spent on their neighbors.
+  constexpr _u64  kNavGraphSearchL = 32;
 }  // namespace
 
 namespace diskann {
@@ -75,21 +83,17 @@ namespace diskann {
       }
     }
 
-    this->dist_cmp = diskann::get_distance_function<T>(m);
+    this->dist_cmp = diskann::get_mixed_distance_function<T>(m);
     this->dist_cmp_float = diskann::get_distance_function<float>(m);
   }
 
   template<typename T>
   PQFlashIndex<T>::~PQFlashIndex() {
     destroy_cache_async_task();
+    destroy_cache_refresh_task();
 
     if (centroid_data != nullptr)
       aligned_free(centroid_data);
-    // delete backing bufs for nhood and coord cache
-    if (nhood_cache_buf != nullptr) {
-      nhood_cache_buf.reset();
-      diskann::aligned_free(coord_cache_buf);
-    }
 
     if (load_flag) {
       this->destroy_thread_data();
@@ -118,16 +122,12 @@ namespace diskann {
                              256);
       diskann::alloc_aligned((void **) &scratch.aligned_dist_scratch,
                              (_u64) MAX_GRAPH_DEGREE * sizeof(float), 256);
-      diskann::alloc_aligned((void **) &scratch.aligned_query_T,
-                             this->aligned_dim * sizeof(T), 8 * sizeof(T));
       diskann::alloc_aligned((void **) &scratch.aligned_query_float,
                              this->aligned_dim * sizeof(float),
                              8 * sizeof(float));
       scratch.visited = new tsl::robin_set<_u64>(4096);
 
       memset((void *) scratch.coord_scratch, 0, sizeof(T) * this->aligned_dim);
-      memset((void *) scratch.aligned_query_T, 0,
-             this->aligned_dim * sizeof(T));
       memset(scratch.aligned_query_float, 0, this->aligned_dim * sizeof(float));
 
       ThreadData<T> data;
@@ -148,7 +148,6 @@ namespace diskann {
     thread_data_size +=
         ROUND_UP(256 * (_u64) this->aligned_dim * sizeof(float), 256);
     thread_data_size += ROUND_UP((_u64) MAX_GRAPH_DEGREE * sizeof(float), 256);
-    thread_data_size += ROUND_UP(this->aligned_dim * sizeof(T), 8 * sizeof(T));
     thread_data_size +=
         ROUND_UP(this->aligned_dim * sizeof(float), 8 * sizeof(float));
     return thread_data_size;
@@ -171,7 +170,6 @@ namespace diskann {
       diskann::aligned_free((void *) scratch.aligned_pqtable_dist_scratch);
       diskann::aligned_free((void *) scratch.aligned_dist_scratch);
       diskann::aligned_free((void *) scratch.aligned_query_float);
-      diskann::aligned_free((void *) scratch.aligned_query_T);
 
       delete scratch.visited;
     }
@@ -185,19 +183,7 @@ namespace diskann {
 
     auto ctx = this->reader->get_ctx();
 
-    if (nhood_cache_buf == nullptr) {
-      nhood_cache_buf =
-          std::make_unique<unsigned[]>(num_cached_nodes * (max_degree + 1));
-      memset(nhood_cache_buf.get(), 0,
-             num_cached_nodes * (max_degree + 1) * sizeof(unsigned));
-    }
-
-    _u64 coord_cache_buf_len = num_cached_nodes * aligned_dim;
-    if (coord_cache_buf == nullptr) {
-      diskann::alloc_aligned((void **) &coord_cache_buf,
-                             coord_cache_buf_len * sizeof(T), 8 * sizeof(T));
-      std::fill_n(coord_cache_buf, coord_cache_buf_len, T());
-    }
+    node_cache.init(num_cached_nodes, max_degree, aligned_dim);
 
     size_t BLOCK_SIZE = 32;
     size_t num_blocks = DIV_ROUND_UP(num_cached_nodes, BLOCK_SIZE);
@@ -220,32 +206,19 @@ namespace diskann {
 
       reader->read(read_reqs, ctx);
 
-      _u64 node_idx = start_idx;
       for (_u32 i = 0; i < read_reqs.size(); i++) {
         auto &nhood = nhoods[i];
         char *node_buf = get_offset_to_node(nhood.second, nhood.first);
         T    *node_coords = OFFSET_TO_NODE_COORDS(node_buf);
-        T    *cached_coords = coord_cache_buf + node_idx * aligned_dim;
-        memcpy(cached_coords, node_coords, disk_bytes_per_point);
-
-        // insert node nhood into nhood_cache
+        // insert node nhood and coords into cache
         unsigned *node_nhood = OFFSET_TO_NODE_NHOOD(node_buf);
-
-        auto                        nnbrs = *node_nhood;
-        unsigned                   *nbrs = node_nhood + 1;
-        std::pair<_u32, unsigned *> cnhood;
-        cnhood.first = nnbrs;
-        cnhood.second = nhood_cache_buf.get() + node_idx * (max_degree + 1);
-        memcpy(cnhood.second, nbrs, nnbrs * sizeof(unsigned));
-        {
-          std::unique_lock<std::shared_mutex> lock(this->cache_mtx);
-          coord_cache.insert(std::make_pair(nhood.first, cached_coords));
-          nhood_cache.insert(std::make_pair(nhood.first, cnhood));
-        }
+        node_cache.add(nhood.first, node_coords, disk_bytes_per_point,
+                       *node_nhood, node_nhood + 1);
         aligned_free(nhood.second);
-        node_idx++;
       }
     }
+    // searches find the nodes from here on
+    node_cache.publish();
     this->reader->put_ctx(ctx);
     LOG_KNOWHERE_DEBUG_ << "done.";
   }
@@ -265,19 +238,7 @@ namespace diskann {
     this->count_visited_nodes.store(true);
 
     // sync allocate memory
-    if (nhood_cache_buf == nullptr) {
-      nhood_cache_buf =
-          std::make_unique<unsigned[]>(num_nodes_to_cache * (max_degree + 1));
-      memset(nhood_cache_buf.get(), 0,
-             num_nodes_to_cache * (max_degree + 1) * sizeof(unsigned));
-    }
-
-    _u64 coord_cache_buf_len = num_nodes_to_cache * aligned_dim;
-    if (coord_cache_buf == nullptr) {
-      diskann::alloc_aligned((void **) &coord_cache_buf,
-                             coord_cache_buf_len * sizeof(T), 8 * sizeof(T));
-      std::fill_n(coord_cache_buf, coord_cache_buf_len, T());
-    }
+    node_cache.init(num_nodes_to_cache, max_degree, aligned_dim);
 
     async_pool.push([&, state_controller = this->state_controller, sample_bin,
                      l_search, beamwidth, num_nodes_to_cache]() {
@@ -383,6 +344,60 @@ namespace diskann {
     return;
   }
 
+  template<typename T>
+  void PQFlashIndex<T>::enable_adaptive_cache(_u64 num_nodes_to_cache,
+                                              _u64 refresh_interval) {
+    node_cache.init(num_nodes_to_cache, max_degree, aligned_dim);
+    node_cache.enable_access_counts(num_points);
+    cache_refresh_interval = refresh_interval;
+  }
+
+  template<typename T>
+  bool PQFlashIndex<T>::count_search_for_cache() {
+    if (cache_refresh_interval == 0) {
+      return false;
+    }
+    const _u64 n =
+        cache_search_counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (n % cache_refresh_interval == 0 && !cache_refreshing.exchange(true)) {
+      async_pool.push([this]() {
+        if (!stop_cache_refresh.load()) {
+          try {
+            refresh_cache();
+          } catch (std::exception &e) {
+            LOG(INFO) << "Can't refresh Diskann cache: " << e.what();
+          }
+        }
+        cache_refreshing.store(false);
+      });
+    }
+    return n % kCacheAccessSampleRate == 0;
+  }
+
+  template<typename T>
+  void PQFlashIndex<T>::refresh_cache() {
+    std::vector<_u32> evict, admit;
+    node_cache.select_refresh(evict, admit);
+    if (admit.empty()) {
+      return;
+    }
+    node_cache.remove(evict);
+    load_cache_list(admit);
+#ifdef NOT_COMPILE_FOR_SWIG
+    knowhere::knowhere_diskann_cache_promotions.Increment(admit.size());
+#endif
+    LOG_KNOWHERE_DEBUG_ << "Refreshed cache, " << admit.size()
+                        << " nodes cached, " << evict.size() << " evicted.";
+  }
+
+  template<typename T>
+  void PQFlashIndex<T>::destroy_cache_refresh_task() {
+    stop_cache_refresh.store(true);
+    while (cache_refreshing.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
   template<typename T>
   void PQFlashIndex<T>::cache_bfs_levels(_u64 num_nodes_to_cache,
                                          std::vector<uint32_t> &node_list) {
@@ -508,6 +523,27 @@ namespace diskann {
     LOG(INFO) << "done";
   }
 
+  template<typename T>
+  _u32 PQFlashIndex<T>::select_entry_point(const float *query_float) {
+    if (!nav_graph.empty()) {
+      std::vector<_u32> closest;
+      nav_graph.search(query_float, kNavGraphSearchL, 1, closest);
+      return closest[0];
+    }
+    _u32  best_medoid = 0;
+    float best_dist = (std::numeric_limits<float>::max)();
+    for (_u64 cur_m = 0; cur_m < num_medoids; cur_m++) {
+      float cur_expanded_dist = dist_cmp_float_wrap(
+          query_float, centroid_data + aligned_dim * cur_m,
+          (size_t) aligned_dim, medoids[cur_m]);
+      if (cur_expanded_dist < best_dist) {
+        best_medoid = medoids[cur_m];
+        best_dist = cur_expanded_dist;
+      }
+    }
+    return best_medoid;
+  }
+
   template<typename T>
   void PQFlashIndex<T>::use_medoids_data_as_centroids() {
     if (centroid_data != nullptr)
@@ -693,6 +729,43 @@ namespace diskann {
 
     index_metadata.close();
 
+    std::string layout_file = get_disk_index_layout_filename(disk_index_file);
+    if (!long_node && file_exists(layout_file)) {
+      std::unique_ptr<_u32[]> locs;
+      size_t                  nlocs, tmp_dim;
+      diskann::load_bin<_u32>(layout_file, locs, nlocs, tmp_dim);
+      if (nlocs != num_points || tmp_dim != 1) {
+        LOG(ERROR) << "Mismatch in #points for layout file and disk index "
+                      "file: "
+                   << nlocs << " vs " << num_points;
+        return -1;
+      }
+      loc_to_id.assign(locs.get(), locs.get() + nlocs);
+      // each point must be at exactly one location.
+      id_to_loc.assign(nlocs, std::numeric_limits<_u32>::max());
+      for (_u32 loc = 0; loc < nlocs; loc++) {
+        const _u32 id = loc_to_id[loc];
+        if (id >= nlocs || id_to_loc[id] != std::numeric_limits<_u32>::max()) {
+          LOG(ERROR) << "Layout file " << layout_file
+                     << " is not a permutation of the points, id " << id
+                     << " at location " << loc;
+          loc_to_id.clear();
+          id_to_loc.clear();
+          return -1;
+        }
+        id_to_loc[id] = loc;
+      }
+      LOG(INFO) << "Loaded page aware layout of " << nlocs << " nodes.";
+    }
+
+    std::string nav_graph_file =
+        get_disk_index_nav_graph_filename(disk_index_file);
+    if (file_exists(nav_graph_file)) {
+      nav_graph.load(nav_graph_file, aligned_dim);
+      LOG(INFO) << "Loaded navigation graph of " << nav_graph.size()
+                << " nodes.";
+    }
+
     // open AlignedFileReader handle to index_file
     std::string index_fname(disk_index_file);
     reader->open(index_fname);
@@ -773,7 +846,6 @@ namespace diskann {
     }
     for (uint32_t i = 0; i < q_dim; i++) {
       data.scratch.aligned_query_float[i] = (float) query1[i];
-      data.scratch.aligned_query_T[i] = query1[i];
       query_norm += (float) query1[i] * (float) query1[i];
     }
 
@@ -786,12 +858,9 @@ namespace diskann {
       }
       query_norm = std::sqrt(query_norm);
       if (metric == diskann::Metric::INNER_PRODUCT) {
-        data.scratch.aligned_query_T[this->data_dim - 1] = 0;
         data.scratch.aligned_query_float[this->data_dim - 1] = 0;
       }
       for (uint32_t i = 0; i < q_dim; i++) {
-        data.scratch.aligned_query_T[i] =
-            (T) ((float) data.scratch.aligned_query_T[i] / query_norm);
         data.scratch.aligned_query_float[i] /= query_norm;
       }
     }
@@ -808,7 +877,6 @@ namespace diskann {
       const knowhere::feder::diskann::FederResultUniq &feder,
       knowhere::BitsetView                             bitset_view) {
     auto         query_scratch = &(data.scratch);
-    const T     *query = data.scratch.aligned_query_T;
     auto         beam_width = beam_width_param * kRefineBeamWidthFactor;
     const float *query_float = data.scratch.aligned_query_float;
     float       *pq_dists = query_scratch->aligned_pqtable_dist_scratch;
@@ -829,38 +897,41 @@ namespace diskann {
     knowhere::ResultMaxHeap<float, _u64> max_heap(k_search);
     Timer                                io_timer, query_timer;
 
-    // scan un-marked points and calculate pq dists
-    for (_u64 id = 0; id < num_points; ++id) {
-      if (bitset_view.empty() || !bitset_view.test(id)) {
-        pq_batch_ids.push_back(id);
+    // scan un-marked points and calculate pq dists, only the ids surviving the
+    // filter are visited
+    auto flush_pq_batch = [&]() {
+      const size_t sz = pq_batch_ids.size();
+      aggregate_coords(pq_batch_ids.data(), sz, this->data.get(),
+                       this->n_chunks, pq_coord_scratch);
+      pq_dist_lookup(pq_coord_scratch, sz, this->n_chunks, pq_dists,
+                     dist_scratch);
+      for (size_t i = 0; i < sz; ++i) {
+        pq_max_heap.Push(dist_scratch[i], pq_batch_ids[i]);
       }
-
-      if (pq_batch_ids.size() == pq_batch_size || id == num_points - 1) {
-        const size_t sz = pq_batch_ids.size();
-        aggregate_coords(pq_batch_ids.data(), sz, this->data.get(),
-                         this->n_chunks, pq_coord_scratch);
-        pq_dist_lookup(pq_coord_scratch, sz, this->n_chunks, pq_dists,
-                       dist_scratch);
-        for (size_t i = 0; i < sz; ++i) {
-          pq_max_heap.Push(dist_scratch[i], pq_batch_ids[i]);
-        }
-        pq_batch_ids.clear();
+      pq_batch_ids.clear();
+    };
+    bitset_view.for_each_allowed(num_points, [&](int64_t id) {
+      pq_batch_ids.push_back(id);
+      if (pq_batch_ids.size() == pq_batch_size) {
+        flush_pq_batch();
       }
+    });
+    if (!pq_batch_ids.empty()) {
+      flush_pq_batch();
     }
 
     // deduplicate sectors by ids
+    typename NodeCache<T>::ReadGuard cache(node_cache);
     while (const auto opt = pq_max_heap.Pop()) {
       const auto [dist, id] = opt.value();
 
       // check if in cache
-      {
-        std::shared_lock<std::shared_mutex> lock(this->cache_mtx);
-        if (coord_cache.find(id) != coord_cache.end()) {
-          float dist = dist_cmp_wrap(query, coord_cache.at(id),
-                                     (size_t) aligned_dim, id);
-          max_heap.Push(dist, id);
-          continue;
-        }
+      typename NodeCache<T>::Node cached_node;
+      if (cache.find(id, cached_node)) {
+        float dist = dist_cmp_wrap(query_float, cached_node.coords,
+                                   (size_t) aligned_dim, id);
+        max_heap.Push(dist, id);
+        continue;
       }
 
       // deduplicate and prepare for I/O
@@ -897,7 +968,7 @@ namespace diskann {
             char *node_buf = get_offset_to_node(sector_buf, cur_id);
             memcpy(node_fp_coords_copy, node_buf,
                    disk_bytes_per_point);  // Do we really need memcpy here?
-            float dist = dist_cmp_wrap(query, node_fp_coords_copy,
+            float dist = dist_cmp_wrap(query_float, node_fp_coords_copy,
                                        (size_t) aligned_dim, cur_id);
             max_heap.Push(dist, cur_id);
             if (feder != nullptr) {
@@ -949,7 +1020,8 @@ namespace diskann {
       float *distances, const _u64 beam_width, const bool use_reorder_data,
       QueryStats *stats, const knowhere::feder::diskann::FederResultUniq &feder,
       knowhere::BitsetView bitset_view, const float filter_ratio_in,
-      const bool for_tuning) {
+      const bool for_tuning, const _u64 io_depth,
+      SharedSectorReads *shared_reads) {
     if (beam_width > MAX_N_SECTOR_READS)
       throw ANNException("Beamwidth can not be higher than MAX_N_SECTOR_READS",
                          -1, __FUNCSIG__, __FILE__, __LINE__);
@@ -1010,7 +1082,6 @@ namespace diskann {
     }
 
     auto         query_scratch = &(data.scratch);
-    const T     *query = data.scratch.aligned_query_T;
     const float *query_float = data.scratch.aligned_query_float;
 
     // pointers to buffers for data
@@ -1028,9 +1099,18 @@ namespace diskann {
     frontier_nhoods.reserve(2 * beam_width);
     std::vector<AlignedRead> frontier_read_reqs;
     frontier_read_reqs.reserve(2 * beam_width);
-    std::vector<std::pair<unsigned, std::pair<unsigned, unsigned *>>>
+    std::vector<std::pair<unsigned, typename NodeCache<T>::Node>>
         cached_nhoods;
     cached_nhoods.reserve(2 * beam_width);
+    // the sectors of the beam claimed in shared_reads, and the frontier nhoods
+    // whose sector another search is reading
+    std::vector<_u64> claimed_offsets;
+    std::vector<_u64> awaited_nhoods;
+    // counted before the lookups, as the cache refresh it may start waits for
+    // the searches looking up nodes.
+    const bool record_accesses = count_search_for_cache();
+    // the cached nodes looked up stay in the cache until the search is done
+    typename NodeCache<T>::ReadGuard cache(node_cache);
 
     // query <-> PQ chunk centers distances
     float *pq_dists = query_scratch->aligned_pqtable_dist_scratch;
@@ -1060,17 +1140,7 @@ namespace diskann {
     // for tuning, do not use cache
     // lzh::找到起点
     if (for_tuning || !lru_cache.try_get(vec_hash, best_medoid)) {
-      float best_dist = (std::numeric_limits<float>::max)();
-      std::vector<SimpleNeighbor> medoid_dists;
-      for (_u64 cur_m = 0; cur_m < num_medoids; cur_m++) {
-        float cur_expanded_dist = dist_cmp_float_wrap(
-            query_float, centroid_data + aligned_dim * cur_m,
-            (size_t) aligned_dim, medoids[cur_m]);
-        if (cur_expanded_dist < best_dist) {
-          best_medoid = medoids[cur_m];
-          best_dist = cur_expanded_dist;
-        }
-      }
+      best_medoid = select_entry_point(query_float);
     }
 
     compute_dists(&best_medoid, 1, dist_scratch);
@@ -1114,14 +1184,393 @@ namespace diskann {
       return {filtered_nbrs.size(), filtered_nbrs.data()};
     };
 
+    // the best position in retset updated by process_node
+    unsigned nk = cur_list_size;
+    auto process_node = [&](T *node_fp_coords_copy, auto node_id, auto n_nbr,
+                            auto *nbrs) {
+      if (bitset_view.empty() || !bitset_view.test(node_id)) {
+        // lzh::如果没有被filter掉，找到距离q最近的node
+        float cur_expanded_dist;
+        if (!use_disk_index_pq) {
+          cur_expanded_dist =
+              dist_cmp_wrap(query_float, node_fp_coords_copy,
+                            (size_t) aligned_dim, node_id);
+        } else {
+          if (metric == diskann::Metric::INNER_PRODUCT ||
+              metric == diskann::Metric::COSINE)
+            cur_expanded_dist = disk_pq_table.inner_product(
+                query_float, (_u8 *) node_fp_coords_copy);
+          else
+            cur_expanded_dist = disk_pq_table.l2_distance(
+                query_float, (_u8 *) node_fp_coords_copy);
+        }
+
+        // lzh::以上比较了query和这个node的距离，然后放到了res集合里
+        full_retset.push_back(
+            Neighbor((unsigned) node_id, cur_expanded_dist, true));
+
+        // add top candidate info into feder result
+        if (feder != nullptr) {
+          feder->visit_info_.AddTopCandidateInfo(node_id, cur_expanded_dist);
+          feder->id_set_.insert(node_id);
+        }
+      }
+      // lzh::筛选出该node可以作为候选的neighbor
+      auto [nnbrs, node_nbrs] = filter_nbrs(n_nbr, nbrs);
+
+      // compute node_nbrs <-> query dists in PQ space
+      // lzh::算邻居的距离
+      cpu_timer.reset();
+      compute_dists(node_nbrs, nnbrs, dist_scratch);
+      if (stats != nullptr) {
+        stats->n_cmps += (double) nnbrs;
+        stats->cpu_us += (double) cpu_timer.elapsed();
+      }
+
+      cpu_timer.reset();
+
+      // process prefetched nhood
+      // lzh::比较邻居与retset
+      for (_u64 m = 0; m < nnbrs; ++m) {
+        unsigned id = node_nbrs[m];
+
+        // add neighbor info into feder result
+        if (feder != nullptr) {
+          feder->visit_info_.AddTopCandidateNeighbor(node_id, id,
+                                                     dist_scratch[m]);
+          feder->id_set_.insert(id);
+        }
+
+        float dist = dist_scratch[m];
+        if (stats != nullptr) {
+          stats->n_cmps++;
+        }
+        if (cur_list_size > 0 && dist >= retset[cur_list_size - 1].distance &&
+            (cur_list_size == l_search))
+          continue;
+        Neighbor nn(id, dist, true);
+        // Return position in sorted list where nn inserted.
+        auto r = InsertIntoPool(retset.data(), cur_list_size, nn);
+        if (cur_list_size < l_search)
+          ++cur_list_size;
+        if (r < nk)
+          // nk logs the best position in the retset that was
+          // updated due to neighbors of n.
+          nk = r;
+      }
+      if (stats != nullptr) {
+        stats->cpu_us += (double) cpu_timer.elapsed();
+      }
+    };
+
+    // With a page aware layout, the other nodes in the sector of a node read
+    // are mostly its neighbors, so the ones worth expanding are expanded
+    // along with it rather than read again later: the candidates not expanded
+    // yet, and the nodes not seen yet that make it into retset.
+    const bool expand_sector = !loc_to_id.empty();
+    auto expand_sector_nodes = [&](char *sector_buf, unsigned read_id) {
+      const _u64 sector_start =
+          get_node_loc(read_id) / nnodes_per_sector * nnodes_per_sector;
+      const _u64 sector_end =
+          std::min(num_points, sector_start + nnodes_per_sector);
+      for (_u64 loc = sector_start; loc < sector_end; loc++) {
+        unsigned id = loc_to_id[loc];
+        if (id == read_id) {
+          continue;
+        }
+        unsigned pos = 0;
+        if (visited.find(id) != visited.end()) {
+          while (pos < cur_list_size && retset[pos].id != id) {
+            pos++;
+          }
+          if (pos == cur_list_size || !retset[pos].flag) {
+            continue;
+          }
+          retset[pos].flag = false;
+          if (!bitset_view.empty() && bitset_view.test(id)) {
+            std::memmove(&retset[pos], &retset[pos + 1],
+                         (cur_list_size - pos - 1) * sizeof(Neighbor));
+            cur_list_size--;
+          }
+        } else {
+          if (!bitset_view.empty() && bitset_view.test(id)) {
+            continue;
+          }
+          compute_dists(&id, 1, dist_scratch);
+          if (cur_list_size == l_search &&
+              dist_scratch[0] >= retset[cur_list_size - 1].distance) {
+            continue;
+          }
+          visited.insert(id);
+          pos = InsertIntoPool(retset.data(), cur_list_size,
+                               Neighbor(id, dist_scratch[0], false));
+          if (cur_list_size < l_search) {
+            ++cur_list_size;
+          }
+        }
+        nk = std::min(nk, pos);
+        char *node_disk_buf =
+            sector_buf + (loc % nnodes_per_sector) * max_node_len;
+        unsigned *node_buf = OFFSET_TO_NODE_NHOOD(node_disk_buf);
+        memcpy(data_buf, OFFSET_TO_NODE_COORDS(node_disk_buf),
+               disk_bytes_per_point);
+        process_node(data_buf, id, *node_buf, node_buf + 1);
+      }
+    };
+
+    // Pipelined search: rather than reading a beam of candidates and waiting
+    // for all of the reads before expanding any of them, up to io_depth reads
+    // of the best unexpanded candidates are kept in flight. Each node is
+    // expanded as soon as its read completes, and the freed read goes to the
+    // best candidate at that time, so the SSD keeps working while the nodes
+    // read are expanded.
+    if (io_depth > 0) {
+      const _u64 pipeline_depth =
+          std::min({io_depth, (_u64) MAX_N_SECTOR_READS,
+                    (_u64) this->reader->max_events_per_ctx()});
+      // the node read into each slot, the buffer it's read into, and the
+      // slots not in use. A slot reads into its sector scratch, or into a
+      // buffer of shared_reads if the search claimed the sector there.
+      std::vector<unsigned> slot_nodes(pipeline_depth);
+      std::vector<char *>   slot_bufs(pipeline_depth, nullptr);
+      std::vector<bool>     slot_claimed(pipeline_depth, false);
+      // the offset read into each slot, 0 (the metadata) if not in use
+      std::vector<_u64>     slot_offsets(pipeline_depth, 0);
+      std::vector<_u64>     free_slots(pipeline_depth);
+      std::iota(free_slots.rbegin(), free_slots.rend(), 0);
+      std::vector<void *> completed;
+      completed.reserve(pipeline_depth);
+      // the reads submitted and not completed yet, and whether the reader is
+      // in a call, its reads in flight are unknown if the call throws
+      _u64 n_in_flight = 0;
+      bool in_reader = false;
+      // the nodes whose sector another search is reading, they take the
+      // place of reads in flight
+      struct SharedRead {
+        unsigned id;
+        _u64     offset;
+        char    *buf;
+      };
+      std::vector<SharedRead> awaited;
+
+      auto expand_read = [&](char *sector_buf, unsigned id) {
+        char     *node_disk_buf = get_offset_to_node(sector_buf, id);
+        unsigned *node_buf = OFFSET_TO_NODE_NHOOD(node_disk_buf);
+        T        *node_fp_coords = OFFSET_TO_NODE_COORDS(node_disk_buf);
+        memcpy(data_buf, node_fp_coords, disk_bytes_per_point);
+        nk = cur_list_size;
+        process_node(data_buf, id, *node_buf, node_buf + 1);
+        if (expand_sector) {
+          expand_sector_nodes(sector_buf, id);
+        }
+        k = std::min(k, nk);
+      };
+      // adds the read of the sector of id, into claimed_buf if not null
+      auto add_read = [&](unsigned id, _u64 offset, char *claimed_buf) {
+        const _u64 slot = free_slots.back();
+        free_slots.pop_back();
+        slot_nodes[slot] = id;
+        slot_offsets[slot] = offset;
+        slot_claimed[slot] = claimed_buf != nullptr;
+        slot_bufs[slot] = claimed_buf != nullptr
+                              ? claimed_buf
+                              : sector_scratch + slot * read_len_for_node;
+        frontier_read_reqs.emplace_back(offset, read_len_for_node,
+                                        slot_bufs[slot]);
+        if (stats != nullptr) {
+          stats->n_4k++;
+          stats->n_ios++;
+        }
+        num_ios++;
+      };
+      auto submit_reads = [&]() {
+        in_reader = true;
+        reader->submit_req(ctx, frontier_read_reqs);
+        in_reader = false;
+        n_in_flight += frontier_read_reqs.size();
+      };
+      auto sector_pending = [&](_u64 offset) {
+        return std::find(slot_offsets.begin(), slot_offsets.end(), offset) !=
+                   slot_offsets.end() ||
+               std::any_of(awaited.begin(), awaited.end(),
+                           [offset](const SharedRead &read) {
+                             return read.offset == offset;
+                           });
+      };
+      // reads the best candidates not expanded or read yet until the slots
+      // not in use are taken by the shared reads awaited, expanding cached
+      // ones right away.
+      auto issue_reads = [&]() {
+        frontier_read_reqs.clear();
+        while (k < cur_list_size && awaited.size() < free_slots.size()) {
+          if (!retset[k].flag) {
+            k++;
+            continue;
+          }
+          const unsigned id = retset[k].id;
+          const _u64     offset = get_node_sector_offset((size_t) id);
+          // expanded once the sector in flight is read
+          if (expand_sector && sector_pending(offset)) {
+            k++;
+            continue;
+          }
+          retset[k].flag = false;
+          {
+            std::shared_lock<std::shared_mutex> lock(
+                this->node_visit_counter_mtx);
+            if (this->count_visited_nodes) {
+              this->node_visit_counter[id].second->fetch_add(1);
+            }
+          }
+          if (record_accesses) {
+            node_cache.record_access(id);
+          }
+          if (!bitset_view.empty() && bitset_view.test(id)) {
+            std::memmove(&retset[k], &retset[k + 1],
+                         (cur_list_size - k - 1) * sizeof(Neighbor));
+            cur_list_size--;
+          }
+
+          typename NodeCache<T>::Node cached_node;
+          if (cache.find(id, cached_node)) {
+            if (stats != nullptr) {
+              stats->n_cache_hits++;
+              stats->n_hops++;
+            }
+            nk = cur_list_size;
+            process_node(cached_node.coords, id, cached_node.nnbrs,
+                         cached_node.nbrs);
+            k = std::min(k, nk);
+            continue;
+          }
+
+          char *shared_buf = nullptr;
+          if (shared_reads != nullptr) {
+            const auto status = shared_reads->acquire(offset, shared_buf);
+            if (status == SharedSectorReads::Status::READ) {
+              if (stats != nullptr) {
+                stats->n_shared_ios++;
+                stats->n_hops++;
+              }
+              expand_read(shared_buf, id);
+              continue;
+            }
+            if (status == SharedSectorReads::Status::IN_FLIGHT) {
+              awaited.push_back({id, offset, shared_buf});
+              continue;
+            }
+            if (status == SharedSectorReads::Status::NONE) {
+              shared_buf = nullptr;
+            }
+          }
+          add_read(id, offset, shared_buf);
+        }
+        if (!frontier_read_reqs.empty()) {
+          submit_reads();
+        }
+      };
+
+      try {
+        issue_reads();
+        while (n_in_flight > 0 || !awaited.empty()) {
+          if (n_in_flight > 0) {
+            completed.clear();
+            io_timer.reset();
+            in_reader = true;
+            reader->get_completed_req(ctx, 1, n_in_flight, completed);
+            in_reader = false;
+            n_in_flight -= completed.size();
+            if (stats != nullptr) {
+              stats->io_us += (double) io_timer.elapsed();
+              stats->n_hops++;
+            }
+          }
+          for (auto buf : completed) {
+            const _u64 slot =
+                std::find(slot_bufs.begin(), slot_bufs.end(), buf) -
+                slot_bufs.begin();
+            if (slot_claimed[slot]) {
+              shared_reads->publish(slot_offsets[slot]);
+            }
+            expand_read(static_cast<char *>(buf), slot_nodes[slot]);
+            slot_offsets[slot] = 0;
+            slot_bufs[slot] = nullptr;
+            free_slots.push_back(slot);
+            issue_reads();
+          }
+          completed.clear();
+          // the reads of other searches, waited for only once none of this
+          // search is in flight, so a search waiting has no claimed read
+          // that others may wait for
+          for (_u64 i = 0; i < awaited.size();) {
+            const SharedRead read = awaited[i];
+            const auto       status =
+                shared_reads->wait(read.offset, read.buf, n_in_flight == 0);
+            if (status == SharedSectorReads::Status::IN_FLIGHT) {
+              i++;
+              continue;
+            }
+            awaited.erase(awaited.begin() + i);
+            if (status == SharedSectorReads::Status::READ) {
+              if (stats != nullptr) {
+                stats->n_shared_ios++;
+                stats->n_hops++;
+              }
+              expand_read(read.buf, read.id);
+              issue_reads();
+            } else {
+              // abandoned, read on its own
+              frontier_read_reqs.clear();
+              add_read(read.id, read.offset, nullptr);
+              submit_reads();
+            }
+          }
+          hops++;
+        }
+      } catch (...) {
+        // wait for the reads still in flight: they write to the sector
+        // scratch and to the claimed buffers until they complete, and the
+        // next search of the context would reap them. The scratch and the
+        // context are then reusable, unless the reader itself failed and the
+        // reads it left in flight are unknown.
+        bool drained = !in_reader;
+        if (drained && n_in_flight > 0) {
+          try {
+            completed.clear();
+            reader->get_completed_req(ctx, n_in_flight, n_in_flight,
+                                      completed);
+          } catch (const std::exception &e) {
+            LOG(ERROR) << "Failed to drain " << n_in_flight
+                       << " reads of a failed search: " << e.what();
+            drained = false;
+          }
+        }
+        for (_u64 slot = 0; slot < pipeline_depth; slot++) {
+          if (slot_offsets[slot] != 0 && slot_claimed[slot]) {
+            shared_reads->abandon(slot_offsets[slot]);
+          }
+        }
+        if (drained) {
+          this->thread_data.push(data);
+          this->thread_data.push_notify_all();
+          this->reader->put_ctx(ctx);
+        }
+        throw;
+      }
+    }
+
     // lzh::主循环
+    // the pipelined search leaves no unexpanded candidates in retset, so this
+    // loop is skipped after it.
     while (k < cur_list_size) {
-      auto nk = cur_list_size;
+      nk = cur_list_size;
       // clear iteration state
       frontier.clear();
       frontier_nhoods.clear();
       frontier_read_reqs.clear();
       cached_nhoods.clear();
+      claimed_offsets.clear();
+      awaited_nhoods.clear();
       sector_scratch_idx = 0;
       // find new beam
       _u32 marker = k;
@@ -1133,19 +1582,16 @@ namespace diskann {
              num_seen < beam_width) {
         if (retset[marker].flag) {
           num_seen++;
-          {
-            std::shared_lock<std::shared_mutex> lock(this->cache_mtx);
-            auto iter = nhood_cache.find(retset[marker].id);
-            // lzh::判断其是否在cache里
-            if (iter != nhood_cache.end()) {
-              cached_nhoods.push_back(
-                  std::make_pair(retset[marker].id, iter->second));
-              if (stats != nullptr) {
-                stats->n_cache_hits++;
-              }
-            } else {
-              frontier.push_back(retset[marker].id);
+          // lzh::判断其是否在cache里
+          typename NodeCache<T>::Node cached_node;
+          if (cache.find(retset[marker].id, cached_node)) {
+            cached_nhoods.push_back(
+                std::make_pair(retset[marker].id, cached_node));
+            if (stats != nullptr) {
+              stats->n_cache_hits++;
             }
+          } else {
+            frontier.push_back(retset[marker].id);
           }
           retset[marker].flag = false;
           // 说明这个node被visited了
@@ -1156,6 +1602,9 @@ namespace diskann {
               this->node_visit_counter[retset[marker].id].second->fetch_add(1);
             }
           }
+          if (record_accesses) {
+            node_cache.record_access(retset[marker].id);
+          }
           if (!bitset_view.empty() && bitset_view.test(retset[marker].id)) {
             // 被干掉掉的节点，从retset中去除
             std::memmove(&retset[marker], &retset[marker + 1],
@@ -1176,14 +1625,52 @@ namespace diskann {
           stats->n_hops++;
         for (_u64 i = 0; i < frontier.size(); i++) {
           auto                    id = frontier[i];
+          const _u64              offset = get_node_sector_offset((size_t) id);
           std::pair<_u32, char *> fnhood;
           fnhood.first = id;
-          fnhood.second =
-              sector_scratch + sector_scratch_idx * read_len_for_node;
-          sector_scratch_idx++;
+          // nodes of the beam in the same sector share its read
+          auto same_sector = std::find_if(
+              frontier_read_reqs.begin(), frontier_read_reqs.end(),
+              [offset](const AlignedRead &req) {
+                return req.offset == offset;
+              });
+          if (same_sector != frontier_read_reqs.end()) {
+            fnhood.second = static_cast<char *>(same_sector->buf);
+            frontier_nhoods.push_back(fnhood);
+            continue;
+          }
+          // sectors read or being read by other searches are not read again
+          char *shared_buf = nullptr;
+          if (shared_reads != nullptr) {
+            const auto status = shared_reads->acquire(offset, shared_buf);
+            if (status == SharedSectorReads::Status::READ ||
+                status == SharedSectorReads::Status::IN_FLIGHT) {
+              if (status == SharedSectorReads::Status::IN_FLIGHT) {
+                awaited_nhoods.push_back(frontier_nhoods.size());
+              }
+              fnhood.second = shared_buf;
+              frontier_nhoods.push_back(fnhood);
+              if (stats != nullptr) {
+                stats->n_shared_ios++;
+              }
+              continue;
+            }
+            if (status == SharedSectorReads::Status::CLAIMED) {
+              claimed_offsets.push_back(offset);
+            } else {
+              shared_buf = nullptr;
+            }
+          }
+          if (shared_buf != nullptr) {
+            fnhood.second = shared_buf;
+          } else {
+            fnhood.second =
+                sector_scratch + sector_scratch_idx * read_len_for_node;
+            sector_scratch_idx++;
+          }
           frontier_nhoods.push_back(fnhood);
-          frontier_read_reqs.emplace_back(get_node_sector_offset(((size_t) id)),
-                                          read_len_for_node, fnhood.second);
+          frontier_read_reqs.emplace_back(offset, read_len_for_node,
+                                          fnhood.second);
           if (stats != nullptr) {
             stats->n_4k++;
             stats->n_ios++;
@@ -1191,101 +1678,53 @@ namespace diskann {
           num_ios++;
         }
         io_timer.reset();
-        reader->read(frontier_read_reqs, ctx);  // synchronous IO linux
-        if (stats != nullptr) {
-          stats->io_us += (double) io_timer.elapsed();
-        }
-      }
-
-      auto process_node = [&](T *node_fp_coords_copy, auto node_id, auto n_nbr,
-                              auto *nbrs) {
-        if (bitset_view.empty() || !bitset_view.test(node_id)) {
-          // lzh::如果没有被filter掉，找到距离q最近的node
-          float cur_expanded_dist;
-          if (!use_disk_index_pq) {
-            cur_expanded_dist = dist_cmp_wrap(query, node_fp_coords_copy,
-                                              (size_t) aligned_dim, node_id);
-          } else {
-            if (metric == diskann::Metric::INNER_PRODUCT ||
-                metric == diskann::Metric::COSINE)
-              cur_expanded_dist = disk_pq_table.inner_product(
-                  query_float, (_u8 *) node_fp_coords_copy);
-            else
-              cur_expanded_dist = disk_pq_table.l2_distance(
-                  query_float, (_u8 *) node_fp_coords_copy);
-          }
-
-          // lzh::以上比较了query和这个node的距离，然后放到了res集合里
-          full_retset.push_back(
-              Neighbor((unsigned) node_id, cur_expanded_dist, true));
-
-          // add top candidate info into feder result
-          if (feder != nullptr) {
-            feder->visit_info_.AddTopCandidateInfo(node_id, cur_expanded_dist);
-            feder->id_set_.insert(node_id);
+        if (!frontier_read_reqs.empty()) {
+          try {
+            reader->read(frontier_read_reqs, ctx);  // synchronous IO linux
+          } catch (...) {
+            for (auto offset : claimed_offsets) {
+              shared_reads->abandon(offset);
+            }
+            throw;
           }
         }
-        // lzh::筛选出该node可以作为候选的neighbor
-        auto [nnbrs, node_nbrs] = filter_nbrs(n_nbr, nbrs);
-
-        // compute node_nbrs <-> query dists in PQ space
-        // lzh::算邻居的距离
-        cpu_timer.reset();
-        compute_dists(node_nbrs, nnbrs, dist_scratch);
-        if (stats != nullptr) {
-          stats->n_cmps += (double) nnbrs;
-          stats->cpu_us += (double) cpu_timer.elapsed();
+        // published before waiting for the reads of others, so a search
+        // waiting has no claimed read that others may wait for
+        for (auto offset : claimed_offsets) {
+          shared_reads->publish(offset);
         }
-
-        cpu_timer.reset();
-
-        // process prefetched nhood
-        // lzh::比较邻居与retset
-        for (_u64 m = 0; m < nnbrs; ++m) {
-          unsigned id = node_nbrs[m];
-
-          // add neighbor info into feder result
-          if (feder != nullptr) {
-            feder->visit_info_.AddTopCandidateNeighbor(node_id, id,
-                                                       dist_scratch[m]);
-            feder->id_set_.insert(id);
+        for (auto i : awaited_nhoods) {
+          auto      &fnhood = frontier_nhoods[i];
+          const _u64 offset = get_node_sector_offset(fnhood.first);
+          if (shared_reads->wait(offset, fnhood.second) ==
+              SharedSectorReads::Status::READ) {
+            continue;
           }
-
-          float dist = dist_scratch[m];
+          // abandoned, read on its own
+          fnhood.second =
+              sector_scratch + sector_scratch_idx * read_len_for_node;
+          sector_scratch_idx++;
+          std::vector<AlignedRead> read_req(
+              1, AlignedRead(offset, read_len_for_node, fnhood.second));
+          reader->read(read_req, ctx);
           if (stats != nullptr) {
-            stats->n_cmps++;
+            stats->n_4k++;
+            stats->n_ios++;
           }
-          if (cur_list_size > 0 && dist >= retset[cur_list_size - 1].distance &&
-              (cur_list_size == l_search))
-            continue;
-          Neighbor nn(id, dist, true);
-          // Return position in sorted list where nn inserted.
-          auto r = InsertIntoPool(retset.data(), cur_list_size, nn);
-          if (cur_list_size < l_search)
-            ++cur_list_size;
-          if (r < nk)
-            // nk logs the best position in the retset that was
-            // updated due to neighbors of n.
-            nk = r;
+          num_ios++;
         }
         if (stats != nullptr) {
-          stats->cpu_us += (double) cpu_timer.elapsed();
+          stats->io_us += (double) io_timer.elapsed();
         }
-      };
+      }
 
       // process cached nhoods
       for (auto &cached_nhood : cached_nhoods) {
         if (stats != nullptr) {
           stats->n_hops++;
         }
-        T *node_fp_coords_copy;
-        {
-          std::shared_lock<std::shared_mutex> lock(this->cache_mtx);
-          auto global_cache_iter = coord_cache.find(cached_nhood.first);
-          node_fp_coords_copy = global_cache_iter->second;
-        }
-        process_node(node_fp_coords_copy, cached_nhood.first,
-                     cached_nhood.second.first, cached_nhood.second.second);
+        process_node(cached_nhood.second.coords, cached_nhood.first,
+                     cached_nhood.second.nnbrs, cached_nhood.second.nbrs);
       }
 
       for (auto &frontier_nhood : frontier_nhoods) {
@@ -1297,6 +1736,9 @@ namespace diskann {
         memcpy(node_fp_coords_copy, node_fp_coords, disk_bytes_per_point);
         process_node(node_fp_coords_copy, frontier_nhood.first, *node_buf,
                      node_buf + 1);
+        if (expand_sector) {
+          expand_sector_nodes(frontier_nhood.second, frontier_nhood.first);
+        }
       }
 
       // update best inserted position
@@ -1351,7 +1793,8 @@ namespace diskann {
         auto location =
             (sector_scratch + i * SECTOR_LEN) + VECTOR_SECTOR_OFFSET(id);
         full_retset[i].distance =
-            dist_cmp_wrap(query, (T *) location, this->data_dim, id);
+            dist_cmp_float_wrap(query_float, (float *) location,
+                                this->data_dim, id);
       }
 
       std::sort(full_retset.begin(), full_retset.end(),
@@ -1474,16 +1917,15 @@ namespace diskann {
   PQFlashIndex<T>::get_sectors_layout_and_write_data_from_cache(
       const int64_t *ids, int64_t n, T *output_data) {
     std::unordered_map<_u64, std::vector<_u64>> sectors_to_visit;
+    typename NodeCache<T>::ReadGuard cache(node_cache);
     for (int64_t i = 0; i < n; ++i) {
       _u64 id = ids[i];
-      {
-        std::shared_lock<std::shared_mutex> lock(this->cache_mtx);
-        if (coord_cache.find(id) != coord_cache.end()) {
-          copy_vec_base_data(output_data, i, coord_cache.at(id));
-        } else {
-          const _u64 sector_offset = get_node_sector_offset(id);
-          sectors_to_visit[sector_offset].push_back(i);
-        }
+      typename NodeCache<T>::Node cached_node;
+      if (cache.find(id, cached_node)) {
+        copy_vec_base_data(output_data, i, cached_node.coords);
+      } else {
+        const _u64 sector_offset = get_node_sector_offset(id);
+        sectors_to_visit[sector_offset].push_back(i);
       }
     }
     return sectors_to_visit;
@@ -1505,7 +1947,7 @@ namespace diskann {
     }
 
     const size_t batch_size =
-        std::min(AioContextPool::GetGlobalAioPool()->max_events_per_ctx(),
+        std::min(this->reader->max_events_per_ctx(),
                  std::min(MAX_N_SECTOR_READS / 2UL, sectors_to_visit.size()));
     const size_t half_buf_idx = MAX_N_SECTOR_READS / 2 * read_len_for_node;
     char        *sector_scratch = data.scratch.sector_scratch;
@@ -1578,6 +2020,11 @@ namespace diskann {
     return max_degree;
   }
 
+  template<typename T>
+  _u64 PQFlashIndex<T>::get_read_len_for_node() const noexcept {
+    return read_len_for_node;
+  }
+
   template<typename T>
   _u32 *PQFlashIndex<T>::get_medoids() const noexcept {
     return medoids.get();
@@ -1593,6 +2040,21 @@ namespace diskann {
     return metric;
   }
 
+  template<typename T>
+  float PQFlashIndex<T>::get_max_base_norm() const noexcept {
+    return max_base_norm;
+  }
+
+  template<typename T>
+  bool PQFlashIndex<T>::has_disk_pq() const noexcept {
+    return use_disk_index_pq;
+  }
+
+  template<typename T>
+  bool PQFlashIndex<T>::has_reorder_data() const noexcept {
+    return reorder_data_exists;
+  }
+
   template<typename T>
   void PQFlashIndex<T>::getIteratorNextBatch(IteratorWorkspace *workspace) {
 
@@ -1611,7 +2073,6 @@ namespace diskann {
     auto  ctx = this->reader->get_ctx();
 
     auto         query_scratch = &(data.scratch);
-    const T     *query = data.scratch.aligned_query_T;
     const float *query_float = data.scratch.aligned_query_float;
 
     // pointers to buffers for data
@@ -1637,9 +2098,10 @@ namespace diskann {
     frontier_nhoods.reserve(2 * workspace->Config.beam_width);
     std::vector<AlignedRead> frontier_read_reqs;
     frontier_read_reqs.reserve(2 * workspace->Config.beam_width);
-    std::vector<std::pair<unsigned, std::pair<unsigned, unsigned *>>>
+    std::vector<std::pair<unsigned, typename NodeCache<T>::Node>>
         cached_nhoods;
     cached_nhoods.reserve(2 * workspace->Config.beam_width);
+    typename NodeCache<T>::ReadGuard cache(node_cache);
 
     // lambda to batch compute query<-> node distances in PQ space
     auto compute_dists = [this, pq_coord_scratch, pq_dists](const unsigned *ids,
@@ -1661,17 +2123,7 @@ namespace diskann {
       // TODO::这个判断条件含义
       if (workspace->Config.for_tuning ||
           !lru_cache.try_get(vec_hash, best_medoid)) {
-        float best_dist = (std::numeric_limits<float>::max)();
-        std::vector<SimpleNeighbor> medoid_dists;
-        for (_u64 cur_m = 0; cur_m < num_medoids; cur_m++) {
-          float cur_expanded_dist = dist_cmp_float_wrap(
-              query_float, centroid_data + aligned_dim * cur_m,
-              (size_t) aligned_dim, medoids[cur_m]);
-          if (cur_expanded_dist < best_dist) {
-            best_medoid = medoids[cur_m];
-            best_dist = cur_expanded_dist;
-          }
-        }
+        best_medoid = select_entry_point(query_float);
       }
 
       compute_dists(&best_medoid, 1, dist_scratch);
@@ -1716,14 +2168,11 @@ namespace diskann {
       auto top = workspace->candidate.top();
       workspace->candidate.pop();
 
-      {
-        std::shared_lock<std::shared_mutex> lock(this->cache_mtx);
-        auto                                iter = nhood_cache.find(top.id);
-        if (iter != nhood_cache.end()) {
-          cached_nhoods.push_back(std::make_pair(top.id, iter->second));
-        } else {
-          frontier.push_back(top.id);
-        }
+      typename NodeCache<T>::Node cached_node;
+      if (cache.find(top.id, cached_node)) {
+        cached_nhoods.push_back(std::make_pair(top.id, cached_node));
+      } else {
+        frontier.push_back(top.id);
       }
       // TODO::bitview相关，筛选
 
@@ -1751,8 +2200,9 @@ namespace diskann {
           // lzh::如果没有被filter掉，找到距离q最近的node
           float cur_expanded_dist;
           if (!use_disk_index_pq) {
-            cur_expanded_dist = dist_cmp_wrap(query, node_fp_coords_copy,
-                                              (size_t) aligned_dim, node_id);
+            cur_expanded_dist =
+                dist_cmp_wrap(query_float, node_fp_coords_copy,
+                              (size_t) aligned_dim, node_id);
           } else {
             if (metric == diskann::Metric::INNER_PRODUCT ||
                 metric == diskann::Metric::COSINE)
@@ -1780,14 +2230,8 @@ namespace diskann {
       };
 
       for (auto &cached_nhood : cached_nhoods) {
-        T *node_fp_coords_copy;
-        {
-          std::shared_lock<std::shared_mutex> lock(this->cache_mtx);
-          auto global_cache_iter = coord_cache.find(cached_nhood.first);
-          node_fp_coords_copy = global_cache_iter->second;
-        }
-        process_node(node_fp_coords_copy, cached_nhood.first,
-                     cached_nhood.second.first, cached_nhood.second.second);
+        process_node(cached_nhood.second.coords, cached_nhood.first,
+                     cached_nhood.second.nnbrs, cached_nhood.second.nbrs);
       }
 
       for (auto &frontier_nhood : frontier_nhoods) {
@@ -1827,14 +2271,11 @@ namespace diskann {
     // thread data size:
     index_mem_size += (_u64) this->thread_data.size() * get_thread_data_size();
     // get cache size:
-    auto num_cached_nodes = coord_cache.size();
-    index_mem_size +=
-        ROUND_UP(num_cached_nodes * aligned_dim * sizeof(T), 8 * sizeof(T));
-    index_mem_size += num_cached_nodes * (max_degree + 1) * sizeof(unsigned);
-    index_mem_size += coord_cache.size() * sizeof(std::pair<_u32, T *>);
-    index_mem_size +=
-        nhood_cache.size() * sizeof(std::pair<_u32, std::pair<_u32, _u32 *>>);
+    index_mem_size += node_cache.memory_size();
+    // page aware layout:
+    index_mem_size += (id_to_loc.size() + loc_to_id.size()) * sizeof(_u32);
     // get entry points:
+    index_mem_size += nav_graph.memory_size();
     index_mem_size += ROUND_UP(num_medoids * aligned_dim * sizeof(float), 32);
     index_mem_size += num_medoids * aligned_dim * sizeof(uint32_t);
     // get pq data and pq_table:
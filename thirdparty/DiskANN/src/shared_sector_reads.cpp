@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "diskann/shared_sector_reads.h"
+
+namespace diskann {
+  SharedSectorReads::SharedSectorReads(_u64 read_len, _u64 max_bytes)
+      : read_len(read_len), max_reads(max_bytes / read_len) {
+  }
+
+  SharedSectorReads::~SharedSectorReads() {
+    for (auto block : blocks) {
+      aligned_free(block);
+    }
+  }
+
+  SharedSectorReads::Status SharedSectorReads::acquire(_u64   offset,
+                                                       char *&buf) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto                        it = entries.find(offset);
+    if (it != entries.end()) {
+      buf = it->second.buf;
+      n_shared++;
+      return it->second.read ? Status::READ : Status::IN_FLIGHT;
+    }
+    if (!free_bufs.empty()) {
+      buf = free_bufs.back();
+      free_bufs.pop_back();
+      entries.emplace(offset, Entry{buf, false});
+      return Status::CLAIMED;
+    }
+    if (n_claimed == max_reads) {
+      return Status::NONE;
+    }
+    if (n_claimed % kBlockReads == 0) {
+      char *block = nullptr;
+      // aligned as the sector scratch of the searches, for O_DIRECT reads
+      alloc_aligned((void **) &block, kBlockReads * read_len, 4096);
+      blocks.push_back(block);
+    }
+    buf = blocks.back() + (n_claimed % kBlockReads) * read_len;
+    n_claimed++;
+    entries.emplace(offset, Entry{buf, false});
+    return Status::CLAIMED;
+  }
+
+  void SharedSectorReads::publish(_u64 offset) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      entries[offset].read = true;
+      n_reads++;
+    }
+    cv.notify_all();
+  }
+
+  void SharedSectorReads::abandon(_u64 offset) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      // buf is claimed again by the next acquire() of a new sector, the
+      // searches waiting for this one find it gone, see wait()
+      auto it = entries.find(offset);
+      if (it != entries.end()) {
+        free_bufs.push_back(it->second.buf);
+        entries.erase(it);
+      }
+    }
+    cv.notify_all();
+  }
+
+  SharedSectorReads::Status SharedSectorReads::wait(_u64        offset,
+                                                    const char *buf,
+                                                    bool        block) {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+      // once abandoned, the sector may be claimed again into another buffer
+      auto it = entries.find(offset);
+      if (it == entries.end() || it->second.buf != buf) {
+        return Status::NONE;
+      }
+      if (it->second.read) {
+        return Status::READ;
+      }
+      if (!block) {
+        return Status::IN_FLIGHT;
+      }
+      cv.wait(lock);
+    }
+  }
+
+  _u64 SharedSectorReads::num_reads() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return n_reads;
+  }
+
+  _u64 SharedSectorReads::num_shared() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return n_shared;
+  }
+}  // namespace diskann
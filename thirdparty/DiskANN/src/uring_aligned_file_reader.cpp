@@ -0,0 +1,452 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "diskann/uring_aligned_file_reader.h"
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#include "diskann/ann_exception.h"
+#include "diskann/aux_utils.h"
+#include "diskann/utils.h"
+
+// reads and probing the supported ops came with the io_uring of Linux 5.6, as
+// did IORING_SETUP_ATTACH_WQ.
+#ifdef IORING_SETUP_ATTACH_WQ
+#define DISKANN_WITH_IO_URING 1
+#else
+#define DISKANN_WITH_IO_URING 0
+#endif
+
+// before Linux 5.11, the sqpoll thread only reads the registered files.
+#if DISKANN_WITH_IO_URING && !defined(IORING_FEAT_SQPOLL_NONFIXED)
+#define IORING_FEAT_SQPOLL_NONFIXED (1U << 7)
+#endif
+
+namespace {
+  static constexpr uint64_t n_retries = 10;
+  // same as the max events of a libaio context.
+  static constexpr unsigned ring_entries = diskann::MAX_N_SECTOR_READS / 2;
+  // the sqpoll thread sleeps after idling for this long.
+  static constexpr unsigned sq_thread_idle_ms = 1000;
+
+  [[noreturn]] void throw_io_error(const std::string &what, int err) {
+    std::stringstream ss;
+    ss << what << ", errno: " << err << ", " << strerror(err);
+    throw diskann::ANNException(ss.str(), -1, __FUNCSIG__, __FILE__, __LINE__);
+  }
+
+  std::mutex        global_uring_mut;
+  std::atomic<bool> global_uring_enabled{false};
+
+#if DISKANN_WITH_IO_URING
+  int sys_io_uring_setup(unsigned entries, struct io_uring_params *p) {
+    return (int) ::syscall(__NR_io_uring_setup, entries, p);
+  }
+
+  int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                         unsigned flags) {
+    return (int) ::syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                           flags, nullptr, 0);
+  }
+
+  int sys_io_uring_register(int fd, unsigned opcode, void *arg,
+                            unsigned nr_args) {
+    return (int) ::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+  }
+
+  // An io_uring of reads. The submission and completion queues are only
+  // touched by the thread that owns the ring, with the kernel on the other
+  // side of each.
+  class Ring {
+   public:
+    Ring() = default;
+    Ring(const Ring &) = delete;
+    Ring &operator=(const Ring &) = delete;
+
+    ~Ring() {
+      if (sqes_ != MAP_FAILED) {
+        ::munmap(sqes_, sqes_size_);
+      }
+      if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) {
+        ::munmap(cq_ptr_, cq_size_);
+      }
+      if (sq_ptr_ != MAP_FAILED) {
+        ::munmap(sq_ptr_, sq_size_);
+      }
+      if (fd_ >= 0) {
+        ::close(fd_);
+      }
+    }
+
+    // returns 0 or -errno. With sqpoll, attach_fd is the ring whose sqpoll
+    // thread to share, or -1 for a new thread.
+    int setup(unsigned entries, bool sqpoll, int attach_fd) {
+      struct io_uring_params p;
+      memset(&p, 0, sizeof(p));
+      if (sqpoll) {
+        p.flags |= IORING_SETUP_SQPOLL;
+        p.sq_thread_idle = sq_thread_idle_ms;
+        if (attach_fd >= 0) {
+          p.flags |= IORING_SETUP_ATTACH_WQ;
+          p.wq_fd = attach_fd;
+        }
+      }
+      fd_ = sys_io_uring_setup(entries, &p);
+      if (fd_ < 0) {
+        return -errno;
+      }
+      // the reads go to fds that are not registered.
+      if (sqpoll && !(p.features & IORING_FEAT_SQPOLL_NONFIXED)) {
+        return -EOPNOTSUPP;
+      }
+      sqpoll_ = sqpoll;
+      entries_ = p.sq_entries;
+
+      sq_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+      cq_size_ = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+      bool single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+      if (single_mmap) {
+        sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+      }
+      sq_ptr_ = ::mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+      if (sq_ptr_ == MAP_FAILED) {
+        return -errno;
+      }
+      cq_ptr_ = single_mmap
+                    ? sq_ptr_
+                    : ::mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+      if (cq_ptr_ == MAP_FAILED) {
+        return -errno;
+      }
+      sqes_size_ = p.sq_entries * sizeof(struct io_uring_sqe);
+      sqes_ = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+      if (sqes_ == MAP_FAILED) {
+        return -errno;
+      }
+
+      auto sq = static_cast<char *>(sq_ptr_);
+      sq_tail_ = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+      sq_mask_ = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+      sq_flags_ = reinterpret_cast<unsigned *>(sq + p.sq_off.flags);
+      sq_array_ = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+      auto cq = static_cast<char *>(cq_ptr_);
+      cq_head_ = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+      cq_tail_ = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+      cq_mask_ = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+      cqes_ = reinterpret_cast<struct io_uring_cqe *>(cq + p.cq_off.cqes);
+      return 0;
+    }
+
+    int fd() const {
+      return fd_;
+    }
+
+    unsigned entries() const {
+      return entries_;
+    }
+
+    // whether the kernel supports the reads issued by submit().
+    bool supports_read() {
+      size_t size = sizeof(struct io_uring_probe) +
+                    (IORING_OP_READ + 1) * sizeof(struct io_uring_probe_op);
+      std::vector<char> buf(size, 0);
+      auto probe = reinterpret_cast<struct io_uring_probe *>(buf.data());
+      if (sys_io_uring_register(fd_, IORING_REGISTER_PROBE, probe,
+                                IORING_OP_READ + 1) < 0) {
+        return false;
+      }
+      return probe->last_op >= IORING_OP_READ &&
+             (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+    }
+
+    // queues and submits reads, at most entries() reads may be in flight.
+    void submit(int file, const AlignedRead *reqs, size_t n) {
+      if (in_flight_ + n > entries_) {
+        std::stringstream err;
+        err << "Number of read requests in flight (" << in_flight_ + n
+            << ") exceeds the io_uring entries (" << entries_ << ")";
+        throw diskann::ANNException(err.str(), -1, __FUNCSIG__, __FILE__,
+                                    __LINE__);
+      }
+      // the kernel has consumed all submissions whose reads completed, so
+      // there is room for n more.
+      unsigned tail = *sq_tail_;
+      for (size_t i = 0; i < n; ++i, ++tail) {
+        unsigned idx = tail & sq_mask_;
+        auto     sqe = static_cast<struct io_uring_sqe *>(sqes_) + idx;
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = file;
+        sqe->off = reqs[i].offset;
+        sqe->addr = reinterpret_cast<uint64_t>(reqs[i].buf);
+        sqe->len = static_cast<uint32_t>(reqs[i].len);
+        sqe->user_data = reinterpret_cast<uint64_t>(reqs[i].buf);
+        sq_array_[idx] = idx;
+      }
+      __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+      in_flight_ += n;
+
+      if (sqpoll_) {
+        // the sqpoll thread must see the new tail before its flags are
+        // checked for a wakeup.
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(sq_flags_, __ATOMIC_RELAXED) &
+            IORING_SQ_NEED_WAKEUP) {
+          enter(0, 0, IORING_ENTER_SQ_WAKEUP, "io_uring_enter() wakeup");
+        }
+        return;
+      }
+      uint64_t submitted = 0, submit_retry = 0;
+      while (submitted < n) {
+        submitted += enter(n - submitted, 0, 0, "io_uring_enter() submit");
+        if (submitted < n && ++submit_retry > n_retries) {
+          std::stringstream err;
+          err << "io_uring_enter() submitted " << submitted << " of " << n
+              << " reads after retried " << n_retries << " times";
+          throw diskann::ANNException(err.str(), -1, __FUNCSIG__, __FILE__,
+                                      __LINE__);
+        }
+      }
+    }
+
+    // waits for n reads in flight to complete.
+    void wait(size_t n) {
+      wait(n, n, nullptr);
+    }
+
+    // waits for at least min_n and reaps at most max_n reads in flight,
+    // appending the bufs of the reaped reads to completed if not null.
+    void wait(size_t min_n, size_t max_n, std::vector<void *> *completed) {
+      int    error = 0;
+      size_t n = 0;
+      while (n < max_n) {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+          if (n >= min_n) {
+            break;
+          }
+          enter(0, min_n - n, IORING_ENTER_GETEVENTS, "io_uring_enter() wait");
+          continue;
+        }
+        for (; head != tail && n < max_n; ++head, ++n, --in_flight_) {
+          const auto &cqe = cqes_[head & cq_mask_];
+          if (cqe.res < 0 && error == 0) {
+            error = -cqe.res;
+          }
+          if (completed != nullptr) {
+            completed->push_back(reinterpret_cast<void *>(cqe.user_data));
+          }
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      }
+      // all completions are reaped first to leave the ring usable.
+      if (error != 0) {
+        throw_io_error("io_uring read failed", error);
+      }
+    }
+
+   private:
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags,
+              const char *what) {
+      int ret;
+      while ((ret = sys_io_uring_enter(fd_, to_submit, min_complete, flags)) <
+             0) {
+        if (errno != EINTR && errno != EAGAIN) {
+          throw_io_error(std::string("Unknown error occur in ") + what, errno);
+        }
+      }
+      return ret;
+    }
+
+    int      fd_ = -1;
+    bool     sqpoll_ = false;
+    unsigned entries_ = 0;
+    size_t   in_flight_ = 0;
+
+    void  *sq_ptr_ = MAP_FAILED;
+    void  *cq_ptr_ = MAP_FAILED;
+    void  *sqes_ = MAP_FAILED;
+    size_t sq_size_ = 0;
+    size_t cq_size_ = 0;
+    size_t sqes_size_ = 0;
+
+    unsigned             *sq_tail_ = nullptr;
+    unsigned              sq_mask_ = 0;
+    unsigned             *sq_flags_ = nullptr;
+    unsigned             *sq_array_ = nullptr;
+    unsigned             *cq_head_ = nullptr;
+    unsigned             *cq_tail_ = nullptr;
+    unsigned              cq_mask_ = 0;
+    struct io_uring_cqe *cqes_ = nullptr;
+  };
+
+  std::atomic<bool>     global_uring_sqpoll{false};
+  // ring set up when enabled, proving io_uring works, whose sqpoll thread the
+  // thread rings share.
+  std::unique_ptr<Ring> global_root_ring;
+
+  Ring *thread_ring() {
+    thread_local std::unique_ptr<Ring> ring;
+    if (ring == nullptr) {
+      int  attach_fd = -1;
+      bool sqpoll = global_uring_sqpoll.load();
+      if (sqpoll) {
+        std::scoped_lock lk(global_uring_mut);
+        attach_fd = global_root_ring != nullptr ? global_root_ring->fd() : -1;
+      }
+      auto new_ring = std::make_unique<Ring>();
+      int  ret = new_ring->setup(ring_entries, sqpoll, attach_fd);
+      if (ret != 0) {
+        throw_io_error("io_uring_setup() failed", -ret);
+      }
+      ring = std::move(new_ring);
+    }
+    return ring.get();
+  }
+#else
+  // never set up, InitGlobalUring() keeps the reader disabled.
+  class Ring {
+   public:
+    unsigned entries() const {
+      return ring_entries;
+    }
+
+    void submit(int file, const AlignedRead *reqs, size_t n) {
+      throw_io_error("io_uring is not supported", ENOSYS);
+    }
+
+    void wait(size_t n) {
+      throw_io_error("io_uring is not supported", ENOSYS);
+    }
+
+    void wait(size_t min_n, size_t max_n, std::vector<void *> *completed) {
+      throw_io_error("io_uring is not supported", ENOSYS);
+    }
+  };
+
+  Ring *thread_ring() {
+    throw_io_error("io_uring is not supported", ENOSYS);
+  }
+#endif
+}  // namespace
+
+bool UringAlignedFileReader::InitGlobalUring(bool enable, bool sqpoll) {
+  std::scoped_lock lk(global_uring_mut);
+  if (!enable) {
+    global_uring_enabled = false;
+    return false;
+  }
+#if DISKANN_WITH_IO_URING
+  // rings created before keep the sqpoll setting they were created with.
+  for (bool with_sqpoll : {sqpoll, false}) {
+    auto ring = std::make_unique<Ring>();
+    int  ret = ring->setup(ring_entries, with_sqpoll, -1);
+    if (ret != 0) {
+      LOG(WARNING) << "io_uring_setup() failed"
+                   << (with_sqpoll ? " with sqpoll" : "") << ", errno: " << -ret
+                   << ", " << strerror(-ret);
+      if (!with_sqpoll) {
+        break;
+      }
+      continue;
+    }
+    if (!ring->supports_read()) {
+      LOG(WARNING) << "io_uring doesn't support reads, using libaio";
+      break;
+    }
+    global_root_ring = std::move(ring);
+    global_uring_sqpoll = with_sqpoll;
+    global_uring_enabled = true;
+    LOG_KNOWHERE_INFO_ << "DiskANN reads with io_uring, sqpoll: "
+                       << with_sqpoll;
+    return true;
+  }
+#else
+  LOG(WARNING) << "Built without io_uring support, using libaio";
+#endif
+  global_uring_enabled = false;
+  return false;
+}
+
+bool UringAlignedFileReader::IsEnabled() {
+  return global_uring_enabled.load();
+}
+
+UringAlignedFileReader::UringAlignedFileReader() {
+  this->file_desc = -1;
+}
+
+UringAlignedFileReader::~UringAlignedFileReader() {
+  if (this->file_desc != -1) {
+    ::close(this->file_desc);
+  }
+}
+
+IOContext UringAlignedFileReader::get_ctx() {
+  return thread_ring();
+}
+
+size_t UringAlignedFileReader::max_events_per_ctx() {
+  return ring_entries;
+}
+
+void UringAlignedFileReader::open(const std::string &fname) {
+  int flags = O_DIRECT | O_RDONLY | O_LARGEFILE;
+  this->file_desc = ::open(fname.c_str(), flags);
+  if (this->file_desc == -1) {
+    throw_io_error("Failed to open " + fname, errno);
+  }
+  LOG_KNOWHERE_DEBUG_ << "Opened file : " << fname;
+}
+
+void UringAlignedFileReader::close() {
+  if (this->file_desc != -1) {
+    ::close(this->file_desc);
+    this->file_desc = -1;
+  }
+}
+
+void UringAlignedFileReader::read(std::vector<AlignedRead> &read_reqs,
+                                  IOContext &ctx, bool async) {
+  if (async == true) {
+    diskann::cout << "Async currently not supported in linux." << std::endl;
+  }
+  assert(this->file_desc != -1);
+  auto ring = static_cast<Ring *>(ctx);
+  for (size_t begin = 0; begin < read_reqs.size(); begin += ring->entries()) {
+    auto n = std::min<size_t>(ring->entries(), read_reqs.size() - begin);
+    ring->submit(this->file_desc, read_reqs.data() + begin, n);
+    ring->wait(n);
+  }
+}
+
+void UringAlignedFileReader::submit_req(IOContext                &ctx,
+                                        std::vector<AlignedRead> &read_reqs) {
+  static_cast<Ring *>(ctx)->submit(this->file_desc, read_reqs.data(),
+                                   read_reqs.size());
+}
+
+void UringAlignedFileReader::get_submitted_req(IOContext &ctx, size_t n_ops) {
+  static_cast<Ring *>(ctx)->wait(n_ops);
+}
+
+void UringAlignedFileReader::get_completed_req(IOContext &ctx, size_t min_n,
+                                               size_t               max_n,
+                                               std::vector<void *> &completed) {
+  static_cast<Ring *>(ctx)->wait(min_n, max_n, &completed);
+}
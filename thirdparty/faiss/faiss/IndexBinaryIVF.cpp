@@ -395,17 +395,21 @@ struct IVFBinaryScannerL2 : BinaryInvertedListScanner {
         using C = CMax<int32_t, idx_t>;
 
         size_t nup = 0;
-        for (size_t j = 0; j < n; j++) {
-            if (!this->sel || this->sel->is_member(ids[j])) {
-                auto dis = hc.compute(codes);
-                if (dis < simi[0]) {
-                    idx_t id = store_pairs ? lo_build(list_no, j) : ids[j];
-                    heap_replace_top<C>(k, simi, idxi, dis, id);
-                    nup++;
-                }
-            }
-            codes += code_size;
-        }
+        scan_binary_codes(
+                hc,
+                codes,
+                code_size,
+                n,
+                [&](size_t j) {
+                    return !this->sel || this->sel->is_member(ids[j]);
+                },
+                [&](size_t j, int32_t dis) {
+                    if (dis < simi[0]) {
+                        idx_t id = store_pairs ? lo_build(list_no, j) : ids[j];
+                        heap_replace_top<C>(k, simi, idxi, dis, id);
+                        nup++;
+                    }
+                });
         return nup;
     }
 
@@ -415,16 +419,20 @@ struct IVFBinaryScannerL2 : BinaryInvertedListScanner {
             const idx_t* __restrict ids,
             float radius,
             RangeQueryResult& result) const override {
-        for (size_t j = 0; j < n; j++) {
-            if (!this->sel || this->sel->is_member(ids[j])) {
-                auto dis = hc.compute(codes);
-                if (dis < radius) {
-                    int64_t id = store_pairs ? lo_build(list_no, j) : ids[j];
-                    result.add(dis, id);
-                }
-            }
-            codes += code_size;
-        }
+        scan_binary_codes(
+                hc,
+                codes,
+                code_size,
+                n,
+                [&](size_t j) {
+                    return !this->sel || this->sel->is_member(ids[j]);
+                },
+                [&](size_t j, int32_t dis) {
+                    if (dis < radius) {
+                        int64_t id = store_pairs ? lo_build(list_no, j) : ids[j];
+                        result.add(dis, id);
+                    }
+                });
     }
 };
 
@@ -461,17 +469,21 @@ struct IVFBinaryScannerJaccard : BinaryInvertedListScanner {
         // todo aguzhva: this is a dirty hack in the baseline
         float* psimi = (float*)simi;
         size_t nup = 0;
-        for (size_t j = 0; j < n; j++) {
-            if (!this->sel || this->sel->is_member(ids[j])) {
-                float dis = hc.compute(codes);
-                if (dis < psimi[0]) {
-                    idx_t id = store_pairs ? lo_build(list_no, j) : ids[j];
-                    heap_replace_top<C>(k, psimi, idxi, dis, id);
-                    nup++;
-                }
-            }
-            codes += code_size;
-        }
+        scan_binary_codes(
+                hc,
+                codes,
+                code_size,
+                n,
+                [&](size_t j) {
+                    return !this->sel || this->sel->is_member(ids[j]);
+                },
+                [&](size_t j, float dis) {
+                    if (dis < psimi[0]) {
+                        idx_t id = store_pairs ? lo_build(list_no, j) : ids[j];
+                        heap_replace_top<C>(k, psimi, idxi, dis, id);
+                        nup++;
+                    }
+                });
         return nup;
     }
 
@@ -481,16 +493,20 @@ struct IVFBinaryScannerJaccard : BinaryInvertedListScanner {
             const idx_t* ids,
             float radius,
             RangeQueryResult& result) const override {
-        for (size_t j = 0; j < n; j++) {
-            if (!this->sel || this->sel->is_member(ids[j])) {
-                float dis = hc.compute(codes);
-                if (dis < radius) {
-                    idx_t id = store_pairs ? lo_build(list_no, j) : ids[j];
-                    result.add(dis, id);
-                }
-            }
-            codes += code_size;
-        }
+        scan_binary_codes(
+                hc,
+                codes,
+                code_size,
+                n,
+                [&](size_t j) {
+                    return !this->sel || this->sel->is_member(ids[j]);
+                },
+                [&](size_t j, float dis) {
+                    if (dis < radius) {
+                        idx_t id = store_pairs ? lo_build(list_no, j) : ids[j];
+                        result.add(dis, id);
+                    }
+                });
     }
 };
 
@@ -1000,10 +1016,11 @@ BinaryInvertedListScanner* select_IVFBinaryScannerJaccard(
         HANDLE_CS(16)
         HANDLE_CS(32)
         HANDLE_CS(64)
-        HANDLE_CS(128)
-        HANDLE_CS(256)
-        HANDLE_CS(512)
         default:
+            if (code_size > kHookedBinaryCodeSizeThreshold) {
+                return new IVFBinaryScannerJaccard<JaccardComputerHook>(
+                        code_size, store_pairs, sel);
+            }
             return new IVFBinaryScannerJaccard<
                     JaccardComputerDefault>(code_size, store_pairs, sel);
     }
@@ -463,18 +463,20 @@ void binary_knn_hc(
                 MetricComputer hc(bs1 + i * bytes_per_code, bytes_per_code);
 
                 const uint8_t* bs2_ = bs2 + j0 * bytes_per_code;
-                T dis;
                 T* __restrict bh_val_ = ha->val + i * k;
                 int64_t* __restrict bh_ids_ = ha->ids + i * k;
-                for (size_t j = j0; j < j1; j++, bs2_ += bytes_per_code) {
-                    if (!sel || sel->is_member(j)) {
-                        dis = hc.compute(bs2_);
-                        if (C::cmp(bh_val_[0], dis)) {
-                            faiss::heap_replace_top<C>(
-                                    k, bh_val_, bh_ids_, dis, j);
-                        }
-                    }
-                }
+                scan_binary_codes(
+                        hc,
+                        bs2_,
+                        bytes_per_code,
+                        j1 - j0,
+                        [&](size_t j) { return !sel || sel->is_member(j0 + j); },
+                        [&](size_t j, T dis) {
+                            if (C::cmp(bh_val_[0], dis)) {
+                                faiss::heap_replace_top<C>(
+                                        k, bh_val_, bh_ids_, dis, j0 + j);
+                            }
+                        });
             }
         }
     }
@@ -503,13 +505,15 @@ void binary_knn_hc(
                     binary_knn_hc_jaccard(16);
                     binary_knn_hc_jaccard(32);
                     binary_knn_hc_jaccard(64);
-                    binary_knn_hc_jaccard(128);
-                    binary_knn_hc_jaccard(256);
-                    binary_knn_hc_jaccard(512);
 #undef binary_knn_hc_jaccard
                     default:
-                        binary_knn_hc<C, faiss::JaccardComputerDefault>(
-                                ncodes, ha, a, b, nb, sel);
+                        if (ncodes > kHookedBinaryCodeSizeThreshold) {
+                            binary_knn_hc<C, faiss::JaccardComputerHook>(
+                                    ncodes, ha, a, b, nb, sel);
+                        } else {
+                            binary_knn_hc<C, faiss::JaccardComputerDefault>(
+                                    ncodes, ha, a, b, nb, sel);
+                        }
                         break;
                 }
             }
@@ -532,8 +536,13 @@ void binary_knn_hc(
                     binary_knn_hc_hamming(64);
 #undef binary_knn_hc_hamming
                     default:
-                        binary_knn_hc<C, faiss::HammingComputerDefault>(
-                                ncodes, ha, a, b, nb, sel);
+                        if (ncodes > kHookedBinaryCodeSizeThreshold) {
+                            binary_knn_hc<C, faiss::HammingComputerHook>(
+                                    ncodes, ha, a, b, nb, sel);
+                        } else {
+                            binary_knn_hc<C, faiss::HammingComputerDefault>(
+                                    ncodes, ha, a, b, nb, sel);
+                        }
                         break;
                 }
             }
@@ -580,14 +589,17 @@ void binary_range_search(
         for (int64_t i = 0; i < na; i++) {
             MetricComputer mc(a + i * code_size, code_size);
             RangeQueryResult& qres = pres.new_result(i);
-            for (size_t j = 0; j < nb; j++) {
-                if (!sel || sel->is_member(j)) {
-                    T dis = mc.compute(b + j * code_size);
-                    if (C::cmp(dis, radius)) {
-                        qres.add(dis, j);
-                    }
-                }
-            }
+            scan_binary_codes(
+                    mc,
+                    b,
+                    code_size,
+                    nb,
+                    [&](size_t j) { return !sel || sel->is_member(j); },
+                    [&](size_t j, T dis) {
+                        if (C::cmp(dis, radius)) {
+                            qres.add(dis, j);
+                        }
+                    });
         }
         pres.finalize();
     }
@@ -617,16 +629,21 @@ void binary_range_search(
                     binary_range_search_jaccard(16);
                     binary_range_search_jaccard(32);
                     binary_range_search_jaccard(64);
-                    binary_range_search_jaccard(128);
-                    binary_range_search_jaccard(256);
-                    binary_range_search_jaccard(512);
 #undef binary_range_search_jaccard
                     default:
-                        binary_range_search<
-                                C,
-                                T,
-                                faiss::JaccardComputerDefault>(
-                                a, b, na, nb, radius, code_size, res, sel);
+                        if (code_size > kHookedBinaryCodeSizeThreshold) {
+                            binary_range_search<
+                                    C,
+                                    T,
+                                    faiss::JaccardComputerHook>(
+                                    a, b, na, nb, radius, code_size, res, sel);
+                        } else {
+                            binary_range_search<
+                                    C,
+                                    T,
+                                    faiss::JaccardComputerDefault>(
+                                    a, b, na, nb, radius, code_size, res, sel);
+                        }
                         break;
                 }
             }
@@ -649,11 +666,19 @@ void binary_range_search(
                     binary_range_search_hamming(64);
 #undef binary_range_search_hamming
                     default:
-                        binary_range_search<
-                                C,
-                                T,
-                                faiss::HammingComputerDefault>(
-                                a, b, na, nb, radius, code_size, res, sel);
+                        if (code_size > kHookedBinaryCodeSizeThreshold) {
+                            binary_range_search<
+                                    C,
+                                    T,
+                                    faiss::HammingComputerHook>(
+                                    a, b, na, nb, radius, code_size, res, sel);
+                        } else {
+                            binary_range_search<
+                                    C,
+                                    T,
+                                    faiss::HammingComputerDefault>(
+                                    a, b, na, nb, radius, code_size, res, sel);
+                        }
                         break;
                 }
             }
@@ -13,6 +13,10 @@
 
 #include <faiss/utils/hamming_distance/common.h>
 
+#include <type_traits>
+
+#include "simd/hook.h"
+
 #ifdef __aarch64__
 // ARM compilers may produce inoptimal code for Hamming distance somewhy.
 #include <faiss/utils/hamming_distance/neon-inl.h>
@@ -52,6 +56,109 @@ SPECIALIZED_HC(64);
 
 #undef SPECIALIZED_HC
 
+/***************************************************************************
+ * Computer for long codes, backed by the vectorized popcount kernels of
+ * simd/hook.h. Codes up to kHookedBinaryCodeSizeThreshold bytes stay on the
+ * unrolled HammingComputerXX, where the call through the hook would cost
+ * more than the popcounts themselves.
+ **************************************************************************/
+
+constexpr int kHookedBinaryCodeSizeThreshold = 64;
+
+struct HammingComputerHook {
+    const uint8_t* a8;
+    int code_size;
+
+    HammingComputerHook() {}
+
+    HammingComputerHook(const uint8_t* a8, int code_size) {
+        set(a8, code_size);
+    }
+
+    void set(const uint8_t* a8_2, int code_size_2) {
+        a8 = a8_2;
+        code_size = code_size_2;
+    }
+
+    inline int compute(const uint8_t* b8) const {
+        return bvec_hamming_dis(a8, b8, code_size);
+    }
+
+    inline void compute_batch_4(
+            const uint8_t* b0,
+            const uint8_t* b1,
+            const uint8_t* b2,
+            const uint8_t* b3,
+            int& dis0,
+            int& dis1,
+            int& dis2,
+            int& dis3) const {
+        bvec_hamming_dis_batch_4(
+                a8, b0, b1, b2, b3, code_size, dis0, dis1, dis2, dis3);
+    }
+
+    inline int get_code_size() const {
+        return code_size;
+    }
+};
+
+template <class Computer, class = void>
+struct has_compute_batch_4 : std::false_type {};
+
+template <class Computer>
+struct has_compute_batch_4<
+        Computer,
+        std::void_t<decltype(&Computer::compute_batch_4)>> : std::true_type {};
+
+/// Call consume(j, dis) for every code j in [0, n) for which filter(j) holds,
+/// in ascending order of j. Computers that provide compute_batch_4 score the
+/// selected codes 4 at a time.
+template <class Computer, class Filter, class Consumer>
+inline void scan_binary_codes(
+        const Computer& hc,
+        const uint8_t* codes,
+        size_t code_size,
+        size_t n,
+        Filter&& filter,
+        Consumer&& consume) {
+    if constexpr (has_compute_batch_4<Computer>::value) {
+        using dis_t = decltype(hc.compute(codes));
+        size_t buf[4];
+        int nbuf = 0;
+        for (size_t j = 0; j < n; j++) {
+            if (!filter(j)) {
+                continue;
+            }
+            buf[nbuf++] = j;
+            if (nbuf == 4) {
+                dis_t dis[4];
+                hc.compute_batch_4(
+                        codes + buf[0] * code_size,
+                        codes + buf[1] * code_size,
+                        codes + buf[2] * code_size,
+                        codes + buf[3] * code_size,
+                        dis[0],
+                        dis[1],
+                        dis[2],
+                        dis[3]);
+                for (int b = 0; b < 4; b++) {
+                    consume(buf[b], dis[b]);
+                }
+                nbuf = 0;
+            }
+        }
+        for (int b = 0; b < nbuf; b++) {
+            consume(buf[b], hc.compute(codes + buf[b] * code_size));
+        }
+    } else {
+        for (size_t j = 0; j < n; j++) {
+            if (filter(j)) {
+                consume(j, hc.compute(codes + j * code_size));
+            }
+        }
+    }
+}
+
 /***************************************************************************
  * Dispatching function that takes a code size and a consumer object
  * the consumer object should contain a retun type t and a operation template
@@ -74,6 +181,9 @@ typename Consumer::T dispatch_HammingComputer(
         DISPATCH_HC(32);
         DISPATCH_HC(64);
         default:
+            if (code_size > kHookedBinaryCodeSizeThreshold) {
+                return consumer.template f<HammingComputerHook>(args...);
+            }
             return consumer.template f<HammingComputerDefault>(args...);
     }
 }
@@ -19,6 +19,8 @@
 
 #include <faiss/utils/hamming_distance/common.h>
 
+#include "simd/hook.h"
+
 namespace faiss {
 
 // todo aguzhva: upgrade code
@@ -459,6 +461,39 @@ struct JaccardComputerDefault {
     }
 };
 
+// long codes, backed by the vectorized popcount kernels of simd/hook.h
+struct JaccardComputerHook {
+    const uint8_t* a;
+    int n;
+
+    JaccardComputerHook() {}
+
+    JaccardComputerHook(const uint8_t* a8, int code_size) {
+        set(a8, code_size);
+    }
+
+    void set(const uint8_t* a8, int code_size) {
+        a = a8;
+        n = code_size;
+    }
+
+    float compute(const uint8_t* b8) const {
+        return bvec_jaccard_dis(a, b8, n);
+    }
+
+    void compute_batch_4(
+            const uint8_t* b0,
+            const uint8_t* b1,
+            const uint8_t* b2,
+            const uint8_t* b3,
+            float& dis0,
+            float& dis1,
+            float& dis2,
+            float& dis3) const {
+        bvec_jaccard_dis_batch_4(a, b0, b1, b2, b3, n, dis0, dis1, dis2, dis3);
+    }
+};
+
 // default template
 template <int CODE_SIZE>
 struct JaccardComputer : JaccardComputerDefault {
@@ -1304,12 +1304,11 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
     std::vector<std::pair<dist_t, labeltype>>
     searchKnnBF(const void* query_data, size_t k, const knowhere::BitsetView bitset) const {
         knowhere::ResultMaxHeap<dist_t, labeltype> max_heap(k);
-        for (labeltype id = 0; id < cur_element_count; ++id) {
-            if (bitset.empty() || !bitset.test(id)) {
-                dist_t dist = calcDistance(query_data, id);
-                max_heap.Push(dist, id);
-            }
-        }
+        // only visit the ids that survive the filter
+        bitset.for_each_allowed(cur_element_count, [&](int64_t id) {
+            dist_t dist = calcDistance(query_data, id);
+            max_heap.Push(dist, id);
+        });
         const size_t len = std::min(max_heap.Size(), k);
         std::vector<std::pair<dist_t, labeltype>> result(len);
         for (int64_t i = len - 1; i >= 0; --i) {
@@ -1546,14 +1545,12 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
     std::vector<std::pair<dist_t, labeltype>>
     searchRangeBF(const void* query_data, float radius, const knowhere::BitsetView bitset) const {
         std::vector<std::pair<dist_t, labeltype>> result;
-        for (labeltype id = 0; id < cur_element_count; ++id) {
-            if (bitset.empty() || !bitset.test(id)) {
-                dist_t dist = calcDistance(query_data, id);
-                if (dist < radius) {
-                    result.emplace_back(dist, id);
-                }
+        bitset.for_each_allowed(cur_element_count, [&](int64_t id) {
+            dist_t dist = calcDistance(query_data, id);
+            if (dist < radius) {
+                result.emplace_back(dist, id);
             }
-        }
+        });
         return result;
     }
 